@@ -23,6 +23,8 @@ import h5py
 import struct
 import argparse
 import sys
+import glob
+import os
 
 # class for parsing Bfs messages
 class BfsMessage:
@@ -34,7 +36,7 @@ class BfsMessage:
     _ReturnPayload = []
     _LengthBuffer = []
     _Checksum = [0,0]
-    DataTypes = ("Uint64Key","Uint32Key","Uint16Key","Uint8Key","Int64Key","Int32Key","Int16Key","Int8Key","FloatKey","DoubleKey","Uint64Desc","Uint32Desc","Uint16Desc","Uint8Desc","Int64Desc","Int32Desc","Int16Desc","Int8Desc","FloatDesc","DoubleDesc","Data")
+    DataTypes = ("Uint64Key","Uint32Key","Uint16Key","Uint8Key","Int64Key","Int32Key","Int16Key","Int8Key","FloatKey","DoubleKey","Uint64Desc","Uint32Desc","Uint16Desc","Uint8Desc","Int64Desc","Int32Desc","Int16Desc","Int8Desc","FloatDesc","DoubleDesc","Data","GroupDef","GroupKey","GroupDesc","GroupData","Float16Key","ScaledInt16Key","ScaledUint16Key","Float16Desc","ScaledInt16Desc","ScaledUint16Desc","EventKey","EventDesc","EventData","StringKey")
     def Parse(Self,ByteRead):
         Header = bytearray([0x42,0x46])
         HeaderLength = 5;
@@ -111,6 +113,147 @@ class BfsMessage:
             Checksum[1] = (Checksum[1] + Checksum[0]) % 256
         return Checksum
 
+# CRC16 (xmodem) used to check compressed datalog blocks
+Crc16Table = []
+for i in range(0,256):
+    Crc = i << 8
+    for j in range(0,8):
+        Crc = ((Crc << 1) ^ 0x1021) if (Crc & 0x8000) else (Crc << 1)
+    Crc16Table.append(Crc & 0xffff)
+
+def Crc16(ByteArray):
+    Crc = 0
+    for Byte in ByteArray:
+        Crc = ((Crc << 8) & 0xffff) ^ Crc16Table[((Crc >> 8) ^ Byte) & 0xff]
+    return Crc
+
+# decodes a block in the LZ4 block format
+def Lz4Decompress(Src, RawSize):
+    Dst = bytearray()
+    i = 0
+    while i < len(Src):
+        Token = Src[i]
+        i += 1
+        Length = Token >> 4
+        if Length == 15:
+            while True:
+                Length += Src[i]
+                i += 1
+                if Src[i-1] != 255:
+                    break
+        Dst += Src[i:i+Length]
+        i += Length
+        if i >= len(Src):
+            break
+        Offset = Src[i] | (Src[i+1] << 8)
+        i += 2
+        Length = Token & 15
+        if Length == 15:
+            while True:
+                Length += Src[i]
+                i += 1
+                if Src[i-1] != 255:
+                    break
+        Length += 4
+        Start = len(Dst) - Offset
+        if Offset >= Length:
+            Dst += Dst[Start:Start+Length]
+        else:
+            for j in range(0,Length):
+                Dst.append(Dst[Start+j])
+    if len(Dst) != RawSize:
+        raise ValueError("block size mismatch")
+    return Dst
+
+# undoes the XOR of each Data and GroupData payload with the previous payload of its stream
+def UnXorRows(Block):
+    Previous = {}
+    Location = 0
+    while Location + 5 <= len(Block):
+        if Block[Location] != 0x42 or Block[Location+1] != 0x46:
+            break
+        Type = Block[Location+2]
+        Length = Block[Location+3] | (Block[Location+4] << 8)
+        Start = Location + 5
+        Location += 5 + Length + 2
+        if Location > len(Block):
+            break
+        if BfsMessage.DataTypes[Type] == 'Data':
+            Key = -1
+        elif BfsMessage.DataTypes[Type] == 'GroupData' and Length > 0:
+            Key = Block[Start]
+            Start += 1
+            Length -= 1
+        else:
+            continue
+        if Key in Previous and len(Previous[Key]) == Length:
+            Prev = Previous[Key]
+            for i in range(0,Length):
+                Block[Start+i] ^= Prev[i]
+        Previous[Key] = Block[Start:Start+Length]
+    return Block
+
+# returns the contents of a datalog file, inflating compressed logs up to the last complete block
+def InflateLog(Contents):
+    Contents = bytearray(Contents)
+    if Contents[0:4] != bytearray([0x42,0x46,0x5a,1]):
+        return Contents
+    Raw = bytearray()
+    Offset = 4
+    while Offset + 14 <= len(Contents):
+        if Contents[Offset:Offset+4] != bytearray([0x42,0x46,0x5a,0x42]):
+            break
+        RawSize, StoredSize, Crc = struct.unpack_from('<IIH',Contents,Offset+4)
+        Offset += 14
+        if Offset + StoredSize > len(Contents):
+            break
+        Stored = Contents[Offset:Offset+StoredSize]
+        Offset += StoredSize
+        try:
+            Block = Stored if StoredSize == RawSize else Lz4Decompress(Stored,RawSize)
+        except (IndexError, ValueError):
+            continue
+        Block = UnXorRows(Block)
+        if Crc16(Block) != Crc:
+            continue
+        Raw += Block
+    return Raw
+
+# returns the contents of a log given the contents of one of its files. Segmented logs
+# are read from data<N>_0000.bin up to the first missing segment, each segment starts
+# with "BFLS", version, flags, log number, sequence number and start time
+def ReadLog(FileName, Contents):
+    Contents = bytearray(Contents)
+    if Contents[0:4] != bytearray([0x42,0x46,0x4c,0x53]) or len(Contents) < 24:
+        return InflateLog(Contents)
+    LogNumber = struct.unpack_from('<I',Contents,8)[0]
+    Segments = {}
+    for SegmentName in glob.glob(os.path.join(os.path.dirname(FileName),"data" + str(LogNumber) + "_*.bin")):
+        with open(SegmentName,'rb') as SegmentFile:
+            Segment = bytearray(SegmentFile.read())
+        if Segment[0:4] == bytearray([0x42,0x46,0x4c,0x53]) and len(Segment) >= 24:
+            SegmentLog, Sequence = struct.unpack_from('<II',Segment,8)
+            if SegmentLog == LogNumber:
+                Segments[Sequence] = Segment[24:]
+    Raw = bytearray()
+    Sequence = 0
+    while Sequence in Segments:
+        Raw += InflateLog(Segments[Sequence])
+        Sequence += 1
+    return Raw
+
+# converts IEEE half precision bits to a float
+def HalfToFloat(Half):
+    Exponent = (Half >> 10) & 0x1f
+    Mantissa = Half & 0x3ff
+    if Exponent == 0:
+        Value = Mantissa * 2.0**-24
+    elif Exponent == 31:
+        Value = float('inf') if Mantissa == 0 else float('nan')
+    else:
+        Value = (1.0 + Mantissa / 1024.0) * 2.0**(Exponent - 15)
+    return -Value if Half & 0x8000 else Value
+
 # function to see if file name exists
 def FileExists(FileName):
     try:
@@ -132,12 +275,12 @@ sys.stdout.write("Converting " + args.file + "...")
 sys.stdout.flush()
 # Open binary file
 try:
-    BinaryFile = open(args.file,'r')
+    BinaryFile = open(args.file,'rb')
 except IOError:
     print "Could not read file " + args.file
     sys.exit()
 # Read binary file and close
-FileContents = BinaryFile.read()
+FileContents = ReadLog(args.file,BinaryFile.read())
 BinaryFile.close()
 # Create HDF5 file
 if args.output:
@@ -178,6 +321,24 @@ FloatDatasets = []
 FloatCounter=0
 DoubleDatasets = []
 DoubleCounter=0
+Float16Datasets = []
+Float16Counter=0
+# scaled signals are logged as round((value - offset) / scale)
+ScaledInt16Datasets = []
+ScaledInt16Scaling = []
+ScaledInt16Counter=0
+ScaledUint16Datasets = []
+ScaledUint16Scaling = []
+ScaledUint16Counter=0
+# decimation groups, each with its own time column and datasets in logged order
+Groups = {}
+GroupTypes = {'Uint64Key':('uint64','@Q'),'Uint32Key':('uint32','@I'),'Uint16Key':('uint16','@H'),'Uint8Key':('uint8','@B'),
+              'Int64Key':('int64','@q'),'Int32Key':('int32','@i'),'Int16Key':('int16','@h'),'Int8Key':('int8','@b'),
+              'FloatKey':('float','@f'),'DoubleKey':('double','@d'),
+              'Float16Key':('float','@H'),'ScaledInt16Key':('float','@h'),'ScaledUint16Key':('float','@H')}
+# events, logged with their time when they change. Values are in the event's key
+# and times in the same key under /Datalog/Events
+Events = {}
 # parse byte array
 NumberDataPoints = 0
 FileContentsBinary = bytearray(FileContents)
@@ -235,6 +396,25 @@ for k in range(0,len(FileContentsBinary)):
             for i in range(0,len(Payload)):
                 KeyName += unichr(Payload[i])
             DoubleDatasets.append(DataLogFile.create_dataset(KeyName,(0, 1), maxshape=(None, 1), dtype='double'))
+        if DataLogMessage.DataTypes[DataType] == 'Float16Key':
+            KeyName = ""
+            for i in range(0,len(Payload)):
+                KeyName += unichr(Payload[i])
+            Float16Datasets.append(DataLogFile.create_dataset(KeyName,(0, 1), maxshape=(None, 1), dtype='float'))
+        if DataLogMessage.DataTypes[DataType] == 'ScaledInt16Key':
+            Scale, Offset = struct.unpack_from('@ff',bytearray(Payload),0)
+            KeyName = ""
+            for i in range(8,len(Payload)):
+                KeyName += unichr(Payload[i])
+            ScaledInt16Datasets.append(DataLogFile.create_dataset(KeyName,(0, 1), maxshape=(None, 1), dtype='float'))
+            ScaledInt16Scaling.append((Scale, Offset))
+        if DataLogMessage.DataTypes[DataType] == 'ScaledUint16Key':
+            Scale, Offset = struct.unpack_from('@ff',bytearray(Payload),0)
+            KeyName = ""
+            for i in range(8,len(Payload)):
+                KeyName += unichr(Payload[i])
+            ScaledUint16Datasets.append(DataLogFile.create_dataset(KeyName,(0, 1), maxshape=(None, 1), dtype='float'))
+            ScaledUint16Scaling.append((Scale, Offset))
         if DataLogMessage.DataTypes[DataType] == 'Uint64Desc':
             Desc = ""
             for i in range(0,len(Payload)):
@@ -295,6 +475,24 @@ for k in range(0,len(FileContentsBinary)):
                 Desc += unichr(Payload[i])
             (DoubleDatasets[DoubleCounter]).attrs["Description"] = Desc
             DoubleCounter += 1
+        if DataLogMessage.DataTypes[DataType] == 'Float16Desc':
+            Desc = ""
+            for i in range(0,len(Payload)):
+                Desc += unichr(Payload[i])
+            (Float16Datasets[Float16Counter]).attrs["Description"] = Desc
+            Float16Counter += 1
+        if DataLogMessage.DataTypes[DataType] == 'ScaledInt16Desc':
+            Desc = ""
+            for i in range(0,len(Payload)):
+                Desc += unichr(Payload[i])
+            (ScaledInt16Datasets[ScaledInt16Counter]).attrs["Description"] = Desc
+            ScaledInt16Counter += 1
+        if DataLogMessage.DataTypes[DataType] == 'ScaledUint16Desc':
+            Desc = ""
+            for i in range(0,len(Payload)):
+                Desc += unichr(Payload[i])
+            (ScaledUint16Datasets[ScaledUint16Counter]).attrs["Description"] = Desc
+            ScaledUint16Counter += 1
         if DataLogMessage.DataTypes[DataType] == 'Data':
             offset = 0
             for i in range (0,len(Uint64Datasets)):
@@ -337,8 +535,102 @@ for k in range(0,len(FileContentsBinary)):
                 (DoubleDatasets[i]).resize(NumberDataPoints+1,axis=0)
                 (DoubleDatasets[i])[NumberDataPoints] = struct.unpack_from('@d',bytearray(Payload),offset)[0]
                 offset += 8
+            for i in range (0,len(Float16Datasets)):
+                (Float16Datasets[i]).resize(NumberDataPoints+1,axis=0)
+                (Float16Datasets[i])[NumberDataPoints] = HalfToFloat(struct.unpack_from('@H',bytearray(Payload),offset)[0])
+                offset += 2
+            for i in range (0,len(ScaledInt16Datasets)):
+                Scale, Offset = ScaledInt16Scaling[i]
+                (ScaledInt16Datasets[i]).resize(NumberDataPoints+1,axis=0)
+                (ScaledInt16Datasets[i])[NumberDataPoints] = struct.unpack_from('@h',bytearray(Payload),offset)[0] * Scale + Offset
+                offset += 2
+            for i in range (0,len(ScaledUint16Datasets)):
+                Scale, Offset = ScaledUint16Scaling[i]
+                (ScaledUint16Datasets[i]).resize(NumberDataPoints+1,axis=0)
+                (ScaledUint16Datasets[i])[NumberDataPoints] = struct.unpack_from('@H',bytearray(Payload),offset)[0] * Scale + Offset
+                offset += 2
             DataLogFile.flush()
             NumberDataPoints += 1
+        if DataLogMessage.DataTypes[DataType] == 'GroupDef':
+            Decimation = struct.unpack_from('@H',bytearray(Payload),1)[0]
+            GroupName = ""
+            for i in range(3,len(Payload)):
+                GroupName += unichr(Payload[i])
+            TimeDataset = DataLogFile.create_dataset("/Datalog/" + GroupName + "/Time_us",(0, 1), maxshape=(None, 1), dtype='uint64')
+            TimeDataset.attrs["Decimation"] = Decimation
+            Groups[Payload[0]] = {'Time': TimeDataset, 'Datasets': [], 'Points': 0}
+        if DataLogMessage.DataTypes[DataType] == 'GroupKey':
+            Type = DataLogMessage.DataTypes[Payload[1]]
+            Dtype, Format = GroupTypes[Type]
+            Scaling = None
+            Start = 2
+            if Type == 'ScaledInt16Key' or Type == 'ScaledUint16Key':
+                Scaling = struct.unpack_from('@ff',bytearray(Payload),Start)
+                Start += 8
+            KeyName = ""
+            for i in range(Start,len(Payload)):
+                KeyName += unichr(Payload[i])
+            Groups[Payload[0]]['Datasets'].append((DataLogFile.create_dataset(KeyName,(0, 1), maxshape=(None, 1), dtype=Dtype), Format, Type, Scaling))
+        if DataLogMessage.DataTypes[DataType] == 'GroupDesc':
+            Desc = ""
+            for i in range(1,len(Payload)):
+                Desc += unichr(Payload[i])
+            Groups[Payload[0]]['Datasets'][-1][0].attrs["Description"] = Desc
+        if DataLogMessage.DataTypes[DataType] == 'GroupData':
+            Group = Groups[Payload[0]]
+            Points = Group['Points']
+            Group['Time'].resize(Points+1,axis=0)
+            Group['Time'][Points] = struct.unpack_from('@Q',bytearray(Payload),1)[0]
+            offset = 9
+            for Dataset, Format, Type, Scaling in Group['Datasets']:
+                Value = struct.unpack_from(Format,bytearray(Payload),offset)[0]
+                if Type == 'Float16Key':
+                    Value = HalfToFloat(Value)
+                elif Scaling:
+                    Value = Value * Scaling[0] + Scaling[1]
+                Dataset.resize(Points+1,axis=0)
+                Dataset[Points] = Value
+                offset += struct.calcsize(Format)
+            DataLogFile.flush()
+            Group['Points'] += 1
+        if DataLogMessage.DataTypes[DataType] == 'EventKey':
+            Id = struct.unpack_from('@H',bytearray(Payload),0)[0]
+            Type = DataLogMessage.DataTypes[Payload[2]]
+            KeyName = ""
+            for i in range(3,len(Payload)):
+                KeyName += unichr(Payload[i])
+            if Type == 'StringKey':
+                Dtype, Format = h5py.special_dtype(vlen=unicode), None
+            else:
+                Dtype, Format = GroupTypes[Type]
+            TimeDataset = DataLogFile.create_dataset("/Datalog/Events" + KeyName,(0, 1), maxshape=(None, 1), dtype='uint64')
+            Events[Id] = {'Time': TimeDataset, 'Dataset': DataLogFile.create_dataset(KeyName,(0, 1), maxshape=(None, 1), dtype=Dtype), 'Format': Format, 'Points': 0}
+        if DataLogMessage.DataTypes[DataType] == 'EventDesc':
+            Desc = ""
+            for i in range(2,len(Payload)):
+                Desc += unichr(Payload[i])
+            Events[struct.unpack_from('@H',bytearray(Payload),0)[0]]['Dataset'].attrs["Description"] = Desc
+        if DataLogMessage.DataTypes[DataType] == 'EventData':
+            Time = struct.unpack_from('@Q',bytearray(Payload),0)[0]
+            offset = 8
+            while offset < len(Payload):
+                Event = Events[struct.unpack_from('@H',bytearray(Payload),offset)[0]]
+                offset += 2
+                if Event['Format'] is None:
+                    Value = ""
+                    for i in range(offset+1,offset+1+Payload[offset]):
+                        Value += unichr(Payload[i])
+                    offset += 1 + Payload[offset]
+                else:
+                    Value = struct.unpack_from(Event['Format'],bytearray(Payload),offset)[0]
+                    offset += struct.calcsize(Event['Format'])
+                Points = Event['Points']
+                Event['Time'].resize(Points+1,axis=0)
+                Event['Time'][Points] = Time
+                Event['Dataset'].resize(Points+1,axis=0)
+                Event['Dataset'][Points] = Value
+                Event['Points'] += 1
+            DataLogFile.flush()
 DataLogFile.close()
 print "done!"
 print "Created data log file " + DataLogName
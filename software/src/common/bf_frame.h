@@ -0,0 +1,226 @@
+/*
+* Brian R Taylor
+* brian.taylor@bolderflight.com
+*
+* Copyright (c) 2018 Bolder Flight Systems
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+* and associated documentation files (the "Software"), to deal in the Software without restriction,
+* including without limitation the rights to use, copy, modify, merge, publish, distribute,
+* sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or
+* substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+* BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+* DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef BF_FRAME_H
+#define BF_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+/*
+* BFS frame codec, used by the datalog, telemetry, FMU node driver and node
+* comms. A frame is:
+*   * 0x42 0x46 ("BF")
+*   * the message type
+*   * the payload length, uint16 little endian
+*   * the payload
+*   * two checksum bytes, 8 bit running sums over the header and payload:
+*     Checksum[0] += Byte; Checksum[1] += Checksum[0];
+* Frames are built in place: the payload is written at Frame+kHeaderSize,
+* where Payload() points, and Seal fills in the header and checksum. Encode
+* does the same for a payload held elsewhere.
+*/
+class BfFrame {
+  public:
+    static const uint8_t kHeader0 = 0x42;
+    static const uint8_t kHeader1 = 0x46;
+    static const size_t kHeaderSize = 5;
+    static const size_t kChecksumSize = 2;
+    static const size_t kOverhead = kHeaderSize + kChecksumSize;
+    static const size_t kMaxPayload = 0xffff;
+    /* Returns the frame size for a payload size */
+    static size_t Size(size_t PayloadSize) {
+      return PayloadSize + kOverhead;
+    }
+    /* Returns where the payload goes in a frame */
+    static uint8_t *Payload(uint8_t *Frame) {
+      return Frame + kHeaderSize;
+    }
+    /* Writes the header and checksum around the payload at Frame+kHeaderSize, returns the frame size */
+    static size_t Seal(uint8_t Type, size_t PayloadSize, uint8_t *Frame) {
+      Frame[0] = kHeader0;
+      Frame[1] = kHeader1;
+      Frame[2] = Type;
+      Frame[3] = PayloadSize & 0xff;
+      Frame[4] = (PayloadSize >> 8) & 0xff;
+      Checksum(Frame,PayloadSize+kHeaderSize,Frame+kHeaderSize+PayloadSize);
+      return Size(PayloadSize);
+    }
+    /* Copies a payload into Frame and seals it, returns the frame size or 0 if it does not fit in FrameSize */
+    static size_t Encode(uint8_t Type, const uint8_t *Payload, size_t PayloadSize, uint8_t *Frame, size_t FrameSize) {
+      if ((PayloadSize > kMaxPayload)||(Size(PayloadSize) > FrameSize)) {
+        return 0;
+      }
+      if (PayloadSize > 0) {
+        memmove(Frame+kHeaderSize,Payload,PayloadSize);
+      }
+      return Seal(Type,PayloadSize,Frame);
+    }
+    /* Computes the two byte checksum. The sums are taken 16 bytes at a time where
+    SSE2 or NEON is available: each byte lane keeps a running sum A and a sum P of A
+    over the previous blocks, so over n bytes Checksum[1] = 16*sum(P) + sum((16-j)*A[j]).
+    Only the low 8 bits are kept, so the 16 bit lanes are free to wrap. Runs shorter
+    than kMinVectorSize_ use the byte loop, which is faster for them. */
+    static void Checksum(const uint8_t *Data, size_t Size, uint8_t *Checksum) {
+      uint32_t Sum0 = 0;
+      uint32_t Sum1 = 0;
+      size_t i = 0;
+#if defined(__SSE2__) || defined(__ARM_NEON) || defined(__ARM_NEON__)
+      if (Size >= kMinVectorSize_) {
+        uint16_t A[kBlockSize_], P[kBlockSize_];
+#if defined(__SSE2__)
+        const __m128i Zero = _mm_setzero_si128();
+        __m128i A0 = Zero, A1 = Zero, P0 = Zero, P1 = Zero;
+        for (; i + kBlockSize_ <= Size; i += kBlockSize_) {
+          __m128i Bytes = _mm_loadu_si128((const __m128i *)(Data+i));
+          P0 = _mm_add_epi16(P0,A0);
+          P1 = _mm_add_epi16(P1,A1);
+          A0 = _mm_add_epi16(A0,_mm_unpacklo_epi8(Bytes,Zero));
+          A1 = _mm_add_epi16(A1,_mm_unpackhi_epi8(Bytes,Zero));
+        }
+        _mm_storeu_si128((__m128i *)A,A0);
+        _mm_storeu_si128((__m128i *)(A+8),A1);
+        _mm_storeu_si128((__m128i *)P,P0);
+        _mm_storeu_si128((__m128i *)(P+8),P1);
+#else
+        uint16x8_t A0 = vdupq_n_u16(0), A1 = vdupq_n_u16(0), P0 = vdupq_n_u16(0), P1 = vdupq_n_u16(0);
+        for (; i + kBlockSize_ <= Size; i += kBlockSize_) {
+          uint8x16_t Bytes = vld1q_u8(Data+i);
+          P0 = vaddq_u16(P0,A0);
+          P1 = vaddq_u16(P1,A1);
+          A0 = vaddw_u8(A0,vget_low_u8(Bytes));
+          A1 = vaddw_u8(A1,vget_high_u8(Bytes));
+        }
+        vst1q_u16(A,A0);
+        vst1q_u16(A+8,A1);
+        vst1q_u16(P,P0);
+        vst1q_u16(P+8,P1);
+#endif
+        for (size_t j=0; j < kBlockSize_; j++) {
+          Sum0 += A[j];
+          Sum1 += kBlockSize_*P[j] + (kBlockSize_-j)*A[j];
+        }
+      }
+#endif
+      for (; i < Size; i++) {
+        Sum0 += Data[i];
+        Sum1 += Sum0;
+      }
+      Checksum[0] = Sum0 & 0xff;
+      Checksum[1] = Sum1 & 0xff;
+    }
+  private:
+    static const size_t kBlockSize_ = 16;
+    static const size_t kMinVectorSize_ = 64;
+};
+
+/*
+* Incremental frame parser. Bytes are fed as they arrive into a buffer of
+* BufferSize bytes; once a frame with a valid checksum is complete, Type(),
+* Payload() and PayloadSize() describe it until the next byte is parsed.
+* Frames longer than the buffer are dropped.
+*/
+template <size_t BufferSize>
+class BfFrameParser {
+  public:
+    static const size_t kMaxPayload = BufferSize - BfFrame::kOverhead;
+    /* Parses a byte, returns true when it completes a valid frame */
+    bool Parse(uint8_t Byte) {
+      if (State_ < 2) {
+        if (((State_ == 0)&&(Byte == BfFrame::kHeader0))||((State_ == 1)&&(Byte == BfFrame::kHeader1))) {
+          Buffer_[State_++] = Byte;
+        } else {
+          State_ = 0;
+          if (Byte == BfFrame::kHeader0) {
+            Buffer_[State_++] = Byte;
+          }
+        }
+        return false;
+      }
+      Buffer_[State_++] = Byte;
+      if (State_ == BfFrame::kHeaderSize) {
+        Length_ = Buffer_[3] | ((size_t)Buffer_[4] << 8);
+        if (Length_ > kMaxPayload) {
+          State_ = 0;
+        }
+        return false;
+      }
+      return (State_ == Length_ + BfFrame::kOverhead) && Complete();
+    }
+    /* Parses bytes up to the end of the first complete frame, returns true if that
+    frame is valid. Used is set to the number of bytes parsed. */
+    bool Parse(const uint8_t *Data, size_t Size, size_t *Used) {
+      size_t i = 0;
+      while (i < Size) {
+        if (State_ >= BfFrame::kHeaderSize) {
+          // payload and checksum are copied as a run
+          size_t Count = Length_ + BfFrame::kOverhead - State_;
+          if (Count > Size - i) {
+            Count = Size - i;
+          }
+          memcpy(Buffer_+State_,Data+i,Count);
+          State_ += Count;
+          i += Count;
+          if (State_ == Length_ + BfFrame::kOverhead) {
+            *Used = i;
+            return Complete();
+          }
+        } else if (Parse(Data[i++])) {
+          *Used = i;
+          return true;
+        }
+      }
+      *Used = i;
+      return false;
+    }
+    uint8_t Type() const {
+      return Buffer_[2];
+    }
+    const uint8_t *Payload() const {
+      return Buffer_ + BfFrame::kHeaderSize;
+    }
+    size_t PayloadSize() const {
+      return Length_;
+    }
+    void Reset() {
+      State_ = 0;
+    }
+  private:
+    uint8_t Buffer_[BufferSize];
+    size_t State_ = 0;
+    size_t Length_ = 0;
+    /* Checks the checksum of a complete frame and starts over */
+    bool Complete() {
+      uint8_t Checksum[BfFrame::kChecksumSize];
+      State_ = 0;
+      BfFrame::Checksum(Buffer_,Length_+BfFrame::kHeaderSize,Checksum);
+      return (Checksum[0] == Buffer_[Length_+BfFrame::kHeaderSize])&&(Checksum[1] == Buffer_[Length_+BfFrame::kHeaderSize+1]);
+    }
+};
+
+#endif
@@ -33,3 +33,15 @@ unsigned short fletcher16(unsigned char *data,unsigned int len)
   }
   return (sum1 << 8) | sum0;
 }
+
+unsigned int fnv1a32(const unsigned char *data,unsigned int len)
+{
+  unsigned int hash = 2166136261u;
+  unsigned int i;
+  if (!data) {return hash;}
+  for (i = 0; i < len; ++i) {
+    hash ^= data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
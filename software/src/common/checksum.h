@@ -39,6 +39,9 @@ extern "C" {
 /* Fletcher-16 checksum */
 unsigned short fletcher16(unsigned char *data,unsigned int len);
 
+/* 32 bit FNV-1a hash, used to identify configuration content */
+unsigned int fnv1a32(const unsigned char *data,unsigned int len);
+
 /*
 * Ensure C friendly linkages in a mixed C/C++ build
 */
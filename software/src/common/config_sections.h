@@ -0,0 +1,126 @@
+/*
+* Brian R Taylor
+* brian.taylor@bolderflight.com
+*
+* Copyright (c) 2018 Bolder Flight Systems
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+* and associated documentation files (the "Software"), to deal in the Software without restriction,
+* including without limitation the rights to use, copy, modify, merge, publish, distribute,
+* sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or
+* substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+* BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+* DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CONFIG_SECTIONS_H
+#define CONFIG_SECTIONS_H
+
+#include "checksum.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/*
+* FMU configuration section cache. The SOC sends the hashes of its configuration
+* sections, in order; the FMU answers with the ones it does not have cached and
+* the SOC uploads only those. Entering run mode applies the requested sections
+* from the cache. Only the sections actually applied are reported back as
+* applied, so a section that never arrived is uploaded again rather than taken
+* as already running.
+*/
+class ConfigSections {
+  public:
+    /* Gets the hashes of the applied sections, in order */
+    void GetApplied(std::vector<uint32_t> *Hashes) const {
+      *Hashes = applied_hashes_;
+    }
+    /* Sets the sections to apply and returns the hashes of sections not in the cache */
+    void SetRequested(const std::vector<uint32_t> &Hashes,std::vector<uint32_t> *MissingHashes) {
+      requested_hashes_ = Hashes;
+      MissingHashes->clear();
+      for (size_t i=0; i < requested_hashes_.size(); i++) {
+        if (Find(requested_hashes_[i]) == NULL) {
+          MissingHashes->push_back(requested_hashes_[i]);
+        }
+      }
+    }
+    /* Returns true if sections were requested and are waiting to be applied */
+    bool Requested() const {
+      return requested_hashes_.size() > 0;
+    }
+    /* Caches a section, returns false if no sections were requested and it should be applied immediately */
+    bool Cache(const char *Json,size_t Size) {
+      if (!Requested()) {
+        return false;
+      }
+      uint32_t Hash = fnv1a32((const unsigned char *)Json,Size);
+      if (Find(Hash) == NULL) {
+        Section NewSection;
+        NewSection.Hash = Hash;
+        NewSection.Json.assign(Json,Size);
+        sections_.push_back(NewSection);
+      }
+      return true;
+    }
+    /* Calls Apply with the JSON of each requested section in order, drops cached sections no
+    longer used and returns the number of requested sections that were not cached */
+    template <typename Function>
+    size_t Apply(Function Apply) {
+      size_t Missing = 0;
+      applied_hashes_.clear();
+      for (size_t i=0; i < requested_hashes_.size(); i++) {
+        const Section *Cached = Find(requested_hashes_[i]);
+        if (Cached != NULL) {
+          Apply(Cached->Json.c_str());
+          applied_hashes_.push_back(Cached->Hash);
+        } else {
+          Missing++;
+        }
+      }
+      std::vector<Section> UsedSections;
+      for (size_t j=0; j < sections_.size(); j++) {
+        for (size_t i=0; i < requested_hashes_.size(); i++) {
+          if (sections_[j].Hash == requested_hashes_[i]) {
+            UsedSections.push_back(sections_[j]);
+            break;
+          }
+        }
+      }
+      sections_ = UsedSections;
+      requested_hashes_.clear();
+      return Missing;
+    }
+    /* Clears the applied hashes, called when the configuration is torn down */
+    void ClearApplied() {
+      applied_hashes_.clear();
+    }
+  private:
+    struct Section {
+      uint32_t Hash;
+      std::string Json;
+    };
+    // configuration sections received from the SOC, kept so unchanged sections are not resent
+    std::vector<Section> sections_;
+    // hashes, in order, of the sections currently applied and of the sections requested by the SOC
+    std::vector<uint32_t> applied_hashes_;
+    std::vector<uint32_t> requested_hashes_;
+    const Section *Find(uint32_t Hash) const {
+      for (size_t j=0; j < sections_.size(); j++) {
+        if (sections_[j].Hash == Hash) {
+          return &sections_[j];
+        }
+      }
+      return NULL;
+    }
+};
+
+#endif
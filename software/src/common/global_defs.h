@@ -43,6 +43,9 @@ extern "C" {
 /* double precision PI */
 #define D_PI 3.141592653589793
 
+/* largest number of lost SBUS frames an inceptor message carries */
+#define MSG_MAX_LOST_FRAMES 31
+
 /* 
 * FMU configuration. Configures the sample rate divider to set
 * the flight computer frame rate, where the frequency is 1000 / (1 + srd).
@@ -257,14 +260,14 @@ struct mag_data {
 /* 
 * Inceptor data, includes a rolling frame counter to sync data and
 * a time offset from the start of the frame in us for when the data was
-* collected. Also includes boolean values for whether a frame was lost,
-* whether the receiver is in failsafe mode, and 16 channels of normalized
-* pilot input data. 
+* collected. Also includes the number of frames lost since the previous
+* message (up to MSG_MAX_LOST_FRAMES), whether the receiver is in failsafe
+* mode, and 16 channels of normalized pilot input data. 
 */
 struct inceptor_data {
   unsigned int frame_counter;             // a rolling frame counter to sync data packets
   unsigned int time_offset_us;            // time offset from the frame start time, us
-  _Bool lost_frame;                       // 0 = frame received, 1 = frame lost
+  unsigned int lost_frames;               // frames lost since the previous message
   _Bool failsafe_activated;               // 0 = failsafe inactive, 1 = failsafe active
   float ch[16];                           // SBUS channel data                  
 };
@@ -355,6 +358,31 @@ struct voltage_data {
   unsigned int time_offset_us;            // time offset from the frame start time, us
   float voltage;                          // measured voltage
 };
+/* 
+* Humidity data, includes a rolling frame counter to sync data,
+* a time offset from the start of the frame in us for when the data was
+* collected, and relative humidity data.
+*/
+struct humidity_data {
+  unsigned int frame_counter;             // a rolling frame counter to sync data packets
+  unsigned int time_offset_us;            // time offset from the frame start time, us
+  float humidity_rh;                      // relative humidity, percent
+};
+/* 
+* GNSS time data, includes a rolling frame counter to sync data and
+* a time offset from the start of the frame in us for when the data was
+* collected. Also includes the UTC date and time of the navigation solution.
+*/
+struct gnss_time_data {
+  unsigned int frame_counter;             // a rolling frame counter to sync data packets
+  unsigned int time_offset_us;            // time offset from the frame start time, us
+  unsigned int year;                      // UTC year
+  unsigned int month;                     // UTC month
+  unsigned int day;                       // UTC day
+  unsigned int hour;                      // UTC hour
+  unsigned int min;                       // UTC minute
+  unsigned int sec;                       // UTC second
+};
 
 /*
 * Ensure C friendly linkages in a mixed C/C++ build
@@ -283,14 +283,14 @@ struct msg_mag_data {
 /* 
 * Inceptor data, includes a rolling frame counter to sync data and
 * a time offset from the start of the frame in us for when the data was
-* collected. Also includes boolean values for whether a frame was lost,
-* whether the receiver is in failsafe mode, and 16 channels of normalized
-* pilot input data. 
+* collected. Also includes the number of frames lost since the previous
+* message, whether the receiver is in failsafe mode, and 16 channels of
+* normalized pilot input data. 
 */
 struct msg_inceptor_data {
   unsigned int frame_counter : 3;         // a rolling frame counter to sync data packets
   unsigned int time_offset_us : 15;       // time offset from the frame start time, us
-  unsigned int lost_frame : 1;            // 0 = frame received, 1 = frame lost
+  unsigned int lost_frames : 5;           // frames lost since the previous message, up to MSG_MAX_LOST_FRAMES
   unsigned int failsafe_activated : 1;    // 0 = failsafe inactive, 1 = failsafe active
   unsigned int ch0 : 11;                  // SBUS channel data, +/- 1 range
   unsigned int ch1 : 11;                  
@@ -396,6 +396,31 @@ struct msg_voltage_data {
   unsigned int time_offset_us : 15;       // time offset from the frame start time, us
   unsigned int voltage : 13;              // measured voltage
 };
+/* 
+* Humidity data, includes a rolling frame counter to sync data and
+* a time offset from the start of the frame in us for when the data was
+* collected. Humidity data is valid from 0 - 100 percent.
+*/
+struct msg_humidity_data {
+  unsigned int frame_counter : 3;         // a rolling frame counter to sync data packets
+  unsigned int time_offset_us : 15;       // time offset from the frame start time, us
+  unsigned int humidity_rh : 14;          // relative humidity, 0 - 100 percent
+};
+/* 
+* GNSS time data, includes a rolling frame counter to sync data and
+* a time offset from the start of the frame in us for when the data was
+* collected. Also includes the UTC date and time of the navigation solution.
+*/
+struct msg_gnss_time_data {
+  unsigned int frame_counter : 3;         // a rolling frame counter to sync data packets
+  unsigned int time_offset_us : 15;       // time offset from the frame start time, us
+  unsigned int year : 12;                 // UTC year, 0 - 4095
+  unsigned int month : 4;                 // UTC month, 1 - 12
+  unsigned int day : 5;                   // UTC day, 1 - 31
+  unsigned int hour : 5;                  // UTC hour, 0 - 23
+  unsigned int min : 6;                   // UTC minute, 0 - 59
+  unsigned int sec : 6;                   // UTC second, 0 - 60
+};
 
 #pragma pack(pop)
 
@@ -450,10 +475,21 @@ void pack_digital_data(void *unpacked, void *packed);
 void unpack_digital_data(void *packed, void *unpacked);
 void pack_voltage_data(void *unpacked, void *packed);
 void unpack_voltage_data(void *packed, void *unpacked);
+void pack_humidity_data(void *unpacked, void *packed);
+void unpack_humidity_data(void *packed, void *unpacked);
+void pack_gnss_time_data(void *unpacked, void *packed);
+void unpack_gnss_time_data(void *packed, void *unpacked);
+/*
+* Limits a value to the range of its packed representation.
+*/
+static float msg_clamp(float val,float min,float max);
+/*
+* Fills the message length and function pointer tables.
+*/
+static void msg_init_tables();
 
-Msg_t *msg_init()
+static void msg_init_tables()
 {
-  Msg_t *msg;
   unsigned int i;
   /* array of packed message lengths */
   msg_packed_len[MSG_FMU_CFG]           = sizeof(struct msg_fmu_config);
@@ -480,6 +516,8 @@ Msg_t *msg_init()
   msg_packed_len[MSG_ANALOG_DATA]       = sizeof(struct msg_analog_data);
   msg_packed_len[MSG_DIGITAL_DATA]      = sizeof(struct msg_digital_data);
   msg_packed_len[MSG_VOLTAGE_DATA]      = sizeof(struct msg_voltage_data);
+  msg_packed_len[MSG_HUMIDITY_DATA]     = sizeof(struct msg_humidity_data);
+  msg_packed_len[MSG_GNSS_TIME_DATA]    = sizeof(struct msg_gnss_time_data);
   /* array of unpacked message lengths */
   msg_unpacked_len[MSG_FMU_CFG]           = sizeof(struct fmu_config);
   msg_unpacked_len[MSG_INT_MPU9250_CFG]   = sizeof(struct int_mpu9250_config);
@@ -505,6 +543,8 @@ Msg_t *msg_init()
   msg_unpacked_len[MSG_ANALOG_DATA]       = sizeof(struct analog_data);
   msg_unpacked_len[MSG_DIGITAL_DATA]      = sizeof(struct digital_data);
   msg_unpacked_len[MSG_VOLTAGE_DATA]      = sizeof(struct voltage_data);  
+  msg_unpacked_len[MSG_HUMIDITY_DATA]     = sizeof(struct humidity_data);
+  msg_unpacked_len[MSG_GNSS_TIME_DATA]    = sizeof(struct gnss_time_data);
   /* array of function pointers to pack messages */
   pack_msg[MSG_FMU_CFG]           = pack_fmu_config;
   pack_msg[MSG_INT_MPU9250_CFG]   = pack_int_mpu9250_config;
@@ -530,6 +570,8 @@ Msg_t *msg_init()
   pack_msg[MSG_ANALOG_DATA]       = pack_analog_data;
   pack_msg[MSG_DIGITAL_DATA]      = pack_digital_data;
   pack_msg[MSG_VOLTAGE_DATA]      = pack_voltage_data;
+  pack_msg[MSG_HUMIDITY_DATA]     = pack_humidity_data;
+  pack_msg[MSG_GNSS_TIME_DATA]    = pack_gnss_time_data;
   /* array of function pointers to unpack messages */
   unpack_msg[MSG_FMU_CFG]           = unpack_fmu_config;
   unpack_msg[MSG_INT_MPU9250_CFG]   = unpack_int_mpu9250_config;
@@ -555,6 +597,8 @@ Msg_t *msg_init()
   unpack_msg[MSG_ANALOG_DATA]       = unpack_analog_data;
   unpack_msg[MSG_DIGITAL_DATA]      = unpack_digital_data;
   unpack_msg[MSG_VOLTAGE_DATA]      = unpack_voltage_data;
+  unpack_msg[MSG_HUMIDITY_DATA]     = unpack_humidity_data;
+  unpack_msg[MSG_GNSS_TIME_DATA]    = unpack_gnss_time_data;
   /* max packed message length (for sizing buffers) */
   msg_max_packed_len = 0;
   for (i = 0; i < ARRAY_SIZE(msg_packed_len); ++i) {
@@ -569,6 +613,12 @@ Msg_t *msg_init()
       msg_max_unpacked_len = msg_unpacked_len[i];
     }
   }
+}
+
+Msg_t *msg_init()
+{
+  Msg_t *msg;
+  msg_init_tables();
   /* allocate the Msg_t structure */
   msg = calloc(1,sizeof(Msg_t));
   if (!msg) {return NULL;}
@@ -766,6 +816,40 @@ void *msg_rx_payload(Msg_t *self)
   return self->rx_payload;    
 }
 
+unsigned int msg_packed_size(MsgId_t msg)
+{
+  if ((msg < 0) || (msg >= NUM_MSG_ID)) {return 0;}
+  if (!pack_msg[msg]) {msg_init_tables();}
+  return msg_packed_len[msg];
+}
+
+unsigned int msg_pack(MsgId_t msg,void *payload,unsigned char *buffer)
+{
+  if ((!payload) || (!buffer)) {return 0;}
+  if ((msg < 0) || (msg >= NUM_MSG_ID)) {return 0;}
+  if (!pack_msg[msg]) {msg_init_tables();}
+  /* bits past the last field are not written by the pack functions */
+  memset(buffer,0,msg_packed_len[msg]);
+  (*pack_msg[msg])(payload,(void *)buffer);
+  return msg_packed_len[msg];
+}
+
+MsgError_t msg_unpack(MsgId_t msg,const unsigned char *buffer,void *payload)
+{
+  if ((!payload) || (!buffer)) {return MSG_ERROR_NULL_PTR;}
+  if ((msg < 0) || (msg >= NUM_MSG_ID)) {return MSG_ERROR_INCORRECT_ID;}
+  if (!unpack_msg[msg]) {msg_init_tables();}
+  (*unpack_msg[msg])((void *)buffer,payload);
+  return MSG_ERROR_SUCCESS;
+}
+
+static float msg_clamp(float val,float min,float max)
+{
+  if (val < min) {return min;}
+  if (val > max) {return max;}
+  return val;
+}
+
 void pack_fmu_config(void *unpacked, void *packed)
 {
   if ((unpacked) && (packed)) {
@@ -1137,9 +1221,9 @@ void pack_accel_data(void *unpacked, void *packed)
   if ((unpacked) && (packed)) {
     ((struct msg_accel_data *)packed)->frame_counter   = ((struct accel_data *)unpacked)->frame_counter;
     ((struct msg_accel_data *)packed)->time_offset_us  = ((struct accel_data *)unpacked)->time_offset_us;
-    ((struct msg_accel_data *)packed)->accel_x_mss     = ((struct accel_data *)unpacked)->accel_x_mss * 262143.5f / (16.0f * G) + 262143.5f;
-    ((struct msg_accel_data *)packed)->accel_y_mss     = ((struct accel_data *)unpacked)->accel_y_mss * 262143.5f / (16.0f * G) + 262143.5f;
-    ((struct msg_accel_data *)packed)->accel_z_mss     = ((struct accel_data *)unpacked)->accel_z_mss * 262143.5f / (16.0f * G) + 262143.5f;
+    ((struct msg_accel_data *)packed)->accel_x_mss     = msg_clamp(((struct accel_data *)unpacked)->accel_x_mss,-16.0f * G,16.0f * G) * 262143.5f / (16.0f * G) + 262143.5f;
+    ((struct msg_accel_data *)packed)->accel_y_mss     = msg_clamp(((struct accel_data *)unpacked)->accel_y_mss,-16.0f * G,16.0f * G) * 262143.5f / (16.0f * G) + 262143.5f;
+    ((struct msg_accel_data *)packed)->accel_z_mss     = msg_clamp(((struct accel_data *)unpacked)->accel_z_mss,-16.0f * G,16.0f * G) * 262143.5f / (16.0f * G) + 262143.5f;
   }
 }
 
@@ -1159,9 +1243,9 @@ void pack_gyro_data(void *unpacked, void *packed)
   if ((unpacked) && (packed)) {
     ((struct msg_gyro_data *)packed)->frame_counter   = ((struct gyro_data *)unpacked)->frame_counter;
     ((struct msg_gyro_data *)packed)->time_offset_us  = ((struct gyro_data *)unpacked)->time_offset_us;
-    ((struct msg_gyro_data *)packed)->gyro_x_rads     = ((struct gyro_data *)unpacked)->gyro_x_rads * 2097151.5f / (2000.0f * D2R);
-    ((struct msg_gyro_data *)packed)->gyro_y_rads     = ((struct gyro_data *)unpacked)->gyro_y_rads * 2097151.5f / (2000.0f * D2R);
-    ((struct msg_gyro_data *)packed)->gyro_z_rads     = ((struct gyro_data *)unpacked)->gyro_z_rads * 2097151.5f / (2000.0f * D2R);
+    ((struct msg_gyro_data *)packed)->gyro_x_rads     = msg_clamp(((struct gyro_data *)unpacked)->gyro_x_rads,-2000.0f * D2R,2000.0f * D2R) * 2097151.5f / (2000.0f * D2R) + 2097151.5f;
+    ((struct msg_gyro_data *)packed)->gyro_y_rads     = msg_clamp(((struct gyro_data *)unpacked)->gyro_y_rads,-2000.0f * D2R,2000.0f * D2R) * 2097151.5f / (2000.0f * D2R) + 2097151.5f;
+    ((struct msg_gyro_data *)packed)->gyro_z_rads     = msg_clamp(((struct gyro_data *)unpacked)->gyro_z_rads,-2000.0f * D2R,2000.0f * D2R) * 2097151.5f / (2000.0f * D2R) + 2097151.5f;
   }
 }
 
@@ -1181,9 +1265,9 @@ void pack_mag_data(void *unpacked, void *packed)
   if ((unpacked) && (packed)) {
     ((struct msg_mag_data *)packed)->frame_counter   = ((struct mag_data *)unpacked)->frame_counter;
     ((struct msg_mag_data *)packed)->time_offset_us  = ((struct mag_data *)unpacked)->time_offset_us;
-    ((struct msg_mag_data *)packed)->mag_x_ut        = ((struct mag_data *)unpacked)->mag_x_ut * 131071.5f / 1000.0f + 131071.5f; 
-    ((struct msg_mag_data *)packed)->mag_y_ut        = ((struct mag_data *)unpacked)->mag_y_ut * 131071.5f / 1000.0f + 131071.5f; 
-    ((struct msg_mag_data *)packed)->mag_z_ut        = ((struct mag_data *)unpacked)->mag_z_ut * 131071.5f / 1000.0f + 131071.5f; 
+    ((struct msg_mag_data *)packed)->mag_x_ut        = msg_clamp(((struct mag_data *)unpacked)->mag_x_ut,-1000.0f,1000.0f) * 131071.5f / 1000.0f + 131071.5f; 
+    ((struct msg_mag_data *)packed)->mag_y_ut        = msg_clamp(((struct mag_data *)unpacked)->mag_y_ut,-1000.0f,1000.0f) * 131071.5f / 1000.0f + 131071.5f; 
+    ((struct msg_mag_data *)packed)->mag_z_ut        = msg_clamp(((struct mag_data *)unpacked)->mag_z_ut,-1000.0f,1000.0f) * 131071.5f / 1000.0f + 131071.5f; 
   }
 }
 
@@ -1203,24 +1287,24 @@ void pack_inceptor_data(void *unpacked, void *packed)
   if ((unpacked) && (packed)) {
     ((struct msg_inceptor_data *)packed)->frame_counter       = ((struct inceptor_data *)unpacked)->frame_counter;
     ((struct msg_inceptor_data *)packed)->time_offset_us      = ((struct inceptor_data *)unpacked)->time_offset_us;
-    ((struct msg_inceptor_data *)packed)->lost_frame          = ((struct inceptor_data *)unpacked)->lost_frame;
+    ((struct msg_inceptor_data *)packed)->lost_frames         = (((struct inceptor_data *)unpacked)->lost_frames > MSG_MAX_LOST_FRAMES) ? MSG_MAX_LOST_FRAMES : ((struct inceptor_data *)unpacked)->lost_frames;
     ((struct msg_inceptor_data *)packed)->failsafe_activated  = ((struct inceptor_data *)unpacked)->failsafe_activated;
-    ((struct msg_inceptor_data *)packed)->ch0                 = ((struct inceptor_data *)unpacked)->ch[0] * 1023.5f + 1023.5f;
-    ((struct msg_inceptor_data *)packed)->ch1                 = ((struct inceptor_data *)unpacked)->ch[1] * 1023.5f + 1023.5f;
-    ((struct msg_inceptor_data *)packed)->ch2                 = ((struct inceptor_data *)unpacked)->ch[2] * 1023.5f + 1023.5f;
-    ((struct msg_inceptor_data *)packed)->ch3                 = ((struct inceptor_data *)unpacked)->ch[3] * 1023.5f + 1023.5f;
-    ((struct msg_inceptor_data *)packed)->ch4                 = ((struct inceptor_data *)unpacked)->ch[4] * 1023.5f + 1023.5f;
-    ((struct msg_inceptor_data *)packed)->ch5                 = ((struct inceptor_data *)unpacked)->ch[5] * 1023.5f + 1023.5f;
-    ((struct msg_inceptor_data *)packed)->ch6                 = ((struct inceptor_data *)unpacked)->ch[6] * 1023.5f + 1023.5f;
-    ((struct msg_inceptor_data *)packed)->ch7                 = ((struct inceptor_data *)unpacked)->ch[7] * 1023.5f + 1023.5f;
-    ((struct msg_inceptor_data *)packed)->ch8                 = ((struct inceptor_data *)unpacked)->ch[8] * 1023.5f + 1023.5f;
-    ((struct msg_inceptor_data *)packed)->ch9                 = ((struct inceptor_data *)unpacked)->ch[9] * 1023.5f + 1023.5f;
-    ((struct msg_inceptor_data *)packed)->ch10                = ((struct inceptor_data *)unpacked)->ch[10] * 1023.5f + 1023.5f;
-    ((struct msg_inceptor_data *)packed)->ch11                = ((struct inceptor_data *)unpacked)->ch[11] * 1023.5f + 1023.5f;
-    ((struct msg_inceptor_data *)packed)->ch12                = ((struct inceptor_data *)unpacked)->ch[12] * 1023.5f + 1023.5f;
-    ((struct msg_inceptor_data *)packed)->ch13                = ((struct inceptor_data *)unpacked)->ch[13] * 1023.5f + 1023.5f;
-    ((struct msg_inceptor_data *)packed)->ch14                = ((struct inceptor_data *)unpacked)->ch[14] * 1023.5f + 1023.5f;
-    ((struct msg_inceptor_data *)packed)->ch15                = ((struct inceptor_data *)unpacked)->ch[15] * 1023.5f + 1023.5f;
+    ((struct msg_inceptor_data *)packed)->ch0                 = msg_clamp(((struct inceptor_data *)unpacked)->ch[0],-1.0f,1.0f) * 1023.5f + 1023.5f;
+    ((struct msg_inceptor_data *)packed)->ch1                 = msg_clamp(((struct inceptor_data *)unpacked)->ch[1],-1.0f,1.0f) * 1023.5f + 1023.5f;
+    ((struct msg_inceptor_data *)packed)->ch2                 = msg_clamp(((struct inceptor_data *)unpacked)->ch[2],-1.0f,1.0f) * 1023.5f + 1023.5f;
+    ((struct msg_inceptor_data *)packed)->ch3                 = msg_clamp(((struct inceptor_data *)unpacked)->ch[3],-1.0f,1.0f) * 1023.5f + 1023.5f;
+    ((struct msg_inceptor_data *)packed)->ch4                 = msg_clamp(((struct inceptor_data *)unpacked)->ch[4],-1.0f,1.0f) * 1023.5f + 1023.5f;
+    ((struct msg_inceptor_data *)packed)->ch5                 = msg_clamp(((struct inceptor_data *)unpacked)->ch[5],-1.0f,1.0f) * 1023.5f + 1023.5f;
+    ((struct msg_inceptor_data *)packed)->ch6                 = msg_clamp(((struct inceptor_data *)unpacked)->ch[6],-1.0f,1.0f) * 1023.5f + 1023.5f;
+    ((struct msg_inceptor_data *)packed)->ch7                 = msg_clamp(((struct inceptor_data *)unpacked)->ch[7],-1.0f,1.0f) * 1023.5f + 1023.5f;
+    ((struct msg_inceptor_data *)packed)->ch8                 = msg_clamp(((struct inceptor_data *)unpacked)->ch[8],-1.0f,1.0f) * 1023.5f + 1023.5f;
+    ((struct msg_inceptor_data *)packed)->ch9                 = msg_clamp(((struct inceptor_data *)unpacked)->ch[9],-1.0f,1.0f) * 1023.5f + 1023.5f;
+    ((struct msg_inceptor_data *)packed)->ch10                = msg_clamp(((struct inceptor_data *)unpacked)->ch[10],-1.0f,1.0f) * 1023.5f + 1023.5f;
+    ((struct msg_inceptor_data *)packed)->ch11                = msg_clamp(((struct inceptor_data *)unpacked)->ch[11],-1.0f,1.0f) * 1023.5f + 1023.5f;
+    ((struct msg_inceptor_data *)packed)->ch12                = msg_clamp(((struct inceptor_data *)unpacked)->ch[12],-1.0f,1.0f) * 1023.5f + 1023.5f;
+    ((struct msg_inceptor_data *)packed)->ch13                = msg_clamp(((struct inceptor_data *)unpacked)->ch[13],-1.0f,1.0f) * 1023.5f + 1023.5f;
+    ((struct msg_inceptor_data *)packed)->ch14                = msg_clamp(((struct inceptor_data *)unpacked)->ch[14],-1.0f,1.0f) * 1023.5f + 1023.5f;
+    ((struct msg_inceptor_data *)packed)->ch15                = msg_clamp(((struct inceptor_data *)unpacked)->ch[15],-1.0f,1.0f) * 1023.5f + 1023.5f;
   }
 }
 
@@ -1229,7 +1313,7 @@ void unpack_inceptor_data(void *packed, void *unpacked)
   if ((unpacked) && (packed)) {
     ((struct inceptor_data *)unpacked)->frame_counter       = ((struct msg_inceptor_data *)packed)->frame_counter;
     ((struct inceptor_data *)unpacked)->time_offset_us      = ((struct msg_inceptor_data *)packed)->time_offset_us;
-    ((struct inceptor_data *)unpacked)->lost_frame          = ((struct msg_inceptor_data *)packed)->lost_frame;
+    ((struct inceptor_data *)unpacked)->lost_frames         = ((struct msg_inceptor_data *)packed)->lost_frames;
     ((struct inceptor_data *)unpacked)->failsafe_activated  = ((struct msg_inceptor_data *)packed)->failsafe_activated;
     ((struct inceptor_data *)unpacked)->ch[0]               = (float) ((struct msg_inceptor_data *)packed)->ch0 / 1023.5f - 1.0f;
     ((struct inceptor_data *)unpacked)->ch[1]               = (float) ((struct msg_inceptor_data *)packed)->ch1 / 1023.5f - 1.0f;
@@ -1255,7 +1339,7 @@ void pack_temperature_data(void *unpacked, void *packed)
   if ((unpacked) && (packed)) {
     ((struct msg_temperature_data *)packed)->frame_counter   = ((struct temperature_data *)unpacked)->frame_counter;
     ((struct msg_temperature_data *)packed)->time_offset_us  = ((struct temperature_data *)unpacked)->time_offset_us;
-    ((struct msg_temperature_data *)packed)->temp_c          = ((struct temperature_data *)unpacked)->temp_c * 16383.0f / 120.0f + 5461.0f;
+    ((struct msg_temperature_data *)packed)->temp_c          = msg_clamp(((struct temperature_data *)unpacked)->temp_c,-40.0f,80.0f) * 16383.0f / 120.0f + 5461.0f;
   }
 }
 
@@ -1278,14 +1362,14 @@ void pack_gnss_data(void *unpacked, void *packed)
     ((struct msg_gnss_data *)packed)->tow_ms          = ((struct gnss_data *)unpacked)->tow_ms;
     ((struct msg_gnss_data *)packed)->lat_rad         = ((struct gnss_data *)unpacked)->lat_rad * 2147483647.5 / D_PI + 2147483647.5;
     ((struct msg_gnss_data *)packed)->lon_rad         = ((struct gnss_data *)unpacked)->lon_rad * 2147483647.5 / D_PI + 2147483647.5;
-    ((struct msg_gnss_data *)packed)->hmsl_m          = ((struct gnss_data *)unpacked)->hmsl_m * 1118.48105f + 11184810.5f;
-    ((struct msg_gnss_data *)packed)->vel_north_ms    = ((struct gnss_data *)unpacked)->vel_north_ms * 1048.575f + 524287.5f;
-    ((struct msg_gnss_data *)packed)->vel_east_ms     = ((struct gnss_data *)unpacked)->vel_east_ms * 1048.575f + 524287.5f;
-    ((struct msg_gnss_data *)packed)->vel_down_ms     = ((struct gnss_data *)unpacked)->vel_down_ms * 1310.715f + 131071.5f;
-    ((struct msg_gnss_data *)packed)->horiz_acc_m     = ((struct gnss_data *)unpacked)->horiz_acc_m * 1310.71f;
-    ((struct msg_gnss_data *)packed)->vert_acc_m      = ((struct gnss_data *)unpacked)->vert_acc_m * 1310.71f;
-    ((struct msg_gnss_data *)packed)->speed_acc_ms    = ((struct gnss_data *)unpacked)->speed_acc_ms * 1310.71f;
-    ((struct msg_gnss_data *)packed)->pdop            = ((struct gnss_data *)unpacked)->pdop * 163.83f;
+    ((struct msg_gnss_data *)packed)->hmsl_m          = msg_clamp(((struct gnss_data *)unpacked)->hmsl_m,-10000.0f,50000.0f) * 1118.48105f + 11184810.5f;
+    ((struct msg_gnss_data *)packed)->vel_north_ms    = msg_clamp(((struct gnss_data *)unpacked)->vel_north_ms,-500.0f,500.0f) * 1048.575f + 524287.5f;
+    ((struct msg_gnss_data *)packed)->vel_east_ms     = msg_clamp(((struct gnss_data *)unpacked)->vel_east_ms,-500.0f,500.0f) * 1048.575f + 524287.5f;
+    ((struct msg_gnss_data *)packed)->vel_down_ms     = msg_clamp(((struct gnss_data *)unpacked)->vel_down_ms,-100.0f,100.0f) * 1310.715f + 131071.5f;
+    ((struct msg_gnss_data *)packed)->horiz_acc_m     = msg_clamp(((struct gnss_data *)unpacked)->horiz_acc_m,0.0f,100.0f) * 1310.71f;
+    ((struct msg_gnss_data *)packed)->vert_acc_m      = msg_clamp(((struct gnss_data *)unpacked)->vert_acc_m,0.0f,100.0f) * 1310.71f;
+    ((struct msg_gnss_data *)packed)->speed_acc_ms    = msg_clamp(((struct gnss_data *)unpacked)->speed_acc_ms,0.0f,100.0f) * 1310.71f;
+    ((struct msg_gnss_data *)packed)->pdop            = msg_clamp(((struct gnss_data *)unpacked)->pdop,0.0f,100.0f) * 163.83f;
   }
 }
 
@@ -1315,7 +1399,7 @@ void pack_static_press_data(void *unpacked, void *packed)
   if ((unpacked) && (packed)) {
     ((struct msg_static_press_data *)packed)->frame_counter   = ((struct static_press_data *)unpacked)->frame_counter;
     ((struct msg_static_press_data *)packed)->time_offset_us  = ((struct static_press_data *)unpacked)->time_offset_us;
-    ((struct msg_static_press_data *)packed)->press_pa        = ((struct static_press_data *)unpacked)->press_pa * 4194303.0f / 80000.0f - 1572863.625f;
+    ((struct msg_static_press_data *)packed)->press_pa        = msg_clamp(((struct static_press_data *)unpacked)->press_pa,30000.0f,110000.0f) * 4194303.0f / 80000.0f - 1572863.625f;
   }
 }
 
@@ -1333,7 +1417,7 @@ void pack_diff_press_data(void *unpacked, void *packed)
   if ((unpacked) && (packed)) {
     ((struct msg_diff_press_data *)packed)->frame_counter   = ((struct diff_press_data *)unpacked)->frame_counter;
     ((struct msg_diff_press_data *)packed)->time_offset_us  = ((struct diff_press_data *)unpacked)->time_offset_us;
-    ((struct msg_diff_press_data *)packed)->press_pa        = ((struct diff_press_data *)unpacked)->press_pa * 2097151.5f / 20000.0f + 2097151.5f;
+    ((struct msg_diff_press_data *)packed)->press_pa        = msg_clamp(((struct diff_press_data *)unpacked)->press_pa,-20000.0f,20000.0f) * 2097151.5f / 20000.0f + 2097151.5f;
   }
 }
 
@@ -1352,7 +1436,7 @@ void pack_analog_data(void *unpacked, void *packed)
   if ((unpacked) && (packed)) {
     ((struct msg_analog_data *)packed)->frame_counter   = ((struct analog_data *)unpacked)->frame_counter;
     ((struct msg_analog_data *)packed)->time_offset_us  = ((struct analog_data *)unpacked)->time_offset_us;
-    ((struct msg_analog_data *)packed)->voltage         = ((struct analog_data *)unpacked)->voltage * 8191.0f / 3.3f;
+    ((struct msg_analog_data *)packed)->voltage         = msg_clamp(((struct analog_data *)unpacked)->voltage,0.0f,3.3f) * 8191.0f / 3.3f;
     memcpy(&temp,&((struct analog_data *)unpacked)->cal_value,sizeof(temp));
     ((struct msg_analog_data *)packed)->cal_value       = temp;
   }
@@ -1393,7 +1477,7 @@ void pack_voltage_data(void *unpacked, void *packed)
   if ((unpacked) && (packed)) {
     ((struct msg_voltage_data *)packed)->frame_counter   = ((struct voltage_data *)unpacked)->frame_counter;
     ((struct msg_voltage_data *)packed)->time_offset_us  = ((struct voltage_data *)unpacked)->time_offset_us;
-    ((struct msg_voltage_data *)packed)->voltage         = ((struct voltage_data *)unpacked)->voltage * 8191.0f / 36.0f;
+    ((struct msg_voltage_data *)packed)->voltage         = msg_clamp(((struct voltage_data *)unpacked)->voltage,0.0f,36.0f) * 8191.0f / 36.0f;
   }
 }
 
@@ -1405,3 +1489,49 @@ void unpack_voltage_data(void *packed, void *unpacked)
     ((struct voltage_data *)unpacked)->voltage         = (float) ((struct msg_voltage_data *)packed)->voltage * 36.0f / 8191.0f;
   }
 }
+
+void pack_humidity_data(void *unpacked, void *packed)
+{
+  if ((unpacked) && (packed)) {
+    ((struct msg_humidity_data *)packed)->frame_counter   = ((struct humidity_data *)unpacked)->frame_counter;
+    ((struct msg_humidity_data *)packed)->time_offset_us  = ((struct humidity_data *)unpacked)->time_offset_us;
+    ((struct msg_humidity_data *)packed)->humidity_rh     = msg_clamp(((struct humidity_data *)unpacked)->humidity_rh,0.0f,100.0f) * 16383.0f / 100.0f;
+  }
+}
+
+void unpack_humidity_data(void *packed, void *unpacked)
+{
+  if ((unpacked) && (packed)) {
+    ((struct humidity_data *)unpacked)->frame_counter   = ((struct msg_humidity_data *)packed)->frame_counter;
+    ((struct humidity_data *)unpacked)->time_offset_us  = ((struct msg_humidity_data *)packed)->time_offset_us;
+    ((struct humidity_data *)unpacked)->humidity_rh     = (float) ((struct msg_humidity_data *)packed)->humidity_rh * 100.0f / 16383.0f;
+  }
+}
+
+void pack_gnss_time_data(void *unpacked, void *packed)
+{
+  if ((unpacked) && (packed)) {
+    ((struct msg_gnss_time_data *)packed)->frame_counter   = ((struct gnss_time_data *)unpacked)->frame_counter;
+    ((struct msg_gnss_time_data *)packed)->time_offset_us  = ((struct gnss_time_data *)unpacked)->time_offset_us;
+    ((struct msg_gnss_time_data *)packed)->year            = ((struct gnss_time_data *)unpacked)->year;
+    ((struct msg_gnss_time_data *)packed)->month           = ((struct gnss_time_data *)unpacked)->month;
+    ((struct msg_gnss_time_data *)packed)->day             = ((struct gnss_time_data *)unpacked)->day;
+    ((struct msg_gnss_time_data *)packed)->hour            = ((struct gnss_time_data *)unpacked)->hour;
+    ((struct msg_gnss_time_data *)packed)->min             = ((struct gnss_time_data *)unpacked)->min;
+    ((struct msg_gnss_time_data *)packed)->sec             = ((struct gnss_time_data *)unpacked)->sec;
+  }
+}
+
+void unpack_gnss_time_data(void *packed, void *unpacked)
+{
+  if ((unpacked) && (packed)) {
+    ((struct gnss_time_data *)unpacked)->frame_counter   = ((struct msg_gnss_time_data *)packed)->frame_counter;
+    ((struct gnss_time_data *)unpacked)->time_offset_us  = ((struct msg_gnss_time_data *)packed)->time_offset_us;
+    ((struct gnss_time_data *)unpacked)->year            = ((struct msg_gnss_time_data *)packed)->year;
+    ((struct gnss_time_data *)unpacked)->month           = ((struct msg_gnss_time_data *)packed)->month;
+    ((struct gnss_time_data *)unpacked)->day             = ((struct msg_gnss_time_data *)packed)->day;
+    ((struct gnss_time_data *)unpacked)->hour            = ((struct msg_gnss_time_data *)packed)->hour;
+    ((struct gnss_time_data *)unpacked)->min             = ((struct msg_gnss_time_data *)packed)->min;
+    ((struct gnss_time_data *)unpacked)->sec             = ((struct msg_gnss_time_data *)packed)->sec;
+  }
+}
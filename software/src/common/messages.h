@@ -66,6 +66,8 @@ enum MessageIds {
   MSG_ANALOG_DATA,
   MSG_DIGITAL_DATA,
   MSG_VOLTAGE_DATA,
+  MSG_HUMIDITY_DATA,
+  MSG_GNSS_TIME_DATA,
   NUM_MSG_ID
 };
 typedef enum MessageIds MsgId_t;
@@ -178,6 +180,23 @@ MsgId_t msg_rx_id(Msg_t *self);
 * Returns a pointer to the payload from the last call to msg_parse_rx.
 */
 void *msg_rx_payload(Msg_t *self);
+/*
+* Returns the length of the packed message body, without header or
+* checksum, given the message id. Returns 0 for an invalid id.
+*/
+unsigned int msg_packed_size(MsgId_t msg);
+/*
+* Packs a payload into a message body without header or checksum, for
+* use within an already framed and checksummed stream. The buffer must
+* hold msg_packed_size(msg) bytes. Returns the number of bytes packed,
+* or 0 on failure.
+*/
+unsigned int msg_pack(MsgId_t msg,void *payload,unsigned char *buffer);
+/*
+* Unpacks a message body packed by msg_pack into the payload. Message
+* error codes are returned to indicate success or failure.
+*/
+MsgError_t msg_unpack(MsgId_t msg,const unsigned char *buffer,void *payload);
 
 /*
 * Ensure C friendly linkages in a mixed C/C++ build
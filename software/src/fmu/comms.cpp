@@ -89,6 +89,30 @@ bool AircraftSocComms::ReceiveEffectorCommand(std::vector<float> *EffectorComman
   }
 }
 
+/* returns configuration section hashes if a hash message has been received */
+bool AircraftSocComms::ReceiveConfigHashes(std::vector<uint32_t> *Hashes) {
+  if (MessageReceived_) {
+    if (ReceivedMessage_ == ConfigHashes) {
+      MessageReceived_ = false;
+      Hashes->resize(ReceivedPayload_.size()/sizeof(uint32_t));
+      memcpy(Hashes->data(),ReceivedPayload_.data(),Hashes->size()*sizeof(uint32_t));
+      return true;
+    } else {
+      return false;
+    }
+  } else {
+    return false;
+  }
+}
+
+/* sends configuration section hashes */
+void AircraftSocComms::SendConfigHashes(std::vector<uint32_t> &Hashes) {
+  std::vector<uint8_t> Payload;
+  Payload.resize(Hashes.size()*sizeof(uint32_t));
+  memcpy(Payload.data(),Hashes.data(),Payload.size());
+  SendMessage(ConfigHashes,Payload);
+}
+
 /* checks for valid BFS messages received */
 void AircraftSocComms::CheckMessages() {
   MessageReceived_ = ReceiveMessage(&ReceivedMessage_,&ReceivedPayload_);
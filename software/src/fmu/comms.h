@@ -34,7 +34,8 @@ class AircraftSocComms {
       ModeCommand,
       Configuration,
       SensorData,
-      EffectorCommand
+      EffectorCommand,
+      ConfigHashes
     };
     AircraftSocComms(HardwareSerial& bus,uint32_t baud);
     void Begin();
@@ -42,6 +43,8 @@ class AircraftSocComms {
     bool ReceiveModeCommand(AircraftMission::Mode *mode);
     bool ReceiveConfigMessage(std::vector<char> *ConfigString);
     bool ReceiveEffectorCommand(std::vector<float> *EffectorCommands);
+    bool ReceiveConfigHashes(std::vector<uint32_t> *Hashes);
+    void SendConfigHashes(std::vector<uint32_t> &Hashes);
     void CheckMessages();
     void SendMessage(Message message,std::vector<uint8_t> &Payload);
     bool ReceiveMessage(Message *message,std::vector<uint8_t> *Payload);
@@ -62,3 +62,41 @@ void AircraftConfiguration::Update(const char* JsonString,AircraftMission *Aircr
     }
   }
 }
+
+/* Gets the hashes of the applied configuration sections */
+void AircraftConfiguration::GetAppliedHashes(std::vector<uint32_t> *Hashes) {
+  sections_.GetApplied(Hashes);
+}
+
+/* Sets the configuration sections to apply and returns the hashes of sections not in the cache */
+void AircraftConfiguration::SetRequestedHashes(const std::vector<uint32_t> &Hashes,std::vector<uint32_t> *MissingHashes) {
+  sections_.SetRequested(Hashes,MissingHashes);
+}
+
+/* Caches a configuration section, returns false if no sections were requested and it should be applied immediately */
+bool AircraftConfiguration::CacheSection(std::vector<char> &JsonString) {
+  return sections_.Cache(JsonString.data(),JsonString.size());
+}
+
+/* Applies the requested configuration sections in order and drops cached sections no longer used */
+void AircraftConfiguration::ApplySections(AircraftMission *AircraftMissionPtr,AircraftSensors *AircraftSensorsPtr,ControlLaws *ControlLawsPtr,AircraftEffectors *AircraftEffectorsPtr,DefinitionTree *DefinitionTreePtr) {
+  if (!sections_.Requested()) {
+    return;
+  }
+  Serial.println("Applying configuration sections...");
+  size_t Missing = sections_.Apply([&](const char *Json) {
+    Update(Json,AircraftMissionPtr,AircraftSensorsPtr,ControlLawsPtr,AircraftEffectorsPtr,DefinitionTreePtr);
+  });
+  if (Missing > 0) {
+    // not reported as applied, so the SOC uploads them again
+    Serial.print("\tWARNING: ");
+    Serial.print(Missing);
+    Serial.println(" requested sections were never received.");
+  }
+  Serial.println("done!");
+}
+
+/* Clears the applied configuration hashes, called when the configuration is torn down */
+void AircraftConfiguration::ClearAppliedHashes() {
+  sections_.ClearApplied();
+}
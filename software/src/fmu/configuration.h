@@ -30,6 +30,9 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include "definition-tree.h"
 #include "EEPROM.h"
 #include "Arduino.h"
+#include "config_sections.h"
+#include <string>
+#include <vector>
 
 class AircraftConfiguration {
   public:
@@ -38,8 +41,15 @@ class AircraftConfiguration {
     };
     void Load();
     void Update(const char* JsonString,AircraftMission *AircraftMissionPtr,AircraftSensors *AircraftSensorsPtr,ControlLaws *ControlLawsPtr,AircraftEffectors *AircraftEffectorsPtr,DefinitionTree *DefinitionTreePtr);
+    void GetAppliedHashes(std::vector<uint32_t> *Hashes);
+    void SetRequestedHashes(const std::vector<uint32_t> &Hashes,std::vector<uint32_t> *MissingHashes);
+    bool CacheSection(std::vector<char> &JsonString);
+    void ApplySections(AircraftMission *AircraftMissionPtr,AircraftSensors *AircraftSensorsPtr,ControlLaws *ControlLawsPtr,AircraftEffectors *AircraftEffectorsPtr,DefinitionTree *DefinitionTreePtr);
+    void ClearAppliedHashes();
   private:
     Config config_;
+    // configuration sections received from the SOC and the hashes applied
+    ConfigSections sections_;
 };
 
 #endif
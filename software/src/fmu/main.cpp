@@ -51,6 +51,10 @@ AircraftMission::State MissionState;
 AircraftMission::Mode RequestedMode;
 // effector commands
 std::vector<float> EffectorCommands;
+// configuration section hashes
+std::vector<uint32_t> ConfigHashes;
+// configuration section hashes sent back to the SOC
+std::vector<uint32_t> ReplyHashes;
 
 // runs with the FMU integrated IMU data ready interrupt
 void ImuInterrupt() {
@@ -127,11 +131,29 @@ int main()
       std::vector<char> ConfigBuffer;
       // update configuration
       if (SocComms.ReceiveConfigMessage(&ConfigBuffer)) {
-        Config.Update(ConfigBuffer.data(),&Mission,&Sensors,&Control,&Effectors,&GlobalData);
+        // sections are cached and applied on entering run mode if the SOC sent their hashes
+        if (!Config.CacheSection(ConfigBuffer)) {
+          Config.Update(ConfigBuffer.data(),&Mission,&Sensors,&Control,&Effectors,&GlobalData);
+        }
+      }
+    }
+    // configuration hashes, an empty list requests the applied configuration
+    if (SocComms.ReceiveConfigHashes(&ConfigHashes)) {
+      if (ConfigHashes.size() == 0) {
+        Config.GetAppliedHashes(&ReplyHashes);
+      } else {
+        Config.SetRequestedHashes(ConfigHashes,&ReplyHashes);
       }
+      SocComms.SendConfigHashes(ReplyHashes);
     }
     // request mode
     if (SocComms.ReceiveModeCommand(&RequestedMode)) {
+      if ((MissionMode == AircraftMission::Configuration)&&(RequestedMode == AircraftMission::Run)) {
+        Config.ApplySections(&Mission,&Sensors,&Control,&Effectors,&GlobalData);
+      }
+      if ((MissionMode == AircraftMission::Run)&&(RequestedMode == AircraftMission::Configuration)) {
+        Config.ClearAppliedHashes();
+      }
       Mission.SetRequestedMode(RequestedMode);
     }
     // check for new messages from SOC
@@ -19,6 +19,25 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 */
 
 #include "sensors.h"
+#include "messages.h"
+
+/* packed sensor message names used to configure the message rates */
+static const struct {
+  const char *Name;
+  MsgId_t Id;
+} kMessageNames[] = {
+  {"Accel",MSG_ACCEL_DATA},
+  {"Gyro",MSG_GYRO_DATA},
+  {"Mag",MSG_MAG_DATA},
+  {"Inceptor",MSG_INCEPTOR_DATA},
+  {"Temperature",MSG_TEMPERATURE_DATA},
+  {"Humidity",MSG_HUMIDITY_DATA},
+  {"Gnss",MSG_GNSS_DATA},
+  {"StaticPressure",MSG_STATIC_PRESS_DATA},
+  {"DifferentialPressure",MSG_DIFF_PRESS_DATA},
+  {"Analog",MSG_ANALOG_DATA},
+  {"Voltage",MSG_VOLTAGE_DATA}
+};
 
 /* update internal MPU9250 sensor configuration */
 void InternalMpu9250Sensor::UpdateConfig(const char *JsonString,std::string RootPath,DefinitionTree *DefinitionTreePtr) {
@@ -685,6 +704,11 @@ void Ams5915Sensor::GetConfig(Config *ConfigPtr) {
   *ConfigPtr = config_;
 }
 
+/* returns true for differential transducers, false for the absolute and barometric ones */
+bool Ams5915Sensor::IsDifferential(AMS5915::Transducer Transducer) {
+  return (Transducer != AMS5915::AMS5915_1000_A)&&(Transducer != AMS5915::AMS5915_1200_B);
+}
+
 /* start communication with the AMS5915 */
 void Ams5915Sensor::Begin() {
   ams_ = new AMS5915(Wire1,config_.Addr,config_.Transducer);
@@ -1001,6 +1025,7 @@ void SensorNodes::UpdateConfig(const char *JsonString,std::string RootPath,Defin
             }
             if (Sensor["Type"] == "Ams5915") {
               data_.Ams5915.resize(data_.Ams5915.size()+1);
+              config_.Ams5915Differential.push_back((Sensor["Transducer"] != "AMS5915-1000-A")&&(Sensor["Transducer"] != "AMS5915-1200-B"));
               std::string Output = (std::string) Sensor.get<String>("Output").c_str();
               DefinitionTreePtr->InitMember(RootPath+"/"+Output+"/Status",(int8_t*)&data_.Ams5915.back().ReadStatus);
               DefinitionTreePtr->InitMember(RootPath+"/"+Output+"/Pressure_Pa",&data_.Ams5915.back().Pressure_Pa);
@@ -1176,6 +1201,19 @@ void AircraftSensors::UpdateConfig(const char *JsonString,DefinitionTree *Defini
         data_.InternalBme280.resize(classes_.InternalBme280.size());
         classes_.InternalBme280.back().UpdateConfig(buffer.data(),RootPath_,DefinitionTreePtr);
       }
+      if (Sensor["Type"] == "MessageRates") {
+        Serial.print("\tMessage rates: ");
+        if (MessageDividers_.size() != NUM_MSG_ID) {
+          SetDefaultMessageDividers();
+        }
+        for (size_t i=0; i < sizeof(kMessageNames)/sizeof(kMessageNames[0]); i++) {
+          if (Sensor.containsKey(kMessageNames[i].Name)) {
+            uint8_t Divider = Sensor[kMessageNames[i].Name];
+            MessageDividers_[kMessageNames[i].Id] = (Divider > 0) ? Divider : 1;
+          }
+        }
+        Serial.println("done.");
+      }
       if (Sensor["Type"] == "InputVoltage") {
         if (AcquireInputVoltageData_) {
           while(1){
@@ -1414,6 +1452,18 @@ void AircraftSensors::Begin() {
     Serial.print("\t\tAnalog: ");
     Serial.println(data_.Nodes[i].Analog.size());
   }
+  // AMS5915 transducer types in the order the sensors are sent, FMU sensors then node sensors
+  Ams5915Differential_.clear();
+  for (size_t i=0; i < classes_.Ams5915.size(); i++) {
+    Ams5915Sensor::Config TempConfig;
+    classes_.Ams5915[i].GetConfig(&TempConfig);
+    Ams5915Differential_.push_back(Ams5915Sensor::IsDifferential(TempConfig.Transducer));
+  }
+  for (size_t i=0; i < classes_.Nodes.size(); i++) {
+    SensorNodes::Config TempConfig;
+    classes_.Nodes[i].GetConfig(&TempConfig);
+    Ams5915Differential_.insert(Ams5915Differential_.end(),TempConfig.Ams5915Differential.begin(),TempConfig.Ams5915Differential.end());
+  }
   Serial.println("done!");
 }
 
@@ -1565,102 +1615,185 @@ void AircraftSensors::GetData(Data *DataPtr) {
   *DataPtr = data_;
 }
 
-/* get data buffer */
+/* get data buffer, meta data and time followed by the packed sensor messages */
 void AircraftSensors::GetDataBuffer(std::vector<uint8_t> *Buffer) {
-  size_t BufferLocation = 0;
-  Buffer->resize(SerializedDataMetadataSize+
-    sizeof(data_.Time_us[0])*data_.Time_us.size()+
-    sizeof(InternalMpu9250Sensor::Data)*data_.InternalMpu9250.size()+
-    sizeof(InternalBme280Sensor::Data)*data_.InternalBme280.size()+
-    sizeof(data_.InputVoltage_V[0])*data_.InputVoltage_V.size()+
-    sizeof(data_.RegulatedVoltage_V[0])*data_.RegulatedVoltage_V.size()+
-    sizeof(data_.PwmVoltage_V[0])*data_.PwmVoltage_V.size()+
-    sizeof(data_.SbusVoltage_V[0])*data_.SbusVoltage_V.size()+
-    sizeof(Mpu9250Sensor::Data)*data_.Mpu9250.size()+
-    sizeof(Bme280Sensor::Data)*data_.Bme280.size()+
-    sizeof(uBloxSensor::Data)*data_.uBlox.size()+
-    sizeof(SwiftSensor::Data)*data_.Swift.size()+
-    sizeof(SbusSensor::Data)*data_.Sbus.size()+
-    sizeof(Ams5915Sensor::Data)*data_.Ams5915.size()+
-    sizeof(AnalogSensor::Data)*data_.Analog.size());
-    // meta data
-    uint8_t AcquireInternalData,NumberPwmVoltageSensor,NumberSbusVoltageSensor,NumberMpu9250Sensor,NumberBme280Sensor,NumberuBloxSensor,NumberSwiftSensor,NumberAms5915Sensor,NumberSbusSensor,NumberAnalogSensor;
-    AcquireInternalData = 0x00;
-    if (AcquireTimeData_) {
-      AcquireInternalData |=  0x01;
-    }
-    if (AcquireInternalMpu9250Data_) {
-      AcquireInternalData |=  0x02;
-    }
-    if (data_.InternalBme280.size() > 0) {
-      AcquireInternalData |=  0x04;
-    }
-    if (AcquireInputVoltageData_) {
-      AcquireInternalData |=  0x08;
-    }
-    if (AcquireRegulatedVoltageData_) {
-      AcquireInternalData |=  0x10;
-    }
-    NumberPwmVoltageSensor = data_.PwmVoltage_V.size();
-    NumberSbusVoltageSensor = data_.SbusVoltage_V.size();
-    NumberMpu9250Sensor = data_.Mpu9250.size();
-    NumberBme280Sensor = data_.Bme280.size();
-    NumberuBloxSensor = data_.uBlox.size();
-    NumberSwiftSensor = data_.Swift.size();
-    NumberAms5915Sensor = data_.Ams5915.size();
-    NumberSbusSensor = data_.Sbus.size();
-    NumberAnalogSensor = data_.Analog.size();
-    // Serial.println(NumberSbusSensor);
-    memcpy(Buffer->data()+BufferLocation,&AcquireInternalData,sizeof(AcquireInternalData));
-    BufferLocation+=sizeof(AcquireInternalData);
-    memcpy(Buffer->data()+BufferLocation,&NumberPwmVoltageSensor,sizeof(NumberPwmVoltageSensor));
-    BufferLocation+=sizeof(NumberPwmVoltageSensor);
-    memcpy(Buffer->data()+BufferLocation,&NumberSbusVoltageSensor,sizeof(NumberSbusVoltageSensor));
-    BufferLocation+=sizeof(NumberSbusVoltageSensor);
-    memcpy(Buffer->data()+BufferLocation,&NumberMpu9250Sensor,sizeof(NumberMpu9250Sensor));
-    BufferLocation+=sizeof(NumberMpu9250Sensor);
-    memcpy(Buffer->data()+BufferLocation,&NumberBme280Sensor,sizeof(NumberBme280Sensor));
-    BufferLocation+=sizeof(NumberBme280Sensor);
-    memcpy(Buffer->data()+BufferLocation,&NumberuBloxSensor,sizeof(NumberuBloxSensor));
-    BufferLocation+=sizeof(NumberuBloxSensor);
-    memcpy(Buffer->data()+BufferLocation,&NumberSwiftSensor,sizeof(NumberSwiftSensor));
-    BufferLocation+=sizeof(NumberSwiftSensor);
-    memcpy(Buffer->data()+BufferLocation,&NumberAms5915Sensor,sizeof(NumberAms5915Sensor));
-    BufferLocation+=sizeof(NumberAms5915Sensor);
-    memcpy(Buffer->data()+BufferLocation,&NumberSbusSensor,sizeof(NumberSbusSensor));
-    BufferLocation+=sizeof(NumberSbusSensor);
-    memcpy(Buffer->data()+BufferLocation,&NumberAnalogSensor,sizeof(NumberAnalogSensor));
-    BufferLocation+=sizeof(NumberAnalogSensor);
-    // sensor data
-    memcpy(Buffer->data()+BufferLocation,data_.Time_us.data(),data_.Time_us.size()*sizeof(data_.Time_us[0]));
-    BufferLocation+=data_.Time_us.size()*sizeof(data_.Time_us[0]);
-    memcpy(Buffer->data()+BufferLocation,data_.InternalMpu9250.data(),data_.InternalMpu9250.size()*sizeof(InternalMpu9250Sensor::Data));
-    BufferLocation+=data_.InternalMpu9250.size()*sizeof(InternalMpu9250Sensor::Data);
-    memcpy(Buffer->data()+BufferLocation,data_.InternalBme280.data(),data_.InternalBme280.size()*sizeof(InternalBme280Sensor::Data));
-    BufferLocation+=data_.InternalBme280.size()*sizeof(InternalBme280Sensor::Data);
-    memcpy(Buffer->data()+BufferLocation,data_.InputVoltage_V.data(),data_.InputVoltage_V.size()*sizeof(data_.InputVoltage_V[0]));
-    BufferLocation+=data_.InputVoltage_V.size()*sizeof(data_.InputVoltage_V[0]);
-    memcpy(Buffer->data()+BufferLocation,data_.RegulatedVoltage_V.data(),data_.RegulatedVoltage_V.size()*sizeof(data_.RegulatedVoltage_V[0]));
-    BufferLocation+=data_.RegulatedVoltage_V.size()*sizeof(data_.RegulatedVoltage_V[0]);
-    memcpy(Buffer->data()+BufferLocation,data_.PwmVoltage_V.data(),data_.PwmVoltage_V.size()*sizeof(data_.PwmVoltage_V[0]));
-    BufferLocation+=data_.PwmVoltage_V.size()*sizeof(data_.PwmVoltage_V[0]);
-    memcpy(Buffer->data()+BufferLocation,data_.SbusVoltage_V.data(),data_.SbusVoltage_V.size()*sizeof(data_.SbusVoltage_V[0]));
-    BufferLocation+=data_.SbusVoltage_V.size()*sizeof(data_.SbusVoltage_V[0]);
-    memcpy(Buffer->data()+BufferLocation,data_.Mpu9250.data(),data_.Mpu9250.size()*sizeof(Mpu9250Sensor::Data));
-    BufferLocation+=data_.Mpu9250.size()*sizeof(Mpu9250Sensor::Data);
-    memcpy(Buffer->data()+BufferLocation,data_.Bme280.data(),data_.Bme280.size()*sizeof(Bme280Sensor::Data));
-    BufferLocation+=data_.Bme280.size()*sizeof(Bme280Sensor::Data);
-    memcpy(Buffer->data()+BufferLocation,data_.uBlox.data(),data_.uBlox.size()*sizeof(uBloxSensor::Data));
-    BufferLocation+=data_.uBlox.size()*sizeof(uBloxSensor::Data);
-    memcpy(Buffer->data()+BufferLocation,data_.Swift.data(),data_.Swift.size()*sizeof(SwiftSensor::Data));
-    BufferLocation+=data_.Swift.size()*sizeof(SwiftSensor::Data);
-    memcpy(Buffer->data()+BufferLocation,data_.Ams5915.data(),data_.Ams5915.size()*sizeof(Ams5915Sensor::Data));
-    BufferLocation+=data_.Ams5915.size()*sizeof(Ams5915Sensor::Data);
-    memcpy(Buffer->data()+BufferLocation,data_.Sbus.data(),data_.Sbus.size()*sizeof(SbusSensor::Data));
-    BufferLocation+=data_.Sbus.size()*sizeof(SbusSensor::Data);
-    memcpy(Buffer->data()+BufferLocation,data_.Analog.data(),data_.Analog.size()*sizeof(AnalogSensor::Data));
-    BufferLocation+=data_.Analog.size()*sizeof(AnalogSensor::Data);
+  if (MessageDividers_.size() != NUM_MSG_ID) {
+    SetDefaultMessageDividers();
   }
+  Buffer->clear();
+  // meta data
+  uint8_t AcquireInternalData = 0x00;
+  if (AcquireTimeData_) {
+    AcquireInternalData |=  0x01;
+  }
+  if (AcquireInternalMpu9250Data_) {
+    AcquireInternalData |=  0x02;
+  }
+  if (data_.InternalBme280.size() > 0) {
+    AcquireInternalData |=  0x04;
+  }
+  if (AcquireInputVoltageData_) {
+    AcquireInternalData |=  0x08;
+  }
+  if (AcquireRegulatedVoltageData_) {
+    AcquireInternalData |=  0x10;
+  }
+  Buffer->push_back(AcquireInternalData);
+  Buffer->push_back((uint8_t)data_.PwmVoltage_V.size());
+  Buffer->push_back((uint8_t)data_.SbusVoltage_V.size());
+  Buffer->push_back((uint8_t)data_.Mpu9250.size());
+  Buffer->push_back((uint8_t)data_.Bme280.size());
+  Buffer->push_back((uint8_t)data_.uBlox.size());
+  Buffer->push_back((uint8_t)data_.Swift.size());
+  Buffer->push_back((uint8_t)data_.Ams5915.size());
+  Buffer->push_back((uint8_t)data_.Sbus.size());
+  Buffer->push_back((uint8_t)data_.Analog.size());
+  // time is sent unpacked, the message protocol has no 64 bit time
+  if (AcquireTimeData_) {
+    size_t BufferLocation = Buffer->size();
+    Buffer->resize(BufferLocation+sizeof(data_.Time_us[0]));
+    memcpy(Buffer->data()+BufferLocation,&data_.Time_us[0],sizeof(data_.Time_us[0]));
+  }
+  // packed sensor messages, sensors are numbered in meta data order with the Swift using two slots
+  uint8_t Slot = 0;
+  if (AcquireInternalMpu9250Data_) {
+    InternalMpu9250Sensor::Data &Data = data_.InternalMpu9250[0];
+    AddImuMessages(Buffer,Slot++,Data.Accel_mss,Data.Gyro_rads,Data.Mag_uT,Data.Temperature_C,false);
+  }
+  for (size_t i=0; i < data_.InternalBme280.size(); i++) {
+    struct humidity_data Humidity = {FrameCounter_ & 0x07,0,data_.InternalBme280[i].Humidity_RH};
+    AddPressureMessages(Buffer,Slot,data_.InternalBme280[i].Pressure_Pa,data_.InternalBme280[i].Temperature_C,false,false);
+    AddSensorMessage(Buffer,Slot++,MSG_HUMIDITY_DATA,&Humidity,false);
+  }
+  std::vector<float> *Voltages[4] = {&data_.InputVoltage_V,&data_.RegulatedVoltage_V,&data_.PwmVoltage_V,&data_.SbusVoltage_V};
+  for (size_t i=0; i < 4; i++) {
+    for (size_t j=0; j < Voltages[i]->size(); j++) {
+      struct voltage_data Voltage = {FrameCounter_ & 0x07,0,(*Voltages[i])[j]};
+      AddSensorMessage(Buffer,Slot++,MSG_VOLTAGE_DATA,&Voltage,false);
+    }
+  }
+  for (size_t i=0; i < data_.Mpu9250.size(); i++) {
+    Mpu9250Sensor::Data &Data = data_.Mpu9250[i];
+    AddImuMessages(Buffer,Slot++,Data.Accel_mss,Data.Gyro_rads,Data.Mag_uT,Data.Temperature_C,Data.ReadStatus < 0);
+  }
+  for (size_t i=0; i < data_.Bme280.size(); i++) {
+    Bme280Sensor::Data &Data = data_.Bme280[i];
+    struct humidity_data Humidity = {FrameCounter_ & 0x07,0,Data.Humidity_RH};
+    AddPressureMessages(Buffer,Slot,Data.Pressure_Pa,Data.Temperature_C,false,Data.ReadStatus < 0);
+    AddSensorMessage(Buffer,Slot++,MSG_HUMIDITY_DATA,&Humidity,Data.ReadStatus < 0);
+  }
+  // GNSS messages are only sent with a new navigation solution
+  uBloxTow_.resize(data_.uBlox.size(),0xFFFFFFFF);
+  for (size_t i=0; i < data_.uBlox.size(); i++,Slot++) {
+    uBloxSensor::Data &Data = data_.uBlox[i];
+    if ((Data.TOW == uBloxTow_[i])||((FrameCounter_ + Slot) % MessageDividers_[MSG_GNSS_DATA] != 0)) {
+      continue;
+    }
+    uBloxTow_[i] = Data.TOW;
+    struct gnss_data Gnss;
+    Gnss.frame_counter = FrameCounter_ & 0x07;
+    Gnss.time_offset_us = 0;
+    Gnss.fix = Data.Fix;
+    Gnss.num_sv = Data.NumberSatellites;
+    Gnss.tow_ms = Data.TOW;
+    Gnss.lat_rad = Data.LLA(0,0);
+    Gnss.lon_rad = Data.LLA(1,0);
+    Gnss.hmsl_m = Data.LLA(2,0);
+    Gnss.vel_north_ms = Data.NEDVelocity_ms(0,0);
+    Gnss.vel_east_ms = Data.NEDVelocity_ms(1,0);
+    Gnss.vel_down_ms = Data.NEDVelocity_ms(2,0);
+    Gnss.horiz_acc_m = Data.Accuracy(0,0);
+    Gnss.vert_acc_m = Data.Accuracy(1,0);
+    Gnss.speed_acc_ms = Data.Accuracy(2,0);
+    Gnss.pdop = Data.pDOP;
+    struct gnss_time_data GnssTime = {FrameCounter_ & 0x07,0,Data.Year,Data.Month,Data.Day,Data.Hour,Data.Min,Data.Sec};
+    AddSensorMessage(Buffer,Slot,MSG_GNSS_DATA,&Gnss,false);
+    AddSensorMessage(Buffer,Slot,MSG_GNSS_TIME_DATA,&GnssTime,false);
+  }
+  for (size_t i=0; i < data_.Swift.size(); i++) {
+    SwiftSensor::Data &Data = data_.Swift[i];
+    AddPressureMessages(Buffer,Slot++,Data.Static.Pressure_Pa,Data.Static.Temperature_C,false,Data.Static.ReadStatus < 0);
+    AddPressureMessages(Buffer,Slot++,Data.Differential.Pressure_Pa,Data.Differential.Temperature_C,true,Data.Differential.ReadStatus < 0);
+  }
+  // AMS-5915 transducers are either differential or barometric, the configured type picks the message
+  for (size_t i=0; i < data_.Ams5915.size(); i++) {
+    Ams5915Sensor::Data &Data = data_.Ams5915[i];
+    bool Differential = (i < Ams5915Differential_.size()) ? Ams5915Differential_[i] : true;
+    AddPressureMessages(Buffer,Slot++,Data.Pressure_Pa,Data.Temperature_C,Differential,Data.ReadStatus < 0);
+  }
+  // lost frames are sent as the number lost since the last message, anything
+  // over what the message holds is carried to the next one
+  SbusLostFrames_.resize(data_.Sbus.size(),0);
+  for (size_t i=0; i < data_.Sbus.size(); i++) {
+    SbusSensor::Data &Data = data_.Sbus[i];
+    if (Data.LostFrames < SbusLostFrames_[i]) {
+      SbusLostFrames_[i] = Data.LostFrames;
+    }
+    uint64_t LostFrames = Data.LostFrames - SbusLostFrames_[i];
+    if (LostFrames > MSG_MAX_LOST_FRAMES) {
+      LostFrames = MSG_MAX_LOST_FRAMES;
+    }
+    struct inceptor_data Inceptor;
+    Inceptor.frame_counter = FrameCounter_ & 0x07;
+    Inceptor.time_offset_us = 0;
+    Inceptor.lost_frames = LostFrames;
+    Inceptor.failsafe_activated = Data.FailSafe;
+    memcpy(Inceptor.ch,Data.Channels,sizeof(Inceptor.ch));
+    if ((FrameCounter_ + Slot) % MessageDividers_[MSG_INCEPTOR_DATA] == 0) {
+      SbusLostFrames_[i] += LostFrames;
+    }
+    AddSensorMessage(Buffer,Slot++,MSG_INCEPTOR_DATA,&Inceptor,false);
+  }
+  for (size_t i=0; i < data_.Analog.size(); i++) {
+    struct analog_data Analog = {FrameCounter_ & 0x07,0,data_.Analog[i].Voltage_V,data_.Analog[i].CalibratedValue};
+    AddSensorMessage(Buffer,Slot++,MSG_ANALOG_DATA,&Analog,false);
+  }
+  FrameCounter_++;
+}
+
+/* sets the default message rates, slowly changing temperature and humidity are sent every 10th frame */
+void AircraftSensors::SetDefaultMessageDividers() {
+  MessageDividers_.assign(NUM_MSG_ID,1);
+  MessageDividers_[MSG_TEMPERATURE_DATA] = 10;
+  MessageDividers_[MSG_HUMIDITY_DATA] = 10;
+}
+
+/* appends a packed sensor message, the slot offsets the frame a decimated message is sent on */
+void AircraftSensors::AddSensorMessage(std::vector<uint8_t> *Buffer,uint8_t Slot,uint8_t Id,void *Payload,bool ReadFailed) {
+  if ((FrameCounter_ + Slot) % MessageDividers_[Id] != 0) {
+    return;
+  }
+  size_t BufferLocation = Buffer->size();
+  Buffer->resize(BufferLocation+2+msg_packed_size((MsgId_t)Id));
+  (*Buffer)[BufferLocation] = Slot;
+  (*Buffer)[BufferLocation+1] = ReadFailed ? (Id | 0x80) : Id;
+  msg_pack((MsgId_t)Id,Payload,Buffer->data()+BufferLocation+2);
+}
+
+/* appends the accel, gyro, mag, and temperature messages for an MPU-9250 */
+void AircraftSensors::AddImuMessages(std::vector<uint8_t> *Buffer,uint8_t Slot,const Eigen::Matrix<float,3,1> &Accel_mss,const Eigen::Matrix<float,3,1> &Gyro_rads,const Eigen::Matrix<float,3,1> &Mag_uT,float Temperature_C,bool ReadFailed) {
+  struct accel_data Accel = {FrameCounter_ & 0x07,0,Accel_mss(0,0),Accel_mss(1,0),Accel_mss(2,0)};
+  struct gyro_data Gyro = {FrameCounter_ & 0x07,0,Gyro_rads(0,0),Gyro_rads(1,0),Gyro_rads(2,0)};
+  struct mag_data Mag = {FrameCounter_ & 0x07,0,Mag_uT(0,0),Mag_uT(1,0),Mag_uT(2,0)};
+  struct temperature_data Temperature = {FrameCounter_ & 0x07,0,Temperature_C};
+  AddSensorMessage(Buffer,Slot,MSG_ACCEL_DATA,&Accel,ReadFailed);
+  AddSensorMessage(Buffer,Slot,MSG_GYRO_DATA,&Gyro,ReadFailed);
+  AddSensorMessage(Buffer,Slot,MSG_MAG_DATA,&Mag,ReadFailed);
+  AddSensorMessage(Buffer,Slot,MSG_TEMPERATURE_DATA,&Temperature,ReadFailed);
+}
+
+/* appends the pressure and temperature messages for a pressure transducer */
+void AircraftSensors::AddPressureMessages(std::vector<uint8_t> *Buffer,uint8_t Slot,float Pressure_Pa,float Temperature_C,bool Differential,bool ReadFailed) {
+  struct temperature_data Temperature = {FrameCounter_ & 0x07,0,Temperature_C};
+  if (Differential) {
+    struct diff_press_data Pressure = {FrameCounter_ & 0x07,0,Pressure_Pa};
+    AddSensorMessage(Buffer,Slot,MSG_DIFF_PRESS_DATA,&Pressure,ReadFailed);
+  } else {
+    struct static_press_data Pressure = {FrameCounter_ & 0x07,0,Pressure_Pa};
+    AddSensorMessage(Buffer,Slot,MSG_STATIC_PRESS_DATA,&Pressure,ReadFailed);
+  }
+  AddSensorMessage(Buffer,Slot,MSG_TEMPERATURE_DATA,&Temperature,ReadFailed);
+}
 
   /* free all sensor resources and reset sensor vectors and states */
   void AircraftSensors::End() {
@@ -1726,5 +1859,11 @@ void AircraftSensors::GetDataBuffer(std::vector<uint8_t> *Buffer) {
     AcquireRegulatedVoltageData_ = false;
     AcquirePwmVoltageData_ = false;
     AcquireSbusVoltageData_ = false;
+    // reset message rates and state
+    MessageDividers_.clear();
+    uBloxTow_.clear();
+    SbusLostFrames_.clear();
+    Ams5915Differential_.clear();
+    FrameCounter_ = 0;
     Serial.println("done!");
   }
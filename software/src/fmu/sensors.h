@@ -194,6 +194,7 @@ class Ams5915Sensor {
     void UpdateConfig(const char *JsonString,std::string RootPath,DefinitionTree *DefinitionTreePtr);
     void SetConfig(const Config &ConfigRef);
     void GetConfig(Config *ConfigPtr);
+    static bool IsDifferential(AMS5915::Transducer Transducer);
     void Begin();
     int GetData(Data *DataPtr);
     void End();
@@ -281,6 +282,7 @@ class SensorNodes {
   public:
     struct Config {
       uint8_t BfsAddr;
+      std::vector<bool> Ams5915Differential;                                        // whether each AMS5915 is differential
     };
     struct Data {
       std::vector<float> PwmVoltage_V;
@@ -357,6 +359,16 @@ class AircraftSensors {
     bool AcquirePwmVoltageData_ = false;
     bool AcquireSbusVoltageData_ = false;
     size_t SerializedDataMetadataSize = 10;
+    // sensor messages are sent every MessageDividers_[id] frames
+    std::vector<uint8_t> MessageDividers_;
+    uint32_t FrameCounter_ = 0;
+    std::vector<uint32_t> uBloxTow_;
+    std::vector<uint64_t> SbusLostFrames_;
+    std::vector<bool> Ams5915Differential_;
+    void SetDefaultMessageDividers();
+    void AddSensorMessage(std::vector<uint8_t> *Buffer,uint8_t Slot,uint8_t Id,void *Payload,bool ReadFailed);
+    void AddImuMessages(std::vector<uint8_t> *Buffer,uint8_t Slot,const Eigen::Matrix<float,3,1> &Accel_mss,const Eigen::Matrix<float,3,1> &Gyro_rads,const Eigen::Matrix<float,3,1> &Mag_uT,float Temperature_C,bool ReadFailed);
+    void AddPressureMessages(std::vector<uint8_t> *Buffer,uint8_t Slot,float Pressure_Pa,float Temperature_C,bool Differential,bool ReadFailed);
 };
 
 #endif
@@ -60,32 +60,34 @@ bool Node::ReadSensorData() {
   std::vector<uint8_t> Payload;
   std::vector<uint8_t> Buffer;
   Message message;
+  const uint8_t *RxPayload;
+  size_t RxPayloadSize;
   size_t dataSize = 0;
   BuildMessage(SensorMetaData,Payload,&Buffer);
   bus_->beginTransmission(addr_);
   bus_->write(Buffer.data(),Buffer.size());
   bus_->endTransmission(I2C_NOSTOP,I2cHeaderTimeout_us);
-  bus_->requestFrom(addr_,MetaDataLength_+headerLength_+checksumLength_,I2C_STOP,I2cHeaderTimeout_us);
-  if (ReceiveMessage(&message,&Payload)) {
+  bus_->requestFrom(addr_,BfFrame::Size(MetaDataLength_),I2C_STOP,I2cHeaderTimeout_us);
+  if (ReceiveMessage(&message,&RxPayload,&RxPayloadSize)) {
     if (message == SensorMetaData) {
       size_t PayloadLocation = 0;
       // meta data
       uint8_t AcquireInternalData,NumberMpu9250Sensor,NumberBme280Sensor,NumberuBloxSensor,NumberSwiftSensor,NumberAms5915Sensor,NumberSbusSensor,NumberAnalogSensor;
-      memcpy(&AcquireInternalData,Payload.data()+PayloadLocation,sizeof(AcquireInternalData));
+      memcpy(&AcquireInternalData,RxPayload+PayloadLocation,sizeof(AcquireInternalData));
       PayloadLocation += sizeof(AcquireInternalData);
-      memcpy(&NumberMpu9250Sensor,Payload.data()+PayloadLocation,sizeof(NumberMpu9250Sensor));
+      memcpy(&NumberMpu9250Sensor,RxPayload+PayloadLocation,sizeof(NumberMpu9250Sensor));
       PayloadLocation += sizeof(NumberMpu9250Sensor);
-      memcpy(&NumberBme280Sensor,Payload.data()+PayloadLocation,sizeof(NumberBme280Sensor));
+      memcpy(&NumberBme280Sensor,RxPayload+PayloadLocation,sizeof(NumberBme280Sensor));
       PayloadLocation += sizeof(NumberBme280Sensor);
-      memcpy(&NumberuBloxSensor,Payload.data()+PayloadLocation,sizeof(NumberuBloxSensor));
+      memcpy(&NumberuBloxSensor,RxPayload+PayloadLocation,sizeof(NumberuBloxSensor));
       PayloadLocation += sizeof(NumberuBloxSensor);
-      memcpy(&NumberSwiftSensor,Payload.data()+PayloadLocation,sizeof(NumberSwiftSensor));
+      memcpy(&NumberSwiftSensor,RxPayload+PayloadLocation,sizeof(NumberSwiftSensor));
       PayloadLocation += sizeof(NumberSwiftSensor);
-      memcpy(&NumberAms5915Sensor,Payload.data()+PayloadLocation,sizeof(NumberAms5915Sensor));
+      memcpy(&NumberAms5915Sensor,RxPayload+PayloadLocation,sizeof(NumberAms5915Sensor));
       PayloadLocation += sizeof(NumberAms5915Sensor);
-      memcpy(&NumberSbusSensor,Payload.data()+PayloadLocation,sizeof(NumberSbusSensor));
+      memcpy(&NumberSbusSensor,RxPayload+PayloadLocation,sizeof(NumberSbusSensor));
       PayloadLocation += sizeof(NumberSbusSensor);
-      memcpy(&NumberAnalogSensor,Payload.data()+PayloadLocation,sizeof(NumberAnalogSensor));
+      memcpy(&NumberAnalogSensor,RxPayload+PayloadLocation,sizeof(NumberAnalogSensor));
       PayloadLocation += sizeof(NumberAnalogSensor);
       // resize data buffers
       if (AcquireInternalData & 0x20) {
@@ -121,30 +123,30 @@ bool Node::ReadSensorData() {
   bus_->beginTransmission(addr_);
   bus_->write(Buffer.data(),Buffer.size());
   bus_->endTransmission(I2C_NOSTOP,I2cHeaderTimeout_us);
-  bus_->requestFrom(addr_,dataSize+headerLength_+checksumLength_,I2C_STOP,I2cDataTimeout_us);
-  if (ReceiveMessage(&message,&Payload)) {
+  bus_->requestFrom(addr_,BfFrame::Size(dataSize),I2C_STOP,I2cDataTimeout_us);
+  if (ReceiveMessage(&message,&RxPayload,&RxPayloadSize)) {
     if (message == SensorData) {
       size_t PayloadLocation = 0;
       // sensor data
-      memcpy(SensorData_.PwmVoltage_V.data(),Payload.data()+PayloadLocation,SensorData_.PwmVoltage_V.size()*sizeof(SensorData_.PwmVoltage_V[0]));
+      memcpy(SensorData_.PwmVoltage_V.data(),RxPayload+PayloadLocation,SensorData_.PwmVoltage_V.size()*sizeof(SensorData_.PwmVoltage_V[0]));
       PayloadLocation += SensorData_.PwmVoltage_V.size()*sizeof(SensorData_.PwmVoltage_V[0]);
-      memcpy(SensorData_.SbusVoltage_V.data(),Payload.data()+PayloadLocation,SensorData_.SbusVoltage_V.size()*sizeof(SensorData_.SbusVoltage_V[0]));
+      memcpy(SensorData_.SbusVoltage_V.data(),RxPayload+PayloadLocation,SensorData_.SbusVoltage_V.size()*sizeof(SensorData_.SbusVoltage_V[0]));
       PayloadLocation += SensorData_.SbusVoltage_V.size()*sizeof(SensorData_.SbusVoltage_V[0]);
-      memcpy(SensorData_.Mpu9250.data(),Payload.data()+PayloadLocation,SensorData_.Mpu9250.size()*sizeof(Mpu9250SensorData));
+      memcpy(SensorData_.Mpu9250.data(),RxPayload+PayloadLocation,SensorData_.Mpu9250.size()*sizeof(Mpu9250SensorData));
       PayloadLocation += SensorData_.Mpu9250.size()*sizeof(Mpu9250SensorData);
-      memcpy(SensorData_.Bme280.data(),Payload.data()+PayloadLocation,SensorData_.Bme280.size()*sizeof(Bme280SensorData));
+      memcpy(SensorData_.Bme280.data(),RxPayload+PayloadLocation,SensorData_.Bme280.size()*sizeof(Bme280SensorData));
       PayloadLocation += SensorData_.Bme280.size()*sizeof(Bme280SensorData);
-      memcpy(SensorData_.uBlox.data(),Payload.data()+PayloadLocation,SensorData_.uBlox.size()*sizeof(uBloxSensorData));
+      memcpy(SensorData_.uBlox.data(),RxPayload+PayloadLocation,SensorData_.uBlox.size()*sizeof(uBloxSensorData));
       PayloadLocation += SensorData_.uBlox.size()*sizeof(uBloxSensorData);
-      memcpy(SensorData_.Swift.data(),Payload.data()+PayloadLocation,SensorData_.Swift.size()*sizeof(SwiftSensorData));
+      memcpy(SensorData_.Swift.data(),RxPayload+PayloadLocation,SensorData_.Swift.size()*sizeof(SwiftSensorData));
       PayloadLocation += SensorData_.Swift.size()*sizeof(SwiftSensorData);
-      memcpy(SensorData_.Ams5915.data(),Payload.data()+PayloadLocation,SensorData_.Ams5915.size()*sizeof(Ams5915SensorData));
+      memcpy(SensorData_.Ams5915.data(),RxPayload+PayloadLocation,SensorData_.Ams5915.size()*sizeof(Ams5915SensorData));
       PayloadLocation += SensorData_.Ams5915.size()*sizeof(Ams5915SensorData);
-      memcpy(SensorData_.Sbus.data(),Payload.data()+PayloadLocation,SensorData_.Sbus.size()*sizeof(SbusSensorData));
+      memcpy(SensorData_.Sbus.data(),RxPayload+PayloadLocation,SensorData_.Sbus.size()*sizeof(SbusSensorData));
       PayloadLocation += SensorData_.Sbus.size()*sizeof(SbusSensorData);
-      memcpy(SensorData_.Analog.data(),Payload.data()+PayloadLocation,SensorData_.Analog.size()*sizeof(AnalogSensorData));
+      memcpy(SensorData_.Analog.data(),RxPayload+PayloadLocation,SensorData_.Analog.size()*sizeof(AnalogSensorData));
       PayloadLocation += SensorData_.Analog.size()*sizeof(AnalogSensorData);
-      DataBuffer_ = Payload;
+      DataBuffer_.assign(RxPayload,RxPayload+RxPayloadSize);
       return true;
     } else {
       return false;
@@ -224,106 +226,22 @@ void Node::SendMessage(Message message,std::vector<uint8_t> &Payload) {
 
 /* builds a BFS message given a message ID and payload */
 void Node::BuildMessage(Message message,std::vector<uint8_t> &Payload,std::vector<uint8_t> *TxBuffer) {
-  if (Payload.size() < (kBufferMaxSize-headerLength_-checksumLength_)) {
-    TxBuffer->resize(Payload.size()+headerLength_+checksumLength_);
-    // header
-    Buffer_[0] = header_[0];
-    Buffer_[1] = header_[1];
-    // message ID
-    Buffer_[2] = (uint8_t)message;
-    // payload length
-    Buffer_[3] = Payload.size() & 0xff;
-    Buffer_[4] = Payload.size() >> 8;
-    // payload
-    memcpy(Buffer_+headerLength_,Payload.data(),Payload.size());
-    // checksum
-    CalcChecksum((size_t)(Payload.size()+headerLength_),Buffer_,Checksum_);
-    Buffer_[Payload.size()+headerLength_] = Checksum_[0];
-    Buffer_[Payload.size()+headerLength_+1] = Checksum_[1];
-    memcpy(TxBuffer->data(),Buffer_,TxBuffer->size());
+  if (Payload.size() < (kBufferMaxSize-BfFrame::kOverhead)) {
+    TxBuffer->resize(BfFrame::Size(Payload.size()));
+    BfFrame::Encode((uint8_t)message,Payload.data(),Payload.size(),TxBuffer->data(),TxBuffer->size());
   }
 }
 
-/* parses BFS messages returning message ID and payload on success */
-bool Node::ReceiveMessage(Message *message,std::vector<uint8_t> *Payload) {
+/* parses BFS messages returning message ID and payload on success, the payload
+points into the parser and is valid until the next message is received */
+bool Node::ReceiveMessage(Message *message,const uint8_t **Payload,size_t *PayloadSize) {
   while(bus_->available()) {
-    RxByte_ = bus_->read();
-    // header
-    if (ParserState_ < 2) {
-      if (RxByte_ == header_[ParserState_]) {
-        Buffer_[ParserState_] = RxByte_;
-        ParserState_++;
-      }
-    } else if (ParserState_ == 3) {
-      LengthBuffer_[0] = RxByte_;
-      Buffer_[ParserState_] = RxByte_;
-      ParserState_++;
-    } else if (ParserState_ == 4) {
-      LengthBuffer_[1] = RxByte_;
-      Length_ = ((uint16_t)LengthBuffer_[1] << 8) | LengthBuffer_[0];
-      if (Length_ > (kBufferMaxSize-headerLength_-checksumLength_)) {
-        ParserState_ = 0;
-        LengthBuffer_[0] = 0;
-        LengthBuffer_[1] = 0;
-        Length_ = 0;
-        Checksum_[0] = 0;
-        Checksum_[1] = 0;
-        return false;
-      }
-      Buffer_[ParserState_] = RxByte_;
-      ParserState_++;
-    } else if (ParserState_ < (Length_ + headerLength_)) {
-      Buffer_[ParserState_] = RxByte_;
-      ParserState_++;
-    } else if (ParserState_ == (Length_ + headerLength_)) {
-      CalcChecksum(Length_ + headerLength_,Buffer_,Checksum_);
-      if (RxByte_ == Checksum_[0]) {
-        ParserState_++;
-      } else {
-        ParserState_ = 0;
-        LengthBuffer_[0] = 0;
-        LengthBuffer_[1] = 0;
-        Length_ = 0;
-        Checksum_[0] = 0;
-        Checksum_[1] = 0;
-        return false;
-      }
-    // checksum 1
-    } else if (ParserState_ == (Length_ + headerLength_ + 1)) {
-      if (RxByte_ == Checksum_[1]) {
-        // message ID
-        *message = (Message) Buffer_[2];
-        // payload size
-        Payload->resize(Length_);
-        // payload
-        memcpy(Payload->data(),Buffer_+headerLength_,Length_);
-        ParserState_ = 0;
-        LengthBuffer_[0] = 0;
-        LengthBuffer_[1] = 0;
-        Length_ = 0;
-        Checksum_[0] = 0;
-        Checksum_[1] = 0;
-        return true;
-      } else {
-        ParserState_ = 0;
-        LengthBuffer_[0] = 0;
-        LengthBuffer_[1] = 0;
-        Length_ = 0;
-        Checksum_[0] = 0;
-        Checksum_[1] = 0;
-        return false;
-      }
+    if (Parser_.Parse(bus_->read())) {
+      *message = (Message) Parser_.Type();
+      *Payload = Parser_.Payload();
+      *PayloadSize = Parser_.PayloadSize();
+      return true;
     }
   }
   return false;
 }
-
-/* computes a two byte checksum */
-void Node::CalcChecksum(size_t ArraySize, uint8_t *ByteArray, uint8_t *Checksum) {
-  Checksum[0] = 0;
-  Checksum[1] = 0;
-  for (size_t i = 0; i < ArraySize; i++) {
-    Checksum[0] += ByteArray[i];
-    Checksum[1] += Checksum[0];
-  }
-}
@@ -26,6 +26,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include "Eigen.h"
 #include "i2c_t3.h"
 #include "Arduino.h"
+#include "bf_frame.h"
 
 class Node {
   public:
@@ -121,22 +122,13 @@ class Node {
     i2c_t3 *bus_;
     uint8_t addr_;
     uint32_t rate_;
-    uint8_t Buffer_[kBufferMaxSize];
-    const uint8_t header_[2] = {0x42,0x46};
-    const size_t headerLength_ = 5;
-    const size_t checksumLength_ = 2;
-    uint8_t RxByte_;
-    uint16_t ParserState_ = 0;
-    uint8_t LengthBuffer_[2];
-    uint16_t Length_ = 0;
-    uint8_t Checksum_[2];
+    BfFrameParser<kBufferMaxSize> Parser_;
     const size_t MetaDataLength_ = 8;
     struct SensorData SensorData_;
     std::vector<uint8_t> DataBuffer_;
     void SendMessage(Message message,std::vector<uint8_t> &Payload);
     void BuildMessage(Message message,std::vector<uint8_t> &Payload,std::vector<uint8_t> *TxBuffer);
-    bool ReceiveMessage(Message *message,std::vector<uint8_t> *Payload);
-    void CalcChecksum(size_t ArraySize, uint8_t *ByteArray, uint8_t *Checksum);
+    bool ReceiveMessage(Message *message,const uint8_t **Payload,size_t *PayloadSize);
 };
 
 #endif
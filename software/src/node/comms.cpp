@@ -49,7 +49,7 @@ void AircraftBfsComms::SendSensorMetaData(std::vector<uint8_t> &DataBuffer) {
 bool AircraftBfsComms::ReceiveModeCommand(AircraftMission::Mode *mode) {
   if (MessageReceived_) {
     if (ReceivedMessage_ == ModeCommand) {
-      if (ReceivedPayload_.size() == 1) {
+      if (ReceivedPayloadSize_ == 1) {
         MessageReceived_ = false;
         *mode = (AircraftMission::Mode)ReceivedPayload_[0];
         return true;
@@ -69,8 +69,8 @@ bool AircraftBfsComms::ReceiveConfigMessage(std::vector<char> *ConfigString) {
   if (MessageReceived_) {
     if (ReceivedMessage_ == Configuration) {
       MessageReceived_ = false;
-      ConfigString->resize(ReceivedPayload_.size());
-      memcpy(ConfigString->data(),ReceivedPayload_.data(),ReceivedPayload_.size());
+      ConfigString->resize(ReceivedPayloadSize_);
+      memcpy(ConfigString->data(),ReceivedPayload_,ReceivedPayloadSize_);
       return true;
     } else {
       return false;
@@ -85,8 +85,8 @@ bool AircraftBfsComms::ReceiveEffectorCommand(std::vector<float> *EffectorComman
   if (MessageReceived_) {
     if (ReceivedMessage_ == EffectorCommand) {
       MessageReceived_ = false;
-      EffectorCommands->resize(ReceivedPayload_.size()/sizeof(float));
-      memcpy(EffectorCommands->data(),ReceivedPayload_.data(),ReceivedPayload_.size());
+      EffectorCommands->resize(ReceivedPayloadSize_/sizeof(float));
+      memcpy(EffectorCommands->data(),ReceivedPayload_,EffectorCommands->size()*sizeof(float));
       return true;
     } else {
       return false;
@@ -98,115 +98,32 @@ bool AircraftBfsComms::ReceiveEffectorCommand(std::vector<float> *EffectorComman
 
 /* checks for valid BFS messages received */
 void AircraftBfsComms::CheckMessages() {
-  MessageReceived_ = ReceiveMessage(&ReceivedMessage_,&ReceivedPayload_);
+  MessageReceived_ = ReceiveMessage(&ReceivedMessage_,&ReceivedPayload_,&ReceivedPayloadSize_);
 }
 
 /* builds and sends a BFS message given a message ID and payload */
 void AircraftBfsComms::SendMessage(Message message,std::vector<uint8_t> &Payload) {
-  if (Payload.size() < (kUartBufferMaxSize-headerLength_-checksumLength_)) {
-    // header
-    Buffer_[0] = header_[0];
-    Buffer_[1] = header_[1];
-    // message ID
-    Buffer_[2] = (uint8_t)message;
-    // payload length
-    Buffer_[3] = Payload.size() & 0xff;
-    Buffer_[4] = Payload.size() >> 8;
-    // payload
-    memcpy(Buffer_+headerLength_,Payload.data(),Payload.size());
-    // checksum
-    CalcChecksum((size_t)(Payload.size()+headerLength_),Buffer_,Checksum_);
-    Buffer_[Payload.size()+headerLength_] = Checksum_[0];
-    Buffer_[Payload.size()+headerLength_+1] = Checksum_[1];
+  size_t FrameSize = BfFrame::Encode((uint8_t)message,Payload.data(),Payload.size(),TxBuffer_,sizeof(TxBuffer_));
+  if (FrameSize > 0) {
     // transmit
-    bus_->write(Buffer_,Payload.size()+headerLength_+checksumLength_);
+    bus_->write(TxBuffer_,FrameSize);
   }
 }
 
-/* parses BFS messages returning message ID and payload on success */
-bool AircraftBfsComms::ReceiveMessage(Message *message,std::vector<uint8_t> *Payload) {
+/* parses BFS messages returning message ID and payload on success, the payload
+points into the parser and is valid until the next message is received */
+bool AircraftBfsComms::ReceiveMessage(Message *message,const uint8_t **Payload,size_t *PayloadSize) {
   while(bus_->available()) {
-    RxByte_ = bus_->read();
-    // header
-    if (ParserState_ < 2) {
-      if (RxByte_ == header_[ParserState_]) {
-        Buffer_[ParserState_] = RxByte_;
-        ParserState_++;
-      }
-    } else if (ParserState_ == 3) {
-      LengthBuffer_[0] = RxByte_;
-      Buffer_[ParserState_] = RxByte_;
-      ParserState_++;
-    } else if (ParserState_ == 4) {
-      LengthBuffer_[1] = RxByte_;
-      Length_ = ((uint16_t)LengthBuffer_[1] << 8) | LengthBuffer_[0];
-      if (Length_ > (kUartBufferMaxSize-headerLength_-checksumLength_)) {
-        ParserState_ = 0;
-        LengthBuffer_[0] = 0;
-        LengthBuffer_[1] = 0;
-        Length_ = 0;
-        Checksum_[0] = 0;
-        Checksum_[1] = 0;
-        return false;
-      }
-      Buffer_[ParserState_] = RxByte_;
-      ParserState_++;
-    } else if (ParserState_ < (Length_ + headerLength_)) {
-      Buffer_[ParserState_] = RxByte_;
-      ParserState_++;
-    } else if (ParserState_ == (Length_ + headerLength_)) {
-      CalcChecksum(Length_ + headerLength_,Buffer_,Checksum_);
-      if (RxByte_ == Checksum_[0]) {
-        ParserState_++;
-      } else {
-        ParserState_ = 0;
-        LengthBuffer_[0] = 0;
-        LengthBuffer_[1] = 0;
-        Length_ = 0;
-        Checksum_[0] = 0;
-        Checksum_[1] = 0;
-        return false;
-      }
-    // checksum 1
-    } else if (ParserState_ == (Length_ + headerLength_ + 1)) {
-      if (RxByte_ == Checksum_[1]) {
-        // message ID
-        *message = (Message) Buffer_[2];
-        // payload size
-        Payload->resize(Length_);
-        // payload
-        memcpy(Payload->data(),Buffer_+headerLength_,Length_);
-        ParserState_ = 0;
-        LengthBuffer_[0] = 0;
-        LengthBuffer_[1] = 0;
-        Length_ = 0;
-        Checksum_[0] = 0;
-        Checksum_[1] = 0;
-        return true;
-      } else {
-        ParserState_ = 0;
-        LengthBuffer_[0] = 0;
-        LengthBuffer_[1] = 0;
-        Length_ = 0;
-        Checksum_[0] = 0;
-        Checksum_[1] = 0;
-        return false;
-      }
+    if (Parser_.Parse(bus_->read())) {
+      *message = (Message) Parser_.Type();
+      *Payload = Parser_.Payload();
+      *PayloadSize = Parser_.PayloadSize();
+      return true;
     }
   }
   return false;
 }
 
-/* computes a two byte checksum */
-void AircraftBfsComms::CalcChecksum(size_t ArraySize, uint8_t *ByteArray, uint8_t *Checksum) {
-  Checksum[0] = 0;
-  Checksum[1] = 0;
-  for (size_t i = 0; i < ArraySize; i++) {
-    Checksum[0] += ByteArray[i];
-    Checksum[1] += Checksum[0];
-  }
-}
-
 /* returns the last received message */
 void AircraftBfsComms::GetMessage(Message *message) {
   *message = ReceivedMessage_;
@@ -26,6 +26,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include "Vector.h"
 #include "i2c_t3.h"
 #include "Arduino.h"
+#include "bf_frame.h"
 
 class AircraftBfsComms {
   public:
@@ -45,7 +46,7 @@ class AircraftBfsComms {
     bool ReceiveEffectorCommand(std::vector<float> *EffectorCommands);
     void CheckMessages();
     void SendMessage(Message message,std::vector<uint8_t> &Payload);
-    bool ReceiveMessage(Message *message,std::vector<uint8_t> *Payload);
+    bool ReceiveMessage(Message *message,const uint8_t **Payload,size_t *PayloadSize);
     void GetMessage(Message *message);
     void OnReceive(void (*function)(size_t len));
     void OnRequest(void (*function)(void));
@@ -54,19 +55,12 @@ class AircraftBfsComms {
     uint8_t addr_;
     i2c_pins pins_;
     uint32_t rate_;
-    uint8_t Buffer_[kUartBufferMaxSize];
-    const uint8_t header_[2] = {0x42,0x46};
-    const uint8_t headerLength_ = 5;
-    const uint8_t checksumLength_ = 2;
-    uint8_t RxByte_;
-    uint16_t ParserState_ = 0;
-    uint8_t LengthBuffer_[2];
-    uint16_t Length_;
-    uint8_t Checksum_[2];
+    uint8_t TxBuffer_[kUartBufferMaxSize];
+    BfFrameParser<kUartBufferMaxSize> Parser_;
     bool MessageReceived_ = false;
     Message ReceivedMessage_;
-    std::vector<uint8_t> ReceivedPayload_;
-    void CalcChecksum(size_t ArraySize, uint8_t *ByteArray, uint8_t *Checksum);
+    const uint8_t *ReceivedPayload_ = nullptr;
+    size_t ReceivedPayloadSize_ = 0;
 };
 
 #endif
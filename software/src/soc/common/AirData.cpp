@@ -21,7 +21,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 
 /* computes indicated airspeed given differential pressure */
 float AirData::getIAS(float qc) {
-  float temp = 5.0f*(powf((qc/P0 + 1.0f),(2.0f/7.0f)) - 1.0f);
+  float temp = 5.0f*(powf((qc*(1.0f/P0) + 1.0f),(2.0f/7.0f)) - 1.0f);
   if (temp > 0) {
     return A0 * sqrtf(temp);
   } else {
@@ -50,7 +50,7 @@ float AirData::getTAS(float AS, float T) {
 
 /* computes pressure altitude given static pressure */
 float AirData::getPressureAltitude(float p) {
-  return (T0/L)*(1.0f - powf((p/P0),((L*R)/(M*g))));
+  return (T0/L)*(1.0f - powf((p*(1.0f/P0)),((L*R)/(M*g))));
 }
 
 /* computes altitude Above Ground Level (AGL) given static pressure and a bias */
@@ -83,7 +83,7 @@ float AirData::getDensity(float p, float T) {
 // For beta: Angle ports are beta, Side ports are alpha
 float AirData::getAngle(float pTip, float pAngle1, float pAngle2, float pSide1, float pSide2, float kCal) {
 
-  float qcn = pTip - 0.5 * (pSide1 + pSide2);
+  float qcn = pTip - 0.5f * (pSide1 + pSide2);
   float angle;
 
   if (qcn != 0) { // Dived by zero protection
@@ -43,13 +43,14 @@ class AirData{
 		float getAngleMeth2(float pTip, float pAngle, float kCal);
 
   private:
-    const float A0 = 340.29f;   // standard sea level speed of sound, m/s
-    const float P0 = 101325.0f; // standard sea level pressure, Pa
-    const float T0 = 288.15f;   // standard sea level temperature, K
-    const float L = 0.0065f;    // standard lapse rate, K/m
-    const float R = 8.314f;     // gas constant, J/kg-mol
-    const float M = 0.02895f;   // molecular mass dry air, kg/mol
-    const float g = 9.807f;     // acceleration due to gravity, m/s/s
+    // compile time constants, so the exponents and ratios below fold
+    static constexpr float A0 = 340.29f;   // standard sea level speed of sound, m/s
+    static constexpr float P0 = 101325.0f; // standard sea level pressure, Pa
+    static constexpr float T0 = 288.15f;   // standard sea level temperature, K
+    static constexpr float L = 0.0065f;    // standard lapse rate, K/m
+    static constexpr float R = 8.314f;     // gas constant, J/kg-mol
+    static constexpr float M = 0.02895f;   // molecular mass dry air, kg/mol
+    static constexpr float g = 9.807f;     // acceleration due to gravity, m/s/s
 };
 
 #endif
@@ -92,6 +92,11 @@ void HardwareSerial::end()
   close(_fd);
 }
 
+int HardwareSerial::fd()
+{
+  return _fd;
+}
+
 speed_t HardwareSerial::get_baud(unsigned int baud)
 {
   switch (baud) {
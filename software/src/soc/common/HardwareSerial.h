@@ -39,6 +39,7 @@ class HardwareSerial {
     unsigned char read();
     int read(unsigned char *data, unsigned int len);
     void end();
+    int fd();
   private:
     std::string _port;
     int _fd;
@@ -306,3 +306,10 @@ bool SerialLink::getTransmissionStatus()
 {
   return (_status == ACK) ? true : false;
 }
+/*
+* Returns the file descriptor of the serial port, for waiting on received data.
+*/
+int SerialLink::fd()
+{
+  return _bus->fd();
+}
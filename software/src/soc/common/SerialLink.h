@@ -49,6 +49,7 @@ class SerialLink {
 		unsigned int read(unsigned char *data, unsigned int len);
 		bool getTransmissionStatus();
 		void sendStatus(bool ack);
+		int fd();
 	private:
 		HardwareSerial* _bus;
 		CRC16 _send_crc_16, _recv_crc_16;
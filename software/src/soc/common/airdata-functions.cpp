@@ -45,6 +45,7 @@ void IndicatedAirspeed::Configure(const rapidjson::Value& Config,std::string Roo
   }
   // resize bias vector
   data_.DifferentialPressureBias.resize(config_.DifferentialPressure.size());
+  data_.InvNumSources = 1.0f/(float)config_.DifferentialPressure.size();
   // get initialization time
   if (Config.HasMember("Initialization-Time")) {
     config_.InitTime = Config["Initialization-Time"].GetFloat();
@@ -87,11 +88,12 @@ bool IndicatedAirspeed::Initialized() {
 void IndicatedAirspeed::Run(Mode mode) {
   data_.mode_node->setInt(mode);
   if (mode!=kStandby) {
-    // compute average differential pressure
-    data_.AvgDifferentialPressure = 0.0f;
+    // compute average differential pressure, scaling the sum once
+    float Sum = 0.0f;
     for (size_t i=0; i < config_.DifferentialPressure.size(); i++) {
-      data_.AvgDifferentialPressure += (config_.DifferentialPressure[i]->getFloat()-data_.DifferentialPressureBias[i])/config_.DifferentialPressure.size();
+      Sum += config_.DifferentialPressure[i]->getFloat() - data_.DifferentialPressureBias[i];
     }
+    data_.AvgDifferentialPressure = Sum*data_.InvNumSources;
     // compute indicated airspeed
     data_.ias_ms_node->setFloat( AirData_.getIAS(data_.AvgDifferentialPressure) );
   }
@@ -101,6 +103,7 @@ void IndicatedAirspeed::Clear() {
   config_.DifferentialPressure.clear();
   config_.InitTime = 0.0f;
   data_.DifferentialPressureBias.clear();
+  data_.InvNumSources = 0.0f;
   data_.mode_node->setFloat(kStandby);
   data_.ias_ms_node->setFloat(0.0f);
   data_.AvgDifferentialPressure = 0.0f;
@@ -144,6 +147,7 @@ void AglAltitude::Configure(const rapidjson::Value& Config,std::string RootPath)
   } else {
     throw std::runtime_error(std::string("ERROR")+OutputName+std::string(": Static pressure sources not specified in configuration."));
   }
+  data_.InvNumSources = 1.0f/(float)config_.StaticPressure.size();
   // get initialization time
   if (Config.HasMember("Initialization-Time")) {
     config_.InitTime = Config["Initialization-Time"].GetFloat();
@@ -171,10 +175,7 @@ void AglAltitude::Initialize() {
   // if less than init time, compute initial pressure altitude
   if (ElapsedTime < config_.InitTime) {
     // average static pressure sources
-    data_.AvgStaticPressure = 0.0f;
-    for (size_t i=0; i < config_.StaticPressure.size(); i++) {
-      data_.AvgStaticPressure += (config_.StaticPressure[i]->getFloat())/config_.StaticPressure.size();
-    }
+    data_.AvgStaticPressure = AverageStaticPressure();
     // compute pressure altitude
     data_.PressAlt0 = data_.PressAlt0 + (AirData_.getPressureAltitude(data_.AvgStaticPressure)-data_.PressAlt0)/((float)NumberSamples_);
     NumberSamples_++;
@@ -191,10 +192,7 @@ void AglAltitude::Run(Mode mode) {
   data_.mode_node->setInt(mode);
   if (mode!=kStandby) {
     // compute average static pressure
-    data_.AvgStaticPressure = 0.0f;
-    for (size_t i=0; i < config_.StaticPressure.size(); i++) {
-      data_.AvgStaticPressure += (config_.StaticPressure[i]->getFloat())/config_.StaticPressure.size();
-    }
+    data_.AvgStaticPressure = AverageStaticPressure();
     // compute altitude above ground level
     data_.agl_m_node->setFloat( AirData_.getAGL(data_.AvgStaticPressure,data_.PressAlt0) );
   }
@@ -203,6 +201,7 @@ void AglAltitude::Run(Mode mode) {
 void AglAltitude::Clear() {
   config_.StaticPressure.clear();
   config_.InitTime = 0.0f;
+  data_.InvNumSources = 0.0f;
   data_.mode_node->setInt( kStandby );
   data_.agl_m_node->setFloat( 0.0f );
   data_.PressAlt0 = 0.0f;
@@ -218,6 +217,15 @@ void AglAltitude::Clear() {
   OutputKey_.clear();
 }
 
+float AglAltitude::AverageStaticPressure() {
+  // scaling the sum once rather than each source
+  float Sum = 0.0f;
+  for (size_t i=0; i < config_.StaticPressure.size(); i++) {
+    Sum += config_.StaticPressure[i]->getFloat();
+  }
+  return Sum*data_.InvNumSources;
+}
+
 uint64_t AglAltitude::micros() {
   struct timeval tv;
   gettimeofday(&tv,NULL);
@@ -495,6 +503,13 @@ void FiveHole::Configure(const rapidjson::Value& Config,std::string RootPath) {
     throw std::runtime_error(std::string("ERROR")+SysName+std::string(": Initialization time not specified in configuration."));
   }
 
+  // ports in the order they are gathered each frame
+  config_.Port[kTip] = config_.TipPressure_node;
+  config_.Port[kAlpha1] = config_.Alpha1Pressure_node;
+  config_.Port[kAlpha2] = config_.Alpha2Pressure_node;
+  config_.Port[kBeta1] = config_.Beta1Pressure_node;
+  config_.Port[kBeta2] = config_.Beta2Pressure_node;
+
   // pointer to log run mode data
   ModeKey_ = SysName+"/Mode";
   data_.mode_node = deftree.initElement(ModeKey_, "Run mode", LOG_UINT8, LOG_NONE);
@@ -525,11 +540,9 @@ void FiveHole::Initialize() {
   if (ElapsedTime < config_.InitTime) {
     // compute pressure biases, using Welford's algorithm
     data_.PressAlt0 += (AirData_.getPressureAltitude(config_.StaticPressure_node->getFloat()) - data_.PressAlt0) / (float)NumberSamples_;
-    data_.TipPressureBias += (config_.TipPressure_node->getFloat() - data_.TipPressureBias) / (float)NumberSamples_;
-    data_.Alpha1PressureBias += (config_.Alpha1Pressure_node->getFloat() - data_.Alpha1PressureBias) / (float)NumberSamples_;
-    data_.Alpha2PressureBias += (config_.Alpha2Pressure_node->getFloat() - data_.Alpha2PressureBias) / (float)NumberSamples_;
-    data_.Beta1PressureBias += (config_.Beta1Pressure_node->getFloat() - data_.Beta1PressureBias) / (float)NumberSamples_;
-    data_.Beta2PressureBias += (config_.Beta2Pressure_node->getFloat() - data_.Beta2PressureBias) / (float)NumberSamples_;
+    for (size_t i=0; i < kNumPorts; i++) {
+      data_.PressureBias[i] += (config_.Port[i]->getFloat() - data_.PressureBias[i]) / (float)NumberSamples_;
+    }
 
     NumberSamples_++;
   } else {
@@ -544,34 +557,39 @@ bool FiveHole::Initialized() {
 void FiveHole::Run(Mode mode) {
   data_.mode_node->setInt(mode);
   if (mode!=kStandby) {
+    // read each port once, removing its bias
+    float Pressure[kNumPorts];
+    for (size_t i=0; i < kNumPorts; i++) {
+      Pressure[i] = config_.Port[i]->getFloat() - data_.PressureBias[i];
+    }
+
     // compute indicated airspeed
-    data_.ias_ms_node->setFloat( AirData_.getIAS(config_.TipPressure_node->getFloat() - data_.TipPressureBias) );
+    float Ias_ms = AirData_.getIAS(Pressure[kTip]);
+    data_.ias_ms_node->setFloat( Ias_ms );
 
     // compute altitude above ground level
     data_.agl_m_node->setFloat( AirData_.getAGL(config_.StaticPressure_node->getFloat(), data_.PressAlt0) );
 
     // compute Alpha and Beta
     // if the airspeed is low, the non-dimensionalizing pressures on the side port will be very small and result in huge angles
-    if (data_.ias_ms_node->getFloat() > 2.0f) {
-      // compute alpha
-      data_.Alpha_rad_node->setFloat( AirData_.getAngle(config_.TipPressure_node->getFloat() - data_.TipPressureBias, config_.Alpha1Pressure_node->getFloat() - data_.Alpha1PressureBias, config_.Alpha2Pressure_node->getFloat() - data_.Alpha2PressureBias, config_.Beta1Pressure_node->getFloat() - data_.Beta1PressureBias, config_.Beta2Pressure_node->getFloat() - data_.Beta2PressureBias, config_.kAlpha) );
-
-      // limit alpha to +/-45 deg
-      if (data_.Alpha_rad_node->getFloat() > 0.7854f) {
-        data_.Alpha_rad_node->setFloat( 0.7854f );
-      } else if (data_.Alpha_rad_node->getFloat() < -0.7854f) {
-        data_.Alpha_rad_node->setFloat( -0.7854f );
+    if (Ias_ms > 2.0f) {
+      // compute alpha, limited to +/-45 deg
+      float Alpha_rad = AirData_.getAngle(Pressure[kTip], Pressure[kAlpha1], Pressure[kAlpha2], Pressure[kBeta1], Pressure[kBeta2], config_.kAlpha);
+      if (Alpha_rad > 0.7854f) {
+        Alpha_rad = 0.7854f;
+      } else if (Alpha_rad < -0.7854f) {
+        Alpha_rad = -0.7854f;
       }
-
-      // compute beta
-      data_.Beta_rad_node->setFloat( AirData_.getAngle(config_.TipPressure_node->getFloat() - data_.TipPressureBias, config_.Beta1Pressure_node->getFloat() - data_.Beta1PressureBias, config_.Beta2Pressure_node->getFloat() - data_.Beta2PressureBias, config_.Alpha1Pressure_node->getFloat() - data_.Alpha1PressureBias, config_.Alpha2Pressure_node->getFloat() - data_.Alpha2PressureBias, config_.kBeta) );
-
-      // limit beta to +/-45 deg
-      if (data_.Beta_rad_node->getFloat() > 0.7854f) {
-        data_.Beta_rad_node->setFloat( 0.7854f );
-      } else if (data_.Beta_rad_node->getFloat() < -0.7854f) {
-        data_.Beta_rad_node->setFloat( -0.7854f );
+      data_.Alpha_rad_node->setFloat( Alpha_rad );
+
+      // compute beta, limited to +/-45 deg
+      float Beta_rad = AirData_.getAngle(Pressure[kTip], Pressure[kBeta1], Pressure[kBeta2], Pressure[kAlpha1], Pressure[kAlpha2], config_.kBeta);
+      if (Beta_rad > 0.7854f) {
+        Beta_rad = 0.7854f;
+      } else if (Beta_rad < -0.7854f) {
+        Beta_rad = -0.7854f;
       }
+      data_.Beta_rad_node->setFloat( Beta_rad );
 
     } else { // airspeed < theshold
       data_.Alpha_rad_node->setFloat( 0.0f );
@@ -585,18 +603,17 @@ void FiveHole::Clear() {
 
   data_.mode_node->setInt(kStandby);
 
-  data_.TipPressureBias = 0.0f;
+  for (size_t i=0; i < kNumPorts; i++) {
+    data_.PressureBias[i] = 0.0f;
+    config_.Port[i].reset();
+  }
   data_.ias_ms_node->setFloat( 0.0f );
 
   data_.agl_m_node->setFloat( 0.0f );
   data_.PressAlt0 = 0.0f;
 
-  data_.Alpha1PressureBias = 0.0f;
-  data_.Alpha2PressureBias = 0.0f;
   data_.Alpha_rad_node->setFloat( 0.0f );
 
-  data_.Beta1PressureBias = 0.0f;
-  data_.Beta2PressureBias = 0.0f;
   data_.Beta_rad_node->setFloat( 0.0f );
 
   TimeLatch_ = false;
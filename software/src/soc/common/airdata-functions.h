@@ -60,6 +60,7 @@ class IndicatedAirspeed: public GenericFunction {
     };
     struct Data {
       std::vector<float> DifferentialPressureBias;
+      float InvNumSources = 0.0f;
       float AvgDifferentialPressure = 0.0f;
       //uint8_t Mode = kStandby;
       //float Ias_ms = 0.0f;
@@ -109,6 +110,7 @@ class AglAltitude: public GenericFunction {
     };
     struct Data {
       float PressAlt0 = 0.0f;
+      float InvNumSources = 0.0f;
       float AvgStaticPressure = 0.0f;
       //uint8_t Mode = kStandby;
       //float Agl_m = 0.0f;
@@ -123,6 +125,7 @@ class AglAltitude: public GenericFunction {
     bool Initialized_ = false;
     uint64_t T0_us_ = 0;
     size_t NumberSamples_ = 1;
+    float AverageStaticPressure();
     uint64_t micros();
     AirData AirData_;
 };
@@ -219,6 +222,9 @@ class FiveHole: public GenericFunction {
     void Run(Mode mode);
     void Clear();
   private:
+    // probe ports measured relative to the static ring, read and unbiased
+    // together once each frame
+    enum Port {kTip,kAlpha1,kAlpha2,kBeta1,kBeta2,kNumPorts};
     struct Config {
       ElementPtr StaticPressure_node;
       ElementPtr TipPressure_node;
@@ -226,6 +232,7 @@ class FiveHole: public GenericFunction {
       ElementPtr Alpha2Pressure_node;
       ElementPtr Beta1Pressure_node;
       ElementPtr Beta2Pressure_node;
+      ElementPtr Port[kNumPorts];
       float InitTime = 0.0f;
       float kAlpha = 0.0f;
       float kBeta = 0.0f;
@@ -236,15 +243,9 @@ class FiveHole: public GenericFunction {
       float PressAlt0 = 0.0f;
       ElementPtr agl_m_node;
 
-      float TipPressureBias = 0.0f;
+      float PressureBias[kNumPorts] = {0.0f,0.0f,0.0f,0.0f,0.0f};
       ElementPtr ias_ms_node;
-
-      float Alpha1PressureBias = 0.0f;
-      float Alpha2PressureBias = 0.0f;
       ElementPtr Alpha_rad_node;
-
-      float Beta1PressureBias = 0.0f;
-      float Beta2PressureBias = 0.0f;
       ElementPtr Beta_rad_node;
     };
 
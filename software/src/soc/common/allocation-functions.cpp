@@ -71,6 +71,9 @@ void PseudoInverseAllocation::Configure(const rapidjson::Value& Config,std::stri
         config_.Effectiveness(m,n) = Config["Effectiveness"][m][n].GetFloat();
       }
     }
+    // the effectiveness is fixed, so the Jacobi SVD pseudo-inverse is computed once
+    Eigen::MatrixXf I = Eigen::MatrixXf::Identity(config_.Effectiveness.rows(),config_.Effectiveness.rows());
+    config_.PseudoInverse = config_.Effectiveness.jacobiSvd(Eigen::ComputeThinU | Eigen::ComputeThinV).solve(I);
   } else {
     throw std::runtime_error(std::string("ERROR")+RootPath+std::string(": Effectiveness not specified in configuration."));
   }
@@ -105,9 +108,8 @@ void PseudoInverseAllocation::Run(Mode mode) {
     config_.Objectives(i) = config_.input_nodes[i]->getFloat();
   }
 
-  // Pseduo-Inverse solver using singular value decomposition
-  // SVD Decomposition based linear algebra solver
-  data_.uCmd = config_.Effectiveness.jacobiSvd(Eigen::ComputeThinU | Eigen::ComputeThinV).solve(config_.Objectives); // Jacobi SVD solver
+  // Pseduo-Inverse solver using singular value decomposition, precomputed at configuration
+  data_.uCmd.noalias() = config_.PseudoInverse*config_.Objectives;
 
   // saturate output
   for (int i=0; i < data_.uCmd.rows(); i++) {
@@ -127,6 +129,7 @@ void PseudoInverseAllocation::Run(Mode mode) {
 void PseudoInverseAllocation::Clear() {
   config_.Objectives.resize(0);
   config_.Effectiveness.resize(0,0);
+  config_.PseudoInverse.resize(0,0);
   config_.LowerLimit.resize(0);
   config_.UpperLimit.resize(0);
   data_.Mode->setInt(kStandby);
@@ -70,6 +70,7 @@ class PseudoInverseAllocation: public GenericFunction {
       vector<ElementPtr> input_nodes;
       Eigen::VectorXf Objectives;
       Eigen::MatrixXf Effectiveness;
+      Eigen::MatrixXf PseudoInverse;
       Eigen::VectorXf LowerLimit;
       Eigen::VectorXf UpperLimit;
     };
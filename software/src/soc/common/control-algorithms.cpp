@@ -178,6 +178,8 @@ void __SSClass::Configure(Eigen::MatrixXf A, Eigen::MatrixXf B, Eigen::MatrixXf
   yMax_.resize(numY);
   yMin_.resize(numY);
   ySat_.resize(numY);
+  xDot_.resize(numX);
+  yInit_.resize(numY);
 
   Reset(); // Initialize states and output
 
@@ -192,7 +194,7 @@ void __SSClass::Configure(Eigen::MatrixXf A, Eigen::MatrixXf B, Eigen::MatrixXf
   CB_.resize(numY, numU);
 }
 
-void __SSClass::Run(GenericFunction::Mode mode, Eigen::VectorXf u, float dt, Eigen::VectorXf *y, Eigen::VectorXi *ySat) {
+void __SSClass::Run(GenericFunction::Mode mode, const Eigen::VectorXf &u, float dt, Eigen::VectorXf *y, Eigen::VectorXi *ySat) {
   mode_ = mode;
 
   switch(mode_) {
@@ -226,19 +228,24 @@ void __SSClass::Run(GenericFunction::Mode mode, Eigen::VectorXf u, float dt, Eig
   *ySat = ySat_;
 }
 
-void __SSClass::InitializeState(Eigen::VectorXf u, Eigen::VectorXf y, float dt) {
-  x_ = CA_inv_ * (y - (CB_*dt + D_) * u);
+void __SSClass::InitializeState(const Eigen::VectorXf &u, const Eigen::VectorXf &y, float dt) {
+  // x = CA_inv*(y - (CB*dt + D)*u), y may be y_ itself
+  yInit_ = y;
+  yInit_.noalias() -= dt*(CB_*u);
+  yInit_.noalias() -= D_*u;
+  x_.noalias() = CA_inv_*yInit_;
 }
 
-void __SSClass::UpdateState(Eigen::VectorXf u, float dt) {
-
-  uint8_t numX = A_.rows();
-  Eigen::MatrixXf Ix = Eigen::MatrixXf::Identity(numX, numX);
-  x_ = (A_*dt + Ix)*x_ + B_*u*dt;
+void __SSClass::UpdateState(const Eigen::VectorXf &u, float dt) {
+  // x = (A*dt + I)*x + B*u*dt
+  xDot_.noalias() = A_*x_;
+  xDot_.noalias() += B_*u;
+  x_ += dt*xDot_;
 }
 
-void __SSClass::OutputEquation(Eigen::VectorXf u, float dt) {
-  y_ = C_*x_ + D_*u;
+void __SSClass::OutputEquation(const Eigen::VectorXf &u, float dt) {
+  y_.noalias() = C_*x_;
+  y_.noalias() += D_*u;
 
   // saturate output
   if (SatFlag_ == true){
@@ -261,9 +268,9 @@ void __SSClass::OutputEquation(Eigen::VectorXf u, float dt) {
 }
 
 void __SSClass::Reset() {
-  x_.Zero(A_.rows()); // Reset to Zero
-  y_.Zero(C_.cols()); // Reset to Zero
-  ySat_.Zero(C_.cols()); // Reset to Zero
+  x_.setZero(A_.rows()); // Reset to Zero
+  y_.setZero(C_.rows()); // Reset to Zero
+  ySat_.setZero(C_.rows()); // Reset to Zero
 
   mode_ = GenericFunction::Mode::kStandby;
   initLatch_ = false;
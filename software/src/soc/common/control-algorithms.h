@@ -32,7 +32,7 @@ class __PID2Class {
 class __SSClass {
   public:
     void Configure(Eigen::MatrixXf A, Eigen::MatrixXf B, Eigen::MatrixXf C, Eigen::MatrixXf D, float dt, bool satFlag, Eigen::VectorXf yMax, Eigen::VectorXf yMin);
-    void Run(GenericFunction::Mode mode, Eigen::VectorXf u, float dt, Eigen::VectorXf *y, Eigen::VectorXi *ySat_);
+    void Run(GenericFunction::Mode mode, const Eigen::VectorXf &u, float dt, Eigen::VectorXf *y, Eigen::VectorXi *ySat_);
     void Clear();
   private:
     uint8_t mode_ = GenericFunction::Mode::kStandby;
@@ -47,9 +47,12 @@ class __SSClass {
 
     Eigen::MatrixXf CA_inv_, CB_;
 
-    void InitializeState(Eigen::VectorXf u, Eigen::VectorXf y, float dt);
-    void UpdateState(Eigen::VectorXf u, float dt);
-    void OutputEquation(Eigen::VectorXf u, float dt);
+    // scratch sized at configuration so running does not allocate
+    Eigen::VectorXf xDot_, yInit_;
+
+    void InitializeState(const Eigen::VectorXf &u, const Eigen::VectorXf &y, float dt);
+    void UpdateState(const Eigen::VectorXf &u, float dt);
+    void OutputEquation(const Eigen::VectorXf &u, float dt);
     void Reset();
 };
 
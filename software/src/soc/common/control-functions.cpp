@@ -43,21 +43,21 @@ void PID2Class::Configure(const rapidjson::Value& Config,std::string RootPath) {
     data_.mode_node->setInt(kStandby);
 
     // pointer to log command data
-    data_.output_node = deftree.initElement(RootPath + "/" + OutputName, "Control law output", LOG_FLOAT, LOG_NONE);
+    data_.output_node = deftree.initSignal<float>(RootPath + "/" + OutputName, "Control law output", LOG_FLOAT, LOG_NONE);
   } else {
     throw std::runtime_error(std::string("ERROR")+RootPath+std::string(": Output not specified in configuration."));
   }
 
   if (Config.HasMember("Reference")) {
     ReferenceKey_ = Config["Reference"].GetString();
-    config_.reference_node = deftree.getElement(ReferenceKey_, true);
+    config_.reference_node = deftree.getSignal<float>(ReferenceKey_);
   } else {
     throw std::runtime_error(std::string("ERROR")+SystemName+std::string(": Reference not specified in configuration."));
   }
 
   if (Config.HasMember("Feedback")) {
     FeedbackKey_ = Config["Feedback"].GetString();
-    config_.feedback_node = deftree.getElement(FeedbackKey_, true);
+    config_.feedback_node = deftree.getSignal<float>(FeedbackKey_);
   } else {
     throw std::runtime_error(std::string("ERROR")+SystemName+std::string(": Feedback not specified in configuration."));
   }
@@ -84,8 +84,8 @@ void PID2Class::Configure(const rapidjson::Value& Config,std::string RootPath) {
   if (Config.HasMember("Sample-Time")) {
     if (Config["Sample-Time"].IsString()) {
       SampleTimeKey_ = Config["Sample-Time"].GetString();
-      config_.dt_node = deftree.getElement(SampleTimeKey_);
-      if ( !config_.dt_node ) {
+      config_.dt_node = deftree.getSignal<float>(SampleTimeKey_);
+      if ( !config_.dt_node.isBound() ) {
         throw std::runtime_error(std::string("ERROR")+SystemName+std::string(": Sample time ")+SampleTimeKey_+std::string(" not found in global data."));
       }
     } else {
@@ -132,17 +132,17 @@ void PID2Class::Run(Mode mode) {
 
   // sample time
   if(!config_.UseFixedTimeSample) {
-    config_.SampleTime = config_.dt_node->getFloat();
+    config_.SampleTime = config_.dt_node.get();
   }
 
   // Run
   float Output = 0.0f;
   int8_t Saturated = 0;
   PID2Class_.Run(mode,
-                 config_.reference_node->getFloat(),
-                 config_.feedback_node->getFloat(),
+                 config_.reference_node.get(),
+                 config_.feedback_node.get(),
                  config_.SampleTime, &Output, &Saturated);
-  data_.output_node->setFloat(Output);
+  data_.output_node.set(Output);
   data_.saturated_node->setInt(Saturated);
 }
 
@@ -150,7 +150,7 @@ void PID2Class::Clear() {
   config_.UseFixedTimeSample = false;
   data_.mode_node->setInt(kStandby);
   data_.saturated_node->setInt(0);
-  data_.output_node->setFloat(0.0f);
+  data_.output_node.set(0.0f);
   ReferenceKey_.clear();
   FeedbackKey_.clear();
   PID2Class_.Clear();
@@ -176,14 +176,14 @@ void PIDClass::Configure(const rapidjson::Value& Config,std::string RootPath) {
     data_.mode_node = deftree.initElement(RootPath + "/Mode", "Run mode", LOG_UINT8, LOG_NONE);
 
     // pointer to log command data
-    data_.output_node = deftree.initElement(RootPath + "/" + OutputName, "Control law output", LOG_FLOAT, LOG_NONE);
+    data_.output_node = deftree.initSignal<float>(RootPath + "/" + OutputName, "Control law output", LOG_FLOAT, LOG_NONE);
   } else {
     throw std::runtime_error(std::string("ERROR")+RootPath+std::string(": Output not specified in configuration."));
   }
 
   if (Config.HasMember("Reference")) {
     ReferenceKey_ = Config["Reference"].GetString();
-    config_.reference_node = deftree.getElement(ReferenceKey_, true);
+    config_.reference_node = deftree.getSignal<float>(ReferenceKey_);
   } else {
     throw std::runtime_error(std::string("ERROR")+SystemName+std::string(": Reference not specified in configuration."));
   }
@@ -210,8 +210,8 @@ void PIDClass::Configure(const rapidjson::Value& Config,std::string RootPath) {
   if (Config.HasMember("Sample-Time")) {
     if (Config["Sample-Time"].IsString()) {
       SampleTimeKey_ = Config["Sample-Time"].GetString();
-      config_.dt_node = deftree.getElement(SampleTimeKey_);
-      if ( !config_.dt_node ) {
+      config_.dt_node = deftree.getSignal<float>(SampleTimeKey_);
+      if ( !config_.dt_node.isBound() ) {
         throw std::runtime_error(std::string("ERROR")+SystemName+std::string(": Sample time ")+SampleTimeKey_+std::string(" not found in global data."));
       }
     } else {
@@ -248,14 +248,14 @@ void PIDClass::Run(Mode mode) {
 
   // sample time
   if(!config_.UseFixedTimeSample) {
-    config_.SampleTime = config_.dt_node->getFloat();
+    config_.SampleTime = config_.dt_node.get();
   }
 
   // Run
   float Output = 0.0f;
   int8_t Saturated = 0;
-  PID2Class_.Run(mode, config_.reference_node->getFloat(), 0.0, config_.SampleTime, &Output, &Saturated);
-  data_.output_node->setFloat(Output);
+  PID2Class_.Run(mode, config_.reference_node.get(), 0.0, config_.SampleTime, &Output, &Saturated);
+  data_.output_node.set(Output);
   data_.saturated_node->setInt(Saturated);
 }
 
@@ -263,7 +263,7 @@ void PIDClass::Clear() {
   config_.UseFixedTimeSample = false;
   data_.mode_node->setInt(kStandby);
   data_.saturated_node->setInt(0);
-  data_.output_node->setFloat(0.0f);
+  data_.output_node.set(0.0f);
   ReferenceKey_.clear();
   PID2Class_.Clear();
 }
@@ -293,9 +293,9 @@ void SSClass::Configure(const rapidjson::Value& Config,std::string RootPath) {
     for (size_t i=0; i < Config["Inputs"].Size(); i++) {
       const rapidjson::Value& Input = Config["Inputs"][i];
       InputKeys_.push_back(Input.GetString());
-      ElementPtr ele = deftree.getElement(InputKeys_.back());
-      if (ele) {
-        config_.Inputs.push_back(ele);
+      Signal<float> input = deftree.getSignal<float>(InputKeys_.back());
+      if (input.isBound()) {
+        config_.Inputs.push_back(input);
       } else {
         throw std::runtime_error(std::string("ERROR")+RootPath+std::string(": Input ")+InputKeys_.back()+std::string(" not found in global data."));
       }
@@ -316,7 +316,7 @@ void SSClass::Configure(const rapidjson::Value& Config,std::string RootPath) {
       OutputName = Output.GetString();
 
       // pointer to log output
-      data_.y_node[i] = deftree.initElement(RootPath + SystemName + "/" + OutputName, "SS output", LOG_FLOAT, LOG_NONE);
+      data_.y_node[i] = deftree.initSignal<float>(RootPath + SystemName + "/" + OutputName, "SS output", LOG_FLOAT, LOG_NONE);
 
       // pointer to log saturation data
       data_.ySat_node[i] = deftree.initElement(RootPath + SystemName + "/Saturated" + "/" + OutputName, "Output saturation, 0 if not saturated, 1 if saturated on the upper limit, and -1 if saturated on the lower limit", LOG_UINT8, LOG_NONE);
@@ -448,13 +448,13 @@ void SSClass::Run(Mode mode) {
 
   // inputs to Eigen3 vector
   for (size_t i=0; i < config_.Inputs.size(); i++) {
-    config_.u(i) = config_.Inputs[i]->getFloat();
+    config_.u(i) = config_.Inputs[i].get();
   }
 
   // Call Algorithm
   SSClass_.Run(mode, config_.u, dt, &data_.y, &data_.ySat);
   for (size_t i=0; i < data_.y_node.size(); i++) {
-    data_.y_node[i]->setFloat(data_.y(i));
+    data_.y_node[i].set(data_.y(i));
     data_.ySat_node[i]->setInt(data_.ySat(i));
   }
 }
@@ -506,8 +506,8 @@ void TecsClass::Configure(const rapidjson::Value& Config,std::string RootPath) {
 
   if (Config.HasMember("RefSpeed")) {
     string RefSpeedKey = Config["RefSpeed"].GetString();
-    ref_vel_node = deftree.getElement(RefSpeedKey);
-    if ( !ref_vel_node ){
+    ref_vel_node = deftree.getSignal<float>(RefSpeedKey);
+    if ( !ref_vel_node.isBound() ){
       throw std::runtime_error(std::string("ERROR")+std::string(": RefSpeed ")+RefSpeedKey+std::string(" not found in global data."));
     }
   } else {
@@ -516,8 +516,8 @@ void TecsClass::Configure(const rapidjson::Value& Config,std::string RootPath) {
 
   if (Config.HasMember("RefAltitude")) {
     string RefAltitudeKey = Config["RefAltitude"].GetString();
-    ref_agl_node = deftree.getElement(RefAltitudeKey);
-    if ( !ref_agl_node ) {
+    ref_agl_node = deftree.getSignal<float>(RefAltitudeKey);
+    if ( !ref_agl_node.isBound() ) {
       throw std::runtime_error(std::string("ERROR")+std::string(": RefAltitude ")+RefAltitudeKey+std::string(" not found in global data."));
     }
   } else {
@@ -526,8 +526,8 @@ void TecsClass::Configure(const rapidjson::Value& Config,std::string RootPath) {
 
   if (Config.HasMember("FeedbackSpeed")) {
     string FeedbackSpeedKey = Config["FeedbackSpeed"].GetString();
-    vel_node = deftree.getElement(FeedbackSpeedKey);
-    if ( !vel_node ) {
+    vel_node = deftree.getSignal<float>(FeedbackSpeedKey);
+    if ( !vel_node.isBound() ) {
       throw std::runtime_error(std::string("ERROR")+std::string(": FeedbackSpeed ")+FeedbackSpeedKey+std::string(" not found in global data."));
     }
   } else {
@@ -536,8 +536,8 @@ void TecsClass::Configure(const rapidjson::Value& Config,std::string RootPath) {
 
   if (Config.HasMember("FeedbackAltitude")) {
     string FeedbackAltitudeKey = Config["FeedbackAltitude"].GetString();
-    agl_node = deftree.getElement(FeedbackAltitudeKey);
-    if ( !agl_node ) {
+    agl_node = deftree.getSignal<float>(FeedbackAltitudeKey);
+    if ( !agl_node.isBound() ) {
       throw std::runtime_error(std::string("ERROR")+std::string(": FeedbackAltitude ")+FeedbackAltitudeKey+std::string(" not found in global data."));
     }
   } else {
@@ -548,7 +548,7 @@ void TecsClass::Configure(const rapidjson::Value& Config,std::string RootPath) {
     OutputName = Config["OutputTotal"].GetString();
 
     // pointer to log output
-    error_total_node = deftree.initElement(RootPath + "/" + SystemName + "/" + OutputName, "Tecs Total Energy Error", LOG_FLOAT, LOG_NONE);
+    error_total_node = deftree.initSignal<float>(RootPath + "/" + SystemName + "/" + OutputName, "Tecs Total Energy Error", LOG_FLOAT, LOG_NONE);
 
   } else {
     throw std::runtime_error(std::string("ERROR")+RootPath+std::string(": OutputTotal not specified in configuration."));
@@ -558,7 +558,7 @@ void TecsClass::Configure(const rapidjson::Value& Config,std::string RootPath) {
     OutputName = Config["OutputDiff"].GetString();
 
     // pointer to log output
-    error_diff_node = deftree.initElement(RootPath + "/" + SystemName + "/" + OutputName, "Tecs Diff Energy Error ", LOG_FLOAT, LOG_NONE);
+    error_diff_node = deftree.initSignal<float>(RootPath + "/" + SystemName + "/" + OutputName, "Tecs Diff Energy Error ", LOG_FLOAT, LOG_NONE);
 
   } else {
     throw std::runtime_error(std::string("ERROR")+RootPath+std::string(": OutputDiff not specified in configuration."));
@@ -588,12 +588,12 @@ void TecsClass::Run(Mode mode) {
   }
 
   // Feedback energy
-  float energy_pot = mass_kg * g * (agl_node->getFloat());
-  float energy_kin = 0.5 * mass_kg * (vel_node->getFloat()) * (vel_node->getFloat());
+  float energy_pot = mass_kg * g * (agl_node.get());
+  float energy_kin = 0.5 * mass_kg * (vel_node.get()) * (vel_node.get());
 
   // Reference energy
-  float target_pot = mass_kg * g * (ref_agl_node->getFloat());
-  float target_kin = 0.5 * mass_kg * (ref_vel_node->getFloat()) * (ref_vel_node->getFloat());
+  float target_pot = mass_kg * g * (ref_agl_node.get());
+  float target_kin = 0.5 * mass_kg * (ref_vel_node.get()) * (ref_vel_node.get());
 
   // Energy error
   float error_pot = target_pot - energy_pot;
@@ -626,8 +626,8 @@ void TecsClass::Run(Mode mode) {
   // if max pitch angle is saturated.
   if ( error_total > max_error ) { error_total = max_error; }
 
-  error_total_node->setFloat(error_total);
-  error_diff_node->setFloat(error_diff);
+  error_total_node.set(error_total);
+  error_diff_node.set(error_diff);
 }
 
 void TecsClass::Clear() {
@@ -82,13 +82,13 @@ class PID2Class: public GenericFunction {
     struct Config {
       float SampleTime;
       bool UseFixedTimeSample = false;
-      ElementPtr reference_node;
-      ElementPtr feedback_node;
-      ElementPtr dt_node;
+      Signal<float> reference_node;
+      Signal<float> feedback_node;
+      Signal<float> dt_node;
     };
     struct Data {
       ElementPtr mode_node;
-      ElementPtr output_node;
+      Signal<float> output_node;
       ElementPtr saturated_node;
     };
     __PID2Class PID2Class_;
@@ -139,12 +139,12 @@ class PIDClass: public GenericFunction {
     struct Config {
         float SampleTime;
         bool UseFixedTimeSample = false;
-        ElementPtr reference_node;
-        ElementPtr dt_node;
+        Signal<float> reference_node;
+        Signal<float> dt_node;
     };
     struct Data {
         ElementPtr mode_node;
-        ElementPtr output_node;
+        Signal<float> output_node;
         ElementPtr saturated_node;
     };
     __PID2Class PID2Class_;
@@ -200,7 +200,7 @@ class SSClass: public GenericFunction {
     void Clear();
   private:
     struct Config {
-      std::vector<ElementPtr> Inputs;
+      std::vector<Signal<float> > Inputs;
       Eigen::VectorXf u;
       Eigen::VectorXf x;
       Eigen::MatrixXf A;
@@ -219,7 +219,7 @@ class SSClass: public GenericFunction {
         Eigen::VectorXf y;
         Eigen::VectorXi ySat;
         ElementPtr mode_node;
-        vector<ElementPtr>y_node;
+        vector<Signal<float> > y_node;
         vector<ElementPtr>ySat_node;
     };
     __SSClass SSClass_;
@@ -272,14 +272,14 @@ class TecsClass: public GenericFunction {
     //float *ref_agl_m;
     //float *vel_mps;
     //float *agl_m;
-    ElementPtr ref_vel_node;
-    ElementPtr ref_agl_node;
-    ElementPtr vel_node;
-    ElementPtr agl_node;
+    Signal<float> ref_vel_node;
+    Signal<float> ref_agl_node;
+    Signal<float> vel_node;
+    Signal<float> agl_node;
     //float error_total;
     //float error_diff;
-    ElementPtr error_total_node;
-    ElementPtr error_diff_node;
+    Signal<float> error_total_node;
+    Signal<float> error_diff_node;
 
     bool initFlag = false;
     float mass_kg = 0.0;
@@ -126,7 +126,7 @@ void ControlLaws::Configure(const rapidjson::Value& Config) {
                       ElementPtr soc_ele = deftree.getElement(SocKey);
                       if (soc_ele) {
                         SocDataPtr_[GroupKey][KeyName] = soc_ele;
-                        ElementPtr out_ele = deftree.initElement(OutputKey,soc_ele->description, soc_ele->datalog, soc_ele->telemetry);
+                        ElementPtr out_ele = deftree.initElement(OutputKey,soc_ele->description, soc_ele->datalog, soc_ele->telemetry, soc_ele->log_scale, soc_ele->log_offset);
                         if ( out_ele ) {
                           OutputDataPtr_[KeyName] = out_ele;
                         }
@@ -147,49 +147,72 @@ void ControlLaws::Configure(const rapidjson::Value& Config) {
   } else {
     std::cout << "WARNING" << RootPath_ << ": Soc Control configuration not defined." << std::endl;
   }
+  // pair each level's outputs with their sources so running does not look up keys
+  for (auto &Group : SocDataKeys_) {
+    for (auto &LevelKeys : Group.second) {
+      SocOutputs_[Group.first].push_back(OutputCopies());
+      for (auto &Key : LevelKeys) {
+        std::string KeyName = Key.substr(Key.rfind("/"));
+        if ((KeyName!="/Mode")&&(KeyName!="/Saturated")&&OutputDataPtr_.count(KeyName)&&SocDataPtr_[Group.first].count(KeyName)) {
+          SocOutputs_[Group.first].back().push_back(std::make_pair(OutputDataPtr_[KeyName],SocDataPtr_[Group.first][KeyName]));
+        }
+      }
+    }
+  }
 }
 
 /* sets the control law that is engaged and currently output */
-void ControlLaws::SetEngagedController(std::string ControlGroupName) {
-  EngagedGroup_ = ControlGroupName;
+void ControlLaws::SetEngagedController(const std::string &ControlGroupName) {
+  if ((ControlGroupName != EngagedGroup_)||(EngagedFunctions_ == NULL)) {
+    EngagedGroup_ = ControlGroupName;
+    if (SocControlGroups_.count(EngagedGroup_)) {
+      EngagedFunctions_ = &SocControlGroups_[EngagedGroup_];
+      EngagedLevelNames_ = &SocLevelNames_[EngagedGroup_];
+      EngagedOutputs_ = &SocOutputs_[EngagedGroup_];
+    } else {
+      EngagedFunctions_ = NULL;
+      EngagedLevelNames_ = NULL;
+      EngagedOutputs_ = NULL;
+    }
+  }
 }
 
 /* sets the control law that is running and computing states to enable a transient free engage */
-void ControlLaws::SetArmedController(std::string ControlGroupName) {
-  ArmedGroup_ = ControlGroupName;
+void ControlLaws::SetArmedController(const std::string &ControlGroupName) {
+  if (ControlGroupName != ArmedGroup_) {
+    ArmedGroup_ = ControlGroupName;
+  }
 }
 
 /* returns the number of levels for the engaged control law */
 size_t ControlLaws::ActiveControlLevels() {
-  if (EngagedGroup_ == "Baseline") {
+  if ((EngagedGroup_ == "Baseline")||(EngagedFunctions_ == NULL)) {
     return 0;
   } else {
-    return SocControlGroups_[EngagedGroup_].size();
+    return EngagedFunctions_->size();
   }
 }
 
 /* returns the name of the level for the engaged control law */
-std::string ControlLaws::GetActiveLevel(size_t ControlLevel) {
-  if (EngagedGroup_ == "Baseline") {
-    return "";
+const std::string &ControlLaws::GetActiveLevel(size_t ControlLevel) {
+  static const std::string NoLevel;
+  if ((EngagedGroup_ == "Baseline")||(EngagedLevelNames_ == NULL)) {
+    return NoLevel;
   } else {
-    return SocLevelNames_[EngagedGroup_][ControlLevel];
+    return (*EngagedLevelNames_)[ControlLevel];
   }
 }
 
 /* computes control law data */
 void ControlLaws::RunEngaged(size_t ControlLevel) {
-  if (EngagedGroup_ != "Baseline") {
+  if ((EngagedGroup_ != "Baseline")&&(EngagedFunctions_ != NULL)) {
     // running engaged Soc control laws
-    for (auto Func : SocControlGroups_[EngagedGroup_][ControlLevel]) {
+    for (auto &Func : (*EngagedFunctions_)[ControlLevel]) {
       Func->Run(GenericFunction::kEngage);
     }
     // output Soc control laws
-    for (auto Key : SocDataKeys_[EngagedGroup_][ControlLevel]) {
-      std::string KeyName = Key.substr(Key.rfind("/"));
-      if ((KeyName!="/Mode")&&(KeyName!="/Saturated")) {
-        OutputDataPtr_[KeyName]->copyFrom(SocDataPtr_[EngagedGroup_][KeyName]);
-      }
+    for (auto &Copy : (*EngagedOutputs_)[ControlLevel]) {
+      Copy.first->copyFrom(*Copy.second);
     }
   }
 }
@@ -197,21 +220,18 @@ void ControlLaws::RunEngaged(size_t ControlLevel) {
 /* computes control law data */
 void ControlLaws::RunArmed() {
   // iterate through all groups
-  for (auto Group : SocGroupKeys_) {
-    // iterate through all levels
-    for (auto Levels = SocControlGroups_[Group].begin(); Levels != SocControlGroups_[Group].end(); ++Levels) {
-      auto Level = std::distance(SocControlGroups_[Group].begin(),Levels);
-      // iterate through all functions
-      for (auto Func : SocControlGroups_[Group][Level]) {
-        // make sure we don't run the engaged group
-        if (Group != EngagedGroup_) {
-          // run as arm if the armed group, otherwise standby
-          if (Group == ArmedGroup_) {
-            Func->Run(GenericFunction::kArm);
-          } else {
-            Func->Run(GenericFunction::kStandby);
-          }
-        }
+  for (auto &Group : SocGroupKeys_) {
+    // make sure we don't run the engaged group
+    if (Group == EngagedGroup_) {
+      continue;
+    }
+    // run as arm if the armed group, otherwise standby, every frame so filters
+    // and delays keep tracking their inputs and a group can be engaged directly
+    GenericFunction::Mode Mode = (Group == ArmedGroup_) ? GenericFunction::kArm : GenericFunction::kStandby;
+    // iterate through all levels and functions
+    for (auto &Level : SocControlGroups_[Group]) {
+      for (auto &Func : Level) {
+        Func->Run(Mode);
       }
     }
   }
@@ -87,10 +87,10 @@ Where:
 class ControlLaws {
   public:
     void Configure(const rapidjson::Value& Config);
-    void SetEngagedController(std::string ControlGroupName);
-    void SetArmedController(std::string ControlGroupName);
+    void SetEngagedController(const std::string &ControlGroupName);
+    void SetArmedController(const std::string &ControlGroupName);
     size_t ActiveControlLevels();
-    std::string GetActiveLevel(size_t ControlLevel);
+    const std::string &GetActiveLevel(size_t ControlLevel);
     void RunEngaged(size_t ControlLevel);
     void RunArmed();
   private:
@@ -103,6 +103,13 @@ class ControlLaws {
     std::map<std::string,std::vector<std::vector<std::string>>> SocDataKeys_;
     map<string, map<string, ElementPtr>> SocDataPtr_;
     map<string, ElementPtr> OutputDataPtr_;
+    // output and source node pairs copied for each level, built at configuration
+    typedef std::vector<std::pair<ElementPtr, ElementPtr>> OutputCopies;
+    std::map<std::string,std::vector<OutputCopies>> SocOutputs_;
+    // engaged group, looked up when it changes rather than every frame
+    std::vector<std::vector<std::shared_ptr<GenericFunction>>> *EngagedFunctions_ = NULL;
+    std::vector<std::string> *EngagedLevelNames_ = NULL;
+    std::vector<OutputCopies> *EngagedOutputs_ = NULL;
 };
 
 #endif
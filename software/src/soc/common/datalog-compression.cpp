@@ -0,0 +1,173 @@
+/*
+datalog-compression.cpp
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "datalog-compression.h"
+#include "crc16.h"
+#include "bf_frame.h"
+#include <string.h>
+
+const uint8_t DatalogBlockEncoder::kFileHeader[4] = {'B','F','Z',1};
+
+/* Encodes a block of whole frames, Raw is XORed in place. The block with its header is written to Block. */
+void DatalogBlockEncoder::Encode(uint8_t *Raw, size_t RawSize, std::vector<uint8_t> *Block) {
+  CRC16 Crc;
+  uint16_t Checksum = Crc.xmodem(Raw,RawSize);
+  XorRows(Raw,RawSize);
+  Block->resize(kBlockHeaderSize + RawSize);
+  uint8_t *Header = Block->data();
+  size_t StoredSize = Compress(Raw,RawSize,Header+kBlockHeaderSize,RawSize);
+  if (StoredSize == 0) {
+    memcpy(Header+kBlockHeaderSize,Raw,RawSize);
+    StoredSize = RawSize;
+  }
+  Block->resize(kBlockHeaderSize + StoredSize);
+  Header = Block->data();
+  Header[0] = 'B';
+  Header[1] = 'F';
+  Header[2] = 'Z';
+  Header[3] = 'B';
+  for (size_t i=0; i < 4; i++) {
+    Header[4+i] = (RawSize >> (8*i)) & 0xff;
+    Header[8+i] = (StoredSize >> (8*i)) & 0xff;
+  }
+  Header[12] = Checksum & 0xff;
+  Header[13] = Checksum >> 8;
+}
+
+/* XORs each Data and GroupData payload with the previous payload of its stream, starting over each block */
+void DatalogBlockEncoder::XorRows(uint8_t *Raw, size_t RawSize) {
+  // DatalogClient message types
+  const uint8_t DataType = 20;
+  const uint8_t GroupDataType = 24;
+  for (auto &Stream : Previous_) {
+    Stream.second.clear();
+  }
+  size_t Location = 0;
+  while (Location + BfFrame::kHeaderSize <= RawSize) {
+    uint8_t *Frame = Raw + Location;
+    if ((Frame[0] != BfFrame::kHeader0)||(Frame[1] != BfFrame::kHeader1)) {
+      break;
+    }
+    size_t Length = Frame[3] | (Frame[4] << 8);
+    if (Location + BfFrame::Size(Length) > RawSize) {
+      break;
+    }
+    Location += BfFrame::Size(Length);
+    uint8_t *Payload = BfFrame::Payload(Frame);
+    uint16_t Key;
+    if (Frame[2] == DataType) {
+      Key = 0;
+    } else if ((Frame[2] == GroupDataType)&&(Length > 0)) {
+      // keep the group number readable
+      Key = Payload[0];
+      Payload++;
+      Length--;
+    } else {
+      continue;
+    }
+    std::vector<uint8_t> &Previous = Previous_[Key];
+    if (Previous.size() == Length) {
+      Original_.assign(Payload,Payload+Length);
+      for (size_t i=0; i < Length; i++) {
+        Payload[i] ^= Previous[i];
+      }
+      Previous.swap(Original_);
+    } else {
+      Previous.assign(Payload,Payload+Length);
+    }
+  }
+}
+
+/* Compresses in the LZ4 block format, returns the compressed size or 0 if it would not fit in DstCapacity */
+size_t DatalogBlockEncoder::Compress(const uint8_t *Src, size_t SrcSize, uint8_t *Dst, size_t DstCapacity) {
+  const size_t MinMatch = 4;
+  const size_t LastLiterals = 5;
+  const size_t MatchFindLimit = 12;
+  const size_t MaxOffset = 65535;
+  size_t Out = 0;
+  size_t Anchor = 0;
+  size_t Position = 0;
+  // emits the literals since Anchor followed by a match, a MatchLength of zero ends the block
+  auto Sequence = [&](size_t Offset, size_t MatchLength) -> bool {
+    size_t Literals = Position - Anchor;
+    if (Out + 1 + Literals/255 + 1 + Literals + 2 + MatchLength/255 + 1 > DstCapacity) {
+      return false;
+    }
+    uint8_t *Token = Dst + Out++;
+    *Token = ((Literals < 15) ? Literals : 15) << 4;
+    if (Literals >= 15) {
+      size_t Remaining = Literals - 15;
+      for (; Remaining >= 255; Remaining -= 255) {
+        Dst[Out++] = 255;
+      }
+      Dst[Out++] = Remaining;
+    }
+    memcpy(Dst+Out,Src+Anchor,Literals);
+    Out += Literals;
+    if (MatchLength > 0) {
+      Dst[Out++] = Offset & 0xff;
+      Dst[Out++] = Offset >> 8;
+      size_t Extra = MatchLength - MinMatch;
+      *Token |= (Extra < 15) ? Extra : 15;
+      if (Extra >= 15) {
+        size_t Remaining = Extra - 15;
+        for (; Remaining >= 255; Remaining -= 255) {
+          Dst[Out++] = 255;
+        }
+        Dst[Out++] = Remaining;
+      }
+    }
+    return true;
+  };
+  if (SrcSize > MatchFindLimit) {
+    memset(HashTable_,0,sizeof(HashTable_));
+    const size_t MatchLimit = SrcSize - LastLiterals;
+    const size_t SearchLimit = SrcSize - MatchFindLimit;
+    while (Position < SearchLimit) {
+      uint32_t Sequence4;
+      memcpy(&Sequence4,Src+Position,sizeof(Sequence4));
+      uint32_t Hash = (Sequence4*2654435761U) >> (32 - kHashBits_);
+      size_t Candidate = HashTable_[Hash];
+      HashTable_[Hash] = Position;
+      uint32_t CandidateSequence4;
+      memcpy(&CandidateSequence4,Src+Candidate,sizeof(CandidateSequence4));
+      if ((Candidate < Position)&&(Position - Candidate <= MaxOffset)&&(CandidateSequence4 == Sequence4)) {
+        size_t MatchLength = MinMatch;
+        while ((Position + MatchLength < MatchLimit)&&(Src[Candidate+MatchLength] == Src[Position+MatchLength])) {
+          MatchLength++;
+        }
+        if (!Sequence(Position-Candidate,MatchLength)) {
+          return 0;
+        }
+        Position += MatchLength;
+        Anchor = Position;
+      } else {
+        // step faster through data that does not compress
+        Position += 1 + ((Position - Anchor) >> 6);
+      }
+    }
+  }
+  Position = SrcSize;
+  if (!Sequence(0,0)) {
+    return 0;
+  }
+  return Out;
+}
@@ -0,0 +1,59 @@
+/*
+datalog-compression.h
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef DATALOG_COMPRESSION_H_
+#define DATALOG_COMPRESSION_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <map>
+#include <vector>
+
+/*
+Datalog block compression - the datalog server collects the received frames
+into blocks and compresses each block independently. The Data and GroupData
+payloads in a block are first XORed with the previous payload of the same
+stream, so columns that did not change become runs of zero bytes, and the
+block is then compressed in the LZ4 block format. The XOR state starts over
+with each block, so a file cut short by a power loss still decodes up to its
+last complete block.
+File layout:
+   * "BFZ" followed by a version byte of 1
+   * blocks, each "BFZB", the uint32 raw size, the uint32 stored size and
+     the CRC16 (xmodem) of the raw block, all little endian, followed by
+     the stored bytes. A block stored at its raw size is not compressed.
+*/
+class DatalogBlockEncoder {
+  public:
+    static const size_t kBlockSize = 65536;
+    static const size_t kBlockHeaderSize = 14;
+    static const uint8_t kFileHeader[4];
+    void Encode(uint8_t *Raw, size_t RawSize, std::vector<uint8_t> *Block);
+  private:
+    static const size_t kHashBits_ = 12;
+    uint32_t HashTable_[1 << kHashBits_];
+    std::map<uint16_t,std::vector<uint8_t>> Previous_;
+    std::vector<uint8_t> Original_;
+    void XorRows(uint8_t *Raw, size_t RawSize);
+    size_t Compress(const uint8_t *Src, size_t SrcSize, uint8_t *Dst, size_t DstCapacity);
+};
+
+#endif
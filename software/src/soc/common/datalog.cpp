@@ -23,6 +23,18 @@ using std::cout;
 using std::endl;
 
 #include "datalog.h"
+#include "log-conversions.h"
+#include <math.h>
+#include <algorithm>
+#include <cmath>
+
+/* Keys of scaled signals are sent with the scale and offset in front */
+static std::string ScaledKey(const std::string &Key, ElementPtr Node) {
+  std::string Scaled(2*sizeof(float),'\0');
+  memcpy(&Scaled[0],&Node->log_scale,sizeof(float));
+  memcpy(&Scaled[sizeof(float)],&Node->log_offset,sizeof(float));
+  return Scaled + Key;
+}
 
 /* Initializes the datalogger states and opens a socket for datalogging */
 DatalogClient::DatalogClient() {
@@ -32,317 +44,629 @@ DatalogClient::DatalogClient() {
   DataLogServer_.sin_addr.s_addr = inet_addr("127.0.0.1");
 }
 
+/* Configures the decimation groups given a JSON value and the FMU frame period */
+void DatalogClient::Configure(const rapidjson::Value& Config,uint32_t FramePeriod_us) {
+  if (Config.HasMember("Time")) {
+    TimeKey_ = Config["Time"].GetString();
+  }
+  if (Config.HasMember("Groups")) {
+    for (auto &GroupConfig : Config["Groups"].GetArray()) {
+      Group_ Group;
+      if (GroupConfig.HasMember("Name")) {
+        Group.Name = GroupConfig["Name"].GetString();
+      } else {
+        throw std::runtime_error(std::string("ERROR")+RootPath_+std::string(": Name not specified in group configuration."));
+      }
+      if (GroupConfig.HasMember("Decimation")) {
+        uint32_t Decimation = GroupConfig["Decimation"].GetUint();
+        if ((Decimation == 0)||(Decimation > UINT16_MAX)) {
+          throw std::runtime_error(std::string("ERROR")+RootPath_+std::string(": Decimation must be between 1 and 65535 in group ")+Group.Name+std::string("."));
+        }
+        Group.Decimation = Decimation;
+      } else if (GroupConfig.HasMember("Rate")) {
+        float Rate = GroupConfig["Rate"].GetFloat();
+        float Decimation = roundf(1e6f/(Rate*FramePeriod_us));
+        if ((Rate <= 0.0f)||(Decimation > UINT16_MAX)) {
+          throw std::runtime_error(std::string("ERROR")+RootPath_+std::string(": Rate out of range in group ")+Group.Name+std::string("."));
+        }
+        Group.Decimation = (Decimation < 1.0f) ? 1 : (uint16_t)Decimation;
+      } else {
+        throw std::runtime_error(std::string("ERROR")+RootPath_+std::string(": Rate or Decimation not specified in group ")+Group.Name+std::string("."));
+      }
+      if (GroupConfig.HasMember("Signals")) {
+        for (auto &Signal : GroupConfig["Signals"].GetArray()) {
+          Group.Signals.push_back(Signal.GetString());
+        }
+      } else {
+        throw std::runtime_error(std::string("ERROR")+RootPath_+std::string(": Signals not specified in group ")+Group.Name+std::string("."));
+      }
+      if (Groups_.size() > UINT8_MAX) {
+        throw std::runtime_error(std::string("ERROR")+RootPath_+std::string(": Too many groups."));
+      }
+      Groups_.push_back(Group);
+    }
+  }
+  if (Config.HasMember("Events")) {
+    for (auto &Signal : Config["Events"].GetArray()) {
+      EventSignals_.push_back(Signal.GetString());
+    }
+  }
+}
+
+/* Adds a string logged as an event when it changes, returns the event number
+used with LogStringEvent. Must be called before RegisterGlobalData. */
+size_t DatalogClient::AddStringEvent(const std::string &Key, const std::string &Desc) {
+  Event_ Event;
+  Event.Key = Key;
+  Event.Desc = Desc;
+  Event.Type = DataType_::StringKey;
+  Events_.push_back(Event);
+  return Events_.size() - 1;
+}
+
 /* Registers global data with the datalogger */
 void DatalogClient::RegisterGlobalData() {
   // Get all keys
   std::vector<std::string> Keys;
   deftree.GetKeys("/",&Keys);
-  // Find keys that are marked to be datalogged
+  // Find keys that are marked to be datalogged and sort them into events and groups
   for (auto const & key: Keys) {
-    // store keys, description, and value pointers
-    ElementPtr ele = deftree.getElement(key);
-    log_tag_t log_tag = ele->getLoggingType();
-    if ( log_tag == LOG_UINT64 ) {
-      SaveAsUint64Keys_.push_back(key);
-      SaveAsUint64Nodes_.push_back(ele);
-    } else if ( log_tag == LOG_UINT32 ) {
-      SaveAsUint32Keys_.push_back(key);
-      SaveAsUint32Nodes_.push_back(ele);
-    } else if ( log_tag == LOG_UINT16 ) {
-      SaveAsUint16Keys_.push_back(key);
-      SaveAsUint16Nodes_.push_back(ele);
-    } else if ( log_tag == LOG_UINT8 ) {
-      SaveAsUint8Keys_.push_back(key);
-      SaveAsUint8Nodes_.push_back(ele);
-    } else if ( log_tag == LOG_INT64 ) {
-      SaveAsInt64Keys_.push_back(key);
-      SaveAsInt64Nodes_.push_back(ele);
-    } else if ( log_tag == LOG_INT32 ) {
-      SaveAsInt32Keys_.push_back(key);
-      SaveAsInt32Nodes_.push_back(ele);
-    } else if ( log_tag == LOG_INT16 ) {
-      SaveAsInt16Keys_.push_back(key);
-      SaveAsInt16Nodes_.push_back(ele);
-    } else if ( log_tag == LOG_INT8 ) {
-      SaveAsInt8Keys_.push_back(key);
-      SaveAsInt8Nodes_.push_back(ele);
-    } else if ( log_tag == LOG_FLOAT ) {
-      SaveAsFloatKeys_.push_back(key);
-      SaveAsFloatNodes_.push_back(ele);
-    } else if ( log_tag == LOG_DOUBLE ) {
-      SaveAsDoubleKeys_.push_back(key);
-      SaveAsDoubleNodes_.push_back(ele);
-    } else if ( log_tag == LOG_NONE ) {
-      // skip
-    } else {
-      cout << "NOTICE: no valid log tag defined for: " << key << endl;
-    }
-  }
-  // define the data buffer size
-  LogDataBuffer_.resize(
-                        SaveAsUint64Nodes_.size()*sizeof(uint64_t) +
-                        SaveAsUint32Nodes_.size()*sizeof(uint32_t) +
-                        SaveAsUint16Nodes_.size()*sizeof(uint16_t) +
-                        SaveAsUint8Nodes_.size()*sizeof(uint8_t) +
-                        SaveAsInt64Nodes_.size()*sizeof(int64_t) +
-                        SaveAsInt32Nodes_.size()*sizeof(int32_t) +
-                        SaveAsInt16Nodes_.size()*sizeof(int16_t) +
-                        SaveAsInt8Nodes_.size()*sizeof(int8_t) +
-                        SaveAsFloatNodes_.size()*sizeof(float) +
-                        SaveAsDoubleNodes_.size()*sizeof(double)
-                        );
-  // send meta data to disk
-  for (size_t i=0; i < SaveAsUint64Nodes_.size();i++) {
-    std::vector<uint8_t> Buffer;
-    for (size_t j=0; j < SaveAsUint64Keys_[i].size(); j++) {
-      Buffer.push_back((uint8_t)SaveAsUint64Keys_[i][j]);
+    bool IsEvent = false;
+    for (auto const & Signal: EventSignals_) {
+      if (key.find(Signal) != string::npos) {
+        IsEvent = true;
+        break;
+      }
     }
-    SendBinary(DataType_::Uint64Key,Buffer);
-    Buffer.clear();
-    for (size_t j=0; j < SaveAsUint64Nodes_[i]->description.size(); j++) {
-      Buffer.push_back((uint8_t)SaveAsUint64Nodes_[i]->description[j]);
+    if (IsEvent) {
+      AddEvent(key,deftree.getElement(key));
+      continue;
     }
-    SendBinary(DataType_::Uint64Desc,Buffer);
-  }
-  for (size_t i=0; i < SaveAsUint32Nodes_.size();i++) {
-    std::vector<uint8_t> Buffer;
-    for (size_t j=0; j < SaveAsUint32Keys_[i].size(); j++) {
-      Buffer.push_back((uint8_t)SaveAsUint32Keys_[i][j]);
+    size_t GroupIndex = 0;
+    for (size_t i=1; (i < Groups_.size())&&(GroupIndex == 0); i++) {
+      for (auto const & Signal: Groups_[i].Signals) {
+        if (key.find(Signal) != string::npos) {
+          GroupIndex = i;
+          break;
+        }
+      }
     }
-    SendBinary(DataType_::Uint32Key,Buffer);
-    Buffer.clear();
-    for (size_t j=0; j < SaveAsUint32Nodes_[i]->description.size(); j++) {
-      Buffer.push_back((uint8_t)SaveAsUint32Nodes_[i]->description[j]);
+    AddSignal(Groups_[GroupIndex],key,deftree.getElement(key));
+  }
+  if (Events_.size() > UINT16_MAX + 1) {
+    throw std::runtime_error(std::string("ERROR")+RootPath_+std::string(": Too many events."));
+  }
+  if ((Groups_.size() > 1)||(Events_.size() > 0)) {
+    TimeNode_ = deftree.getElement(TimeKey_,false);
+    if (!TimeNode_) {
+      throw std::runtime_error(std::string("ERROR")+RootPath_+std::string(": Time signal ")+TimeKey_+std::string(" not found."));
     }
-    SendBinary(DataType_::Uint32Desc,Buffer);
   }
-  for (size_t i=0; i < SaveAsUint16Nodes_.size();i++) {
-    std::vector<uint8_t> Buffer;
-    for (size_t j=0; j < SaveAsUint16Keys_[i].size(); j++) {
-      Buffer.push_back((uint8_t)SaveAsUint16Keys_[i][j]);
+  size_t PackedSize = 0;
+  for (size_t GroupIndex=0; GroupIndex < Groups_.size(); GroupIndex++) {
+    Group_ &Group = Groups_[GroupIndex];
+    // define the payload size
+    Group.PayloadSize = (
+                        ((GroupIndex > 0) ? kGroupHeaderSize_ : 0) +
+                        Group.SaveAsUint64Nodes.size()*sizeof(uint64_t) +
+                        Group.SaveAsUint32Nodes.size()*sizeof(uint32_t) +
+                        Group.SaveAsUint16Nodes.size()*sizeof(uint16_t) +
+                        Group.SaveAsUint8Nodes.size()*sizeof(uint8_t) +
+                        Group.SaveAsInt64Nodes.size()*sizeof(int64_t) +
+                        Group.SaveAsInt32Nodes.size()*sizeof(int32_t) +
+                        Group.SaveAsInt16Nodes.size()*sizeof(int16_t) +
+                        Group.SaveAsInt8Nodes.size()*sizeof(int8_t) +
+                        Group.SaveAsFloatNodes.size()*sizeof(float) +
+                        Group.SaveAsDoubleNodes.size()*sizeof(double) +
+                        Group.SaveAsFloat16Nodes.size()*sizeof(uint16_t) +
+                        Group.SaveAsScaledInt16Nodes.size()*sizeof(int16_t) +
+                        Group.SaveAsScaledUint16Nodes.size()*sizeof(uint16_t)
+                        );
+    size_t Reduced = std::max(Group.SaveAsFloat16Nodes.size(),std::max(Group.SaveAsScaledInt16Nodes.size(),Group.SaveAsScaledUint16Nodes.size()));
+    if (Reduced > Floats_.size()) {
+      Floats_.resize(Reduced);
+      Halves_.resize(Reduced);
     }
-    SendBinary(DataType_::Uint16Key,Buffer);
-    Buffer.clear();
-    for (size_t j=0; j < SaveAsUint16Nodes_[i]->description.size(); j++) {
-      Buffer.push_back((uint8_t)SaveAsUint16Nodes_[i]->description[j]);
+    PackedSize += BfFrame::Size(Group.PayloadSize);
+    // send meta data to disk
+    if (GroupIndex > 0) {
+      std::vector<uint8_t> Buffer;
+      Buffer.push_back(GroupIndex);
+      Buffer.push_back(Group.Decimation & 0xff);
+      Buffer.push_back(Group.Decimation >> 8);
+      Buffer.insert(Buffer.end(),Group.Name.begin(),Group.Name.end());
+      SendBinary(DataType_::GroupDef,Buffer);
     }
-    SendBinary(DataType_::Uint16Desc,Buffer);
-  }
-  for (size_t i=0; i < SaveAsUint8Nodes_.size();i++) {
-    std::vector<uint8_t> Buffer;
-    for (size_t j=0; j < SaveAsUint8Keys_[i].size(); j++) {
-      Buffer.push_back((uint8_t)SaveAsUint8Keys_[i][j]);
+    for (size_t i=0; i < Group.SaveAsUint64Nodes.size(); i++) {
+      SendMeta(GroupIndex,DataType_::Uint64Key,DataType_::Uint64Desc,Group.SaveAsUint64Keys[i],Group.SaveAsUint64Nodes[i]->description);
     }
-    SendBinary(DataType_::Uint8Key,Buffer);
-    Buffer.clear();
-    for (size_t j=0; j < SaveAsUint8Nodes_[i]->description.size(); j++) {
-      Buffer.push_back((uint8_t)SaveAsUint8Nodes_[i]->description[j]);
+    for (size_t i=0; i < Group.SaveAsUint32Nodes.size(); i++) {
+      SendMeta(GroupIndex,DataType_::Uint32Key,DataType_::Uint32Desc,Group.SaveAsUint32Keys[i],Group.SaveAsUint32Nodes[i]->description);
     }
-    SendBinary(DataType_::Uint8Desc,Buffer);
-  }
-  for (size_t i=0; i < SaveAsInt64Nodes_.size();i++) {
-    std::vector<uint8_t> Buffer;
-    for (size_t j=0; j < SaveAsInt64Keys_[i].size(); j++) {
-      Buffer.push_back((uint8_t)SaveAsInt64Keys_[i][j]);
+    for (size_t i=0; i < Group.SaveAsUint16Nodes.size(); i++) {
+      SendMeta(GroupIndex,DataType_::Uint16Key,DataType_::Uint16Desc,Group.SaveAsUint16Keys[i],Group.SaveAsUint16Nodes[i]->description);
     }
-    SendBinary(DataType_::Int64Key,Buffer);
-    Buffer.clear();
-    for (size_t j=0; j < SaveAsInt64Nodes_[i]->description.size(); j++) {
-      Buffer.push_back((uint8_t)SaveAsInt64Nodes_[i]->description[j]);
+    for (size_t i=0; i < Group.SaveAsUint8Nodes.size(); i++) {
+      SendMeta(GroupIndex,DataType_::Uint8Key,DataType_::Uint8Desc,Group.SaveAsUint8Keys[i],Group.SaveAsUint8Nodes[i]->description);
     }
-    SendBinary(DataType_::Int64Desc,Buffer);
-  }
-  for (size_t i=0; i < SaveAsInt32Nodes_.size();i++) {
-    std::vector<uint8_t> Buffer;
-    for (size_t j=0; j < SaveAsInt32Keys_[i].size(); j++) {
-      Buffer.push_back((uint8_t)SaveAsInt32Keys_[i][j]);
+    for (size_t i=0; i < Group.SaveAsInt64Nodes.size(); i++) {
+      SendMeta(GroupIndex,DataType_::Int64Key,DataType_::Int64Desc,Group.SaveAsInt64Keys[i],Group.SaveAsInt64Nodes[i]->description);
     }
-    SendBinary(DataType_::Int32Key,Buffer);
-    Buffer.clear();
-    for (size_t j=0; j < SaveAsInt32Nodes_[i]->description.size(); j++) {
-      Buffer.push_back((uint8_t)SaveAsInt32Nodes_[i]->description[j]);
+    for (size_t i=0; i < Group.SaveAsInt32Nodes.size(); i++) {
+      SendMeta(GroupIndex,DataType_::Int32Key,DataType_::Int32Desc,Group.SaveAsInt32Keys[i],Group.SaveAsInt32Nodes[i]->description);
     }
-    SendBinary(DataType_::Int32Desc,Buffer);
-  }
-  for (size_t i=0; i < SaveAsInt16Nodes_.size();i++) {
-    std::vector<uint8_t> Buffer;
-    for (size_t j=0; j < SaveAsInt16Keys_[i].size(); j++) {
-      Buffer.push_back((uint8_t)SaveAsInt16Keys_[i][j]);
+    for (size_t i=0; i < Group.SaveAsInt16Nodes.size(); i++) {
+      SendMeta(GroupIndex,DataType_::Int16Key,DataType_::Int16Desc,Group.SaveAsInt16Keys[i],Group.SaveAsInt16Nodes[i]->description);
     }
-    SendBinary(DataType_::Int16Key,Buffer);
-    Buffer.clear();
-    for (size_t j=0; j < SaveAsInt16Nodes_[i]->description.size(); j++) {
-      Buffer.push_back((uint8_t)SaveAsInt16Nodes_[i]->description[j]);
+    for (size_t i=0; i < Group.SaveAsInt8Nodes.size(); i++) {
+      SendMeta(GroupIndex,DataType_::Int8Key,DataType_::Int8Desc,Group.SaveAsInt8Keys[i],Group.SaveAsInt8Nodes[i]->description);
     }
-    SendBinary(DataType_::Int16Desc,Buffer);
-  }
-  for (size_t i=0; i < SaveAsInt8Nodes_.size();i++) {
-    std::vector<uint8_t> Buffer;
-    for (size_t j=0; j < SaveAsInt8Keys_[i].size(); j++) {
-      Buffer.push_back((uint8_t)SaveAsInt8Keys_[i][j]);
+    for (size_t i=0; i < Group.SaveAsFloatNodes.size(); i++) {
+      SendMeta(GroupIndex,DataType_::FloatKey,DataType_::FloatDesc,Group.SaveAsFloatKeys[i],Group.SaveAsFloatNodes[i].getElement()->description);
     }
-    SendBinary(DataType_::Int8Key,Buffer);
-    Buffer.clear();
-    for (size_t j=0; j < SaveAsInt8Nodes_[i]->description.size(); j++) {
-      Buffer.push_back((uint8_t)SaveAsInt8Nodes_[i]->description[j]);
+    for (size_t i=0; i < Group.SaveAsDoubleNodes.size(); i++) {
+      SendMeta(GroupIndex,DataType_::DoubleKey,DataType_::DoubleDesc,Group.SaveAsDoubleKeys[i],Group.SaveAsDoubleNodes[i].getElement()->description);
     }
-    SendBinary(DataType_::Int8Desc,Buffer);
-  }
-  for (size_t i=0; i < SaveAsFloatNodes_.size();i++) {
-    std::vector<uint8_t> Buffer;
-    for (size_t j=0; j < SaveAsFloatKeys_[i].size(); j++) {
-      Buffer.push_back((uint8_t)SaveAsFloatKeys_[i][j]);
+    for (size_t i=0; i < Group.SaveAsFloat16Nodes.size(); i++) {
+      SendMeta(GroupIndex,DataType_::Float16Key,DataType_::Float16Desc,Group.SaveAsFloat16Keys[i],Group.SaveAsFloat16Nodes[i].getElement()->description);
     }
-    SendBinary(DataType_::FloatKey,Buffer);
-    Buffer.clear();
-    for (size_t j=0; j < SaveAsFloatNodes_[i]->description.size(); j++) {
-      Buffer.push_back((uint8_t)SaveAsFloatNodes_[i]->description[j]);
+    for (size_t i=0; i < Group.SaveAsScaledInt16Nodes.size(); i++) {
+      ElementPtr Node = Group.SaveAsScaledInt16Nodes[i].getElement();
+      SendMeta(GroupIndex,DataType_::ScaledInt16Key,DataType_::ScaledInt16Desc,ScaledKey(Group.SaveAsScaledInt16Keys[i],Node),Node->description);
+    }
+    for (size_t i=0; i < Group.SaveAsScaledUint16Nodes.size(); i++) {
+      ElementPtr Node = Group.SaveAsScaledUint16Nodes[i].getElement();
+      SendMeta(GroupIndex,DataType_::ScaledUint16Key,DataType_::ScaledUint16Desc,ScaledKey(Group.SaveAsScaledUint16Keys[i],Node),Node->description);
     }
-    SendBinary(DataType_::FloatDesc,Buffer);
   }
-  for (size_t i=0; i < SaveAsDoubleNodes_.size();i++) {
+  // events are numbered in the order they are sent
+  size_t EventsSize = 0;
+  for (size_t i=0; i < Events_.size(); i++) {
+    Event_ &Event = Events_[i];
     std::vector<uint8_t> Buffer;
-    for (size_t j=0; j < SaveAsDoubleKeys_[i].size(); j++) {
-      Buffer.push_back((uint8_t)SaveAsDoubleKeys_[i][j]);
+    Buffer.push_back(i & 0xff);
+    Buffer.push_back(i >> 8);
+    Buffer.push_back(Event.Type);
+    Buffer.insert(Buffer.end(),Event.Key.begin(),Event.Key.end());
+    SendBinary(DataType_::EventKey,Buffer);
+    Buffer.resize(sizeof(uint16_t));
+    Buffer.insert(Buffer.end(),Event.Desc.begin(),Event.Desc.end());
+    SendBinary(DataType_::EventDesc,Buffer);
+    if (Event.Type == DataType_::StringKey) {
+      Event.Text.reserve(kMaxEventString_);
+      EventsSize += kMaxEventSize_;
+    } else {
+      EventsSize += sizeof(uint16_t) + EventValue(Event,Event.Value);
     }
-    SendBinary(DataType_::DoubleKey,Buffer);
-    Buffer.clear();
-    for (size_t j=0; j < SaveAsDoubleNodes_[i]->description.size(); j++) {
-      Buffer.push_back((uint8_t)SaveAsDoubleNodes_[i]->description[j]);
+  }
+  size_t MaxEventPayload = kUartBufferMaxSize - BfFrame::kOverhead;
+  size_t EventFrames = (Events_.size() > 0) ? 1 + EventsSize/(MaxEventPayload - kEventHeaderSize_ - kMaxEventSize_) : 0;
+  EventBuffer_.reserve(MaxEventPayload);
+  PackedSize += EventsSize + EventFrames*(BfFrame::kOverhead + kEventHeaderSize_);
+  // room for every group and every event to be due in the same frame
+  PackedBuffer_.reserve(PackedSize);
+  PackedSizes_.reserve(Groups_.size() + EventFrames);
+}
+
+/* Adds a signal logged as an event by its log tag, reduced precision signals are logged as floats */
+void DatalogClient::AddEvent(const string &Key, ElementPtr Node) {
+  Event_ Event;
+  Event.Key = Key;
+  Event.Desc = Node->description;
+  Event.Node = Node;
+  log_tag_t log_tag = Node->getLoggingType();
+  if ( log_tag == LOG_UINT64 ) {
+    Event.Type = DataType_::Uint64Key;
+  } else if ( log_tag == LOG_UINT32 ) {
+    Event.Type = DataType_::Uint32Key;
+  } else if ( log_tag == LOG_UINT16 ) {
+    Event.Type = DataType_::Uint16Key;
+  } else if ( log_tag == LOG_UINT8 ) {
+    Event.Type = DataType_::Uint8Key;
+  } else if ( log_tag == LOG_INT64 ) {
+    Event.Type = DataType_::Int64Key;
+  } else if ( log_tag == LOG_INT32 ) {
+    Event.Type = DataType_::Int32Key;
+  } else if ( log_tag == LOG_INT16 ) {
+    Event.Type = DataType_::Int16Key;
+  } else if ( log_tag == LOG_INT8 ) {
+    Event.Type = DataType_::Int8Key;
+  } else if (( log_tag == LOG_FLOAT )||( log_tag == LOG_FLOAT16 )||( log_tag == LOG_SCALED_INT16 )||( log_tag == LOG_SCALED_UINT16 )) {
+    Event.Type = DataType_::FloatKey;
+  } else if ( log_tag == LOG_DOUBLE ) {
+    Event.Type = DataType_::DoubleKey;
+  } else if ( log_tag == LOG_NONE ) {
+    return;
+  } else {
+    cout << "NOTICE: no valid log tag defined for: " << Key << endl;
+    return;
+  }
+  Events_.push_back(Event);
+}
+
+/* Adds a signal to a group by its log tag */
+void DatalogClient::AddSignal(Group_ &Group, const string &Key, ElementPtr Node) {
+  log_tag_t log_tag = Node->getLoggingType();
+  if ( log_tag == LOG_UINT64 ) {
+    Group.SaveAsUint64Keys.push_back(Key);
+    Group.SaveAsUint64Nodes.push_back(Node);
+  } else if ( log_tag == LOG_UINT32 ) {
+    Group.SaveAsUint32Keys.push_back(Key);
+    Group.SaveAsUint32Nodes.push_back(Node);
+  } else if ( log_tag == LOG_UINT16 ) {
+    Group.SaveAsUint16Keys.push_back(Key);
+    Group.SaveAsUint16Nodes.push_back(Node);
+  } else if ( log_tag == LOG_UINT8 ) {
+    Group.SaveAsUint8Keys.push_back(Key);
+    Group.SaveAsUint8Nodes.push_back(Node);
+  } else if ( log_tag == LOG_INT64 ) {
+    Group.SaveAsInt64Keys.push_back(Key);
+    Group.SaveAsInt64Nodes.push_back(Node);
+  } else if ( log_tag == LOG_INT32 ) {
+    Group.SaveAsInt32Keys.push_back(Key);
+    Group.SaveAsInt32Nodes.push_back(Node);
+  } else if ( log_tag == LOG_INT16 ) {
+    Group.SaveAsInt16Keys.push_back(Key);
+    Group.SaveAsInt16Nodes.push_back(Node);
+  } else if ( log_tag == LOG_INT8 ) {
+    Group.SaveAsInt8Keys.push_back(Key);
+    Group.SaveAsInt8Nodes.push_back(Node);
+  } else if ( log_tag == LOG_FLOAT ) {
+    Group.SaveAsFloatKeys.push_back(Key);
+    Group.SaveAsFloatNodes.push_back(deftree.getSignal<float>(Key));
+  } else if ( log_tag == LOG_DOUBLE ) {
+    Group.SaveAsDoubleKeys.push_back(Key);
+    Group.SaveAsDoubleNodes.push_back(deftree.getSignal<double>(Key));
+  } else if ( log_tag == LOG_FLOAT16 ) {
+    Group.SaveAsFloat16Keys.push_back(Key);
+    Group.SaveAsFloat16Nodes.push_back(deftree.getSignal<float>(Key));
+  } else if (( log_tag == LOG_SCALED_INT16 )||( log_tag == LOG_SCALED_UINT16 )) {
+    if (( Node->log_scale == 0.0f )||( !std::isfinite(Node->log_scale) )) {
+      throw std::runtime_error(std::string("ERROR")+RootPath_+std::string(": Log scale of ")+Key+std::string(" must be finite and non-zero."));
     }
-    SendBinary(DataType_::DoubleDesc,Buffer);
+    if ( log_tag == LOG_SCALED_INT16 ) {
+      Group.SaveAsScaledInt16Keys.push_back(Key);
+      Group.SaveAsScaledInt16Nodes.push_back(deftree.getSignal<float>(Key));
+      Group.ScaledInt16Offsets.push_back(Node->log_offset);
+      Group.ScaledInt16InvScales.push_back(1.0f/Node->log_scale);
+    } else {
+      Group.SaveAsScaledUint16Keys.push_back(Key);
+      Group.SaveAsScaledUint16Nodes.push_back(deftree.getSignal<float>(Key));
+      Group.ScaledUint16Offsets.push_back(Node->log_offset);
+      Group.ScaledUint16InvScales.push_back(1.0f/Node->log_scale);
+    }
+  } else if ( log_tag == LOG_NONE ) {
+    // skip
+  } else {
+    cout << "NOTICE: no valid log tag defined for: " << Key << endl;
+  }
+}
+
+/* Sends the key and description of a signal, full rate signals use the original key and description messages */
+void DatalogClient::SendMeta(uint8_t Group, DataType_ KeyType, DataType_ DescType, const string &Key, const string &Desc) {
+  std::vector<uint8_t> Buffer;
+  if (Group == 0) {
+    Buffer.insert(Buffer.end(),Key.begin(),Key.end());
+    SendBinary(KeyType,Buffer);
+    Buffer.clear();
+    Buffer.insert(Buffer.end(),Desc.begin(),Desc.end());
+    SendBinary(DescType,Buffer);
+  } else {
+    Buffer.push_back(Group);
+    Buffer.push_back(KeyType);
+    Buffer.insert(Buffer.end(),Key.begin(),Key.end());
+    SendBinary(DataType_::GroupKey,Buffer);
+    Buffer.clear();
+    Buffer.push_back(Group);
+    Buffer.insert(Buffer.end(),Desc.begin(),Desc.end());
+    SendBinary(DataType_::GroupDesc,Buffer);
+  }
+}
+
+/* Updates a string event, it is logged with the next data if it changed */
+void DatalogClient::LogStringEvent(size_t Event, const std::string &Value) {
+  Event_ &StringEvent = Events_[Event];
+  size_t Length = std::min(Value.size(),(size_t)kMaxEventString_);
+  if (StringEvent.Text.compare(0,std::string::npos,Value,0,Length) != 0) {
+    StringEvent.Text.assign(Value,0,Length);
+    StringEvent.Changed = true;
   }
 }
 
 /* Sends binary data to be logged */
 void DatalogClient::LogBinaryData() {
+  PackBinaryData();
+  SendPackedData();
+}
+
+/* Packs the groups due this frame into frames, sent by SendPackedData */
+void DatalogClient::PackBinaryData() {
+  PackedBuffer_.clear();
+  PackedSizes_.clear();
+  for (size_t i=0; i < Groups_.size(); i++) {
+    Group_ &Group = Groups_[i];
+    if (Group.Count == 0) {
+      PackGroup(i);
+    }
+    if (++Group.Count >= Group.Decimation) {
+      Group.Count = 0;
+    }
+  }
+  if (Events_.size() > 0) {
+    PackEvents();
+  }
+  Packed_ = true;
+}
+
+/* Packs the payload of a group directly into its frame in the packed buffer */
+void DatalogClient::PackGroup(uint8_t GroupIndex) {
+  Group_ &Group = Groups_[GroupIndex];
+  uint8_t *Payload = AddPackedFrame(Group.PayloadSize);
   size_t BufferLocation = 0;
+  if (GroupIndex > 0) {
+    Payload[0] = GroupIndex;
+    uint64_t tmp = TimeNode_->getLong();
+    memcpy(Payload+sizeof(uint8_t),&tmp,sizeof(uint64_t));
+    BufferLocation += kGroupHeaderSize_;
+  }
   // payload
-  for (size_t i=0; i < SaveAsUint64Nodes_.size(); i++) {
-    uint64_t tmp = SaveAsUint64Nodes_[i]->getLong();
-    memcpy(LogDataBuffer_.data()+BufferLocation,&tmp,sizeof(uint64_t));
+  for (size_t i=0; i < Group.SaveAsUint64Nodes.size(); i++) {
+    uint64_t tmp = Group.SaveAsUint64Nodes[i]->getLong();
+    memcpy(Payload+BufferLocation,&tmp,sizeof(uint64_t));
     BufferLocation += sizeof(uint64_t);
   }
-  for (size_t i=0; i < SaveAsUint32Nodes_.size(); i++) {
-    uint32_t tmp = SaveAsUint32Nodes_[i]->getInt();
-    memcpy(LogDataBuffer_.data()+BufferLocation,&tmp,sizeof(uint32_t));
+  for (size_t i=0; i < Group.SaveAsUint32Nodes.size(); i++) {
+    uint32_t tmp = Group.SaveAsUint32Nodes[i]->getInt();
+    memcpy(Payload+BufferLocation,&tmp,sizeof(uint32_t));
     BufferLocation += sizeof(uint32_t);
   }
-  for (size_t i=0; i < SaveAsUint16Nodes_.size(); i++) {
-    uint16_t tmp = SaveAsUint16Nodes_[i]->getInt();
-    memcpy(LogDataBuffer_.data()+BufferLocation,&tmp,sizeof(uint16_t));
+  for (size_t i=0; i < Group.SaveAsUint16Nodes.size(); i++) {
+    uint16_t tmp = Group.SaveAsUint16Nodes[i]->getInt();
+    memcpy(Payload+BufferLocation,&tmp,sizeof(uint16_t));
     BufferLocation += sizeof(uint16_t);
   }
-  for (size_t i=0; i < SaveAsUint8Nodes_.size(); i++) {
-    uint8_t tmp = SaveAsUint8Nodes_[i]->getInt();
-    memcpy(LogDataBuffer_.data()+BufferLocation,&tmp,sizeof(uint8_t));
+  for (size_t i=0; i < Group.SaveAsUint8Nodes.size(); i++) {
+    uint8_t tmp = Group.SaveAsUint8Nodes[i]->getInt();
+    memcpy(Payload+BufferLocation,&tmp,sizeof(uint8_t));
     BufferLocation += sizeof(uint8_t);
   }
-  for (size_t i=0; i < SaveAsInt64Nodes_.size(); i++) {
-    int64_t tmp = SaveAsInt64Nodes_[i]->getLong();
-    memcpy(LogDataBuffer_.data()+BufferLocation,&tmp,sizeof(int64_t));
+  for (size_t i=0; i < Group.SaveAsInt64Nodes.size(); i++) {
+    int64_t tmp = Group.SaveAsInt64Nodes[i]->getLong();
+    memcpy(Payload+BufferLocation,&tmp,sizeof(int64_t));
     BufferLocation += sizeof(int64_t);
   }
-  for (size_t i=0; i < SaveAsInt32Nodes_.size(); i++) {
-    int32_t tmp = SaveAsInt32Nodes_[i]->getInt();
-    memcpy(LogDataBuffer_.data()+BufferLocation,&tmp,sizeof(int32_t));
+  for (size_t i=0; i < Group.SaveAsInt32Nodes.size(); i++) {
+    int32_t tmp = Group.SaveAsInt32Nodes[i]->getInt();
+    memcpy(Payload+BufferLocation,&tmp,sizeof(int32_t));
     BufferLocation += sizeof(int32_t);
   }
-  for (size_t i=0; i < SaveAsInt16Nodes_.size(); i++) {
-    int16_t tmp = SaveAsInt16Nodes_[i]->getInt();
-    memcpy(LogDataBuffer_.data()+BufferLocation,&tmp,sizeof(int16_t));
+  for (size_t i=0; i < Group.SaveAsInt16Nodes.size(); i++) {
+    int16_t tmp = Group.SaveAsInt16Nodes[i]->getInt();
+    memcpy(Payload+BufferLocation,&tmp,sizeof(int16_t));
     BufferLocation += sizeof(int16_t);
   }
-  for (size_t i=0; i < SaveAsInt8Nodes_.size(); i++) {
-    int8_t tmp = SaveAsInt8Nodes_[i]->getInt();
-    memcpy(LogDataBuffer_.data()+BufferLocation,&tmp,sizeof(int8_t));
+  for (size_t i=0; i < Group.SaveAsInt8Nodes.size(); i++) {
+    int8_t tmp = Group.SaveAsInt8Nodes[i]->getInt();
+    memcpy(Payload+BufferLocation,&tmp,sizeof(int8_t));
     BufferLocation += sizeof(int8_t);
   }
-  for (size_t i=0; i < SaveAsFloatNodes_.size(); i++) {
-    float tmp = SaveAsFloatNodes_[i]->getFloat();
-    memcpy(LogDataBuffer_.data()+BufferLocation,&tmp,sizeof(float));
+  for (size_t i=0; i < Group.SaveAsFloatNodes.size(); i++) {
+    float tmp = Group.SaveAsFloatNodes[i].get();
+    memcpy(Payload+BufferLocation,&tmp,sizeof(float));
     BufferLocation += sizeof(float);
   }
-  for (size_t i=0; i < SaveAsDoubleNodes_.size(); i++) {
-    double tmp = SaveAsDoubleNodes_[i]->getDouble();
-    memcpy(LogDataBuffer_.data()+BufferLocation,&tmp,sizeof(double));
+  for (size_t i=0; i < Group.SaveAsDoubleNodes.size(); i++) {
+    double tmp = Group.SaveAsDoubleNodes[i].get();
+    memcpy(Payload+BufferLocation,&tmp,sizeof(double));
     BufferLocation += sizeof(double);
   }
-  // send data
-  SendBinary(DataType_::Data,LogDataBuffer_);
+  // reduced precision signals are gathered and converted together
+  size_t Count = Group.SaveAsFloat16Nodes.size();
+  for (size_t i=0; i < Count; i++) {
+    Floats_[i] = Group.SaveAsFloat16Nodes[i].get();
+  }
+  FloatToHalf(Floats_.data(),Halves_.data(),Count);
+  memcpy(Payload+BufferLocation,Halves_.data(),Count*sizeof(uint16_t));
+  BufferLocation += Count*sizeof(uint16_t);
+  Count = Group.SaveAsScaledInt16Nodes.size();
+  for (size_t i=0; i < Count; i++) {
+    Floats_[i] = Group.SaveAsScaledInt16Nodes[i].get();
+  }
+  FloatToScaledInt16(Floats_.data(),Group.ScaledInt16Offsets.data(),Group.ScaledInt16InvScales.data(),(int16_t *)Halves_.data(),Count);
+  memcpy(Payload+BufferLocation,Halves_.data(),Count*sizeof(int16_t));
+  BufferLocation += Count*sizeof(int16_t);
+  Count = Group.SaveAsScaledUint16Nodes.size();
+  for (size_t i=0; i < Count; i++) {
+    Floats_[i] = Group.SaveAsScaledUint16Nodes[i].get();
+  }
+  FloatToScaledUint16(Floats_.data(),Group.ScaledUint16Offsets.data(),Group.ScaledUint16InvScales.data(),Halves_.data(),Count);
+  memcpy(Payload+BufferLocation,Halves_.data(),Count*sizeof(uint16_t));
+  BufferLocation += Count*sizeof(uint16_t);
+  SealPackedFrame((GroupIndex > 0) ? DataType_::GroupData : DataType_::Data,Group.PayloadSize);
+}
+
+/* Packs the events that changed since they were last logged. Signals are
+checked by their change generation first and then by value, so a signal set
+back to its logged value is not logged again. */
+void DatalogClient::PackEvents() {
+  size_t MaxPayload = kUartBufferMaxSize - BfFrame::kOverhead;
+  uint64_t Time = TimeNode_->getLong();
+  EventBuffer_.resize(kEventHeaderSize_);
+  memcpy(EventBuffer_.data(),&Time,sizeof(uint64_t));
+  for (size_t i=0; i < Events_.size(); i++) {
+    Event_ &Event = Events_[i];
+    size_t Size;
+    if (Event.Type == DataType_::StringKey) {
+      if (!Event.Changed) {
+        continue;
+      }
+      Size = sizeof(uint8_t) + Event.Text.size();
+    } else {
+      uint32_t Generation = Event.Node->getGeneration();
+      if ((!Event.Changed)&&(Generation == Event.Generation)) {
+        continue;
+      }
+      Event.Generation = Generation;
+      uint8_t Value[sizeof(uint64_t)];
+      Size = EventValue(Event,Value);
+      if ((!Event.Changed)&&(memcmp(Value,Event.Value,Size) == 0)) {
+        continue;
+      }
+      memcpy(Event.Value,Value,Size);
+    }
+    Event.Changed = false;
+    // start another frame when this one is full
+    if (EventBuffer_.size() + sizeof(uint16_t) + Size > MaxPayload) {
+      PackFrame(DataType_::EventData,EventBuffer_);
+      EventBuffer_.resize(kEventHeaderSize_);
+    }
+    size_t BufferLocation = EventBuffer_.size();
+    EventBuffer_.resize(BufferLocation + sizeof(uint16_t) + Size);
+    EventBuffer_[BufferLocation] = i & 0xff;
+    EventBuffer_[BufferLocation+1] = i >> 8;
+    BufferLocation += sizeof(uint16_t);
+    if (Event.Type == DataType_::StringKey) {
+      EventBuffer_[BufferLocation] = Event.Text.size();
+      memcpy(EventBuffer_.data()+BufferLocation+sizeof(uint8_t),Event.Text.data(),Event.Text.size());
+    } else {
+      memcpy(EventBuffer_.data()+BufferLocation,Event.Value,Size);
+    }
+  }
+  if (EventBuffer_.size() > kEventHeaderSize_) {
+    PackFrame(DataType_::EventData,EventBuffer_);
+  }
+}
+
+/* Writes the value of a signal event in its logged type, returns its size */
+size_t DatalogClient::EventValue(const Event_ &Event, uint8_t *Value) {
+  switch (Event.Type) {
+    case DataType_::Uint64Key: {
+      uint64_t tmp = Event.Node->getLong();
+      memcpy(Value,&tmp,sizeof(tmp));
+      return sizeof(tmp);
+    }
+    case DataType_::Uint32Key: {
+      uint32_t tmp = Event.Node->getInt();
+      memcpy(Value,&tmp,sizeof(tmp));
+      return sizeof(tmp);
+    }
+    case DataType_::Uint16Key: {
+      uint16_t tmp = Event.Node->getInt();
+      memcpy(Value,&tmp,sizeof(tmp));
+      return sizeof(tmp);
+    }
+    case DataType_::Uint8Key: {
+      uint8_t tmp = Event.Node->getInt();
+      memcpy(Value,&tmp,sizeof(tmp));
+      return sizeof(tmp);
+    }
+    case DataType_::Int64Key: {
+      int64_t tmp = Event.Node->getLong();
+      memcpy(Value,&tmp,sizeof(tmp));
+      return sizeof(tmp);
+    }
+    case DataType_::Int32Key: {
+      int32_t tmp = Event.Node->getInt();
+      memcpy(Value,&tmp,sizeof(tmp));
+      return sizeof(tmp);
+    }
+    case DataType_::Int16Key: {
+      int16_t tmp = Event.Node->getInt();
+      memcpy(Value,&tmp,sizeof(tmp));
+      return sizeof(tmp);
+    }
+    case DataType_::Int8Key: {
+      int8_t tmp = Event.Node->getInt();
+      memcpy(Value,&tmp,sizeof(tmp));
+      return sizeof(tmp);
+    }
+    case DataType_::FloatKey: {
+      float tmp = Event.Node->getFloat();
+      memcpy(Value,&tmp,sizeof(tmp));
+      return sizeof(tmp);
+    }
+    case DataType_::DoubleKey: {
+      double tmp = Event.Node->getDouble();
+      memcpy(Value,&tmp,sizeof(tmp));
+      return sizeof(tmp);
+    }
+    default:
+      return 0;
+  }
+}
+
+/* Appends a frame to the packed buffer, returning where its payload goes. The
+packed buffer is reserved at registration so this does not reallocate. */
+uint8_t *DatalogClient::AddPackedFrame(size_t PayloadSize) {
+  size_t Start = PackedBuffer_.size();
+  PackedBuffer_.resize(Start + BfFrame::Size(PayloadSize));
+  PackedSizes_.push_back(BfFrame::Size(PayloadSize));
+  return BfFrame::Payload(PackedBuffer_.data() + Start);
+}
+
+/* Writes the header and checksum of the last packed frame */
+void DatalogClient::SealPackedFrame(DataType_ Type, size_t PayloadSize) {
+  BfFrame::Seal((uint8_t)Type,PayloadSize,PackedBuffer_.data() + PackedBuffer_.size() - BfFrame::Size(PayloadSize));
+}
+
+/* Frames a payload and appends it to the packed buffer */
+void DatalogClient::PackFrame(DataType_ Type, vector<uint8_t> &Buffer) {
+  memcpy(AddPackedFrame(Buffer.size()),Buffer.data(),Buffer.size());
+  SealPackedFrame(Type,Buffer.size());
+}
+
+/* Sends the packed data frames, may be called from another thread than PackBinaryData */
+void DatalogClient::SendPackedData() {
+  if (Packed_) {
+    size_t Start = 0;
+    for (size_t i=0; i < PackedSizes_.size(); i++) {
+      sendto(DataLogSocket_,PackedBuffer_.data()+Start,PackedSizes_[i],0,(struct sockaddr *)&DataLogServer_,sizeof(DataLogServer_));
+      Start += PackedSizes_[i];
+    }
+    Packed_ = false;
+  }
 }
 
 /* Closes socket and clears states */
 void DatalogClient::End() {
-  SaveAsUint64Keys_.clear();
-  SaveAsUint64Nodes_.clear();
-  SaveAsUint32Keys_.clear();
-  SaveAsUint32Nodes_.clear();
-  SaveAsUint16Keys_.clear();
-  SaveAsUint16Nodes_.clear();
-  SaveAsUint8Keys_.clear();
-  SaveAsUint8Nodes_.clear();
-  SaveAsInt64Keys_.clear();
-  SaveAsInt64Nodes_.clear();
-  SaveAsInt32Keys_.clear();
-  SaveAsInt32Nodes_.clear();
-  SaveAsInt16Keys_.clear();
-  SaveAsInt16Nodes_.clear();
-  SaveAsInt8Keys_.clear();
-  SaveAsInt8Nodes_.clear();
-  SaveAsFloatKeys_.clear();
-  SaveAsFloatNodes_.clear();
-  SaveAsDoubleKeys_.clear();
-  SaveAsDoubleNodes_.clear();
+  Groups_.clear();
+  Groups_.resize(1);
+  Events_.clear();
   close(DataLogSocket_);
 }
 
 /* Sends byte buffer given meta data */
 void DatalogClient::SendBinary(DataType_ Type, std::vector<uint8_t> &Buffer) {
-  std::vector<uint8_t> LogBuffer;
-  LogBuffer.resize(headerLength_ + Buffer.size() + checksumLength_);
-  // header
-  LogBuffer[0] = header_[0];
-  LogBuffer[1] = header_[1];
-  // data source
-  LogBuffer[2] = (uint8_t) Type;
-  // data length
-  LogBuffer[3] = Buffer.size() & 0xff;
-  LogBuffer[4] = Buffer.size() >> 8;
-  // payload
-  std::memcpy(LogBuffer.data()+headerLength_,Buffer.data(),Buffer.size());
-  // checksum
-  CalcChecksum((size_t)(Buffer.size()+headerLength_),LogBuffer.data(),Checksum_);
-  LogBuffer[Buffer.size()+headerLength_] = Checksum_[0];
-  LogBuffer[Buffer.size()+headerLength_+1] = Checksum_[1];
-  // write to UDP
-  sendto(DataLogSocket_,LogBuffer.data(),LogBuffer.size(),0,(struct sockaddr *)&DataLogServer_,sizeof(DataLogServer_));
-}
-
-/* Computes a two byte checksum. */
-void DatalogClient::CalcChecksum(size_t ArraySize, uint8_t *ByteArray, uint8_t *Checksum) {
-  Checksum[0] = 0;
-  Checksum[1] = 0;
-  for (size_t i = 0; i < ArraySize; i++) {
-    Checksum[0] += ByteArray[i];
-    Checksum[1] += Checksum[0];
-  }
-}
-
-/* Initializes the datalogger states, opens a socket for datalogging */
-DatalogServer::DatalogServer() {
-  size_t FileNameCounter = 0;
-  std::string DataLogName;
-  std::string DataLogBaseName = "data";
-  std::string DataLogType = ".bin";
-  DataLogName = DataLogBaseName + std::to_string(FileNameCounter) + DataLogType;
-  while(FileExists(DataLogName)) {
-    FileNameCounter++;
-    DataLogName = DataLogBaseName + std::to_string(FileNameCounter) + DataLogType;
-  }
-  if ((LogFile_ = fopen(DataLogName.c_str(),"wb"))<0) {
-    throw std::runtime_error("Datalog failed to open.");
+  SendBuffer_.resize(BfFrame::Size(Buffer.size()));
+  if (BfFrame::Encode((uint8_t)Type,Buffer.data(),Buffer.size(),SendBuffer_.data(),SendBuffer_.size()) > 0) {
+    // write to UDP
+    sendto(DataLogSocket_,SendBuffer_.data(),SendBuffer_.size(),0,(struct sockaddr *)&DataLogServer_,sizeof(DataLogServer_));
+  }
+}
+
+/* Returns a monotonic time in microseconds */
+static uint64_t Monotonic_us() {
+  struct timespec Time;
+  clock_gettime(CLOCK_MONOTONIC,&Time);
+  return (uint64_t)Time.tv_sec*1000000 + Time.tv_nsec/1000;
+}
+
+/* Syncs the current directory so new and renamed files survive a power loss */
+static void SyncDirectory() {
+  int Directory = open(".",O_RDONLY);
+  if (Directory >= 0) {
+    fsync(Directory);
+    close(Directory);
   }
+}
+
+/* Initializes the datalogger states, opens the first log segment and a socket for datalogging */
+DatalogServer::DatalogServer(bool Compress,size_t SegmentSize,uint32_t SegmentTime_s) {
+  Compress_ = Compress;
+  SegmentSize_ = SegmentSize;
+  SegmentTime_us_ = (uint64_t)SegmentTime_s*1000000;
+  LogNumber_ = NextLogNumber();
+  OpenSegment();
   DataLogSocket_ = socket(AF_INET, SOCK_DGRAM, 0);
   DataLogServer_.sin_family = AF_INET;
   DataLogServer_.sin_port = htons(DataLogPort_);
@@ -351,29 +675,219 @@ DatalogServer::DatalogServer() {
     throw std::runtime_error("Error binding to UDP port.");
   }
   Buffer_.resize(kUartBufferMaxSize);
+  // wake up once a second to write out partly filled blocks or sync the segment
+  struct timeval Timeout;
+  Timeout.tv_sec = 1;
+  Timeout.tv_usec = 0;
+  setsockopt(DataLogSocket_,SOL_SOCKET,SO_RCVTIMEO,&Timeout,sizeof(Timeout));
+  if (Compress_) {
+    for (size_t i=0; i < kBlockBuffers_; i++) {
+      Blocks_[i].reserve(DatalogBlockEncoder::kBlockSize);
+    }
+    Encoded_.reserve(DatalogBlockEncoder::kBlockHeaderSize + DatalogBlockEncoder::kBlockSize);
+    Compressor_ = std::thread(&DatalogServer::CompressLoop,this);
+  }
 }
 
 /* Write received data to log file */
 void DatalogServer::ReceiveBinary() {
   ssize_t MessageSize = recv(DataLogSocket_,Buffer_.data(),Buffer_.size(),0);
-  if (MessageSize > 0) {
+  if (Compress_) {
+    if (MessageSize > 0) {
+      // blocks hold whole frames
+      if (Blocks_[Filling_].size() + MessageSize > DatalogBlockEncoder::kBlockSize) {
+        Flush();
+      }
+      Blocks_[Filling_].insert(Blocks_[Filling_].end(),Buffer_.data(),Buffer_.data()+MessageSize);
+    } else {
+      Flush();
+    }
+  } else if (MessageSize > 0) {
     // write to disk
-    fwrite(Buffer_.data(),MessageSize,1,LogFile_);
-    fflush(LogFile_);
+    Write(Buffer_.data(),MessageSize);
+  } else {
+    Sync();
   }
 }
 
-/* Closes socket and clears states */
-void DatalogServer::End() {
-  close(DataLogSocket_);
+/* Reads the next log number from the index file and stores the one after it.
+Without a usable index the log directory is scanned once for the highest log number. */
+uint32_t DatalogServer::NextLogNumber() {
+  uint32_t LogNumber = 0;
+  bool Indexed = false;
+  if (FILE *Index = fopen(IndexName_.c_str(),"r")) {
+    Indexed = (fscanf(Index,"%u",&LogNumber) == 1);
+    fclose(Index);
+  }
+  // an index older than the logs, restored with an old card image for example,
+  // would point at a log that already exists
+  if (Indexed) {
+    char SegmentName[64];
+    struct stat Info;
+    snprintf(SegmentName,sizeof(SegmentName),"data%u_0000.bin",LogNumber);
+    Indexed = (stat(SegmentName,&Info) != 0);
+  }
+  if (!Indexed) {
+    LogNumber = 0;
+    if (DIR *Directory = opendir(".")) {
+      while (struct dirent *Entry = readdir(Directory)) {
+        unsigned int Number;
+        if (sscanf(Entry->d_name,"data%u",&Number) == 1) {
+          LogNumber = std::max(LogNumber,(uint32_t)Number + 1);
+        }
+      }
+      closedir(Directory);
+    }
+  }
+  // write the index to a temporary file and rename it, so it is never torn
+  std::string TempName = IndexName_ + ".tmp";
+  FILE *Index = fopen(TempName.c_str(),"w");
+  if (Index == NULL) {
+    throw std::runtime_error("Datalog index failed to open.");
+  }
+  fprintf(Index,"%u\n",LogNumber + 1);
+  fflush(Index);
+  fsync(fileno(Index));
+  fclose(Index);
+  if (rename(TempName.c_str(),IndexName_.c_str()) < 0) {
+    throw std::runtime_error("Datalog index failed to update.");
+  }
+  SyncDirectory();
+  return LogNumber;
 }
 
-/* Checks to see if a file exists, returns true if it does and false if it does not */
-bool DatalogServer::FileExists(const std::string &FileName) {
-  if (FILE *file = fopen(FileName.c_str(),"r")) {
-    fclose(file);
-    return true;
-  } else {
-    return false;
+/* Creates and preallocates the next segment of the log and writes its header */
+void DatalogServer::OpenSegment() {
+  char SegmentName[64];
+  snprintf(SegmentName,sizeof(SegmentName),"data%u_%04u.bin",LogNumber_,Sequence_);
+  int File = open(SegmentName,O_WRONLY|O_CREAT|O_EXCL,0644);
+  if (File < 0) {
+    throw std::runtime_error(std::string("Datalog failed to open ")+SegmentName+std::string("."));
+  }
+  // keeping the size lets a reader find the end of the data after a power loss,
+  // file systems without fallocate support just grow the file as it is written
+  fallocate(File,FALLOC_FL_KEEP_SIZE,0,SegmentSize_);
+  if ((LogFile_ = fdopen(File,"wb")) == NULL) {
+    close(File);
+    throw std::runtime_error(std::string("Datalog failed to open ")+SegmentName+std::string("."));
+  }
+  struct timespec Now;
+  clock_gettime(CLOCK_REALTIME,&Now);
+  uint64_t Time_us = (uint64_t)Now.tv_sec*1000000 + Now.tv_nsec/1000;
+  uint16_t Flags = Compress_ ? kSegmentCompressed_ : 0;
+  uint8_t Header[kSegmentHeaderSize_] = {0x42,0x46,0x4c,0x53};
+  Header[4] = kSegmentVersion_ & 0xff;
+  Header[5] = kSegmentVersion_ >> 8;
+  Header[6] = Flags & 0xff;
+  Header[7] = Flags >> 8;
+  for (size_t i=0; i < sizeof(uint32_t); i++) {
+    Header[8+i] = (LogNumber_ >> (8*i)) & 0xff;
+    Header[12+i] = (Sequence_ >> (8*i)) & 0xff;
+  }
+  for (size_t i=0; i < sizeof(uint64_t); i++) {
+    Header[16+i] = (Time_us >> (8*i)) & 0xff;
+  }
+  fwrite(Header,sizeof(Header),1,LogFile_);
+  SegmentHeaderBytes_ = sizeof(Header);
+  // each segment decodes on its own
+  if (Compress_) {
+    fwrite(DatalogBlockEncoder::kFileHeader,sizeof(DatalogBlockEncoder::kFileHeader),1,LogFile_);
+    SegmentHeaderBytes_ += sizeof(DatalogBlockEncoder::kFileHeader);
+  }
+  fflush(LogFile_);
+  fdatasync(File);
+  SyncDirectory();
+  SegmentBytes_ = SegmentHeaderBytes_;
+  SegmentStart_us_ = LastSync_us_ = Monotonic_us();
+  Dirty_ = false;
+  Sequence_++;
+}
+
+/* Syncs and closes the current segment, releasing preallocated space past the data */
+void DatalogServer::CloseSegment() {
+  if (LogFile_ == NULL) {
+    return;
+  }
+  fflush(LogFile_);
+  ftruncate(fileno(LogFile_),SegmentBytes_);
+  fdatasync(fileno(LogFile_));
+  fclose(LogFile_);
+  LogFile_ = NULL;
+}
+
+/* Writes data to the log, starting a new segment first if the current one is full or old enough */
+void DatalogServer::Write(const uint8_t *Data, size_t Size) {
+  uint64_t Now_us = Monotonic_us();
+  if (SegmentBytes_ > SegmentHeaderBytes_) {
+    if ((SegmentBytes_ + Size > SegmentSize_)||((SegmentTime_us_ > 0)&&(Now_us - SegmentStart_us_ >= SegmentTime_us_))) {
+      CloseSegment();
+      OpenSegment();
+    }
+  }
+  fwrite(Data,Size,1,LogFile_);
+  fflush(LogFile_);
+  SegmentBytes_ += Size;
+  Dirty_ = true;
+  if (Compress_||(Now_us - LastSync_us_ >= kSyncPeriod_us_)) {
+    Sync();
+  }
+}
+
+/* Syncs data written to the current segment to disk */
+void DatalogServer::Sync() {
+  if (Dirty_) {
+    fdatasync(fileno(LogFile_));
+    LastSync_us_ = Monotonic_us();
+    Dirty_ = false;
+  }
+}
+
+/* Queues the block being filled for compression, waiting for a free block buffer */
+void DatalogServer::Flush() {
+  if (Blocks_[Filling_].size() == 0) {
+    return;
+  }
+  std::unique_lock<std::mutex> Lock(Mutex_);
+  Cond_.wait(Lock,[this]{return Busy_ < kBlockBuffers_ - 1;});
+  Busy_++;
+  Filling_ = (Filling_ + 1) % kBlockBuffers_;
+  Blocks_[Filling_].clear();
+  Cond_.notify_all();
+}
+
+/* Compresses and writes queued blocks, oldest first */
+void DatalogServer::CompressLoop() {
+  while (1) {
+    size_t Index;
+    {
+      std::unique_lock<std::mutex> Lock(Mutex_);
+      Cond_.wait(Lock,[this]{return (Busy_ > 0)||Stop_;});
+      if (Busy_ == 0) {
+        return;
+      }
+      Index = (Filling_ + kBlockBuffers_ - Busy_) % kBlockBuffers_;
+    }
+    Encoder_.Encode(Blocks_[Index].data(),Blocks_[Index].size(),&Encoded_);
+    Write(Encoded_.data(),Encoded_.size());
+    {
+      std::lock_guard<std::mutex> Lock(Mutex_);
+      Busy_--;
+    }
+    Cond_.notify_all();
+  }
+}
+
+/* Closes socket and clears states */
+void DatalogServer::End() {
+  if (Compress_) {
+    Flush();
+    {
+      std::lock_guard<std::mutex> Lock(Mutex_);
+      Stop_ = true;
+    }
+    Cond_.notify_all();
+    Compressor_.join();
   }
+  CloseSegment();
+  close(DataLogSocket_);
 }
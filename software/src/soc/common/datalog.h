@@ -23,6 +23,9 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 
 #include "definition-tree2.h"
 #include "hardware-defs.h"
+#include "bf_frame.h"
+#include "datalog-compression.h"
+#include "rapidjson/document.h"
 #include <stdio.h>
 #include <fcntl.h>
 #include <unistd.h>
@@ -34,17 +37,59 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include <exception>
 #include <stdexcept>
 #include <cstring>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <arpa/inet.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <time.h>
 
 using std::vector;
 using std::string;
 
+/*
+Datalog client - logs every deftree signal with a log tag. By default all of
+them are written each frame in a single data row. Slowly varying signals can
+be moved into decimation groups, each written as its own record stream, with
+its own time column, every Nth frame. Mode and state signals can be logged as
+events instead, a timestamped record written only when the value changes.
+String events, such as the engaged controller name, are added with
+AddStringEvent and updated each frame with LogStringEvent.
+Example JSON configuration:
+"Datalog": {
+  "Time": "/Sensors/Fmu/Time_us",
+  "Groups": [
+    { "Name": "Slow", "Rate": 1, "Signals": ["/Sensors/uBlox/Year", "/Sensors/Bme280/"] },
+    { "Name": "Mission", "Decimation": 10, "Signals": ["/Mission-Manager/"] }
+  ],
+  "Events": ["/Mission/", "/Sensors/uBlox/Fix", "/Sensors/Sbus/FailSafe"]
+}
+Where:
+   * Time is the signal written as the time column of each group. Optional,
+     defaults to /Sensors/Fmu/Time_us.
+   * Name is the group name, its time column is logged as
+     /Datalog/<Name>/Time_us.
+   * Rate is the group rate in Hz, rounded to a whole number of frames.
+     Decimation writes the group every Nth frame instead. One of the two
+     must be given.
+   * Signals lists keys, or parts of keys, logged in the group. A signal
+     goes into the first group it matches; signals matching no group stay
+     in the full rate row.
+   * Events lists keys, or parts of keys, logged as events. Events are matched
+     before groups. Optional, by default no signals are logged as events.
+*/
 class DatalogClient {
   public:
     DatalogClient();
+    void Configure(const rapidjson::Value& Config,uint32_t FramePeriod_us);
+    size_t AddStringEvent(const std::string &Key, const std::string &Desc);
     void RegisterGlobalData();
+    void LogStringEvent(size_t Event, const std::string &Value);
     void LogBinaryData();
+    void PackBinaryData();
+    void SendPackedData();
     void End();
   private:
     enum DataType_ {
@@ -68,56 +113,170 @@ class DatalogClient {
       Int8Desc,
       FloatDesc,
       DoubleDesc,
-      Data
+      Data,
+      GroupDef,
+      GroupKey,
+      GroupDesc,
+      GroupData,
+      Float16Key,
+      ScaledInt16Key,
+      ScaledUint16Key,
+      Float16Desc,
+      ScaledInt16Desc,
+      ScaledUint16Desc,
+      EventKey,
+      EventDesc,
+      EventData,
+      StringKey
+    };
+    /* signals logged together at one rate, group 0 is the full rate row.
+    Group data payloads start with the group number and the time. */
+    struct Group_ {
+      std::string Name;
+      uint16_t Decimation = 1;
+      uint16_t Count = 0;
+      vector<string> Signals;
+      vector<string> SaveAsUint64Keys;
+      vector<ElementPtr> SaveAsUint64Nodes;
+      vector<string> SaveAsUint32Keys;
+      vector<ElementPtr> SaveAsUint32Nodes;
+      vector<string> SaveAsUint16Keys;
+      vector<ElementPtr> SaveAsUint16Nodes;
+      vector<string> SaveAsUint8Keys;
+      vector<ElementPtr> SaveAsUint8Nodes;
+      vector<string> SaveAsInt64Keys;
+      vector<ElementPtr> SaveAsInt64Nodes;
+      vector<string> SaveAsInt32Keys;
+      vector<ElementPtr> SaveAsInt32Nodes;
+      vector<string> SaveAsInt16Keys;
+      vector<ElementPtr> SaveAsInt16Nodes;
+      vector<string> SaveAsInt8Keys;
+      vector<ElementPtr> SaveAsInt8Nodes;
+      vector<string> SaveAsFloatKeys;
+      vector<Signal<float> > SaveAsFloatNodes;
+      vector<string> SaveAsDoubleKeys;
+      vector<Signal<double> > SaveAsDoubleNodes;
+      vector<string> SaveAsFloat16Keys;
+      vector<Signal<float> > SaveAsFloat16Nodes;
+      vector<string> SaveAsScaledInt16Keys;
+      vector<Signal<float> > SaveAsScaledInt16Nodes;
+      vector<float> ScaledInt16Offsets;
+      vector<float> ScaledInt16InvScales;
+      vector<string> SaveAsScaledUint16Keys;
+      vector<Signal<float> > SaveAsScaledUint16Nodes;
+      vector<float> ScaledUint16Offsets;
+      vector<float> ScaledUint16InvScales;
+      size_t PayloadSize = 0;
+    };
+    static const size_t kGroupHeaderSize_ = sizeof(uint8_t) + sizeof(uint64_t);
+    /* signal or string logged when it changes. Event keys are sent with the
+    event number and value type, event data payloads start with the time
+    followed by the number and value of each event that changed. String
+    values are sent with a one byte length. */
+    struct Event_ {
+      std::string Key;
+      std::string Desc;
+      DataType_ Type;
+      ElementPtr Node;
+      uint32_t Generation = 0;
+      bool Changed = true;
+      uint8_t Value[sizeof(uint64_t)];
+      std::string Text;
     };
+    static const size_t kEventHeaderSize_ = sizeof(uint64_t);
+    static const size_t kMaxEventString_ = UINT8_MAX;
+    static const size_t kMaxEventSize_ = sizeof(uint16_t) + sizeof(uint8_t) + kMaxEventString_;
+    std::string RootPath_ = "/Datalog";
     int DataLogSocket_;
     int DataLogPort_ = 8000;
     struct sockaddr_in DataLogServer_;
-    vector<string> SaveAsUint64Keys_;
-    vector<ElementPtr> SaveAsUint64Nodes_;
-    vector<string> SaveAsUint32Keys_;
-    vector<ElementPtr> SaveAsUint32Nodes_;
-    vector<string> SaveAsUint16Keys_;
-    vector<ElementPtr> SaveAsUint16Nodes_;
-    vector<string> SaveAsUint8Keys_;
-    vector<ElementPtr> SaveAsUint8Nodes_;
-    vector<string> SaveAsInt64Keys_;
-    vector<ElementPtr> SaveAsInt64Nodes_;
-    vector<string> SaveAsInt32Keys_;
-    vector<ElementPtr> SaveAsInt32Nodes_;
-    vector<string> SaveAsInt16Keys_;
-    vector<ElementPtr> SaveAsInt16Nodes_;
-    vector<string> SaveAsInt8Keys_;
-    vector<ElementPtr> SaveAsInt8Nodes_;
-    vector<string> SaveAsFloatKeys_;
-    vector<ElementPtr> SaveAsFloatNodes_;
-    vector<string> SaveAsDoubleKeys_;
-    vector<ElementPtr> SaveAsDoubleNodes_;
-    vector<uint8_t> LogDataBuffer_;
-    vector<uint8_t> Buffer_;
-    const uint8_t header_[2] = {0x42,0x46};
-    const uint8_t headerLength_ = 5;
-    const uint8_t checksumLength_ = 2;
-    uint8_t LengthBuffer_[2];
-    uint16_t Length_ = 0;
-    uint8_t Checksum_[2];
-    uint16_t ParserState_ = 0;
+    vector<Group_> Groups_ = vector<Group_>(1);
+    std::string TimeKey_ = "/Sensors/Fmu/Time_us";
+    ElementPtr TimeNode_;
+    vector<string> EventSignals_;
+    vector<Event_> Events_;
+    vector<uint8_t> EventBuffer_;
+    vector<float> Floats_;
+    vector<uint16_t> Halves_;
+    vector<uint8_t> SendBuffer_;
+    vector<uint8_t> PackedBuffer_;
+    vector<size_t> PackedSizes_;
+    bool Packed_ = false;
+    void AddSignal(Group_ &Group, const string &Key, ElementPtr Node);
+    void SendMeta(uint8_t Group, DataType_ KeyType, DataType_ DescType, const string &Key, const string &Desc);
+    void PackGroup(uint8_t Group);
+    void AddEvent(const string &Key, ElementPtr Node);
+    void PackEvents();
+    uint8_t *AddPackedFrame(size_t PayloadSize);
+    void SealPackedFrame(DataType_ Type, size_t PayloadSize);
+    void PackFrame(DataType_ Type, vector<uint8_t> &Buffer);
+    size_t EventValue(const Event_ &Event, uint8_t *Value);
     void SendBinary(DataType_ Type, vector<uint8_t> &Buffer);
-    void CalcChecksum(size_t ArraySize, uint8_t *ByteArray, uint8_t *Checksum);
 };
 
+/*
+Datalog server - writes the frames received from the datalog client to log
+segments. Each run logs to the next log number, kept in the datalog.idx index
+file so startup does not depend on the number of logs already on the card. A
+missing index, or one pointing at a log that exists, falls back to scanning the
+directory once.
+Log N is written to data<N>_0000.bin, data<N>_0001.bin, ..., starting a new
+segment when the current one reaches the segment size or, if given, the
+segment time. Segments are preallocated and start with a header holding the
+log number and segment sequence number. With compression the frames are
+collected into blocks that a background thread encodes with
+DatalogBlockEncoder and writes, using a fixed number of block buffers. Blocks
+are also written when no data has arrived for a second. Written data is synced
+to disk every block when compressing and at least once a second otherwise, so
+a power loss leaves at most one partly written block or second of frames.
+*/
 class DatalogServer {
   public:
-    DatalogServer();
+    static const size_t kDefaultSegmentSize = 64*1024*1024;
+    DatalogServer(bool Compress=false,size_t SegmentSize=kDefaultSegmentSize,uint32_t SegmentTime_s=0);
     void ReceiveBinary();
     void End();
   private:
-    FILE *LogFile_;
+    static const size_t kBlockBuffers_ = 4;
+    /* segment header: "BFLS", uint16 version, uint16 flags, uint32 log number,
+    uint32 sequence number, uint64 start time (us since the epoch), little endian */
+    static const size_t kSegmentHeaderSize_ = 24;
+    static const uint16_t kSegmentVersion_ = 1;
+    static const uint16_t kSegmentCompressed_ = 0x01;
+    static const uint64_t kSyncPeriod_us_ = 1000000;
+    const std::string IndexName_ = "datalog.idx";
+    FILE *LogFile_ = NULL;
+    uint32_t LogNumber_ = 0;
+    uint32_t Sequence_ = 0;
+    size_t SegmentSize_;
+    uint64_t SegmentTime_us_;
+    size_t SegmentHeaderBytes_ = 0;
+    size_t SegmentBytes_ = 0;
+    uint64_t SegmentStart_us_ = 0;
+    uint64_t LastSync_us_ = 0;
+    bool Dirty_ = false;
     int DataLogSocket_;
     int DataLogPort_ = 8000;
     struct sockaddr_in DataLogServer_;
     vector<uint8_t> Buffer_;
-    bool FileExists(const string &FileName);
+    bool Compress_ = false;
+    // blocks being filled, queued and compressed, used in ring order
+    vector<uint8_t> Blocks_[kBlockBuffers_];
+    size_t Filling_ = 0;
+    size_t Busy_ = 0;
+    bool Stop_ = false;
+    std::thread Compressor_;
+    std::mutex Mutex_;
+    std::condition_variable Cond_;
+    DatalogBlockEncoder Encoder_;
+    vector<uint8_t> Encoded_;
+    uint32_t NextLogNumber();
+    void OpenSegment();
+    void CloseSegment();
+    void Write(const uint8_t *Data, size_t Size);
+    void Sync();
+    void Flush();
+    void CompressLoop();
 };
 
 #endif
@@ -0,0 +1,86 @@
+// definition-tree-snapshot.cpp - lock free snapshots of deftree signals
+
+#include "definition-tree-snapshot.h"
+
+void DefinitionTreeSnapshot::Configure(string Name) {
+  deftree.GetKeys(Name, &keys_);
+  index_.clear();
+  sources_.clear();
+  for ( size_t i = 0; i < keys_.size(); i++ ) {
+    index_[keys_[i]] = i;
+    sources_.push_back(deftree.getElement(keys_[i]));
+  }
+  for ( size_t i = 0; i < 3; i++ ) {
+    buffers_[i].resize(keys_.size());
+    frames_[i] = 0;
+    filled_[i] = false;
+  }
+}
+
+void DefinitionTreeSnapshot::Publish() {
+  vector<Element> &back = buffers_[back_];
+  uint32_t since = generations_[back_];
+  generations_[back_] = deftree.Generation();
+  if ( filled_[back_] ) {
+    for ( size_t i = 0; i < sources_.size(); i++ ) {
+      if ( sources_[i]->changedSince(since) ) {
+        back[i].copyFrom(*sources_[i]);
+      }
+    }
+  } else {
+    for ( size_t i = 0; i < sources_.size(); i++ ) {
+      back[i].copyFrom(*sources_[i]);
+    }
+    filled_[back_] = true;
+  }
+  frames_[back_] = ++frame_;
+  uint8_t prev = middle_.exchange(back_ | kFresh, std::memory_order_acq_rel);
+  back_ = prev & kIndexMask;
+}
+
+bool DefinitionTreeSnapshot::Update() {
+  if ( !(middle_.load(std::memory_order_relaxed) & kFresh) ) {
+    return false;
+  }
+  uint8_t prev = middle_.exchange(front_, std::memory_order_acq_rel);
+  front_ = prev & kIndexMask;
+  return true;
+}
+
+uint64_t DefinitionTreeSnapshot::Frame() {
+  return frames_[front_];
+}
+
+size_t DefinitionTreeSnapshot::Size() {
+  return keys_.size();
+}
+
+/* Gets list of snapshot member keys at a given tree level */
+void DefinitionTreeSnapshot::GetKeys(string Name, vector<string> *KeysPtr) {
+  KeysPtr->clear();
+  for ( auto const& key : keys_ ) {
+    if ( key.find(Name) != string::npos ) {
+      KeysPtr->push_back(key);
+    }
+  }
+}
+
+Element *DefinitionTreeSnapshot::getElement(string name) {
+  map<string, size_t>::iterator it;
+  it = index_.find(name);
+  if ( it != index_.end() ) {
+    return &buffers_[front_][it->second];
+  } else {
+    return NULL;
+  }
+}
+
+int DefinitionTreeSnapshot::Index(string name) {
+  map<string, size_t>::iterator it;
+  it = index_.find(name);
+  if ( it != index_.end() ) {
+    return it->second;
+  } else {
+    return -1;
+  }
+}
@@ -0,0 +1,63 @@
+// definition-tree-snapshot.h - lock free snapshots of deftree signals
+//
+// The flight loop publishes a copy of the selected signals at the end
+// of each frame and a single consumer on another thread reads the
+// latest complete frame. Publishing and reading never block and a
+// reader never sees a partially written frame. Values are held in a
+// triple buffer: the writer fills the back buffer and swaps it with
+// the middle buffer, the reader swaps the middle buffer into the front
+// when a newer frame is waiting. Each consumer owns its own snapshot.
+// A buffer only needs the signals that changed since it was last
+// filled, found from the deftree change generations.
+
+#pragma once
+
+#include "definition-tree2.h"
+#include <atomic>
+
+class DefinitionTreeSnapshot {
+
+ public:
+
+  DefinitionTreeSnapshot() {}
+  ~DefinitionTreeSnapshot() {}
+
+  // selects all deftree signals with keys containing Name, call
+  // after configuration and before the first Publish()
+  void Configure(string Name);
+
+  // writer side, copies the selected signals and publishes the frame
+  void Publish();
+
+  // reader side, latches the newest published frame, returns false
+  // if no new frame has been published since the last call
+  bool Update();
+
+  // reader side accessors for the latched frame
+  uint64_t Frame();
+  size_t Size();
+  void GetKeys(string Name, vector<string> *KeysPtr);
+  Element *getElement(string name);
+
+  // resolve a key once and read it by index afterwards, Index()
+  // returns -1 if the key is not part of the snapshot
+  int Index(string name);
+  Element *getElement(size_t index) { return &buffers_[front_][index]; }
+
+ private:
+
+  static const uint8_t kIndexMask = 0x03;
+  static const uint8_t kFresh = 0x04;
+
+  vector<string> keys_;
+  map<string, size_t> index_;
+  vector<ElementPtr> sources_;
+  vector<Element> buffers_[3];
+  uint64_t frames_[3] = {0, 0, 0};
+  uint32_t generations_[3] = {0, 0, 0};
+  bool filled_[3] = {false, false, false};
+  uint64_t frame_ = 0;
+  uint8_t back_ = 0;
+  uint8_t front_ = 1;
+  std::atomic<uint8_t> middle_{2};
+};
@@ -10,6 +10,8 @@ using std::make_shared;
 // create a global instance of the deftree
 DefinitionTree2 deftree;
 
+std::atomic<uint32_t> Element::generation{0};
+
 ElementPtr DefinitionTree2::initElement(string name, string desc,
                                         log_tag_t datalog,
                                         log_tag_t telemetry)
@@ -21,17 +23,40 @@ ElementPtr DefinitionTree2::initElement(string name, string desc,
     it->second->description = desc;
     it->second->datalog = datalog;
     it->second->telemetry = telemetry;
+    checkType(name, it->second);
     return it->second;
   } else {
     ElementPtr ele = make_shared<Element>();
     ele->description = desc;
     ele->datalog = datalog;
     ele->telemetry = telemetry;
+    checkType(name, ele);
     data[name] = ele;
     return ele;
   }
 }
 
+ElementPtr DefinitionTree2::initElement(string name, string desc,
+                                        log_tag_t datalog,
+                                        log_tag_t telemetry,
+                                        float log_scale, float log_offset)
+{
+  ElementPtr ele = initElement(name, desc, datalog, telemetry);
+  ele->log_scale = log_scale;
+  ele->log_offset = log_offset;
+  return ele;
+}
+
+// fix the published type, which must agree with any typed handle
+// already taken on the element
+void DefinitionTree2::checkType(string name, ElementPtr ele) {
+  if ( !ele->setTypeFromLogging() ) {
+    string published = ( ele->datalog == LOG_DOUBLE ) ? "double" : "float";
+    throw std::runtime_error("ERROR: def-tree element " + name + " is "
+                             + ele->getType() + ", published as " + published);
+  }
+}
+
 ElementPtr DefinitionTree2::getElement(string name, bool create) {
   def_tree_t::iterator it;
   it = data.find(name);
@@ -57,6 +82,17 @@ void DefinitionTree2::GetKeys(string Name, vector<string> *KeysPtr) {
   }
 }
 
+/* Gets list of definition tree member keys at a given tree level that
+changed in or after a given generation */
+void DefinitionTree2::GetChanged(string Name, uint32_t Since, vector<string> *KeysPtr) {
+  KeysPtr->clear();
+  for (auto const& element : data) {
+    if (element.second->changedSince(Since) && element.first.find(Name) != string::npos) {
+      KeysPtr->push_back(element.first);
+    }
+  }
+}
+
 /* Gets number of definition tree members at a given tree level */
 size_t DefinitionTree2::Size(string Name) {
   size_t retval = 0;
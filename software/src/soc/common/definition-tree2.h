@@ -8,6 +8,8 @@
 #include <memory>
 #include <iostream>
 #include <string>
+#include <stdexcept>
+#include <atomic>
 
 using std::map;
 using std::string;
@@ -26,15 +28,27 @@ enum log_tag_t {
   LOG_INT16, LOG_UINT16,
   LOG_INT32, LOG_UINT32,
   LOG_INT64, LOG_UINT64, LOG_LONG,
-  LOG_FLOAT, LOG_DOUBLE
+  LOG_FLOAT, LOG_DOUBLE,
+  // float signals logged with reduced precision: IEEE half precision,
+  // or round((value - log_offset) / log_scale) as a 16 bit integer
+  LOG_FLOAT16, LOG_SCALED_INT16, LOG_SCALED_UINT16
 };
     
 class Element {
 
- private:
+ public:
 
   // supported types
-  enum { NONE, BOOL, INT, LONGLONG, FLOAT, DOUBLE } tag;
+  enum Type { NONE, BOOL, INT, LONGLONG, FLOAT, DOUBLE };
+
+ private:
+
+  Type tag = NONE;
+
+  // once the type is fixed (by initElement or a Signal handle) the
+  // setters convert to it rather than changing it, so typed handles
+  // can keep pointing into the union
+  bool fixed = false;
 
   union {
     bool b;
@@ -44,25 +58,115 @@ class Element {
     double d;
   } x = {0};
 
+  // generation of the last write that changed the value or type.
+  // Setters compare first so signals rewritten with the same value
+  // every frame do not show up as changed.
+  uint32_t changed = 0;
+
+  template <typename T> void assign( T &slot, T val, Type type ) {
+    if ( slot != val || tag != type ) {
+      slot = val;
+      tag = type;
+      touch();
+    }
+  }
+
+  template <typename T> void store( T val ) {
+    switch(tag) {
+    case BOOL: assign(x.b, (bool)val, BOOL); break;
+    case INT: assign(x.i, (int)val, INT); break;
+    case LONGLONG: assign(x.ll, (long long)val, LONGLONG); break;
+    case FLOAT: assign(x.f, (float)val, FLOAT); break;
+    case DOUBLE: assign(x.d, (double)val, DOUBLE); break;
+    default: break;
+    }
+  }
+
+  void storeFrom( const Element &src ) {
+    switch(src.tag) {
+    case BOOL: store(src.x.b); break;
+    case INT: store(src.x.i); break;
+    case LONGLONG: store(src.x.ll); break;
+    case FLOAT: store(src.x.f); break;
+    case DOUBLE: store(src.x.d); break;
+    default: break;
+    }
+  }
+
  public:
     
   string description;
   log_tag_t datalog{LOG_NONE};
   log_tag_t telemetry{LOG_NONE};
+  float log_scale{1.0f};
+  float log_offset{0.0f};
     
   Element() {}
   ~Element() {}
 
   void copyFrom( ElementPtr src ) {
-    this->x = src->x;
-    this->tag = src->tag;
+    copyFrom(*src);
+  }
+  void copyFrom( const Element &src ) {
+    if ( fixed ) {
+      storeFrom(src);
+    } else if ( x.ll != src.x.ll || tag != src.tag ) {
+      this->x = src.x;
+      this->tag = src.tag;
+      touch();
+    }
   }
   
-  void setBool( bool val ) { x.b = val; tag = BOOL; }
-  void setInt( int val ) { x.i = val; tag = INT; }
-  void setLong( long long val ) { x.ll = val; tag = LONGLONG; }
-  void setFloat( float val ) { x.f = val; tag = FLOAT; }
-  void setDouble( double val ) { x.d = val; tag = DOUBLE; }
+  void setBool( bool val ) { if ( fixed ) { store(val); } else { assign(x.b, val, BOOL); } }
+  void setInt( int val ) { if ( fixed ) { store(val); } else { assign(x.i, val, INT); } }
+  void setLong( long long val ) { if ( fixed ) { store(val); } else { assign(x.ll, val, LONGLONG); } }
+  void setFloat( float val ) { if ( fixed ) { store(val); } else { assign(x.f, val, FLOAT); } }
+  void setDouble( double val ) { if ( fixed ) { store(val); } else { assign(x.d, val, DOUBLE); } }
+
+  // change tracking.  The deftree generation is advanced once per
+  // frame, a consumer remembers the generation when it last read and
+  // asks what changed since.  Writes later in that same generation
+  // still count as changed, so nothing is missed at the cost of an
+  // occasional element reported twice.
+  static std::atomic<uint32_t> generation;
+  void touch() { changed = generation.load(std::memory_order_relaxed); }
+  uint32_t getGeneration() { return changed; }
+  bool changedSince( uint32_t gen ) { return (int32_t)(changed - gen) >= 0; }
+
+  // fix the type, converting the current value.  Returns false if it
+  // was already fixed to a different type.
+  bool setType( Type type ) {
+    if ( fixed ) {
+      return tag == type;
+    }
+    Element old;
+    old.x = x;
+    old.tag = tag;
+    x.ll = 0;
+    tag = type;
+    fixed = true;
+    storeFrom(old);
+    return true;
+  }
+
+  // float and double signals are fixed to their logged type, the
+  // integer ones stay loose since some carry float values
+  bool setTypeFromLogging() {
+    switch(datalog) {
+    case LOG_FLOAT:
+    case LOG_FLOAT16:
+    case LOG_SCALED_INT16:
+    case LOG_SCALED_UINT16: return setType(FLOAT);
+    case LOG_DOUBLE: return setType(DOUBLE);
+    default: return true;
+    }
+  }
+
+  bool isFixed() { return fixed; }
+
+  // pointer to the value as type T, fixing the type first.  nullptr
+  // if the element is fixed to another type.
+  template <typename T> T *getPointer();
 
   bool getBool() {
     switch(tag) {
@@ -115,8 +219,12 @@ class Element {
     }
   }
 
-  string getType() {
-    switch(tag) {
+  Type getTag() { return tag; }
+
+  string getType() { return getTypeName(tag); }
+
+  static string getTypeName( Type type ) {
+    switch(type) {
     case BOOL: return "bool";
     case INT: return "int";
     case LONGLONG: return "long";
@@ -146,6 +254,48 @@ class Element {
   }
 };
 
+template <typename T> struct ElementType;
+template <> struct ElementType<bool> { static const Element::Type type = Element::BOOL; };
+template <> struct ElementType<int> { static const Element::Type type = Element::INT; };
+template <> struct ElementType<long long> { static const Element::Type type = Element::LONGLONG; };
+template <> struct ElementType<float> { static const Element::Type type = Element::FLOAT; };
+template <> struct ElementType<double> { static const Element::Type type = Element::DOUBLE; };
+
+template <typename T> T *Element::getPointer() {
+  if ( !setType(ElementType<T>::type) ) {
+    return nullptr;
+  }
+  // every union member starts at the union's address
+  return reinterpret_cast<T *>(&x);
+}
+
+// Typed handle on an element, resolved and type checked when it is
+// created so get() and set() are a plain load and store.
+template <typename T>
+class Signal {
+
+ public:
+
+  Signal() {}
+  Signal( ElementPtr ele, T *ptr ): ele(ele), ptr(ptr) {}
+
+  inline T get() const { return *ptr; }
+  inline void set( T val ) {
+    if ( *ptr != val ) {
+      *ptr = val;
+      ele->touch();
+    }
+  }
+
+  ElementPtr getElement() const { return ele; }
+  bool isBound() const { return ptr != nullptr; }
+
+ private:
+
+  ElementPtr ele;
+  T *ptr = nullptr;
+};
+
 typedef map<string, ElementPtr> def_tree_t ;
 
 class DefinitionTree2 {
@@ -159,17 +309,54 @@ class DefinitionTree2 {
   ElementPtr initElement(string name, string desc,
                        log_tag_t datalog,
                        log_tag_t telemetry);
+  // for LOG_SCALED_INT16 and LOG_SCALED_UINT16 signals
+  ElementPtr initElement(string name, string desc,
+                       log_tag_t datalog,
+                       log_tag_t telemetry,
+                       float log_scale, float log_offset);
   ElementPtr getElement(string name, bool create=true);
 
+  // typed handles for publishers and subscribers, throwing if the
+  // element's type is already fixed to another one
+  template <typename T>
+  Signal<T> initSignal(string name, string desc,
+                       log_tag_t datalog,
+                       log_tag_t telemetry) {
+    return bindSignal<T>(name, initElement(name, desc, datalog, telemetry));
+  }
+  template <typename T>
+  Signal<T> getSignal(string name) {
+    return bindSignal<T>(name, getElement(name));
+  }
+
   void GetKeys(string Name, vector<string> *KeysPtr);
+  // keys containing Name changed in or after generation Since
+  void GetChanged(string Name, uint32_t Since, vector<string> *KeysPtr);
   size_t Size(string Name);
   void PrettyPrint(string Prefix);
 
   void Erase(string name);
+
+  // advance once per frame before the signals are written
+  void NextGeneration() { Element::generation.fetch_add(1, std::memory_order_relaxed); }
+  uint32_t Generation() { return Element::generation.load(std::memory_order_relaxed); }
     
  private:
     
   def_tree_t data;
+
+  void checkType(string name, ElementPtr ele);
+
+  template <typename T>
+  Signal<T> bindSignal(string name, ElementPtr ele) {
+    T *ptr = ele->getPointer<T>();
+    if ( ptr == nullptr ) {
+      throw std::runtime_error("ERROR: def-tree element " + name + " is "
+                               + ele->getType() + ", not "
+                               + Element::getTypeName(ElementType<T>::type));
+    }
+    return Signal<T>(ele, ptr);
+  }
 };
 
 // reference a global instance of the deftree
@@ -94,17 +94,16 @@ void AircraftEffectors::Configure(const rapidjson::Value& Config) {
       throw std::runtime_error(std::string("ERROR")+RootPath_+std::string(": Type not specified in configuration."));
     }
   }
+  Commands_.resize(input_nodes.size());
   Configured_ = true;
 }
 
 /* Run method for effectors, dereferences the inputs and returns a vector of effector commands to send to the FMU */
-std::vector<float> AircraftEffectors::Run() {
-  std::vector<float> Commands;
-  Commands.resize(input_nodes.size());
+const std::vector<float> &AircraftEffectors::Run() {
   for (size_t i=0; i < input_nodes.size(); i++) {
-    Commands[i] = input_nodes[i]->getFloat();
+    Commands_[i] = input_nodes[i]->getFloat();
   }
-  return Commands;
+  return Commands_;
 }
 
 /* Returns whether the class has been configured */
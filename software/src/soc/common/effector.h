@@ -42,12 +42,13 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 class AircraftEffectors {
   public:
     void Configure(const rapidjson::Value& Config);
-    std::vector<float> Run();
+    const std::vector<float> &Run();
     bool Configured();
   private:
     std::string RootPath_ = "/Effectors";
     bool Configured_ = false;
     std::vector<ElementPtr> input_nodes;
+    std::vector<float> Commands_;
 };
 
 #endif
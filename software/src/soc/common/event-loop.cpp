@@ -0,0 +1,78 @@
+// event-loop.cpp - epoll based i/o reactor
+
+#include "event-loop.h"
+
+#include <errno.h>
+#include <unistd.h>
+#include <stdexcept>
+
+EventLoop::EventLoop() {
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if ( epoll_fd_ < 0 ) {
+    throw std::runtime_error("ERROR: Unable to create event loop.");
+  }
+}
+
+EventLoop::~EventLoop() {
+  close(epoll_fd_);
+}
+
+bool EventLoop::Add(int Fd, uint32_t Events, Handler Callback) {
+  if ( Fd < 0 ) {
+    return false;
+  }
+  if ( registrations_.count(Fd) ) {
+    Remove(Fd);
+  }
+  std::unique_ptr<Registration> reg(new Registration);
+  reg->Fd = Fd;
+  reg->Active = true;
+  reg->Callback = Callback;
+  epoll_event ev;
+  ev.events = Events;
+  ev.data.ptr = reg.get();
+  if ( epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, Fd, &ev) < 0 ) {
+    return false;
+  }
+  registrations_[Fd] = std::move(reg);
+  return true;
+}
+
+bool EventLoop::Modify(int Fd, uint32_t Events) {
+  auto it = registrations_.find(Fd);
+  if ( it == registrations_.end() ) {
+    return false;
+  }
+  epoll_event ev;
+  ev.events = Events;
+  ev.data.ptr = it->second.get();
+  return epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, Fd, &ev) == 0;
+}
+
+void EventLoop::Remove(int Fd) {
+  auto it = registrations_.find(Fd);
+  if ( it == registrations_.end() ) {
+    return;
+  }
+  // fails harmlessly if the descriptor was already closed, which
+  // removes it from the epoll set
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, Fd, NULL);
+  it->second->Active = false;
+  removed_.push_back(std::move(it->second));
+  registrations_.erase(it);
+}
+
+int EventLoop::Run(int Timeout_ms) {
+  int num = epoll_wait(epoll_fd_, ready_, kMaxEvents, Timeout_ms);
+  if ( num < 0 ) {
+    return (errno == EINTR) ? 0 : -1;
+  }
+  for ( int i = 0; i < num; i++ ) {
+    Registration *reg = (Registration *)ready_[i].data.ptr;
+    if ( reg->Active ) {
+      reg->Callback(ready_[i].events);
+    }
+  }
+  removed_.clear();
+  return num;
+}
@@ -0,0 +1,65 @@
+// event-loop.h - epoll based i/o reactor
+//
+// File descriptors are registered once with the events of interest
+// and a handler. Run() makes a single wait on all of them and calls
+// the handler of each descriptor that became ready, so the cost of an
+// iteration depends on the number of ready descriptors rather than on
+// the number registered. Descriptors may be registered level or edge
+// triggered (EPOLLET); edge triggered handlers must drain the
+// descriptor or re-arm it with Modify(). Handlers may add, modify and
+// remove registrations, including their own, while being dispatched.
+// An event loop is owned and run by a single thread.
+
+#pragma once
+
+#include <sys/epoll.h>
+#include <stdint.h>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class EventLoop {
+
+ public:
+
+  typedef std::function<void(uint32_t Events)> Handler;
+
+  EventLoop();
+  ~EventLoop();
+
+  // registers Fd for Events (EPOLLIN, EPOLLOUT, EPOLLET, ...), an
+  // existing registration of Fd is replaced
+  bool Add(int Fd, uint32_t Events, Handler Callback);
+
+  // changes the events Fd is waited on for, also re-arms an edge
+  // triggered descriptor that is still ready
+  bool Modify(int Fd, uint32_t Events);
+
+  // removes Fd, call before closing the descriptor
+  void Remove(int Fd);
+
+  // waits up to Timeout_ms (-1 waits forever) for any registered
+  // descriptor to become ready and dispatches its handler, returns the
+  // number of descriptors dispatched or -1 on error
+  int Run(int Timeout_ms);
+
+  size_t Size() { return registrations_.size(); }
+
+ private:
+
+  struct Registration {
+    int Fd;
+    bool Active;
+    Handler Callback;
+  };
+
+  static const int kMaxEvents = 32;
+
+  int epoll_fd_;
+  epoll_event ready_[kMaxEvents];
+  std::unordered_map<int, std::unique_ptr<Registration>> registrations_;
+  // removed registrations are kept until the current dispatch is done
+  // since a pending event may still point at them
+  std::vector<std::unique_ptr<Registration>> removed_;
+};
@@ -32,8 +32,8 @@ void GeneralFilter::Configure(const rapidjson::Value& Config,std::string RootPat
   // get the input
   if (Config.HasMember("Input")) {
     InputKey_ = Config["Input"].GetString();
-    config_.input_node = deftree.getElement(InputKey_);
-    if ( !config_.input_node ) {
+    config_.input_node = deftree.getSignal<float>(InputKey_);
+    if ( !config_.input_node.isBound() ) {
       throw std::runtime_error(std::string("ERROR")+OutputName+std::string(": Input ")+InputKey_+std::string(" not found in global data."));
     }
   } else {
@@ -61,7 +61,7 @@ void GeneralFilter::Configure(const rapidjson::Value& Config,std::string RootPat
   
   // pointer to log command data
   OutputKey_ = RootPath+"/"+Config["Output"].GetString();
-  data_.output_node = deftree.initElement(OutputKey_, "Control law output", LOG_FLOAT, LOG_NONE);
+  data_.output_node = deftree.initSignal<float>(OutputKey_, "Control law output", LOG_FLOAT, LOG_NONE);
 
   // configure filter
   filter_.Configure(b,a);
@@ -75,13 +75,13 @@ bool GeneralFilter::Initialized() {
 
 void GeneralFilter::Run(Mode mode) {
   data_.Mode->setInt(mode);
-  data_.output_node->setFloat( filter_.Run(config_.input_node->getFloat()) );
+  data_.output_node.set( filter_.Run(config_.input_node.get()) );
 }
 
 void GeneralFilter::Clear() {
   filter_.Clear();
   data_.Mode->setInt(kStandby);
-  data_.output_node->setFloat(0.0f);
+  data_.output_node.set(0.0f);
   deftree.Erase(ModeKey_);
   deftree.Erase(OutputKey_);
   InputKey_.clear();
@@ -59,11 +59,11 @@ class GeneralFilter: public GenericFunction {
     void Clear();
   private:
     struct Config {
-      ElementPtr input_node;
+      Signal<float> input_node;
     };
     struct Data {
       ElementPtr Mode;
-      ElementPtr output_node;
+      Signal<float> output_node;
     };
     __GeneralFilter filter_;
     Config config_;
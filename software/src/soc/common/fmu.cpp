@@ -19,63 +19,62 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 */
 
 #include "fmu.h"
+#include "messages.h"
 
 #include <string>
+#include <algorithm>
 using std::to_string;
 using std::cout;
 using std::endl;
 
-/* Opens port to communicate with FMU. */
-void FlightManagementUnit::Begin() {
-  _serial = new HardwareSerial(Port_);
+/* Opens port to communicate with FMU, the FMU serial port unless another is given. */
+void FlightManagementUnit::Begin(std::string Port) {
+  _serial = new HardwareSerial(Port);
   _bus = new SerialLink(*_serial);
   _bus->begin(Baud_);
+  // sized once so receiving a frame does not allocate
+  Payload_.reserve(BUFFER_SIZE);
 }
 
 /* Updates FMU configuration given a JSON value and registers data with global defs */
 void FlightManagementUnit::Configure(const rapidjson::Value& Config) {
-  std::vector<uint8_t> Payload;
-
-  // switch FMU to configuration mode
-  SendModeCommand(kConfigMode);
-
-  // clear the serial buffer
-  _bus->checkReceived();
-  while (_bus->available()>0) {
-    _bus->read();
-    _bus->checkReceived();
-  }
-
-  // configure FMU sensors
+  // build the FMU configuration sections, each is sent as its own message
+  std::vector<std::string> Sections;
   if (Config.HasMember("Sensors")) {
-    std::cout << "\t\tSending Sensors config to FMU..." << std::flush;
-    ConfigureSensors(Config["Sensors"]);
-    std::cout << "done!" << std::endl;
+    ConfigureSensors(Config["Sensors"],&Sections);
   }
-
-  // configuring FMU mission manager
   if (Config.HasMember("Mission-Manager")) {
-    std::cout << "\t\tSending Mission-Manager config to FMU..." << std::flush;
-    ConfigureMissionManager(Config["Mission-Manager"]);
-    std::cout << "done!" << std::endl;
+    ConfigureMissionManager(Config["Mission-Manager"],&Sections);
   }
-
-  // configuring FMU control laws
   if (Config.HasMember("Control")) {
-    std::cout << "\t\tSending Control config to FMU..." << std::flush;
-    ConfigureControlLaws(Config["Control"]);
-    std::cout << "done!" << std::endl;
+    ConfigureControlLaws(Config["Control"],&Sections);
   }
-
-  // configuring FMU effectors
   if (Config.HasMember("Effectors")) {
-    std::cout << "\t\tSending Effector config to FMU..." << std::flush;
-    ConfigureEffectors(Config["Effectors"]);
-    std::cout << "done!" << std::endl;
+    ConfigureEffectors(Config["Effectors"],&Sections);
+  }
+  std::vector<uint32_t> SectionHashes;
+  for (size_t i=0; i < Sections.size(); i++) {
+    SectionHashes.push_back(fnv1a32((const unsigned char *)Sections[i].data(),Sections[i].size()));
   }
 
-  // switch FMU to run mode
-  SendModeCommand(kRunMode);
+  // compare with the configuration the FMU is running, an empty request returns the applied hashes
+  std::cout << "\t\tQuerying FMU configuration..." << std::flush;
+  std::vector<uint32_t> Query, FmuHashes;
+  bool Unchanged = ExchangeConfigHashes(Query,&FmuHashes)&&(SectionHashes.size() > 0)&&(FmuHashes == SectionHashes);
+  std::cout << "done!" << std::endl;
+
+  if (Unchanged) {
+    std::cout << "\t\tFMU configuration unchanged, skipping upload." << std::endl;
+  } else {
+    // the FMU reports back only the sections it applied, any it missed are uploaded again
+    size_t Attempt = 0;
+    while (!UploadConfig(Sections,SectionHashes)) {
+      if (++Attempt >= ConfigUploadAttempts_) {
+        throw std::runtime_error(std::string("ERROR")+RootPath_+std::string(": FMU did not apply the configuration."));
+      }
+      std::cout << "\t\tFMU did not apply every section, retrying." << std::endl;
+    }
+  }
 
   // get the updated configuration from the sensor meta data
   std::cout << "\t\tReading Sensors config back from FMU..." << std::flush;
@@ -95,6 +94,67 @@ void FlightManagementUnit::Configure(const rapidjson::Value& Config) {
   }
 }
 
+/* Uploads the configuration sections the FMU does not have cached and applies them, returns false if
+the FMU reports a different applied configuration */
+bool FlightManagementUnit::UploadConfig(const std::vector<std::string> &Sections,std::vector<uint32_t> &SectionHashes) {
+  // switch FMU to configuration mode
+  SendModeCommand(kConfigMode);
+
+  // clear the serial buffer
+  _bus->checkReceived();
+  while (_bus->available()>0) {
+    _bus->read();
+    _bus->checkReceived();
+  }
+
+  // send the section hashes, the FMU returns the ones it does not have cached
+  std::vector<uint32_t> MissingHashes;
+  bool Hashing = ExchangeConfigHashes(SectionHashes,&MissingHashes);
+  if (!Hashing) {
+    // FMU does not support content hashing, send everything
+    MissingHashes = SectionHashes;
+  }
+
+  // upload the missing sections
+  size_t Sent = 0;
+  std::cout << "\t\tSending config to FMU..." << std::flush;
+  for (size_t i=0; i < Sections.size(); i++) {
+    if (std::find(MissingHashes.begin(),MissingHashes.end(),SectionHashes[i]) != MissingHashes.end()) {
+      std::vector<uint8_t> Payload(Sections[i].begin(),Sections[i].end());
+      SendMessage(Message::kConfigMesg,Payload);
+      Sent++;
+    }
+  }
+  std::cout << "done! (" << Sent << " of " << Sections.size() << " sections)" << std::endl;
+
+  // switch FMU to run mode
+  SendModeCommand(kRunMode);
+
+  // check what was applied, firmware without hashing cannot tell
+  std::vector<uint32_t> Query, FmuHashes;
+  return (!Hashing)||(ExchangeConfigHashes(Query,&FmuHashes)&&(FmuHashes == SectionHashes));
+}
+
+/* Sends a list of configuration section hashes and waits for the FMU's list in response, returns false on timeout */
+bool FlightManagementUnit::ExchangeConfigHashes(std::vector<uint32_t> &Hashes,std::vector<uint32_t> *FmuHashes) {
+  std::vector<uint8_t> Payload;
+  Payload.resize(Hashes.size()*sizeof(uint32_t));
+  memcpy(Payload.data(),Hashes.data(),Payload.size());
+  SendMessage(kConfigHashes,Payload);
+  Message message;
+  elapsedMillis t = 0;
+  while (t < ConfigHashTimeout_ms_) {
+    if (ReceiveMessage(&message,&Payload)) {
+      if (message == kConfigHashes) {
+        FmuHashes->resize(Payload.size()/sizeof(uint32_t));
+        memcpy(FmuHashes->data(),Payload.data(),FmuHashes->size()*sizeof(uint32_t));
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 /* Sends a mode command to the FMU */
 void FlightManagementUnit::SendModeCommand(Mode mode) {
   std::vector<uint8_t> Payload;
@@ -105,129 +165,15 @@ void FlightManagementUnit::SendModeCommand(Mode mode) {
 /* Receive sensor data from FMU */
 bool FlightManagementUnit::ReceiveSensorData(bool publish) {
   Message message;
-  std::vector<uint8_t> Payload;
-  size_t PayloadLocation = 0;
-  if (ReceiveMessage(&message,&Payload)) {
-    if (message == kSensorData) {
-      // meta data
-      uint8_t AcquireInternalData,NumberPwmVoltageSensor,NumberSbusVoltageSensor,NumberMpu9250Sensor,NumberBme280Sensor,NumberuBloxSensor,NumberSwiftSensor,NumberAms5915Sensor,NumberSbusSensor,NumberAnalogSensor;
-      memcpy(&AcquireInternalData,Payload.data()+PayloadLocation,sizeof(AcquireInternalData));
-      PayloadLocation += sizeof(AcquireInternalData);
-      memcpy(&NumberPwmVoltageSensor,Payload.data()+PayloadLocation,sizeof(NumberPwmVoltageSensor));
-      PayloadLocation += sizeof(NumberPwmVoltageSensor);
-      memcpy(&NumberSbusVoltageSensor,Payload.data()+PayloadLocation,sizeof(NumberSbusVoltageSensor));
-      PayloadLocation += sizeof(NumberSbusVoltageSensor);
-      memcpy(&NumberMpu9250Sensor,Payload.data()+PayloadLocation,sizeof(NumberMpu9250Sensor));
-      PayloadLocation += sizeof(NumberMpu9250Sensor);
-      memcpy(&NumberBme280Sensor,Payload.data()+PayloadLocation,sizeof(NumberBme280Sensor));
-      PayloadLocation += sizeof(NumberBme280Sensor);
-      memcpy(&NumberuBloxSensor,Payload.data()+PayloadLocation,sizeof(NumberuBloxSensor));
-      PayloadLocation += sizeof(NumberuBloxSensor);
-      memcpy(&NumberSwiftSensor,Payload.data()+PayloadLocation,sizeof(NumberSwiftSensor));
-      PayloadLocation += sizeof(NumberSwiftSensor);
-      memcpy(&NumberAms5915Sensor,Payload.data()+PayloadLocation,sizeof(NumberAms5915Sensor));
-      PayloadLocation += sizeof(NumberAms5915Sensor);
-      memcpy(&NumberSbusSensor,Payload.data()+PayloadLocation,sizeof(NumberSbusSensor));
-      PayloadLocation += sizeof(NumberSbusSensor);
-      memcpy(&NumberAnalogSensor,Payload.data()+PayloadLocation,sizeof(NumberAnalogSensor));
-      PayloadLocation += sizeof(NumberAnalogSensor);
-      // resize data buffers
-      if (AcquireInternalData & 0x01) {
-        SensorData_.Time_us.resize(1);
-        SensorNodes_.Time_us.resize(1);
-      }
-      if (AcquireInternalData & 0x02) {
-        SensorData_.InternalMpu9250.resize(1);
-        SensorNodes_.InternalMpu9250.resize(1);
+  if (ReceiveMessage(&message,&Payload_)) {
+    if ((message == kSensorData)&&(Payload_.size() >= SensorMetadataSize_)) {
+      // the frame layout only changes if the meta data does
+      if ((!SensorLayoutValid_)||(memcmp(SensorMetadata_,Payload_.data(),SensorMetadataSize_) != 0)) {
+        UpdateSensorLayout(Payload_.data());
       }
-      if (AcquireInternalData & 0x04) {
-        SensorData_.InternalBme280.resize(1);
-        SensorNodes_.InternalBme280.resize(1);
+      if (Payload_.size() < SensorLayout_.MessagesOffset) {
+        return false;
       }
-      if (AcquireInternalData & 0x08) {
-        SensorData_.InputVoltage_V.resize(1);
-        SensorNodes_.input_volts.resize(1);
-      }
-      if (AcquireInternalData & 0x10) {
-        SensorData_.RegulatedVoltage_V.resize(1);
-        SensorNodes_.reg_volts.resize(1);
-      }
-      SensorData_.PwmVoltage_V.resize(NumberPwmVoltageSensor);
-      SensorData_.SbusVoltage_V.resize(NumberSbusVoltageSensor);
-      SensorData_.Mpu9250.resize(NumberMpu9250Sensor);
-      SensorData_.Bme280.resize(NumberBme280Sensor);
-      SensorData_.uBlox.resize(NumberuBloxSensor);
-      SensorData_.Swift.resize(NumberSwiftSensor);
-      SensorData_.Ams5915.resize(NumberAms5915Sensor);
-      SensorData_.Sbus.resize(NumberSbusSensor);
-      SensorData_.Analog.resize(NumberAnalogSensor);
-      if ( SensorNodes_.pwm_volts.size() < NumberPwmVoltageSensor ) {
-        cout << "WARNING: RESIZING pwm_volts size to: "<< (int)NumberPwmVoltageSensor << endl;
-        SensorNodes_.pwm_volts.resize(NumberPwmVoltageSensor);
-      }
-      if ( SensorNodes_.sbus_volts.size() < NumberSbusVoltageSensor ) {
-        cout << "WARNING: RESIZING sbus_volts size to: "<< (int)NumberSbusVoltageSensor << endl;
-        SensorNodes_.sbus_volts.resize(NumberSbusVoltageSensor);
-      }
-      if ( SensorNodes_.Mpu9250.size() < NumberMpu9250Sensor ) {
-        cout << "WARNING: RESIZING Mpu9250 size to: "<< (int)NumberMpu9250Sensor << endl;
-        SensorNodes_.Mpu9250.resize(NumberMpu9250Sensor);
-      }
-      if ( SensorNodes_.Bme280.size() < NumberBme280Sensor ) {
-        cout << "WARNING: RESIZING Bme280 size to: "<< (int)NumberBme280Sensor << endl;
-        SensorNodes_.Bme280.resize(NumberBme280Sensor);
-      }
-      if ( SensorNodes_.uBlox.size() < NumberuBloxSensor ) {
-        cout << "WARNING: RESIZING uBlox size to: "<< (int)NumberuBloxSensor << endl;
-        SensorNodes_.uBlox.resize(NumberuBloxSensor);
-      }
-      if ( SensorNodes_.Swift.size() < NumberSwiftSensor ) {
-        cout << "WARNING: RESIZING Swift size to: "<< (int)NumberSwiftSensor << endl;
-        SensorNodes_.Swift.resize(NumberSwiftSensor);
-      }
-      if ( SensorNodes_.Ams5915.size() < NumberAms5915Sensor ) {
-        cout << "WARNING: RESIZING Ams5915 size to: "<< (int)NumberAms5915Sensor << endl;
-        SensorNodes_.Ams5915.resize(NumberAms5915Sensor);
-      }
-      if ( SensorNodes_.Sbus.size() < NumberSbusSensor ) {
-        cout << "WARNING: RESIZING Sbus size to: "<< (int)NumberSbusSensor << endl;
-        SensorNodes_.Sbus.resize(NumberSbusSensor);
-      }
-      if ( SensorNodes_.Analog.size() < NumberAnalogSensor ) {
-        cout << "WARNING: RESIZING Analog size to: "<< (int)NumberAnalogSensor << endl;
-        SensorNodes_.Analog.resize(NumberAnalogSensor);
-      }
-      
-      // sensor data
-      memcpy(SensorData_.Time_us.data(),Payload.data()+PayloadLocation,SensorData_.Time_us.size()*sizeof(SensorData_.Time_us[0]));
-      PayloadLocation += SensorData_.Time_us.size()*sizeof(SensorData_.Time_us[0]);
-      memcpy(SensorData_.InternalMpu9250.data(),Payload.data()+PayloadLocation,SensorData_.InternalMpu9250.size()*sizeof(InternalMpu9250SensorData));
-      PayloadLocation += SensorData_.InternalMpu9250.size()*sizeof(InternalMpu9250SensorData);
-      memcpy(SensorData_.InternalBme280.data(),Payload.data()+PayloadLocation,SensorData_.InternalBme280.size()*sizeof(InternalBme280SensorData));
-      PayloadLocation += SensorData_.InternalBme280.size()*sizeof(InternalBme280SensorData);
-      memcpy(SensorData_.InputVoltage_V.data(),Payload.data()+PayloadLocation,SensorData_.InputVoltage_V.size()*sizeof(SensorData_.InputVoltage_V[0]));
-      PayloadLocation += SensorData_.InputVoltage_V.size()*sizeof(SensorData_.InputVoltage_V[0]);
-      memcpy(SensorData_.RegulatedVoltage_V.data(),Payload.data()+PayloadLocation,SensorData_.RegulatedVoltage_V.size()*sizeof(SensorData_.RegulatedVoltage_V[0]));
-      PayloadLocation += SensorData_.RegulatedVoltage_V.size()*sizeof(SensorData_.RegulatedVoltage_V[0]);
-      memcpy(SensorData_.PwmVoltage_V.data(),Payload.data()+PayloadLocation,SensorData_.PwmVoltage_V.size()*sizeof(SensorData_.PwmVoltage_V[0]));
-      PayloadLocation += SensorData_.PwmVoltage_V.size()*sizeof(SensorData_.PwmVoltage_V[0]);
-      memcpy(SensorData_.SbusVoltage_V.data(),Payload.data()+PayloadLocation,SensorData_.SbusVoltage_V.size()*sizeof(SensorData_.SbusVoltage_V[0]));
-      PayloadLocation += SensorData_.SbusVoltage_V.size()*sizeof(SensorData_.SbusVoltage_V[0]);
-      memcpy(SensorData_.Mpu9250.data(),Payload.data()+PayloadLocation,SensorData_.Mpu9250.size()*sizeof(Mpu9250SensorData));
-      PayloadLocation += SensorData_.Mpu9250.size()*sizeof(Mpu9250SensorData);
-      memcpy(SensorData_.Bme280.data(),Payload.data()+PayloadLocation,SensorData_.Bme280.size()*sizeof(Bme280SensorData));
-      PayloadLocation += SensorData_.Bme280.size()*sizeof(Bme280SensorData);
-      memcpy(SensorData_.uBlox.data(),Payload.data()+PayloadLocation,SensorData_.uBlox.size()*sizeof(uBloxSensorData));
-      PayloadLocation += SensorData_.uBlox.size()*sizeof(uBloxSensorData);
-      memcpy(SensorData_.Swift.data(),Payload.data()+PayloadLocation,SensorData_.Swift.size()*sizeof(SwiftSensorData));
-      PayloadLocation += SensorData_.Swift.size()*sizeof(SwiftSensorData);
-      memcpy(SensorData_.Ams5915.data(),Payload.data()+PayloadLocation,SensorData_.Ams5915.size()*sizeof(Ams5915SensorData));
-      PayloadLocation += SensorData_.Ams5915.size()*sizeof(Ams5915SensorData);
-      memcpy(SensorData_.Sbus.data(),Payload.data()+PayloadLocation,SensorData_.Sbus.size()*sizeof(SbusSensorData));
-      PayloadLocation += SensorData_.Sbus.size()*sizeof(SbusSensorData);
-      memcpy(SensorData_.Analog.data(),Payload.data()+PayloadLocation,SensorData_.Analog.size()*sizeof(AnalogSensorData));
-      PayloadLocation += SensorData_.Analog.size()*sizeof(AnalogSensorData);
-
       if ( publish ) {
           // copy the incoming sensor data into the definition tree
           PublishSensors();
@@ -242,52 +188,142 @@ bool FlightManagementUnit::ReceiveSensorData(bool publish) {
   }
 }
 
+/* Computes the sensor data layout given the payload meta data */
+void FlightManagementUnit::UpdateSensorLayout(const uint8_t *Metadata) {
+  memcpy(SensorMetadata_,Metadata,SensorMetadataSize_);
+  uint8_t AcquireInternalData = Metadata[0];
+  SensorLayout_.Time_us.Number = (AcquireInternalData & 0x01) ? 1 : 0;
+  SensorLayout_.InternalMpu9250.Number = (AcquireInternalData & 0x02) ? 1 : 0;
+  SensorLayout_.InternalBme280.Number = (AcquireInternalData & 0x04) ? 1 : 0;
+  SensorLayout_.InputVoltage_V.Number = (AcquireInternalData & 0x08) ? 1 : 0;
+  SensorLayout_.RegulatedVoltage_V.Number = (AcquireInternalData & 0x10) ? 1 : 0;
+  SensorLayout_.PwmVoltage_V.Number = Metadata[1];
+  SensorLayout_.SbusVoltage_V.Number = Metadata[2];
+  SensorLayout_.Mpu9250.Number = Metadata[3];
+  SensorLayout_.Bme280.Number = Metadata[4];
+  SensorLayout_.uBlox.Number = Metadata[5];
+  SensorLayout_.Swift.Number = Metadata[6];
+  SensorLayout_.Ams5915.Number = Metadata[7];
+  SensorLayout_.Sbus.Number = Metadata[8];
+  SensorLayout_.Analog.Number = Metadata[9];
+  // the FMU time follows the meta data, then the packed messages of each sensor
+  // slot, numbered in this order with the Swift using a static and a differential slot
+  SensorLayout_.MessagesOffset = SensorMetadataSize_ + SensorLayout_.Time_us.Number*sizeof(uint64_t);
+  size_t Slot = 0;
+  auto Place = [&Slot](SensorBlock &Block,size_t SlotsPerSensor) {
+    Block.Slot = Slot;
+    Slot += Block.Number*SlotsPerSensor;
+  };
+  Place(SensorLayout_.InternalMpu9250,1);
+  Place(SensorLayout_.InternalBme280,1);
+  Place(SensorLayout_.InputVoltage_V,1);
+  Place(SensorLayout_.RegulatedVoltage_V,1);
+  Place(SensorLayout_.PwmVoltage_V,1);
+  Place(SensorLayout_.SbusVoltage_V,1);
+  Place(SensorLayout_.Mpu9250,1);
+  Place(SensorLayout_.Bme280,1);
+  Place(SensorLayout_.uBlox,1);
+  Place(SensorLayout_.Swift,2);
+  Place(SensorLayout_.Ams5915,1);
+  Place(SensorLayout_.Sbus,1);
+  Place(SensorLayout_.Analog,1);
+  SensorLayout_.Slots = Slot;
+  SensorLayoutValid_ = true;
+  // resize node buffers
+  SensorNodes_.Time_us.resize(SensorLayout_.Time_us.Number);
+  SensorNodes_.InternalMpu9250.resize(SensorLayout_.InternalMpu9250.Number);
+  SensorNodes_.InternalBme280.resize(SensorLayout_.InternalBme280.Number);
+  SensorNodes_.input_volts.resize(SensorLayout_.InputVoltage_V.Number);
+  SensorNodes_.reg_volts.resize(SensorLayout_.RegulatedVoltage_V.Number);
+  if ( SensorNodes_.pwm_volts.size() < SensorLayout_.PwmVoltage_V.Number ) {
+    cout << "WARNING: RESIZING pwm_volts size to: "<< SensorLayout_.PwmVoltage_V.Number << endl;
+    SensorNodes_.pwm_volts.resize(SensorLayout_.PwmVoltage_V.Number);
+  }
+  if ( SensorNodes_.sbus_volts.size() < SensorLayout_.SbusVoltage_V.Number ) {
+    cout << "WARNING: RESIZING sbus_volts size to: "<< SensorLayout_.SbusVoltage_V.Number << endl;
+    SensorNodes_.sbus_volts.resize(SensorLayout_.SbusVoltage_V.Number);
+  }
+  if ( SensorNodes_.Mpu9250.size() < SensorLayout_.Mpu9250.Number ) {
+    cout << "WARNING: RESIZING Mpu9250 size to: "<< SensorLayout_.Mpu9250.Number << endl;
+    SensorNodes_.Mpu9250.resize(SensorLayout_.Mpu9250.Number);
+  }
+  if ( SensorNodes_.Bme280.size() < SensorLayout_.Bme280.Number ) {
+    cout << "WARNING: RESIZING Bme280 size to: "<< SensorLayout_.Bme280.Number << endl;
+    SensorNodes_.Bme280.resize(SensorLayout_.Bme280.Number);
+  }
+  if ( SensorNodes_.uBlox.size() < SensorLayout_.uBlox.Number ) {
+    cout << "WARNING: RESIZING uBlox size to: "<< SensorLayout_.uBlox.Number << endl;
+    SensorNodes_.uBlox.resize(SensorLayout_.uBlox.Number);
+  }
+  if ( SensorNodes_.Swift.size() < SensorLayout_.Swift.Number ) {
+    cout << "WARNING: RESIZING Swift size to: "<< SensorLayout_.Swift.Number << endl;
+    SensorNodes_.Swift.resize(SensorLayout_.Swift.Number);
+  }
+  if ( SensorNodes_.Ams5915.size() < SensorLayout_.Ams5915.Number ) {
+    cout << "WARNING: RESIZING Ams5915 size to: "<< SensorLayout_.Ams5915.Number << endl;
+    SensorNodes_.Ams5915.resize(SensorLayout_.Ams5915.Number);
+  }
+  if ( SensorNodes_.Sbus.size() < SensorLayout_.Sbus.Number ) {
+    cout << "WARNING: RESIZING Sbus size to: "<< SensorLayout_.Sbus.Number << endl;
+    SensorNodes_.Sbus.resize(SensorLayout_.Sbus.Number);
+  }
+  if ( SensorNodes_.Analog.size() < SensorLayout_.Analog.Number ) {
+    cout << "WARNING: RESIZING Analog size to: "<< SensorLayout_.Analog.Number << endl;
+    SensorNodes_.Analog.resize(SensorLayout_.Analog.Number);
+  }
+  // the slot table follows the layout, rebuild it if it already exists
+  if (SensorsRegistered_) {
+    BuildSensorSlots();
+  }
+}
+
+/* Returns the serial port file descriptor, readable when sensor data is arriving */
+int FlightManagementUnit::GetFileDescriptor() {
+  return _bus->fd();
+}
+
+/* Returns the FMU frame period set by the internal MPU9250 sample rate divider */
+uint32_t FlightManagementUnit::GetFramePeriod_us() {
+  return FramePeriod_us_;
+}
+
 /* Sends effector commands to FMU */
-void FlightManagementUnit::SendEffectorCommands(std::vector<float> Commands) {
-  std::vector<uint8_t> Payload;
-  Payload.resize(Commands.size()*sizeof(float));
-  memcpy(Payload.data(),Commands.data(),Payload.size());
-  SendMessage(kEffectorCommand,Payload);
+void FlightManagementUnit::SendEffectorCommands(const std::vector<float> &Commands) {
+  // only allocates the first time, the number of effectors is fixed
+  CommandPayload_.resize(Commands.size()*sizeof(float));
+  memcpy(CommandPayload_.data(),Commands.data(),CommandPayload_.size());
+  SendMessage(kEffectorCommand,CommandPayload_);
 }
 
-/* Configures the FMU sensors */
-void FlightManagementUnit::ConfigureSensors(const rapidjson::Value& Config) {
-  std::vector<uint8_t> Payload;
+/* Builds the FMU sensor configuration sections */
+void FlightManagementUnit::ConfigureSensors(const rapidjson::Value& Config,std::vector<std::string> *Sections) {
   assert(Config.IsArray());
   for (size_t i=0; i < Config.Size(); i++) {
     const rapidjson::Value& Sensor = Config[i];
     if (Sensor.HasMember("Type")) {
-      Payload.clear();
+      if ((Sensor["Type"] == "InternalMpu9250")&&Sensor.HasMember("SRD")) {
+        FramePeriod_us_ = 1000*(1+Sensor["SRD"].GetUint());
+      }
       rapidjson::StringBuffer StringBuff;
       rapidjson::Writer<rapidjson::StringBuffer> Writer(StringBuff);
       Sensor.Accept(Writer);
       std::string OutputString = StringBuff.GetString();
-      std::string ConfigString = std::string("{\"Sensors\":[") + OutputString + std::string("]}");
-      for (size_t j=0; j < ConfigString.size(); j++) {
-        Payload.push_back((uint8_t)ConfigString[j]);
-      }
-      SendMessage(Message::kConfigMesg,Payload);
+      Sections->push_back(std::string("{\"Sensors\":[") + OutputString + std::string("]}"));
     }
   }
 }
 
-/* Configures the FMU mission manager */
-void FlightManagementUnit::ConfigureMissionManager(const rapidjson::Value& Config) {
-  std::vector<uint8_t> Payload;
+/* Builds the FMU mission manager configuration section */
+void FlightManagementUnit::ConfigureMissionManager(const rapidjson::Value& Config,std::vector<std::string> *Sections) {
   rapidjson::StringBuffer StringBuff;
   rapidjson::Writer<rapidjson::StringBuffer> Writer(StringBuff);
   Config.Accept(Writer);
   std::string OutputString = StringBuff.GetString();
-  std::string ConfigString = std::string("{\"Mission-Manager\":") + OutputString + std::string("}");
-  for (size_t j=0; j < ConfigString.size(); j++) {
-    Payload.push_back((uint8_t)ConfigString[j]);
-  }
-  SendMessage(Message::kConfigMesg,Payload);
+  Sections->push_back(std::string("{\"Mission-Manager\":") + OutputString + std::string("}"));
 }
 
-/* Configures the FMU control laws */
-void FlightManagementUnit::ConfigureControlLaws(const rapidjson::Value& Config) {
-  std::vector<uint8_t> Payload;
+/* Builds the FMU control law configuration section */
+void FlightManagementUnit::ConfigureControlLaws(const rapidjson::Value& Config,std::vector<std::string> *Sections) {
   if (Config.HasMember("Fmu")) {
     if (Config.HasMember(Config["Fmu"].GetString())) {
       rapidjson::StringBuffer FmuStringBuff;
@@ -300,43 +336,33 @@ void FlightManagementUnit::ConfigureControlLaws(const rapidjson::Value& Config)
       const rapidjson::Value& Cntrl = Config[Config["Fmu"].GetString()];
       Cntrl.Accept(CntrlWriter);
       std::string CntrlString = CntrlStringBuff.GetString();
-      std::string ConfigString = std::string("{\"Control\":{") + std::string("\"Fmu\":") + FmuString + std::string(",")
-        + std::string("\"") + Config["Fmu"].GetString() + std::string("\":") + CntrlString + std::string("}}");
-      for (size_t j=0; j < ConfigString.size(); j++) {
-        Payload.push_back((uint8_t)ConfigString[j]);
-      }
-      SendMessage(Message::kConfigMesg,Payload);
+      Sections->push_back(std::string("{\"Control\":{") + std::string("\"Fmu\":") + FmuString + std::string(",")
+        + std::string("\"") + Config["Fmu"].GetString() + std::string("\":") + CntrlString + std::string("}}"));
     }
   }
 }
 
-/* Configures the FMU effectors */
-void FlightManagementUnit::ConfigureEffectors(const rapidjson::Value& Config) {
-  std::vector<uint8_t> Payload;
+/* Builds the FMU effector configuration sections */
+void FlightManagementUnit::ConfigureEffectors(const rapidjson::Value& Config,std::vector<std::string> *Sections) {
   assert(Config.IsArray());
   for (size_t i=0; i < Config.Size(); i++) {
     const rapidjson::Value& Effector = Config[i];
-    Payload.clear();
     rapidjson::StringBuffer StringBuff;
     rapidjson::Writer<rapidjson::StringBuffer> Writer(StringBuff);
     Effector.Accept(Writer);
     std::string OutputString = StringBuff.GetString();
-    std::string ConfigString = std::string("{\"Effectors\":[") + OutputString + std::string("]}");
-    for (size_t j=0; j < ConfigString.size(); j++) {
-      Payload.push_back((uint8_t)ConfigString[j]);
-    }
-    SendMessage(Message::kConfigMesg,Payload);
+    Sections->push_back(std::string("{\"Effectors\":[") + OutputString + std::string("]}"));
   }
 }
 
 /* Registers sensor data with global definition tree */
 void FlightManagementUnit::RegisterSensors(const rapidjson::Value& Config) {
 
-  for (size_t i=0; i < SensorData_.Time_us.size(); i++) {
+  for (size_t i=0; i < SensorLayout_.Time_us.Number; i++) {
     string Path = RootPath_+"/"+GetSensorOutputName(Config,"Time",i);
     SensorNodes_.Time_us[i] = deftree.initElement(Path, "Flight management unit time, us", LOG_UINT64, LOG_NONE);
   }
-  for (size_t i=0; i < SensorData_.InternalMpu9250.size(); i++) {
+  for (size_t i=0; i < SensorLayout_.InternalMpu9250.Number; i++) {
     string Path = RootPath_+"/"+GetSensorOutputName(Config,"InternalMpu9250",i);
     SensorNodes_.InternalMpu9250[i].ax = deftree.initElement(Path+"/AccelX_mss", "Flight management unit MPU-9250 X accelerometer, corrected for installation rotation, m/s/s", LOG_FLOAT, LOG_NONE);
     SensorNodes_.InternalMpu9250[i].ay = deftree.initElement(Path+"/AccelY_mss", "Flight management unit MPU-9250 Y accelerometer, corrected for installation rotation, m/s/s", LOG_FLOAT, LOG_NONE);
@@ -347,31 +373,31 @@ void FlightManagementUnit::RegisterSensors(const rapidjson::Value& Config) {
     SensorNodes_.InternalMpu9250[i].hx = deftree.initElement(Path+"/MagX_uT", "Flight management unit MPU-9250 X magnetometer, corrected for installation rotation, uT", LOG_FLOAT, LOG_NONE);
     SensorNodes_.InternalMpu9250[i].hy = deftree.initElement(Path+"/MagY_uT", "Flight management unit MPU-9250 Y magnetometer, corrected for installation rotation, uT", LOG_FLOAT, LOG_NONE);
     SensorNodes_.InternalMpu9250[i].hz = deftree.initElement(Path+"/MagZ_uT", "Flight management unit MPU-9250 Z magnetometer, corrected for installation rotation, uT", LOG_FLOAT, LOG_NONE);
-    SensorNodes_.InternalMpu9250[i].temp = deftree.initElement(Path+"/Temperature_C", "Flight management unit MPU-9250 temperature, C", LOG_FLOAT, LOG_NONE);
+    SensorNodes_.InternalMpu9250[i].temp = deftree.initElement(Path+"/Temperature_C", "Flight management unit MPU-9250 temperature, C", LOG_FLOAT16, LOG_NONE);
   }
-  for (size_t i=0; i < SensorData_.InternalBme280.size(); i++) {
+  for (size_t i=0; i < SensorLayout_.InternalBme280.Number; i++) {
     string Path = RootPath_+"/"+GetSensorOutputName(Config,"InternalBme280",i);
     SensorNodes_.InternalBme280[i].press = deftree.initElement(Path+"/Pressure_Pa", "Flight management unit BME-280 static pressure, Pa", LOG_FLOAT, LOG_NONE);
-    SensorNodes_.InternalBme280[i].temp = deftree.initElement(Path+"/Temperature_C", "Flight management unit BME-280 temperature, C", LOG_FLOAT, LOG_NONE);
-    SensorNodes_.InternalBme280[i].hum = deftree.initElement(Path+"/Humidity_RH", "Flight management unit BME-280 percent relative humidity", LOG_FLOAT, LOG_NONE);
+    SensorNodes_.InternalBme280[i].temp = deftree.initElement(Path+"/Temperature_C", "Flight management unit BME-280 temperature, C", LOG_FLOAT16, LOG_NONE);
+    SensorNodes_.InternalBme280[i].hum = deftree.initElement(Path+"/Humidity_RH", "Flight management unit BME-280 percent relative humidity", LOG_FLOAT16, LOG_NONE);
   }
-  for (size_t i=0; i < SensorData_.InputVoltage_V.size(); i++) {
+  for (size_t i=0; i < SensorLayout_.InputVoltage_V.Number; i++) {
     string Path = RootPath_+"/"+GetSensorOutputName(Config,"InputVoltage",i);
-    SensorNodes_.input_volts[i] = deftree.initElement(Path, "Flight management unit input voltage, V", LOG_FLOAT, LOG_NONE);
+    SensorNodes_.input_volts[i] = deftree.initElement(Path, "Flight management unit input voltage, V", LOG_SCALED_UINT16, LOG_NONE, 0.001f, 0.0f);
   }
-  for (size_t i=0; i < SensorData_.RegulatedVoltage_V.size(); i++) {
+  for (size_t i=0; i < SensorLayout_.RegulatedVoltage_V.Number; i++) {
     string Path = RootPath_+"/"+GetSensorOutputName(Config,"RegulatedVoltage",i);
-    SensorNodes_.reg_volts[i] = deftree.initElement(Path, "Flight management unit regulated voltage, V", LOG_FLOAT, LOG_NONE);
+    SensorNodes_.reg_volts[i] = deftree.initElement(Path, "Flight management unit regulated voltage, V", LOG_SCALED_UINT16, LOG_NONE, 0.001f, 0.0f);
   }
-  for (size_t i=0; i < SensorData_.PwmVoltage_V.size(); i++) {
+  for (size_t i=0; i < SensorLayout_.PwmVoltage_V.Number; i++) {
     string Path = RootPath_+"/"+GetSensorOutputName(Config,"PwmVoltage",i);
-    SensorNodes_.pwm_volts[i] = deftree.initElement(Path, "Flight management unit PWM servo voltage, V", LOG_FLOAT, LOG_NONE);
+    SensorNodes_.pwm_volts[i] = deftree.initElement(Path, "Flight management unit PWM servo voltage, V", LOG_SCALED_UINT16, LOG_NONE, 0.001f, 0.0f);
   }
-  for (size_t i=0; i < SensorData_.SbusVoltage_V.size(); i++) {
+  for (size_t i=0; i < SensorLayout_.SbusVoltage_V.Number; i++) {
     string Path = RootPath_+"/"+GetSensorOutputName(Config,"SbusVoltage",i);
-    SensorNodes_.sbus_volts[i] = deftree.initElement(Path, "Flight management unit SBUS servo voltage, V", LOG_FLOAT, LOG_NONE);
+    SensorNodes_.sbus_volts[i] = deftree.initElement(Path, "Flight management unit SBUS servo voltage, V", LOG_SCALED_UINT16, LOG_NONE, 0.001f, 0.0f);
   }
-  for (size_t i=0; i < SensorData_.Mpu9250.size(); i++) {
+  for (size_t i=0; i < SensorLayout_.Mpu9250.Number; i++) {
     string Path = RootPath_+"/"+GetSensorOutputName(Config,"Mpu9250",i);
     SensorNodes_.Mpu9250[i].status = deftree.initElement(Path+"/Status", "MPU-9250_" + to_string(i) + " read status, positive if a good sensor read", LOG_UINT8, LOG_NONE);
     SensorNodes_.Mpu9250[i].ax = deftree.initElement(Path+"/AccelX_mss", "MPU-9250_" + to_string(i) + " X accelerometer, corrected for installation rotation, m/s/s", LOG_FLOAT, LOG_NONE);
@@ -383,16 +409,16 @@ void FlightManagementUnit::RegisterSensors(const rapidjson::Value& Config) {
     SensorNodes_.Mpu9250[i].hx = deftree.initElement(Path+"/MagX_uT", "MPU-9250_" + to_string(i) + " X magnetometer, corrected for installation rotation, uT", LOG_FLOAT, LOG_NONE);
     SensorNodes_.Mpu9250[i].hy = deftree.initElement(Path+"/MagY_uT", "MPU-9250_" + to_string(i) + " Y magnetometer, corrected for installation rotation, uT", LOG_FLOAT, LOG_NONE);
     SensorNodes_.Mpu9250[i].hz = deftree.initElement(Path+"/MagZ_uT", "MPU-9250_" + to_string(i) + " Z magnetometer, corrected for installation rotation, uT", LOG_FLOAT, LOG_NONE);
-    SensorNodes_.Mpu9250[i].temp = deftree.initElement(Path+"/Temperature_C", "MPU-9250_" + to_string(i) + " temperature, C", LOG_FLOAT, LOG_NONE);
+    SensorNodes_.Mpu9250[i].temp = deftree.initElement(Path+"/Temperature_C", "MPU-9250_" + to_string(i) + " temperature, C", LOG_FLOAT16, LOG_NONE);
   }
-  for (size_t i=0; i < SensorData_.Bme280.size(); i++) {
+  for (size_t i=0; i < SensorLayout_.Bme280.Number; i++) {
     string Path = RootPath_+"/"+GetSensorOutputName(Config,"Bme280",i);
     SensorNodes_.Bme280[i].status = deftree.initElement(Path+"/Status", "BME-280_" + to_string(i) + " read status, positive if a good sensor read", LOG_UINT8, LOG_NONE);
     SensorNodes_.Bme280[i].press = deftree.initElement(Path+"/Pressure_Pa", "BME-280_" + to_string(i) + " static pressure, Pa", LOG_FLOAT, LOG_NONE);
-    SensorNodes_.Bme280[i].temp = deftree.initElement(Path+"/Temperature_C", "BME-280_" + to_string(i) + " temperature, C", LOG_FLOAT, LOG_NONE);
-    SensorNodes_.Bme280[i].hum = deftree.initElement(Path+"/Humidity_RH", "BME-280_" + to_string(i) + " percent relative humidity", LOG_FLOAT, LOG_NONE);
+    SensorNodes_.Bme280[i].temp = deftree.initElement(Path+"/Temperature_C", "BME-280_" + to_string(i) + " temperature, C", LOG_FLOAT16, LOG_NONE);
+    SensorNodes_.Bme280[i].hum = deftree.initElement(Path+"/Humidity_RH", "BME-280_" + to_string(i) + " percent relative humidity", LOG_FLOAT16, LOG_NONE);
   }
-  for (size_t i=0; i < SensorData_.uBlox.size(); i++) {
+  for (size_t i=0; i < SensorLayout_.uBlox.Number; i++) {
     string Path = RootPath_+"/"+GetSensorOutputName(Config,"uBlox",i);
     SensorNodes_.uBlox[i].fix = deftree.initElement(Path+"/Fix", "uBlox_" + to_string(i) + " fix status, true for 3D fix only", LOG_UINT8, LOG_NONE);
     SensorNodes_.uBlox[i].sats = deftree.initElement(Path+"/NumberSatellites", "uBlox_" + to_string(i) + " number of satellites used in solution", LOG_UINT8, LOG_NONE);
@@ -414,34 +440,36 @@ void FlightManagementUnit::RegisterSensors(const rapidjson::Value& Config) {
     SensorNodes_.uBlox[i].vel_acc = deftree.initElement(Path+"/VelocityAccuracy_ms", "uBlox_" + to_string(i) + " velocity accuracy estimate, m/s", LOG_FLOAT, LOG_NONE);
     SensorNodes_.uBlox[i].pdop = deftree.initElement(Path+"/pDOP", "uBlox_" + to_string(i) + " position dilution of precision", LOG_FLOAT, LOG_NONE);
   }
-  for (size_t i=0; i < SensorData_.Swift.size(); i++) {
+  for (size_t i=0; i < SensorLayout_.Swift.Number; i++) {
     string Path = RootPath_+"/"+GetSensorOutputName(Config,"Swift",i);
     SensorNodes_.Swift[i].Static.status = deftree.initElement(Path+"/Static/Status", "Swift_" + to_string(i) + " static pressure read status, positive if a good sensor read", LOG_UINT8, LOG_NONE);
     SensorNodes_.Swift[i].Static.press = deftree.initElement(Path+"/Static/Pressure_Pa", "Swift_" + to_string(i) + " static pressure, Pa", LOG_FLOAT, LOG_NONE);
-    SensorNodes_.Swift[i].Static.temp = deftree.initElement(Path+"/Static/Temperature_C", "Swift_" + to_string(i) + " static pressure transducer temperature, C", LOG_FLOAT, LOG_NONE);
+    SensorNodes_.Swift[i].Static.temp = deftree.initElement(Path+"/Static/Temperature_C", "Swift_" + to_string(i) + " static pressure transducer temperature, C", LOG_FLOAT16, LOG_NONE);
     SensorNodes_.Swift[i].Differential.status = deftree.initElement(Path+"/Differential/Status", "Swift_" + to_string(i) + " differential pressure read status, positive if a good sensor read", LOG_UINT8, LOG_NONE);
-    SensorNodes_.Swift[i].Differential.press = deftree.initElement(Path+"/Differential/Pressure_Pa", "Swift_" + to_string(i) + " differential pressure, Pa", LOG_FLOAT, LOG_NONE);
-    SensorNodes_.Swift[i].Differential.temp = deftree.initElement(Path+"/Differential/Temperature_C", "Swift_" + to_string(i) + " differential pressure transducer temperature, C", LOG_FLOAT, LOG_NONE);
+    SensorNodes_.Swift[i].Differential.press = deftree.initElement(Path+"/Differential/Pressure_Pa", "Swift_" + to_string(i) + " differential pressure, Pa", LOG_FLOAT16, LOG_NONE);
+    SensorNodes_.Swift[i].Differential.temp = deftree.initElement(Path+"/Differential/Temperature_C", "Swift_" + to_string(i) + " differential pressure transducer temperature, C", LOG_FLOAT16, LOG_NONE);
   }
-  for (size_t i=0; i < SensorData_.Ams5915.size(); i++) {
+  for (size_t i=0; i < SensorLayout_.Ams5915.Number; i++) {
     string Path = RootPath_+"/"+GetSensorOutputName(Config,"Ams5915",i);
     SensorNodes_.Ams5915[i].status = deftree.initElement(Path+"/Status", "AMS-5915_" + to_string(i) + " read status, positive if a good sensor read", LOG_UINT8, LOG_NONE);
     SensorNodes_.Ams5915[i].press = deftree.initElement(Path+"/Pressure_Pa", "AMS-5915_" + to_string(i) + " pressure, Pa", LOG_FLOAT, LOG_NONE);
-    SensorNodes_.Ams5915[i].temp = deftree.initElement(Path+"/Temperature_C", "AMS-5915_" + to_string(i) + " pressure transducer temperature, C", LOG_FLOAT, LOG_NONE);
+    SensorNodes_.Ams5915[i].temp = deftree.initElement(Path+"/Temperature_C", "AMS-5915_" + to_string(i) + " pressure transducer temperature, C", LOG_FLOAT16, LOG_NONE);
   }
-  for (size_t i=0; i < SensorData_.Sbus.size(); i++) {
+  for (size_t i=0; i < SensorLayout_.Sbus.Number; i++) {
     string Path = RootPath_+"/"+GetSensorOutputName(Config,"Sbus",i);
     SensorNodes_.Sbus[i].failsafe = deftree.initElement(Path+"/FailSafe", "SBUS_" + to_string(i) + " fail safe status", LOG_UINT8, LOG_NONE);
     SensorNodes_.Sbus[i].lost_frames = deftree.initElement(Path+"/LostFrames", "SBUS_" + to_string(i) + " number of lost frames", LOG_UINT64, LOG_NONE);
     for (size_t j=0; j < 16; j++) {
-      SensorNodes_.Sbus[i].ch[j] = deftree.initElement(Path+"/Channels/"+to_string(j), "SBUS_" + to_string(i) + " channel" + to_string(j) + " normalized value", LOG_FLOAT, LOG_NONE);
+      SensorNodes_.Sbus[i].ch[j] = deftree.initElement(Path+"/Channels/"+to_string(j), "SBUS_" + to_string(i) + " channel" + to_string(j) + " normalized value", LOG_FLOAT16, LOG_NONE);
     }
   }
-  for (size_t i=0; i < SensorData_.Analog.size(); i++) {
+  for (size_t i=0; i < SensorLayout_.Analog.Number; i++) {
     string Path = RootPath_+"/"+GetSensorOutputName(Config,"Analog",i);
-    SensorNodes_.Analog[i].volt = deftree.initElement(Path+"/Voltage_V", "Analog_" + to_string(i) + " measured voltage, V", LOG_FLOAT, LOG_NONE);
+    SensorNodes_.Analog[i].volt = deftree.initElement(Path+"/Voltage_V", "Analog_" + to_string(i) + " measured voltage, V", LOG_SCALED_UINT16, LOG_NONE, 0.0001f, 0.0f);
     SensorNodes_.Analog[i].val = deftree.initElement(Path+"/CalibratedValue", "Analog_" + to_string(i) + " calibrated value", LOG_FLOAT, LOG_NONE);
   }
+  SensorsRegistered_ = true;
+  BuildSensorSlots();
 }
 
 /* Gets the sensor output name from JSON config given the "Type" and index */
@@ -485,7 +513,7 @@ void FlightManagementUnit::SendMessage(Message message,std::vector<uint8_t> &Pay
   _bus->beginTransmission();
   _bus->write((uint8_t) message);
   _bus->write(Payload.data(),Payload.size());
-  if ((message == kModeCommand)||(message == kConfigMesg)) {
+  if ((message == kModeCommand)||(message == kConfigMesg)||(message == kConfigHashes)) {
     _bus->endTransmission();
   } else {
     _bus->sendTransmission();
@@ -505,102 +533,225 @@ bool FlightManagementUnit::ReceiveMessage(Message *message,std::vector<uint8_t>
   }
 }
 
+/* Builds the table of definition tree nodes each sensor slot is published to */
+void FlightManagementUnit::BuildSensorSlots() {
+  SensorSlots_.assign(SensorLayout_.Slots,SensorSlotNodes());
+  for (size_t i=0; i < SensorLayout_.InternalMpu9250.Number; i++) {
+    SensorSlotNodes &Slot = SensorSlots_[SensorLayout_.InternalMpu9250.Slot+i];
+    InternalMpu9250SensorNodes &Nodes = SensorNodes_.InternalMpu9250[i];
+    Slot.ax = Nodes.ax; Slot.ay = Nodes.ay; Slot.az = Nodes.az;
+    Slot.p = Nodes.p; Slot.q = Nodes.q; Slot.r = Nodes.r;
+    Slot.hx = Nodes.hx; Slot.hy = Nodes.hy; Slot.hz = Nodes.hz;
+    Slot.temp = Nodes.temp;
+  }
+  for (size_t i=0; i < SensorLayout_.InternalBme280.Number; i++) {
+    SensorSlotNodes &Slot = SensorSlots_[SensorLayout_.InternalBme280.Slot+i];
+    Slot.press = SensorNodes_.InternalBme280[i].press;
+    Slot.temp = SensorNodes_.InternalBme280[i].temp;
+    Slot.hum = SensorNodes_.InternalBme280[i].hum;
+  }
+  for (size_t i=0; i < SensorLayout_.InputVoltage_V.Number; i++) {
+    SensorSlots_[SensorLayout_.InputVoltage_V.Slot+i].volt = SensorNodes_.input_volts[i];
+  }
+  for (size_t i=0; i < SensorLayout_.RegulatedVoltage_V.Number; i++) {
+    SensorSlots_[SensorLayout_.RegulatedVoltage_V.Slot+i].volt = SensorNodes_.reg_volts[i];
+  }
+  for (size_t i=0; i < SensorLayout_.PwmVoltage_V.Number; i++) {
+    SensorSlots_[SensorLayout_.PwmVoltage_V.Slot+i].volt = SensorNodes_.pwm_volts[i];
+  }
+  for (size_t i=0; i < SensorLayout_.SbusVoltage_V.Number; i++) {
+    SensorSlots_[SensorLayout_.SbusVoltage_V.Slot+i].volt = SensorNodes_.sbus_volts[i];
+  }
+  for (size_t i=0; i < SensorLayout_.Mpu9250.Number; i++) {
+    SensorSlotNodes &Slot = SensorSlots_[SensorLayout_.Mpu9250.Slot+i];
+    Mpu9250SensorNodes &Nodes = SensorNodes_.Mpu9250[i];
+    Slot.status = Nodes.status;
+    Slot.ax = Nodes.ax; Slot.ay = Nodes.ay; Slot.az = Nodes.az;
+    Slot.p = Nodes.p; Slot.q = Nodes.q; Slot.r = Nodes.r;
+    Slot.hx = Nodes.hx; Slot.hy = Nodes.hy; Slot.hz = Nodes.hz;
+    Slot.temp = Nodes.temp;
+  }
+  for (size_t i=0; i < SensorLayout_.Bme280.Number; i++) {
+    SensorSlotNodes &Slot = SensorSlots_[SensorLayout_.Bme280.Slot+i];
+    Slot.status = SensorNodes_.Bme280[i].status;
+    Slot.press = SensorNodes_.Bme280[i].press;
+    Slot.temp = SensorNodes_.Bme280[i].temp;
+    Slot.hum = SensorNodes_.Bme280[i].hum;
+  }
+  for (size_t i=0; i < SensorLayout_.uBlox.Number; i++) {
+    SensorSlots_[SensorLayout_.uBlox.Slot+i].gnss = SensorNodes_.uBlox[i];
+  }
+  for (size_t i=0; i < SensorLayout_.Swift.Number; i++) {
+    SensorSlotNodes &Static = SensorSlots_[SensorLayout_.Swift.Slot+2*i];
+    SensorSlotNodes &Differential = SensorSlots_[SensorLayout_.Swift.Slot+2*i+1];
+    Static.status = SensorNodes_.Swift[i].Static.status;
+    Static.press = SensorNodes_.Swift[i].Static.press;
+    Static.temp = SensorNodes_.Swift[i].Static.temp;
+    Differential.status = SensorNodes_.Swift[i].Differential.status;
+    Differential.press = SensorNodes_.Swift[i].Differential.press;
+    Differential.temp = SensorNodes_.Swift[i].Differential.temp;
+  }
+  for (size_t i=0; i < SensorLayout_.Ams5915.Number; i++) {
+    SensorSlotNodes &Slot = SensorSlots_[SensorLayout_.Ams5915.Slot+i];
+    Slot.status = SensorNodes_.Ams5915[i].status;
+    Slot.press = SensorNodes_.Ams5915[i].press;
+    Slot.temp = SensorNodes_.Ams5915[i].temp;
+  }
+  for (size_t i=0; i < SensorLayout_.Sbus.Number; i++) {
+    SensorSlots_[SensorLayout_.Sbus.Slot+i].inceptor = SensorNodes_.Sbus[i];
+  }
+  for (size_t i=0; i < SensorLayout_.Analog.Number; i++) {
+    SensorSlotNodes &Slot = SensorSlots_[SensorLayout_.Analog.Slot+i];
+    Slot.volt = SensorNodes_.Analog[i].volt;
+    Slot.val = SensorNodes_.Analog[i].val;
+  }
+}
+
+/* Unpacks the sensor messages in the payload into the definition tree */
 void FlightManagementUnit::PublishSensors() {
-  for (size_t i=0; i < SensorData_.Time_us.size(); i++) {
-    // fixme: uint64_t
-    SensorNodes_.Time_us[i]->setLong(SensorData_.Time_us[i]);
-  }
-  for (size_t i=0; i < SensorData_.InternalMpu9250.size(); i++) {
-    SensorNodes_.InternalMpu9250[i].ax->setFloat(SensorData_.InternalMpu9250[i].Accel_mss(0,0));
-    SensorNodes_.InternalMpu9250[i].ay->setFloat(SensorData_.InternalMpu9250[i].Accel_mss(1,0));
-    SensorNodes_.InternalMpu9250[i].az->setFloat(SensorData_.InternalMpu9250[i].Accel_mss(2,0));
-    SensorNodes_.InternalMpu9250[i].p->setFloat(SensorData_.InternalMpu9250[i].Gyro_rads(0,0));
-    SensorNodes_.InternalMpu9250[i].q->setFloat(SensorData_.InternalMpu9250[i].Gyro_rads(1,0));
-    SensorNodes_.InternalMpu9250[i].r->setFloat(SensorData_.InternalMpu9250[i].Gyro_rads(2,0));
-    SensorNodes_.InternalMpu9250[i].hx->setFloat(SensorData_.InternalMpu9250[i].Mag_uT(0,0));
-    SensorNodes_.InternalMpu9250[i].hy->setFloat(SensorData_.InternalMpu9250[i].Mag_uT(1,0));
-    SensorNodes_.InternalMpu9250[i].hz->setFloat(SensorData_.InternalMpu9250[i].Mag_uT(2,0));
-    SensorNodes_.InternalMpu9250[i].temp->setFloat(SensorData_.InternalMpu9250[i].Temperature_C);
-  }
-  for (size_t i=0; i < SensorData_.InternalBme280.size(); i++) {
-    SensorNodes_.InternalBme280[i].press->setFloat(SensorData_.InternalBme280[i].Pressure_Pa);
-    SensorNodes_.InternalBme280[i].temp->setFloat(SensorData_.InternalBme280[i].Temperature_C);
-    SensorNodes_.InternalBme280[i].hum->setFloat(SensorData_.InternalBme280[i].Humidity_RH);
-  }
-  for (size_t i=0; i < SensorData_.InputVoltage_V.size(); i++) {
-    SensorNodes_.input_volts[i]->setFloat(SensorData_.InputVoltage_V[i]);
-  }
-  for (size_t i=0; i < SensorData_.RegulatedVoltage_V.size(); i++) {
-    SensorNodes_.reg_volts[i]->setFloat(SensorData_.RegulatedVoltage_V[i]);
-  }
-  for (size_t i=0; i < SensorData_.PwmVoltage_V.size(); i++) {
-    SensorNodes_.pwm_volts[i]->setFloat(SensorData_.PwmVoltage_V[i]);
-  }
-  for (size_t i=0; i < SensorData_.SbusVoltage_V.size(); i++) {
-    SensorNodes_.sbus_volts[i]->setFloat(SensorData_.SbusVoltage_V[i]);
-  }
-  for (size_t i=0; i < SensorData_.Mpu9250.size(); i++) {
-    SensorNodes_.Mpu9250[i].status->setInt(SensorData_.Mpu9250[i].status);
-    SensorNodes_.Mpu9250[i].ax->setFloat(SensorData_.Mpu9250[i].Accel_mss(0,0));
-    SensorNodes_.Mpu9250[i].ay->setFloat(SensorData_.Mpu9250[i].Accel_mss(1,0));
-    SensorNodes_.Mpu9250[i].az->setFloat(SensorData_.Mpu9250[i].Accel_mss(2,0));
-    SensorNodes_.Mpu9250[i].p->setFloat(SensorData_.Mpu9250[i].Gyro_rads(0,0));
-    SensorNodes_.Mpu9250[i].q->setFloat(SensorData_.Mpu9250[i].Gyro_rads(1,0));
-    SensorNodes_.Mpu9250[i].r->setFloat(SensorData_.Mpu9250[i].Gyro_rads(2,0));
-    SensorNodes_.Mpu9250[i].hx->setFloat(SensorData_.Mpu9250[i].Mag_uT(0,0));
-    SensorNodes_.Mpu9250[i].hy->setFloat(SensorData_.Mpu9250[i].Mag_uT(1,0));
-    SensorNodes_.Mpu9250[i].hz->setFloat(SensorData_.Mpu9250[i].Mag_uT(2,0));
-    SensorNodes_.Mpu9250[i].temp->setFloat(SensorData_.Mpu9250[i].Temperature_C);
-  }
-  for (size_t i=0; i < SensorData_.Bme280.size(); i++) {
-    SensorNodes_.Bme280[i].status->setInt(SensorData_.Bme280[i].status);
-    SensorNodes_.Bme280[i].press->setFloat(SensorData_.Bme280[i].Pressure_Pa);
-    SensorNodes_.Bme280[i].temp->setFloat(SensorData_.Bme280[i].Temperature_C);
-    SensorNodes_.Bme280[i].hum->setFloat(SensorData_.Bme280[i].Humidity_RH);
-  }
-  for (size_t i=0; i < SensorData_.uBlox.size(); i++) {
-    SensorNodes_.uBlox[i].fix->setInt(SensorData_.uBlox[i].Fix);
-    SensorNodes_.uBlox[i].sats->setInt(SensorData_.uBlox[i].NumberSatellites);
-    SensorNodes_.uBlox[i].tow->setInt(SensorData_.uBlox[i].TOW);
-    SensorNodes_.uBlox[i].year->setInt(SensorData_.uBlox[i].Year);
-    SensorNodes_.uBlox[i].month->setInt(SensorData_.uBlox[i].Month);
-    SensorNodes_.uBlox[i].day->setInt(SensorData_.uBlox[i].Day);
-    SensorNodes_.uBlox[i].hour->setInt(SensorData_.uBlox[i].Hour);
-    SensorNodes_.uBlox[i].min->setInt(SensorData_.uBlox[i].Min);
-    SensorNodes_.uBlox[i].sec->setInt(SensorData_.uBlox[i].Sec);
-    SensorNodes_.uBlox[i].lat->setDouble(SensorData_.uBlox[i].LLA(0,0));
-    SensorNodes_.uBlox[i].lon->setDouble(SensorData_.uBlox[i].LLA(1,0));
-    SensorNodes_.uBlox[i].alt->setFloat(SensorData_.uBlox[i].LLA(2,0));
-    SensorNodes_.uBlox[i].vn->setFloat(SensorData_.uBlox[i].NEDVelocity_ms(0,0));
-    SensorNodes_.uBlox[i].ve->setFloat(SensorData_.uBlox[i].NEDVelocity_ms(1,0));
-    SensorNodes_.uBlox[i].vd->setFloat(SensorData_.uBlox[i].NEDVelocity_ms(2,0));
-    SensorNodes_.uBlox[i].horiz_acc->setFloat(SensorData_.uBlox[i].Accuracy(0,0));
-    SensorNodes_.uBlox[i].vert_acc->setFloat(SensorData_.uBlox[i].Accuracy(1,0));
-    SensorNodes_.uBlox[i].vel_acc->setFloat(SensorData_.uBlox[i].Accuracy(2,0));
-    SensorNodes_.uBlox[i].pdop->setFloat(SensorData_.uBlox[i].pDOP);
-  }
-  for (size_t i=0; i < SensorData_.Swift.size(); i++) {
-    SensorNodes_.Swift[i].Static.status->setInt(SensorData_.Swift[i].Static.status);
-    SensorNodes_.Swift[i].Static.press->setFloat(SensorData_.Swift[i].Static.Pressure_Pa);
-    SensorNodes_.Swift[i].Static.temp->setFloat(SensorData_.Swift[i].Static.Temperature_C);
-    SensorNodes_.Swift[i].Differential.status->setInt(SensorData_.Swift[i].Differential.status);
-    SensorNodes_.Swift[i].Differential.press->setFloat(SensorData_.Swift[i].Differential.Pressure_Pa);
-    SensorNodes_.Swift[i].Differential.temp->setFloat(SensorData_.Swift[i].Differential.Temperature_C);
-  }
-  for (size_t i=0; i < SensorData_.Ams5915.size(); i++) {
-    SensorNodes_.Ams5915[i].status->setInt(SensorData_.Ams5915[i].status);
-    SensorNodes_.Ams5915[i].press->setFloat(SensorData_.Ams5915[i].Pressure_Pa);
-    SensorNodes_.Ams5915[i].temp->setFloat(SensorData_.Ams5915[i].Temperature_C);
-  }
-  for (size_t i=0; i < SensorData_.Sbus.size(); i++) {
-    SensorNodes_.Sbus[i].failsafe->setInt(SensorData_.Sbus[i].FailSafe);
-    SensorNodes_.Sbus[i].lost_frames->setInt(SensorData_.Sbus[i].LostFrames);
-    for (size_t j=0; j < 16; j++) {
-      SensorNodes_.Sbus[i].ch[j]->setFloat(SensorData_.Sbus[i].Channels[j]);
+  const uint8_t *Data = Payload_.data();
+  if ((SensorLayout_.Time_us.Number > 0)&&(SensorNodes_.Time_us[0])) {
+    uint64_t val;
+    memcpy(&val,Data + SensorMetadataSize_,sizeof(val));
+    SensorNodes_.Time_us[0]->setLong(val);
+  }
+  // large enough for any unpacked message
+  union {
+    struct accel_data Accel;
+    struct gyro_data Gyro;
+    struct mag_data Mag;
+    struct inceptor_data Inceptor;
+    struct temperature_data Temperature;
+    struct gnss_data Gnss;
+    struct static_press_data StaticPress;
+    struct diff_press_data DiffPress;
+    struct analog_data Analog;
+    struct voltage_data Voltage;
+    struct humidity_data Humidity;
+    struct gnss_time_data GnssTime;
+  } Unpacked;
+  size_t Location = SensorLayout_.MessagesOffset;
+  while (Location + SensorMessageHeaderSize_ <= Payload_.size()) {
+    size_t Slot = Data[Location];
+    MsgId_t Id = (MsgId_t)(Data[Location+1] & ~SensorReadFailed_);
+    bool ReadFailed = Data[Location+1] & SensorReadFailed_;
+    size_t Size = msg_packed_size(Id);
+    Location += SensorMessageHeaderSize_;
+    // an unknown message cannot be skipped, drop the rest of the frame
+    if ((Size == 0)||(Location + Size > Payload_.size())) {
+      break;
     }
+    if ((Slot < SensorSlots_.size())&&(msg_unpack(Id,Data + Location,&Unpacked) == MSG_ERROR_SUCCESS)) {
+      PublishSensorMessage(SensorSlots_[Slot],Id,&Unpacked,ReadFailed);
+    }
+    Location += Size;
   }
-  for (size_t i=0; i < SensorData_.Analog.size(); i++) {
-    SensorNodes_.Analog[i].volt->setFloat(SensorData_.Analog[i].Voltage_V);
-    SensorNodes_.Analog[i].val->setFloat(SensorData_.Analog[i].CalibratedValue);
+}
+
+/* Copies an unpacked sensor message to the nodes of its sensor slot */
+void FlightManagementUnit::PublishSensorMessage(SensorSlotNodes &Slot,int Id,const void *Data,bool ReadFailed) {
+  auto Set = [](ElementPtr &Node,float val) {
+    if (Node) {
+      Node->setFloat(val);
+    }
+  };
+  if (Slot.status) {
+    Slot.status->setInt(ReadFailed ? -1 : 1);
+  }
+  switch (Id) {
+    case MSG_ACCEL_DATA: {
+      const struct accel_data *Accel = (const struct accel_data *)Data;
+      Set(Slot.ax,Accel->accel_x_mss);
+      Set(Slot.ay,Accel->accel_y_mss);
+      Set(Slot.az,Accel->accel_z_mss);
+      break;
+    }
+    case MSG_GYRO_DATA: {
+      const struct gyro_data *Gyro = (const struct gyro_data *)Data;
+      Set(Slot.p,Gyro->gyro_x_rads);
+      Set(Slot.q,Gyro->gyro_y_rads);
+      Set(Slot.r,Gyro->gyro_z_rads);
+      break;
+    }
+    case MSG_MAG_DATA: {
+      const struct mag_data *Mag = (const struct mag_data *)Data;
+      Set(Slot.hx,Mag->mag_x_ut);
+      Set(Slot.hy,Mag->mag_y_ut);
+      Set(Slot.hz,Mag->mag_z_ut);
+      break;
+    }
+    case MSG_TEMPERATURE_DATA: {
+      Set(Slot.temp,((const struct temperature_data *)Data)->temp_c);
+      break;
+    }
+    case MSG_HUMIDITY_DATA: {
+      Set(Slot.hum,((const struct humidity_data *)Data)->humidity_rh);
+      break;
+    }
+    case MSG_STATIC_PRESS_DATA: {
+      Set(Slot.press,((const struct static_press_data *)Data)->press_pa);
+      break;
+    }
+    case MSG_DIFF_PRESS_DATA: {
+      Set(Slot.press,((const struct diff_press_data *)Data)->press_pa);
+      break;
+    }
+    case MSG_VOLTAGE_DATA: {
+      Set(Slot.volt,((const struct voltage_data *)Data)->voltage);
+      break;
+    }
+    case MSG_ANALOG_DATA: {
+      const struct analog_data *Analog = (const struct analog_data *)Data;
+      Set(Slot.volt,Analog->voltage);
+      Set(Slot.val,Analog->cal_value);
+      break;
+    }
+    case MSG_INCEPTOR_DATA: {
+      const struct inceptor_data *Inceptor = (const struct inceptor_data *)Data;
+      for (size_t j=0; j < 16; j++) {
+        Set(Slot.inceptor.ch[j],Inceptor->ch[j]);
+      }
+      if (Slot.inceptor.failsafe) {
+        Slot.inceptor.failsafe->setInt(Inceptor->failsafe_activated);
+      }
+      // the FMU sends the number of frames lost since the previous message
+      if ((Slot.inceptor.lost_frames)&&(Inceptor->lost_frames > 0)) {
+        Slot.inceptor.lost_frames->setLong(Slot.inceptor.lost_frames->getLong() + Inceptor->lost_frames);
+      }
+      break;
+    }
+    case MSG_GNSS_DATA: {
+      const struct gnss_data *Gnss = (const struct gnss_data *)Data;
+      uBloxSensorNodes &Nodes = Slot.gnss;
+      if (Nodes.fix) {
+        Nodes.fix->setInt(Gnss->fix);
+        Nodes.sats->setInt(Gnss->num_sv);
+        Nodes.tow->setInt(Gnss->tow_ms);
+        Nodes.lat->setDouble(Gnss->lat_rad);
+        Nodes.lon->setDouble(Gnss->lon_rad);
+        Nodes.alt->setFloat(Gnss->hmsl_m);
+        Nodes.vn->setFloat(Gnss->vel_north_ms);
+        Nodes.ve->setFloat(Gnss->vel_east_ms);
+        Nodes.vd->setFloat(Gnss->vel_down_ms);
+        Nodes.horiz_acc->setFloat(Gnss->horiz_acc_m);
+        Nodes.vert_acc->setFloat(Gnss->vert_acc_m);
+        Nodes.vel_acc->setFloat(Gnss->speed_acc_ms);
+        Nodes.pdop->setFloat(Gnss->pdop);
+      }
+      break;
+    }
+    case MSG_GNSS_TIME_DATA: {
+      const struct gnss_time_data *GnssTime = (const struct gnss_time_data *)Data;
+      uBloxSensorNodes &Nodes = Slot.gnss;
+      if (Nodes.year) {
+        Nodes.year->setInt(GnssTime->year);
+        Nodes.month->setInt(GnssTime->month);
+        Nodes.day->setInt(GnssTime->day);
+        Nodes.hour->setInt(GnssTime->hour);
+        Nodes.min->setInt(GnssTime->min);
+        Nodes.sec->setInt(GnssTime->sec);
+      }
+      break;
+    }
   }
 }
@@ -24,6 +24,8 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include "hardware-defs.h"
 #include "definition-tree2.h"
 #include "SerialLink.h"
+#include "elapsedMillis.h"
+#include "checksum.h"
 #include "rapidjson/document.h"
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/writer.h"
@@ -48,47 +50,32 @@ class FlightManagementUnit {
       kModeCommand,
       kConfigMesg,
       kSensorData,
-      kEffectorCommand
+      kEffectorCommand,
+      kConfigHashes
     };
     enum Mode {
       kConfigMode,
       kRunMode
     };
-    void Begin();
+    void Begin(std::string Port=FmuPort);
     void Configure(const rapidjson::Value& Config);
     void SendModeCommand(Mode mode);
     bool ReceiveSensorData(bool publish=true);
-    void SendEffectorCommands(std::vector<float> Commands);
+    void SendEffectorCommands(const std::vector<float> &Commands);
+    int GetFileDescriptor();
+    uint32_t GetFramePeriod_us();
   private:
-    struct InternalMpu9250SensorData {
-      Eigen::Matrix<float,3,1>Accel_mss;        // x,y,z accelerometers, m/s/s
-      Eigen::Matrix<float,3,1>Gyro_rads;        // x,y,z gyros, rad/s
-      Eigen::Matrix<float,3,1>Mag_uT;           // x,y,z magnetometers, uT
-      float Temperature_C;                      // Temperature, C
-    };
     struct InternalMpu9250SensorNodes {
       ElementPtr ax, ay, az;
       ElementPtr p, q, r;
       ElementPtr hx, hy, hz;
       ElementPtr temp;
     };
-    struct InternalBme280SensorData {
-      float Pressure_Pa;                        // Pressure, Pa
-      float Temperature_C;                      // Temperature, C
-      float Humidity_RH;                        // Relative humidity
-    };
     struct InternalBme280SensorNodes {
       ElementPtr press;
       ElementPtr temp;
       ElementPtr hum;
     };
-    struct Mpu9250SensorData {
-      int status;
-      Eigen::Matrix<float,3,1>Accel_mss;        // x,y,z accelerometers, m/s/s
-      Eigen::Matrix<float,3,1>Gyro_rads;        // x,y,z gyros, rad/s
-      Eigen::Matrix<float,3,1>Mag_uT;           // x,y,z magnetometers, uT
-      float Temperature_C;                      // Temperature, C
-    };
     struct Mpu9250SensorNodes {
       ElementPtr status;
       ElementPtr ax, ay, az;
@@ -96,33 +83,12 @@ class FlightManagementUnit {
       ElementPtr hx, hy, hz;
       ElementPtr temp;
     };
-    struct Bme280SensorData {
-      int status;
-      float Pressure_Pa;                        // Pressure, Pa
-      float Temperature_C;                      // Temperature, C
-      float Humidity_RH;                        // Relative humidity
-    };
     struct Bme280SensorNodes {
       ElementPtr status;
       ElementPtr press;
       ElementPtr temp;
       ElementPtr hum;
     };
-    struct uBloxSensorData {
-      bool Fix;                                 // True for 3D fix only
-      uint8_t NumberSatellites;                 // Number of satellites used in solution
-      uint32_t TOW;                             // GPS time of the navigation epoch
-      uint16_t Year;                            // UTC year
-      uint8_t Month;                            // UTC month
-      uint8_t Day;                              // UTC day
-      uint8_t Hour;                             // UTC hour
-      uint8_t Min;                              // UTC minute
-      uint8_t Sec;                              // UTC second
-      Eigen::Matrix<double,3,1>LLA;             // Latitude (rad), Longitude (rad), Altitude (m)
-      Eigen::Matrix<double,3,1>NEDVelocity_ms;  // NED Velocity, m/s
-      Eigen::Matrix<double,3,1>Accuracy;        // Horizontal (m), vertical (m), and speed (m/s) accuracy estimates
-      double pDOP;                              // Position DOP
-    };
     struct uBloxSensorNodes {
       ElementPtr fix;
       ElementPtr sats;
@@ -138,57 +104,62 @@ class FlightManagementUnit {
       ElementPtr horiz_acc, vert_acc, vel_acc;
       ElementPtr pdop;
     };
-    struct Ams5915SensorData {
-      int status;
-      float Pressure_Pa;                        // Pressure, Pa
-      float Temperature_C;                      // Temperature, C
-    };
     struct Ams5915SensorNodes {
       ElementPtr status;
       ElementPtr press;
       ElementPtr temp;
     };
-    struct SwiftSensorData {
-      Ams5915SensorData Static;
-      Ams5915SensorData Differential;
-    };
     struct SwiftSensorNodes {
       Ams5915SensorNodes Static;
       Ams5915SensorNodes Differential;
     };
-    struct SbusSensorData {
-      float Channels[16];
-      bool FailSafe;
-      uint64_t LostFrames;
-    };
     struct SbusSensorNodes {
       ElementPtr ch[16];
       ElementPtr failsafe;
       ElementPtr lost_frames;
     };
-    struct AnalogSensorData {
-      float Voltage_V;
-      float CalibratedValue;
-    };
     struct AnalogSensorNodes {
       ElementPtr volt;
       ElementPtr val;
     };
-    struct SensorData {
-      std::vector<uint64_t> Time_us;
-      std::vector<InternalMpu9250SensorData> InternalMpu9250;
-      std::vector<InternalBme280SensorData> InternalBme280;
-      std::vector<float> InputVoltage_V;
-      std::vector<float> RegulatedVoltage_V;
-      std::vector<float> PwmVoltage_V;
-      std::vector<float> SbusVoltage_V;
-      std::vector<Mpu9250SensorData> Mpu9250;
-      std::vector<Bme280SensorData> Bme280;
-      std::vector<uBloxSensorData> uBlox;
-      std::vector<SwiftSensorData> Swift;
-      std::vector<Ams5915SensorData> Ams5915;
-      std::vector<SbusSensorData> Sbus;
-      std::vector<AnalogSensorData> Analog;
+    // number of sensors of each type and the message slot of the first
+    // sensor of each type, computed once from the payload meta data and
+    // reused until the meta data changes
+    struct SensorBlock {
+      size_t Number = 0;
+      size_t Slot = 0;
+    };
+    struct SensorFrameLayout {
+      SensorBlock Time_us;
+      SensorBlock InternalMpu9250;
+      SensorBlock InternalBme280;
+      SensorBlock InputVoltage_V;
+      SensorBlock RegulatedVoltage_V;
+      SensorBlock PwmVoltage_V;
+      SensorBlock SbusVoltage_V;
+      SensorBlock Mpu9250;
+      SensorBlock Bme280;
+      SensorBlock uBlox;
+      SensorBlock Swift;
+      SensorBlock Ams5915;
+      SensorBlock Sbus;
+      SensorBlock Analog;
+      size_t Slots = 0;
+      size_t MessagesOffset = 0;
+    };
+    // definition tree nodes the packed messages of a sensor slot are published to
+    struct SensorSlotNodes {
+      ElementPtr status;
+      ElementPtr ax, ay, az;
+      ElementPtr p, q, r;
+      ElementPtr hx, hy, hz;
+      ElementPtr temp;
+      ElementPtr press;
+      ElementPtr hum;
+      ElementPtr volt;
+      ElementPtr val;
+      uBloxSensorNodes gnss;
+      SbusSensorNodes inceptor;
     };
     struct SensorNodes {
       vector<ElementPtr> Time_us;
@@ -206,23 +177,40 @@ class FlightManagementUnit {
       vector<SbusSensorNodes> Sbus;
       vector<AnalogSensorNodes> Analog;
     };
-    const std::string Port_ = FmuPort;
     const std::string RootPath_ = "/Sensors";
     const uint32_t Baud_ = FmuBaud;
     HardwareSerial *_serial;
     SerialLink *_bus;
-    SensorData SensorData_;
+    static const size_t SensorMetadataSize_ = 10;
+    static const size_t SensorMessageHeaderSize_ = 2;
+    static const uint8_t SensorReadFailed_ = 0x80;
+    uint8_t SensorMetadata_[SensorMetadataSize_];
+    bool SensorLayoutValid_ = false;
+    // the internal MPU9250 paces the FMU, 1000 / (1 + SRD) Hz with SRD 19 by default
+    uint32_t FramePeriod_us_ = 20000;
+    SensorFrameLayout SensorLayout_;
     SensorNodes SensorNodes_;
+    bool SensorsRegistered_ = false;
+    std::vector<SensorSlotNodes> SensorSlots_;
+    std::vector<uint8_t> Payload_;
+    std::vector<uint8_t> CommandPayload_;
     // static const 
-    void ConfigureSensors(const rapidjson::Value& Config);
-    void ConfigureMissionManager(const rapidjson::Value& Config);
-    void ConfigureControlLaws(const rapidjson::Value& Config);
-    void ConfigureEffectors(const rapidjson::Value& Config);
+    const unsigned long ConfigHashTimeout_ms_ = 1000;
+    const size_t ConfigUploadAttempts_ = 3;
+    void ConfigureSensors(const rapidjson::Value& Config,std::vector<std::string> *Sections);
+    void ConfigureMissionManager(const rapidjson::Value& Config,std::vector<std::string> *Sections);
+    void ConfigureControlLaws(const rapidjson::Value& Config,std::vector<std::string> *Sections);
+    void ConfigureEffectors(const rapidjson::Value& Config,std::vector<std::string> *Sections);
+    bool ExchangeConfigHashes(std::vector<uint32_t> &Hashes,std::vector<uint32_t> *FmuHashes);
+    bool UploadConfig(const std::vector<std::string> &Sections,std::vector<uint32_t> &SectionHashes);
     void RegisterSensors(const rapidjson::Value& Config);
     std::string GetSensorOutputName(const rapidjson::Value& Config,std::string Key,size_t index);
     void SendMessage(Message message,std::vector<uint8_t> &Payload);
     bool ReceiveMessage(Message *message,std::vector<uint8_t> *Payload);
+    void UpdateSensorLayout(const uint8_t *Metadata);
+    void BuildSensorSlots();
     void PublishSensors();
+    void PublishSensorMessage(SensorSlotNodes &Slot,int Id,const void *Data,bool ReadFailed);
 };
 
 #endif
@@ -0,0 +1,127 @@
+/*
+frame-monitor.cpp
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "frame-monitor.h"
+
+/* Configures the frame monitor given a JSON value and the FMU frame period */
+void FrameMonitor::Configure(const rapidjson::Value& Config,uint32_t FramePeriod_us) {
+  float Budget = 1.0f;
+  if (Config.HasMember("Budget")) {
+    Budget = Config["Budget"].GetFloat();
+    if ((Budget <= 0.0f)||(Budget > 1.0f)) {
+      throw std::runtime_error(std::string("ERROR")+RootPath_+std::string(": Budget must be greater than 0 and at most 1."));
+    }
+  }
+  Budget_us_ = Budget*FramePeriod_us;
+  if (Config.HasMember("Degrade-After")) {
+    DegradeAfter_ = Config["Degrade-After"].GetUint();
+  }
+  if (Config.HasMember("Recover-After")) {
+    RecoverAfter_ = Config["Recover-After"].GetUint();
+  }
+  if (Config.HasMember("Degrade")) {
+    for (auto &Item : Config["Degrade"].GetArray()) {
+      if (Item == "Armed-Control") {
+        DegradeArmedControl_ = true;
+      } else if (Item == "Armed-Excitation") {
+        DegradeArmedExcitation_ = true;
+      } else if (Item == "Telemetry") {
+        DegradeTelemetry_ = true;
+      } else {
+        throw std::runtime_error(std::string("ERROR")+RootPath_+std::string(": Degrade item specified is not defined."));
+      }
+    }
+  }
+  if (Config.HasMember("Telemetry-Decimation")) {
+    TelemetryDecimation_ = Config["Telemetry-Decimation"].GetUint();
+    if (TelemetryDecimation_ == 0) {
+      throw std::runtime_error(std::string("ERROR")+RootPath_+std::string(": Telemetry-Decimation must be at least 1."));
+    }
+  }
+  data_.Duration_us = deftree.initElement(RootPath_+"/Duration_us","Frame duration, us",LOG_UINT32,LOG_NONE);
+  data_.Overruns = deftree.initElement(RootPath_+"/Overruns","Number of frames over budget",LOG_UINT32,LOG_NONE);
+  data_.Consecutive = deftree.initElement(RootPath_+"/Consecutive","Number of consecutive frames over budget",LOG_UINT32,LOG_NONE);
+  data_.Degraded = deftree.initElement(RootPath_+"/Degraded","Non-essential work being shed",LOG_UINT8,LOG_NONE);
+  data_.Duration_us->setInt(0);
+  data_.Overruns->setInt(0);
+  data_.Consecutive->setInt(0);
+  data_.Degraded->setInt(0);
+  Configured_ = true;
+}
+
+/* Returns whether the frame monitor has been configured */
+bool FrameMonitor::Configured() {
+  return Configured_;
+}
+
+/* Marks the start of a frame, call when sensor data is received */
+void FrameMonitor::BeginFrame() {
+  clock_gettime(CLOCK_MONOTONIC,&FrameStart_);
+}
+
+/* Marks the end of a frame, updates the overrun counts and the degraded state */
+void FrameMonitor::EndFrame() {
+  if (!Configured_) {
+    return;
+  }
+  struct timespec Now;
+  clock_gettime(CLOCK_MONOTONIC,&Now);
+  int64_t Duration_us = (int64_t)(Now.tv_sec - FrameStart_.tv_sec)*1000000 + (Now.tv_nsec - FrameStart_.tv_nsec)/1000;
+  data_.Duration_us->setInt(Duration_us);
+  if (Duration_us > Budget_us_) {
+    OnTime_ = 0;
+    data_.Overruns->setInt(data_.Overruns->getInt()+1);
+    data_.Consecutive->setInt(data_.Consecutive->getInt()+1);
+    if ((uint32_t)data_.Consecutive->getInt() >= DegradeAfter_) {
+      Degraded_ = true;
+    }
+  } else {
+    OnTime_++;
+    data_.Consecutive->setInt(0);
+    if (OnTime_ >= RecoverAfter_) {
+      Degraded_ = false;
+    }
+  }
+  data_.Degraded->setInt(Degraded_);
+}
+
+/* Returns whether the armed and standby control laws should be run this frame */
+bool FrameMonitor::RunArmedControl() {
+  return !(Degraded_&&DegradeArmedControl_);
+}
+
+/* Returns whether the armed excitations should be run this frame */
+bool FrameMonitor::RunArmedExcitation() {
+  return !(Degraded_&&DegradeArmedExcitation_);
+}
+
+/* Returns whether telemetry should be sent this frame */
+bool FrameMonitor::SendTelemetry() {
+  if (!(Degraded_&&DegradeTelemetry_)) {
+    TelemetryCounter_ = 0;
+    return true;
+  }
+  TelemetryCounter_++;
+  if (TelemetryCounter_ >= TelemetryDecimation_) {
+    TelemetryCounter_ = 0;
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,96 @@
+/*
+frame-monitor.h
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef FRAME_MONITOR_H_
+#define FRAME_MONITOR_H_
+
+#include "rapidjson/document.h"
+#include "definition-tree2.h"
+#include <stdint.h>
+#include <time.h>
+#include <string>
+#include <exception>
+#include <stdexcept>
+
+/*
+Frame deadline monitor - measures the time from receiving a sensor frame to
+the end of the flight loop against the FMU frame period, counts overruns and
+consecutive misses and degrades non-essential work while the budget is being
+exceeded, so the engaged control law stays on time under load spikes. The
+degraded state is entered after Degrade-After consecutive overruns and left
+after Recover-After consecutive frames within budget.
+Example JSON configuration:
+"Frame-Monitor": {
+  "Budget": 0.8,
+  "Degrade-After": 2,
+  "Recover-After": 50,
+  "Degrade": ["Armed-Control", "Armed-Excitation", "Telemetry"],
+  "Telemetry-Decimation": 5
+}
+Where:
+   * Budget is the fraction of the frame period the loop may use before a
+     frame counts as an overrun. Optional, defaults to 1.
+   * Degrade-After and Recover-After are numbers of consecutive frames.
+     Optional, defaulting to 2 and 50.
+   * Degrade lists what is shed while degraded: "Armed-Control" skips the
+     armed and standby control laws, "Armed-Excitation" the armed
+     excitations and "Telemetry" decimates telemetry. Optional, nothing is
+     shed by default and overruns are only counted.
+   * Telemetry-Decimation sends telemetry every Nth frame while degraded.
+     Optional, defaults to 5.
+Data is output to:
+   * /Frame-Monitor/Duration_us, time the last frame took
+   * /Frame-Monitor/Overruns, total number of frames over budget
+   * /Frame-Monitor/Consecutive, current number of consecutive overruns
+   * /Frame-Monitor/Degraded, whether non-essential work is being shed
+*/
+class FrameMonitor {
+  public:
+    void Configure(const rapidjson::Value& Config,uint32_t FramePeriod_us);
+    bool Configured();
+    void BeginFrame();
+    void EndFrame();
+    bool RunArmedControl();
+    bool RunArmedExcitation();
+    bool SendTelemetry();
+  private:
+    std::string RootPath_ = "/Frame-Monitor";
+    bool Configured_ = false;
+    uint32_t Budget_us_ = 0;
+    uint32_t DegradeAfter_ = 2;
+    uint32_t RecoverAfter_ = 50;
+    bool DegradeArmedControl_ = false;
+    bool DegradeArmedExcitation_ = false;
+    bool DegradeTelemetry_ = false;
+    uint32_t TelemetryDecimation_ = 5;
+    uint32_t TelemetryCounter_ = 0;
+    uint32_t OnTime_ = 0;
+    bool Degraded_ = false;
+    struct timespec FrameStart_;
+    struct Data {
+      ElementPtr Duration_us;
+      ElementPtr Overruns;
+      ElementPtr Consecutive;
+      ElementPtr Degraded;
+    };
+    Data data_;
+};
+
+#endif
@@ -0,0 +1,168 @@
+/*
+frame-pipeline.cpp
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "frame-pipeline.h"
+
+/* Stops and joins the pipeline threads */
+FramePipeline::~FramePipeline() {
+  {
+    std::lock_guard<std::mutex> Lock(Mutex_);
+    Stop_ = true;
+  }
+  StartCond_.notify_all();
+  {
+    std::lock_guard<std::mutex> Lock(OutputMutex_);
+    OutputStop_ = true;
+  }
+  OutputCond_.notify_all();
+  for (auto &Worker : Workers_) {
+    Worker.join();
+  }
+  if (Output_.joinable()) {
+    Output_.join();
+  }
+}
+
+/* Configures the pipeline given a JSON value */
+void FramePipeline::Configure(const rapidjson::Value& Config) {
+  if (Config.HasMember("Workers")) {
+    NumWorkers_ = Config["Workers"].GetUint();
+    if (NumWorkers_ >= std::thread::hardware_concurrency()) {
+      throw std::runtime_error(std::string("ERROR")+RootPath_+std::string(": More workers than there are other cores."));
+    }
+  }
+  if (Config.HasMember("Overlap-Output")) {
+    OverlapOutput_ = Config["Overlap-Output"].GetBool();
+  }
+}
+
+/* Starts the pipeline threads, each calls its init function first */
+void FramePipeline::Begin(std::function<void()> WorkerInit,std::function<void()> OutputInit) {
+  for (size_t i=0; i < NumWorkers_; i++) {
+    Workers_.push_back(std::thread(&FramePipeline::WorkerLoop,this,WorkerInit));
+  }
+  if (OverlapOutput_) {
+    Output_ = std::thread(&FramePipeline::OutputLoop,this,OutputInit);
+  }
+}
+
+/* Runs ParallelJob for indices 0 to Count-1 on the pool and the calling thread, returns once all are done */
+void FramePipeline::RunParallel(Job &ParallelJob,size_t Count) {
+  if ((Workers_.size() == 0)||(Count < 2)) {
+    for (size_t i=0; i < Count; i++) {
+      ParallelJob.Run(i);
+    }
+    return;
+  }
+  std::unique_lock<std::mutex> Lock(Mutex_);
+  // a worker that woke late for the previous job may still be leaving it
+  DoneCond_.wait(Lock,[this]{return Active_ == 0;});
+  Job_ = &ParallelJob;
+  Count_ = Count;
+  Next_.store(0);
+  Completed_.store(0);
+  Generation_++;
+  Lock.unlock();
+  StartCond_.notify_all();
+  Work();
+  // barrier, the workers may still be finishing their last index
+  Lock.lock();
+  DoneCond_.wait(Lock,[this]{return (Completed_.load() == Count_)&&(Active_ == 0);});
+}
+
+/* Starts OutputJob on the output thread, or runs it if there is none */
+void FramePipeline::StartOutput(Job &OutputJob) {
+  if (!Output_.joinable()) {
+    OutputJob.Run(0);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> Lock(OutputMutex_);
+    OutputJob_ = &OutputJob;
+    OutputPending_ = true;
+  }
+  OutputCond_.notify_one();
+}
+
+/* Waits for the output job to finish, call before changing what it sends */
+void FramePipeline::WaitOutput() {
+  if (!Output_.joinable()) {
+    return;
+  }
+  std::unique_lock<std::mutex> Lock(OutputMutex_);
+  OutputCond_.wait(Lock,[this]{return !OutputPending_;});
+}
+
+/* Returns the number of worker threads */
+size_t FramePipeline::Workers() {
+  return Workers_.size();
+}
+
+/* Takes indices of the current job until there are none left */
+void FramePipeline::Work() {
+  size_t i;
+  while ((i = Next_.fetch_add(1)) < Count_) {
+    Job_->Run(i);
+    Completed_.fetch_add(1);
+  }
+}
+
+/* Worker thread, waits for each new job */
+void FramePipeline::WorkerLoop(std::function<void()> Init) {
+  if (Init) {
+    Init();
+  }
+  uint64_t Generation = 0;
+  std::unique_lock<std::mutex> Lock(Mutex_);
+  while (1) {
+    StartCond_.wait(Lock,[this,&Generation]{return Stop_||(Generation_ != Generation);});
+    if (Stop_) {
+      return;
+    }
+    Generation = Generation_;
+    Active_++;
+    Lock.unlock();
+    Work();
+    Lock.lock();
+    Active_--;
+    DoneCond_.notify_one();
+  }
+}
+
+/* Output thread, runs each output job as it is started */
+void FramePipeline::OutputLoop(std::function<void()> Init) {
+  if (Init) {
+    Init();
+  }
+  std::unique_lock<std::mutex> Lock(OutputMutex_);
+  while (1) {
+    OutputCond_.wait(Lock,[this]{return OutputStop_||(OutputPending_&&(OutputJob_ != NULL));});
+    if (OutputStop_) {
+      return;
+    }
+    Job *OutputJob = OutputJob_;
+    Lock.unlock();
+    OutputJob->Run(0);
+    Lock.lock();
+    OutputJob_ = NULL;
+    OutputPending_ = false;
+    OutputCond_.notify_all();
+  }
+}
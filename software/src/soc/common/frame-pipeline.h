@@ -0,0 +1,99 @@
+/*
+frame-pipeline.h
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef FRAME_PIPELINE_H_
+#define FRAME_PIPELINE_H_
+
+#include "rapidjson/document.h"
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <string>
+#include <exception>
+#include <stdexcept>
+
+/*
+Frame pipeline - optional parallelism for the flight loop. A small fixed pool
+of worker threads evaluates independent jobs, i.e. the armed research groups,
+with a barrier before returning so each frame stays deterministic; the flight
+thread takes part in the work and the engaged path is never handed to the
+pool. An output thread sends the telemetry and datalog packets packed at the
+end of frame N while the flight thread receives and processes frame N+1.
+Without configuration, or with no workers, jobs run in order on the calling
+thread.
+Example JSON configuration:
+"Pipeline": {
+  "Workers": 1,
+  "Overlap-Output": true
+}
+Where:
+   * Workers is the number of worker threads in addition to the flight
+     thread. Optional, defaults to 0.
+   * Overlap-Output sends telemetry and datalog packets from the output
+     thread. Optional, defaults to false.
+*/
+class FramePipeline {
+  public:
+    /* Work handed to the pipeline, Run is called once for each index */
+    class Job {
+      public:
+        virtual void Run(size_t Index) = 0;
+        virtual ~Job() {}
+    };
+    ~FramePipeline();
+    void Configure(const rapidjson::Value& Config);
+    void Begin(std::function<void()> WorkerInit,std::function<void()> OutputInit);
+    void RunParallel(Job &ParallelJob,size_t Count);
+    void StartOutput(Job &OutputJob);
+    void WaitOutput();
+    size_t Workers();
+  private:
+    std::string RootPath_ = "/Pipeline";
+    size_t NumWorkers_ = 0;
+    bool OverlapOutput_ = false;
+    bool Stop_ = false;
+    // worker pool
+    std::vector<std::thread> Workers_;
+    std::mutex Mutex_;
+    std::condition_variable StartCond_;
+    std::condition_variable DoneCond_;
+    uint64_t Generation_ = 0;
+    Job *Job_ = NULL;
+    size_t Count_ = 0;
+    size_t Active_ = 0;
+    std::atomic<size_t> Next_{0};
+    std::atomic<size_t> Completed_{0};
+    // output thread
+    std::thread Output_;
+    std::mutex OutputMutex_;
+    std::condition_variable OutputCond_;
+    Job *OutputJob_ = NULL;
+    bool OutputPending_ = false;
+    bool OutputStop_ = false;
+    void Work();
+    void WorkerLoop(std::function<void()> Init);
+    void OutputLoop(std::function<void()> Init);
+};
+
+#endif
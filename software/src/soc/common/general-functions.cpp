@@ -21,6 +21,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include "general-functions.h"
 #include <stdio.h>
 #include <iostream>
+#include <algorithm>
 
 /* Constant class methods, see general-functions.h for more information */
 void ConstantClass::Configure(const rapidjson::Value& Config,std::string RootPath) {
@@ -39,7 +40,7 @@ void ConstantClass::Configure(const rapidjson::Value& Config,std::string RootPat
 
   // pointer to log command data
   OutputKey_ = OutputName;
-  data_.output_node = deftree.initElement(OutputKey_,"Control law output", LOG_FLOAT, LOG_NONE);
+  data_.output_node = deftree.initSignal<float>(OutputKey_,"Control law output", LOG_FLOAT, LOG_NONE);
 }
 
 void ConstantClass::Initialize() {}
@@ -48,13 +49,13 @@ bool ConstantClass::Initialized() {return true;}
 
 void ConstantClass::Run(Mode mode) {
   data_.Mode = (uint8_t) mode;
-  data_.output_node->setFloat(config_.Constant);
+  data_.output_node.set(config_.Constant);
 }
 
 void ConstantClass::Clear() {
   config_.Constant = 0.0f;
   data_.Mode = kStandby;
-  data_.output_node->setFloat(0.0f);
+  data_.output_node.set(0.0f);
   deftree.Erase(OutputKey_);
   OutputKey_.clear();
 }
@@ -76,8 +77,8 @@ void GainClass::Configure(const rapidjson::Value& Config,std::string RootPath) {
 
   if (Config.HasMember("Input")) {
     InputKey_ = Config["Input"].GetString();
-    config_.input_node = deftree.getElement(InputKey_);
-    if ( !config_.input_node ) {
+    config_.input_node = deftree.getSignal<float>(InputKey_);
+    if ( !config_.input_node.isBound() ) {
       throw std::runtime_error(std::string("ERROR")+OutputName+std::string(": Input ")+InputKey_+std::string(" not found in global data."));
     }
   } else {
@@ -100,7 +101,7 @@ void GainClass::Configure(const rapidjson::Value& Config,std::string RootPath) {
 
   // pointer to log command data
   OutputKey_ = RootPath+"/"+Config["Output"].GetString();
-  data_.output_node = deftree.initElement(OutputKey_, "Control law output", LOG_FLOAT, LOG_NONE);
+  data_.output_node = deftree.initSignal<float>(OutputKey_, "Control law output", LOG_FLOAT, LOG_NONE);
 }
 
 void GainClass::Initialize() {}
@@ -108,7 +109,7 @@ bool GainClass::Initialized() {return true;}
 
 void GainClass::Run(Mode mode) {
   data_.Mode = (uint8_t) mode;
-  float val = config_.input_node->getFloat()*config_.Gain;
+  float val = config_.input_node.get()*config_.Gain;
   // saturate command
   if (config_.SaturateOutput) {
     if (val <= config_.LowerLimit) {
@@ -121,7 +122,7 @@ void GainClass::Run(Mode mode) {
       data_.saturated_node->setInt(0);
     }
   }
-  data_.output_node->setFloat( val );
+  data_.output_node.set(val);
 }
 
 void GainClass::Clear() {
@@ -130,7 +131,7 @@ void GainClass::Clear() {
   config_.UpperLimit = 0.0f;
   config_.SaturateOutput = false;
   data_.Mode = kStandby;
-  data_.output_node->setFloat(0.0f);
+  data_.output_node.set(0.0f);
   data_.saturated_node->setFloat(0.0f);
   deftree.Erase(SaturatedKey_);
   deftree.Erase(OutputKey_);
@@ -153,9 +154,9 @@ void SumClass::Configure(const rapidjson::Value& Config,std::string RootPath) {
       const rapidjson::Value& Input = Config["Inputs"][i];
       InputKeys_.push_back(Input.GetString());
 
-      ElementPtr ele = deftree.getElement(InputKeys_.back());
-      if ( ele ) {
-        config_.input_nodes.push_back(ele);
+      Signal<float> input = deftree.getSignal<float>(InputKeys_.back());
+      if ( input.isBound() ) {
+        config_.input_nodes.push_back(input);
       } else {
         throw std::runtime_error(std::string("ERROR")+OutputName+std::string(": Input ")+InputKeys_.back()+std::string(" not found in global data."));
       }
@@ -185,7 +186,7 @@ void SumClass::Configure(const rapidjson::Value& Config,std::string RootPath) {
   } else {
     OutputKey_ = RootPath+"/"+Config["Output"].GetString();
   }
-  data_.output_node = deftree.initElement(OutputKey_, "Control law output", LOG_FLOAT, LOG_NONE);
+  data_.output_node = deftree.initSignal<float>(OutputKey_, "Control law output", LOG_FLOAT, LOG_NONE);
 }
 
 void SumClass::Initialize() {}
@@ -196,7 +197,7 @@ void SumClass::Run(Mode mode) {
 
   float sum = 0.0;
   for (size_t i=0; i < config_.input_nodes.size(); i++) {
-    sum += config_.input_nodes[i]->getFloat();
+    sum += config_.input_nodes[i].get();
   }
 
   // saturate command
@@ -212,7 +213,7 @@ void SumClass::Run(Mode mode) {
     }
   }
 
-  data_.output_node->setFloat(sum);
+  data_.output_node.set(sum);
 }
 
 void SumClass::Clear() {
@@ -221,7 +222,7 @@ void SumClass::Clear() {
   config_.UpperLimit = 0.0f;
   config_.SaturateOutput = false;
   data_.Mode = kStandby;
-  data_.output_node->setFloat(0.0f);
+  data_.output_node.set(0.0f);
   data_.saturated_node->setInt(0.0f);
   deftree.Erase(SaturatedKey_);
   deftree.Erase(OutputKey_);
@@ -244,9 +245,9 @@ void ProductClass::Configure(const rapidjson::Value& Config,std::string RootPath
       const rapidjson::Value& Input = Config["Inputs"][i];
       InputKeys_.push_back(Input.GetString());
 
-      ElementPtr ele = deftree.getElement(InputKeys_.back());
-      if ( ele ) {
-        config_.input_nodes.push_back(ele);
+      Signal<float> input = deftree.getSignal<float>(InputKeys_.back());
+      if ( input.isBound() ) {
+        config_.input_nodes.push_back(input);
       } else {
         throw std::runtime_error(std::string("ERROR")+OutputName+std::string(": Input ")+InputKeys_.back()+std::string(" not found in global data."));
       }
@@ -270,7 +271,7 @@ void ProductClass::Configure(const rapidjson::Value& Config,std::string RootPath
 
   // pointer to log command data
   OutputKey_ = RootPath+"/"+Config["Output"].GetString();
-  data_.output_node = deftree.initElement(OutputKey_, "Control law output", LOG_FLOAT, LOG_NONE);
+  data_.output_node = deftree.initSignal<float>(OutputKey_, "Control law output", LOG_FLOAT, LOG_NONE);
 }
 
 void ProductClass::Initialize() {}
@@ -281,7 +282,7 @@ void ProductClass::Run(Mode mode) {
 
   float product = 1.0;
   for (size_t i=0; i < config_.input_nodes.size(); i++) {
-    product *= config_.input_nodes[i]->getFloat();
+    product *= config_.input_nodes[i].get();
   }
 
   // saturate command
@@ -296,7 +297,7 @@ void ProductClass::Run(Mode mode) {
       data_.saturated_node->setInt(0);
     }
   }
-  data_.output_node->setFloat(product);
+  data_.output_node.set(product);
 }
 
 void ProductClass::Clear() {
@@ -305,7 +306,7 @@ void ProductClass::Clear() {
   config_.UpperLimit = 0.0f;
   config_.SaturateOutput = false;
   data_.Mode = kStandby;
-  data_.output_node->setFloat(0.0f);
+  data_.output_node.set(0.0f);
   data_.saturated_node->setInt(0.0f);
   deftree.Erase(SaturatedKey_);
   deftree.Erase(OutputKey_);
@@ -326,8 +327,8 @@ void DelayClass::Configure(const rapidjson::Value& Config, std::string RootPath)
 
   if (Config.HasMember("Input")) {
     InputKey_ = Config["Input"].GetString();
-    config_.input_node = deftree.getElement(InputKey_);
-    if ( !config_.input_node ) {
+    config_.input_node = deftree.getSignal<float>(InputKey_);
+    if ( !config_.input_node.isBound() ) {
       throw std::runtime_error(std::string("ERROR")+OutputName+std::string(": Input ")+InputKey_+std::string(" not found in global data."));
     }
   } else {
@@ -335,18 +336,29 @@ void DelayClass::Configure(const rapidjson::Value& Config, std::string RootPath)
   }
 
   if (Config.HasMember("Delay_frames")) {
-    config_.delay_frames = Config["Delay_frames"].GetInt();
+    float delay = Config["Delay_frames"].GetFloat();
+    if (delay < 0.0f) {
+      throw std::runtime_error(std::string("ERROR")+OutputName+std::string(": Delay_frames must not be negative."));
+    }
+    config_.delay_frames = (size_t)delay;
+    config_.delay_fraction = delay - config_.delay_frames;
   } else {
     throw std::runtime_error(std::string("ERROR")+OutputName+std::string(": Delay_frames not specified in configuration."));
   }
 
+  // history of the current and delayed inputs, plus one more frame to
+  // interpolate a fractional delay
+  data_.buffer.assign(config_.delay_frames+2,0.0f);
+  data_.head = 0;
+
   // pointer to log command data
   OutputKey_ = RootPath+"/"+Config["Output"].GetString();
-  data_.output_node = deftree.initElement(OutputKey_, "Control law (Delay) output", LOG_FLOAT, LOG_NONE);
+  data_.output_node = deftree.initSignal<float>(OutputKey_, "Control law (Delay) output", LOG_FLOAT, LOG_NONE);
 }
 
 void DelayClass::Initialize() {
-  data_.buffer.clear();
+  std::fill(data_.buffer.begin(),data_.buffer.end(),0.0f);
+  data_.head = 0;
 }
 
 bool DelayClass::Initialized() { return true; }
@@ -354,20 +366,25 @@ bool DelayClass::Initialized() { return true; }
 void DelayClass::Run(Mode mode) {
   data_.Mode = (uint8_t) mode;
 
-  data_.buffer.push_back( config_.input_node->getFloat() );
-  float val = 0.0;
-  while ( data_.buffer.size() > 0 && data_.buffer.size() > config_.delay_frames ) {
-    val = data_.buffer.front();
-    data_.buffer.pop_front();
+  // frames before the history fills read the zeroed buffer
+  size_t len = data_.buffer.size();
+  data_.buffer[data_.head] = config_.input_node.get();
+  float val = data_.buffer[(data_.head + len - config_.delay_frames) % len];
+  if (config_.delay_fraction > 0.0f) {
+    float prev = data_.buffer[(data_.head + len - config_.delay_frames - 1) % len];
+    val += config_.delay_fraction*(prev - val);
   }
-  data_.output_node->setFloat(val);
+  data_.head = (data_.head + 1) % len;
+  data_.output_node.set(val);
 }
 
 void DelayClass::Clear() {
   config_.delay_frames = 0;
+  config_.delay_fraction = 0.0f;
   data_.Mode = kStandby;
   data_.buffer.clear();
-  data_.output_node->setFloat(0.0f);
+  data_.head = 0;
+  data_.output_node.set(0.0f);
   deftree.Erase(OutputKey_);
   InputKey_.clear();
   OutputKey_.clear();
@@ -385,8 +402,8 @@ void LatchClass::Configure(const rapidjson::Value& Config,std::string RootPath)
 
   if (Config.HasMember("Input")) {
     InputKey_ = Config["Input"].GetString();
-    config_.input_node = deftree.getElement(InputKey_);
-    if ( !config_.input_node ) {
+    config_.input_node = deftree.getSignal<float>(InputKey_);
+    if ( !config_.input_node.isBound() ) {
       throw std::runtime_error(std::string("ERROR")+OutputName+std::string(": Input ")+InputKey_+std::string(" not found in global data."));
     }
   } else {
@@ -395,7 +412,7 @@ void LatchClass::Configure(const rapidjson::Value& Config,std::string RootPath)
 
   // pointer to log command data
   OutputKey_ = RootPath+"/"+Config["Output"].GetString();
-  data_.output_node = deftree.initElement(OutputKey_, "Control law output", LOG_FLOAT, LOG_NONE);
+  data_.output_node = deftree.initSignal<float>(OutputKey_, "Control law output", LOG_FLOAT, LOG_NONE);
 }
 
 void LatchClass::Initialize() {}
@@ -408,7 +425,7 @@ void LatchClass::Run(Mode mode) {
     case GenericFunction::Mode::kEngage: {
       if (initLatch_ == false) {
         initLatch_ = true;
-        data_.output_node->setFloat(config_.input_node->getFloat());
+        data_.output_node.set(config_.input_node.get());
       }
       break;
     }
@@ -420,7 +437,7 @@ void LatchClass::Run(Mode mode) {
 
 void LatchClass::Clear() {
   data_.Mode = kStandby;
-  data_.output_node->setFloat(0.0f);
+  data_.output_node.set(0.0f);
   deftree.Erase(OutputKey_);
   InputKey_.clear();
   OutputKey_.clear();
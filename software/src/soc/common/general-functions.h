@@ -27,8 +27,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include "definition-tree2.h"
 #include "generic-function.h"
 
-#include <deque>
-using std::deque;
+#include <vector>
 
 /*
 Constant Class - Outputs a constant value.
@@ -56,7 +55,7 @@ class ConstantClass: public GenericFunction {
     };
     struct Data {
       uint8_t Mode = kStandby;
-      ElementPtr output_node;
+      Signal<float> output_node;
     };
     Config config_;
     Data data_;
@@ -92,14 +91,14 @@ class GainClass: public GenericFunction {
     void Clear();
   private:
     struct Config {
-      ElementPtr input_node;
+      Signal<float> input_node;
       float Gain = 1.0f;
       bool SaturateOutput = false;
       float UpperLimit, LowerLimit = 0.0f;
     };
     struct Data {
       uint8_t Mode = kStandby;
-      ElementPtr output_node;
+      Signal<float> output_node;
       ElementPtr saturated_node;
     };
     Config config_;
@@ -135,13 +134,13 @@ class SumClass: public GenericFunction {
     void Clear();
   private:
     struct Config {
-      std::vector<ElementPtr > input_nodes;
+      std::vector<Signal<float> > input_nodes;
       bool SaturateOutput = false;
       float UpperLimit, LowerLimit = 0.0f;
     };
     struct Data {
       uint8_t Mode = kStandby;
-      ElementPtr output_node;
+      Signal<float> output_node;
       ElementPtr saturated_node;
     };
     Config config_;
@@ -178,13 +177,13 @@ class ProductClass: public GenericFunction {
     void Clear();
   private:
     struct Config {
-      std::vector<ElementPtr > input_nodes;
+      std::vector<Signal<float> > input_nodes;
       bool SaturateOutput = false;
       float UpperLimit, LowerLimit = 0.0f;
     };
     struct Data {
       uint8_t Mode = kStandby;
-      ElementPtr output_node;
+      Signal<float> output_node;
       ElementPtr saturated_node;
     };
     Config config_;
@@ -205,8 +204,11 @@ Example JSON configuration:
 Where:
    * Output gives a convenient name for the block (i.e. SpeedReference).
    * Input is the full path name of the input signal.
-   * Output is the input signal delayed by n frames
-Data types for the input and output are both float.
+   * Output is the input signal delayed by n frames. A fractional n
+     linearly interpolates between the two nearest frames.
+Data types for the input and output are both float. The delay history
+is a ring buffer sized at configuration, running the block does not
+allocate.
 */
 class DelayClass: public GenericFunction {
   public:
@@ -217,13 +219,15 @@ class DelayClass: public GenericFunction {
     void Clear();
   private:
     struct Config {
-      ElementPtr input_node;
-      int delay_frames = 0;
+      Signal<float> input_node;
+      size_t delay_frames = 0;
+      float delay_fraction = 0.0f;
     };
     struct Data {
       uint8_t Mode = kStandby;
-      ElementPtr output_node;
-      deque<float> buffer;
+      Signal<float> output_node;
+      std::vector<float> buffer;
+      size_t head = 0;
     };
     Config config_;
     Data data_;
@@ -254,11 +258,11 @@ class LatchClass: public GenericFunction {
     void Clear();
   private:
     struct Config {
-      ElementPtr input_node;
+      Signal<float> input_node;
     };
     struct Data {
       uint8_t Mode = kStandby;
-      ElementPtr output_node;
+      Signal<float> output_node;
     };
     bool initLatch_ = false;
     Config config_;
@@ -0,0 +1,160 @@
+/*
+heap-monitor.cpp
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "heap-monitor.h"
+
+#ifdef HEAP_MONITOR
+
+#include <errno.h>
+#include <execinfo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* glibc's allocator, called by the replacements below */
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t nmemb,size_t size);
+void *__libc_realloc(void *ptr,size_t size);
+void *__libc_memalign(size_t alignment,size_t size);
+void *__libc_valloc(size_t size);
+void *__libc_pvalloc(size_t size);
+}
+
+namespace {
+  // state is per thread so only the flight thread's frames are monitored
+  thread_local bool InFrame_ = false;
+  thread_local bool InHook_ = false;
+  bool Armed_ = false;
+  size_t WarmupFrames_ = 0;
+  uint64_t Frame_ = 0;
+  uint64_t FrameAllocations_ = 0;
+  uint64_t Allocations_ = 0;
+  unsigned int Reports_ = 0;
+  const unsigned int MaxReports_ = 32;
+  const int MaxDepth_ = 32;
+
+  /* Counts an allocation made inside a frame and reports where it came from */
+  void Record(size_t Size) {
+    if ((!InFrame_)||(InHook_)) {
+      return;
+    }
+    InHook_ = true;
+    FrameAllocations_++;
+    Allocations_++;
+    if (Reports_ < MaxReports_) {
+      Reports_++;
+      char Message[96];
+      int Length = snprintf(Message,sizeof(Message),"HeapMonitor: %zu byte allocation in frame %llu\n",Size,(unsigned long long)Frame_);
+      if (write(STDERR_FILENO,Message,Length) < 0) {}
+      void *Stack[MaxDepth_];
+      int Depth = backtrace(Stack,MaxDepth_);
+      backtrace_symbols_fd(Stack,Depth,STDERR_FILENO);
+    }
+    #ifdef HEAP_MONITOR_ABORT
+    abort();
+    #endif
+    InHook_ = false;
+  }
+}
+
+extern "C" void *malloc(size_t size) {
+  Record(size);
+  return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t nmemb,size_t size) {
+  Record(nmemb*size);
+  return __libc_calloc(nmemb,size);
+}
+
+extern "C" void *realloc(void *ptr,size_t size) {
+  Record(size);
+  return __libc_realloc(ptr,size);
+}
+
+// aligned and over-aligned operator new and Eigen's aligned allocations land here
+extern "C" int posix_memalign(void **memptr,size_t alignment,size_t size) {
+  if ((alignment % sizeof(void *) != 0)||((alignment & (alignment - 1)) != 0)||(alignment == 0)) {
+    return EINVAL;
+  }
+  Record(size);
+  void *ptr = __libc_memalign(alignment,size);
+  if (ptr == NULL) {
+    return ENOMEM;
+  }
+  *memptr = ptr;
+  return 0;
+}
+
+extern "C" void *aligned_alloc(size_t alignment,size_t size) {
+  Record(size);
+  return __libc_memalign(alignment,size);
+}
+
+extern "C" void *memalign(size_t alignment,size_t size) {
+  Record(size);
+  return __libc_memalign(alignment,size);
+}
+
+extern "C" void *valloc(size_t size) {
+  Record(size);
+  return __libc_valloc(size);
+}
+
+extern "C" void *pvalloc(size_t size) {
+  Record(size);
+  return __libc_pvalloc(size);
+}
+
+/* Arms the monitor, frames after the first WarmupFrames are checked */
+void HeapMonitor::Arm(size_t WarmupFrames) {
+  // the first backtrace loads the unwinder, which allocates
+  void *Stack[1];
+  backtrace(Stack,1);
+  WarmupFrames_ = WarmupFrames;
+  Frame_ = 0;
+  Armed_ = true;
+}
+
+/* Starts monitoring the calling thread's allocations */
+void HeapMonitor::BeginFrame() {
+  Frame_++;
+  FrameAllocations_ = 0;
+  InFrame_ = Armed_ && (Frame_ > WarmupFrames_);
+}
+
+/* Stops monitoring and reports the frame's allocation count */
+void HeapMonitor::EndFrame() {
+  if (!InFrame_) {
+    return;
+  }
+  InFrame_ = false;
+  if (FrameAllocations_ > 0) {
+    fprintf(stderr,"HeapMonitor: frame %llu made %llu allocations\n",(unsigned long long)Frame_,(unsigned long long)FrameAllocations_);
+  }
+}
+
+/* Returns the number of allocations made inside monitored frames */
+uint64_t HeapMonitor::Allocations() {
+  return Allocations_;
+}
+
+#endif
@@ -0,0 +1,52 @@
+/*
+heap-monitor.h
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef HEAP_MONITOR_H_
+#define HEAP_MONITOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Heap allocation monitor for the flight loop. Built with HEAP_MONITOR defined
+("make HEAP_MONITOR=1", or HEAP_MONITOR=abort to stop at the first one), malloc,
+calloc, realloc and the aligned allocators (posix_memalign, aligned_alloc,
+memalign, valloc and pvalloc, used by aligned operator new and Eigen) are
+replaced with counting versions. Once armed, allocations made on the flight
+thread between BeginFrame and EndFrame are counted and the first few are
+reported to stderr with a backtrace. Without HEAP_MONITOR all of the methods
+compile to nothing.
+*/
+class HeapMonitor {
+  public:
+    static void Arm(size_t WarmupFrames=10);
+    static void BeginFrame();
+    static void EndFrame();
+    static uint64_t Allocations();
+};
+
+#ifndef HEAP_MONITOR
+inline void HeapMonitor::Arm(size_t) {}
+inline void HeapMonitor::BeginFrame() {}
+inline void HeapMonitor::EndFrame() {}
+inline uint64_t HeapMonitor::Allocations() { return 0; }
+#endif
+
+#endif
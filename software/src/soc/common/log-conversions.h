@@ -0,0 +1,82 @@
+/*
+log-conversions.h
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef LOG_CONVERSIONS_H_
+#define LOG_CONVERSIONS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <cstring>
+
+/*
+Reduced precision conversions for the LOG_FLOAT16, LOG_SCALED_INT16 and
+LOG_SCALED_UINT16 tags, shared by the datalog and telemetry.
+*/
+
+/* Converts floats to IEEE half precision, rounding to nearest even. Both the
+normal and subnormal results are computed and selected with masks so the
+compiler vectorizes the loop. */
+inline void FloatToHalf(const float * __restrict Src, uint16_t * __restrict Dst, size_t Count) {
+  for (size_t i=0; i < Count; i++) {
+    uint32_t Bits;
+    memcpy(&Bits,&Src[i],sizeof(Bits));
+    uint32_t Sign = Bits & 0x80000000u;
+    uint32_t Abs = Bits & 0x7fffffffu;
+    // normal range, rebias the exponent and round off 13 mantissa bits
+    uint32_t Normal = (Abs + 0xc8000fffu + ((Abs >> 13) & 1)) >> 13;
+    // subnormal range, adding 0.5 lets the FPU shift the mantissa into place
+    float AbsFloat;
+    memcpy(&AbsFloat,&Abs,sizeof(AbsFloat));
+    float Shifted = AbsFloat + 0.5f;
+    uint32_t ShiftedBits;
+    memcpy(&ShiftedBits,&Shifted,sizeof(ShiftedBits));
+    uint32_t Subnormal = ShiftedBits - 0x3f000000u;
+    // too large for half precision is infinity, NaN stays NaN
+    uint32_t Overflow = 0x7c00u | ((0u - (uint32_t)(Abs > 0x7f800000u)) & 0x200u);
+    uint32_t IsSubnormal = 0u - (uint32_t)(Abs < 0x38800000u);
+    uint32_t IsOverflow = 0u - (uint32_t)(Abs >= 0x47800000u);
+    uint32_t Half = (Subnormal & IsSubnormal) | (Normal & ~IsSubnormal);
+    Half = (Overflow & IsOverflow) | (Half & ~IsOverflow);
+    Dst[i] = Half | (Sign >> 16);
+  }
+}
+
+/* Converts floats to round((Src - Offset) * InvScale), saturating at the int16
+range. Rounding is done in the positive range so the loop vectorizes. */
+inline void FloatToScaledInt16(const float * __restrict Src, const float * __restrict Offset, const float * __restrict InvScale, int16_t * __restrict Dst, size_t Count) {
+  for (size_t i=0; i < Count; i++) {
+    float Value = (Src[i] - Offset[i])*InvScale[i] + 32768.5f;
+    Value = (Value > 0.0f) ? Value : 0.0f;
+    Value = (Value < 65535.0f) ? Value : 65535.0f;
+    Dst[i] = (int32_t)Value - 32768;
+  }
+}
+
+/* Converts floats to round((Src - Offset) * InvScale), saturating at the uint16 range */
+inline void FloatToScaledUint16(const float * __restrict Src, const float * __restrict Offset, const float * __restrict InvScale, uint16_t * __restrict Dst, size_t Count) {
+  for (size_t i=0; i < Count; i++) {
+    float Value = (Src[i] - Offset[i])*InvScale[i] + 0.5f;
+    Value = (Value > 0.0f) ? Value : 0.0f;
+    Value = (Value < 65535.0f) ? Value : 65535.0f;
+    Dst[i] = (int32_t)Value;
+  }
+}
+
+#endif
@@ -393,19 +393,23 @@ void MissionManager::Run() {
       EngagedSensorProcessing_ = TestPoints_[std::to_string(CurrentTestPointIndex_node->getInt())].SensorProcessing;
       EngagedController_ = TestPoints_[std::to_string(CurrentTestPointIndex_node->getInt())].Control;
       ArmedController_ = TestPoints_[std::to_string(NextTestPointIndex_)].Control;
+      ArmedSensorProcessing_ = TestPoints_[std::to_string(NextTestPointIndex_)].SensorProcessing;
       // EngagedExcitation_ = "None";
 
     } else { // In SOC Baseline, arm the next controller, no excitation
       EngagedSensorProcessing_ = "Baseline";
       EngagedController_ = config_.BaselineController;
       ArmedController_ = TestPoints_[std::to_string(CurrentTestPointIndex_node->getInt())].Control;
+      ArmedSensorProcessing_ = TestPoints_[std::to_string(CurrentTestPointIndex_node->getInt())].SensorProcessing;
       EngagedExcitation_ = "None";
       if (LaunchSelect_ == true) {  // In SOC, Launch Controller
         EngagedController_ = config_.LaunchController;
         ArmedController_ = config_.BaselineController;
+        ArmedSensorProcessing_ = "Baseline";
       } else if (LandSelect_ == true) { // In SOC, Landing Controller
         EngagedController_ = config_.LandController;
         ArmedController_ = config_.BaselineController;
+        ArmedSensorProcessing_ = "Baseline";
       }
     }
 
@@ -413,6 +417,7 @@ void MissionManager::Run() {
     EngagedSensorProcessing_ = "Baseline";
     EngagedController_ = "Fmu";
     ArmedController_ = config_.BaselineController;
+    ArmedSensorProcessing_ = "Baseline";
     EngagedExcitation_ = "None";
   }
 
@@ -424,21 +429,26 @@ void MissionManager::Run() {
 }
 
 /* returns the string of the sensor processing group that is engaged */
-std::string MissionManager::GetEngagedSensorProcessing() {
+const std::string &MissionManager::GetEngagedSensorProcessing() {
   return EngagedSensorProcessing_;
 }
 
 /* returns the string of the control group that is engaged */
-std::string MissionManager::GetEngagedController() {
+const std::string &MissionManager::GetEngagedController() {
   return EngagedController_;
 }
 
 /* returns the string of the control group that is armed */
-std::string MissionManager::GetArmedController() {
+const std::string &MissionManager::GetArmedController() {
   return ArmedController_;
 }
 
+/* returns the string of the sensor processing group that is armed */
+const std::string &MissionManager::GetArmedSensorProcessing() {
+  return ArmedSensorProcessing_;
+}
+
 /* returns the string of the excitation group that is engaged */
-std::string MissionManager::GetEngagedExcitation() {
+const std::string &MissionManager::GetEngagedExcitation() {
   return EngagedExcitation_;
 }
@@ -48,10 +48,11 @@ class MissionManager {
     };
     void Configure(const rapidjson::Value& Config);
     void Run();
-    std::string GetEngagedSensorProcessing();
-    std::string GetEngagedController();
-    std::string GetArmedController();
-    std::string GetEngagedExcitation();
+    const std::string &GetEngagedSensorProcessing();
+    const std::string &GetEngagedController();
+    const std::string &GetArmedController();
+    const std::string &GetArmedSensorProcessing();
+    const std::string &GetEngagedExcitation();
   private:
     struct Configuration {
       struct Switch {
@@ -96,6 +97,7 @@ class MissionManager {
     std::string EngagedSensorProcessing_ = "Baseline";
     std::string EngagedController_ = "Fmu";
     std::string ArmedController_ = "Fmu";
+    std::string ArmedSensorProcessing_ = "Baseline";
     std::string EngagedExcitation_ = "None";
     ElementPtr EngagedExcitationFlag_node;
 
@@ -0,0 +1,226 @@
+/*
+real-time.cpp
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "real-time.h"
+
+#include <alloca.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <iostream>
+
+/* Configures the real-time runtime given a JSON value */
+void RealTimeRuntime::Configure(const rapidjson::Value& Config) {
+  Policy_ = SCHED_FIFO;
+  if (Config.HasMember("Policy")) {
+    std::string Policy = Config["Policy"].GetString();
+    if (Policy == "FIFO") {
+      Policy_ = SCHED_FIFO;
+    } else if (Policy == "RR") {
+      Policy_ = SCHED_RR;
+    } else if (Policy == "Other") {
+      Policy_ = SCHED_OTHER;
+    } else {
+      throw std::runtime_error(std::string("ERROR")+RootPath_+std::string(": Policy specified is not a defined policy."));
+    }
+  }
+  if (Config.HasMember("Priority")) {
+    Priority_ = Config["Priority"].GetInt();
+  }
+  if (Config.HasMember("Auxiliary-Priority")) {
+    AuxiliaryPriority_ = Config["Auxiliary-Priority"].GetInt();
+  }
+  if (Policy_ != SCHED_OTHER) {
+    if ((Priority_ < sched_get_priority_min(Policy_))||(Priority_ > sched_get_priority_max(Policy_))) {
+      throw std::runtime_error(std::string("ERROR")+RootPath_+std::string(": Priority out of range."));
+    }
+    if ((AuxiliaryPriority_ != 0)&&((AuxiliaryPriority_ < sched_get_priority_min(Policy_))||(AuxiliaryPriority_ >= Priority_))) {
+      throw std::runtime_error(std::string("ERROR")+RootPath_+std::string(": Auxiliary-Priority must be below Priority."));
+    }
+  }
+  long NumCpus = sysconf(_SC_NPROCESSORS_ONLN);
+  if (Config.HasMember("Cpu")) {
+    Cpu_ = Config["Cpu"].GetInt();
+    if ((Cpu_ < 0)||(Cpu_ >= NumCpus)) {
+      throw std::runtime_error(std::string("ERROR")+RootPath_+std::string(": Cpu not available."));
+    }
+  }
+  if (Config.HasMember("Auxiliary-Cpus")) {
+    for (auto &Cpu : Config["Auxiliary-Cpus"].GetArray()) {
+      if ((Cpu.GetInt() < 0)||(Cpu.GetInt() >= NumCpus)) {
+        throw std::runtime_error(std::string("ERROR")+RootPath_+std::string(": Auxiliary-Cpus not available."));
+      }
+      AuxiliaryCpus_.push_back(Cpu.GetInt());
+    }
+  } else if (Cpu_ >= 0) {
+    // everything but the flight core
+    for (int i=0; i < NumCpus; i++) {
+      if (i != Cpu_) {
+        AuxiliaryCpus_.push_back(i);
+      }
+    }
+  }
+  if (Config.HasMember("Lock-Memory")) {
+    LockMemory_ = Config["Lock-Memory"].GetBool();
+  }
+  if (Config.HasMember("Prefault-Heap_kB")) {
+    PrefaultHeap_kB_ = Config["Prefault-Heap_kB"].GetUint();
+  }
+  if (Config.HasMember("Prefault-Stack_kB")) {
+    PrefaultStack_kB_ = Config["Prefault-Stack_kB"].GetUint();
+  }
+  if (Config.HasMember("Self-Check")) {
+    const rapidjson::Value& SelfCheck = Config["Self-Check"];
+    if (SelfCheck.HasMember("Period_us")) {
+      SelfCheckPeriod_us_ = SelfCheck["Period_us"].GetUint();
+    }
+    if (SelfCheck.HasMember("Samples")) {
+      SelfCheckSamples_ = SelfCheck["Samples"].GetUint();
+    }
+    SelfCheck_ = (SelfCheckPeriod_us_ > 0)&&(SelfCheckSamples_ > 0);
+  }
+  Configured_ = true;
+}
+
+/* Returns whether the runtime has been configured */
+bool RealTimeRuntime::Configured() {
+  return Configured_;
+}
+
+/* Sets up the calling thread as the flight thread, call once configuration is done */
+void RealTimeRuntime::Begin() {
+  if (!Configured_) {
+    return;
+  }
+  if (LockMemory_) {
+    // keep freed memory in the process rather than returning it to the
+    // system, so pre-faulted pages stay resident and locked
+    mallopt(M_TRIM_THRESHOLD,-1);
+    mallopt(M_MMAP_MAX,0);
+    if (mlockall(MCL_CURRENT|MCL_FUTURE) != 0) {
+      std::cout << "WARNING" << RootPath_ << ": Unable to lock memory, " << strerror(errno) << "." << std::endl;
+    }
+  }
+  if (PrefaultHeap_kB_ > 0) {
+    size_t Size = PrefaultHeap_kB_*1024;
+    char *Heap = (char *)malloc(Size);
+    if (Heap) {
+      for (size_t i=0; i < Size; i += sysconf(_SC_PAGESIZE)) {
+        ((volatile char *)Heap)[i] = 0;
+      }
+      free(Heap);
+    }
+  }
+  PrefaultStack(PrefaultStack_kB_*1024);
+  std::vector<int> Cpus;
+  if (Cpu_ >= 0) {
+    Cpus.push_back(Cpu_);
+  }
+  SetScheduling(Policy_,Priority_,Cpus,"flight");
+}
+
+/* Sets up the calling thread as an auxiliary thread, call from the thread */
+void RealTimeRuntime::BeginAuxiliary() {
+  if (!Configured_) {
+    return;
+  }
+  if ((AuxiliaryPriority_ > 0)&&(Policy_ != SCHED_OTHER)) {
+    SetScheduling(Policy_,AuxiliaryPriority_,AuxiliaryCpus_,"auxiliary");
+  } else {
+    SetScheduling(SCHED_OTHER,0,AuxiliaryCpus_,"auxiliary");
+  }
+}
+
+/* Sets up the calling thread as a pipeline worker, call from the thread */
+void RealTimeRuntime::BeginWorker() {
+  if (!Configured_) {
+    return;
+  }
+  SetScheduling(Policy_,Priority_,AuxiliaryCpus_,"worker");
+}
+
+/* Measures the wake up latency of the calling thread and reports it */
+void RealTimeRuntime::SelfCheck() {
+  if (!SelfCheck_) {
+    return;
+  }
+  std::cout << "\tReal-time self-check, " << SelfCheckSamples_ << " samples at " << SelfCheckPeriod_us_ << " us..." << std::flush;
+  int64_t Period_ns = (int64_t)SelfCheckPeriod_us_*1000;
+  int64_t Min_ns = INT64_MAX, Max_ns = 0, Sum_ns = 0;
+  struct timespec Deadline, Now;
+  clock_gettime(CLOCK_MONOTONIC,&Deadline);
+  for (uint32_t i=0; i < SelfCheckSamples_; i++) {
+    Deadline.tv_nsec += Period_ns;
+    while (Deadline.tv_nsec >= 1000000000) {
+      Deadline.tv_nsec -= 1000000000;
+      Deadline.tv_sec++;
+    }
+    clock_nanosleep(CLOCK_MONOTONIC,TIMER_ABSTIME,&Deadline,NULL);
+    clock_gettime(CLOCK_MONOTONIC,&Now);
+    int64_t Latency_ns = (int64_t)(Now.tv_sec - Deadline.tv_sec)*1000000000 + (Now.tv_nsec - Deadline.tv_nsec);
+    if (Latency_ns < Min_ns) {Min_ns = Latency_ns;}
+    if (Latency_ns > Max_ns) {Max_ns = Latency_ns;}
+    Sum_ns += Latency_ns;
+  }
+  std::cout << "done!" << std::endl;
+  std::cout << "\t\tWake up latency (us): min " << Min_ns/1000 << ", mean " << Sum_ns/SelfCheckSamples_/1000 << ", max " << Max_ns/1000 << std::endl;
+  if (Max_ns > Period_ns/2) {
+    std::cout << "WARNING" << RootPath_ << ": Worst case latency exceeds half the self-check period." << std::endl;
+  }
+}
+
+/* Applies a scheduling policy, priority and core affinity to the calling thread */
+void RealTimeRuntime::SetScheduling(int Policy,int Priority,const std::vector<int> &Cpus,const std::string &Name) {
+  struct sched_param Param;
+  memset(&Param,0,sizeof(Param));
+  Param.sched_priority = (Policy == SCHED_OTHER) ? 0 : Priority;
+  int Error = pthread_setschedparam(pthread_self(),Policy,&Param);
+  if (Error != 0) {
+    std::cout << "WARNING" << RootPath_ << ": Unable to set " << Name << " thread scheduling, " << strerror(Error) << "." << std::endl;
+  }
+  if (Cpus.size() > 0) {
+    cpu_set_t Set;
+    CPU_ZERO(&Set);
+    for (auto Cpu : Cpus) {
+      CPU_SET(Cpu,&Set);
+    }
+    Error = pthread_setaffinity_np(pthread_self(),sizeof(Set),&Set);
+    if (Error != 0) {
+      std::cout << "WARNING" << RootPath_ << ": Unable to set " << Name << " thread affinity, " << strerror(Error) << "." << std::endl;
+    }
+  }
+}
+
+/* Touches the given amount of stack so it is resident before flight */
+void RealTimeRuntime::PrefaultStack(size_t Size) {
+  if (Size == 0) {
+    return;
+  }
+  volatile char *Stack = (volatile char *)alloca(Size);
+  for (size_t i=0; i < Size; i += sysconf(_SC_PAGESIZE)) {
+    Stack[i] = 0;
+  }
+}
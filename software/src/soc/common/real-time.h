@@ -0,0 +1,99 @@
+/*
+real-time.h
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef REAL_TIME_H_
+#define REAL_TIME_H_
+
+#include "rapidjson/document.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <exception>
+#include <stdexcept>
+
+/*
+Real-time runtime - sets up the flight thread for bounded frame latency: a
+real-time scheduling policy and priority, pinned to its own core, with all
+memory locked and the heap and stack pre-faulted so page faults do not occur
+in flight. Auxiliary threads (telnet, signal server) are moved to other cores
+at a lower priority. Pipeline workers, which run flight code on behalf of
+the flight thread, keep the flight policy and priority on the auxiliary
+cores. Failing to apply a setting, i.e. when not running with
+the needed privileges, is reported as a warning and the flight code continues.
+Example JSON configuration:
+"Real-Time": {
+  "Policy": "FIFO",
+  "Priority": 80,
+  "Cpu": 3,
+  "Auxiliary-Priority": 10,
+  "Auxiliary-Cpus": [0,1,2],
+  "Lock-Memory": true,
+  "Prefault-Heap_kB": 8192,
+  "Prefault-Stack_kB": 256,
+  "Self-Check": {"Period_us": 1000, "Samples": 1000}
+}
+Where:
+   * Policy is the scheduling policy of the flight thread, "FIFO", "RR" or
+     "Other". Optional, defaults to "FIFO".
+   * Priority is the real-time priority of the flight thread (1-99), ignored
+     for the "Other" policy. Optional, defaults to 80.
+   * Cpu is the core the flight thread is pinned to, ideally one isolated
+     from the scheduler with isolcpus. Optional, unpinned by default.
+   * Auxiliary-Priority is the real-time priority of auxiliary threads, they
+     use the same policy as the flight thread and default scheduling if 0.
+     Optional, defaults to 0.
+   * Auxiliary-Cpus are the cores auxiliary threads may run on. Optional,
+     defaults to all cores but the flight thread's.
+   * Lock-Memory locks current and future memory with mlockall and keeps
+     freed memory in the process. Optional, defaults to true.
+   * Prefault-Heap_kB and Prefault-Stack_kB are touched once at startup so
+     they are resident. Optional, defaulting to 8192 and 256.
+   * Self-Check sleeps Samples times to absolute deadlines Period_us apart
+     on the configured flight thread and reports the wake up latency.
+     Optional, skipped if not given.
+*/
+class RealTimeRuntime {
+  public:
+    void Configure(const rapidjson::Value& Config);
+    bool Configured();
+    void Begin();
+    void BeginAuxiliary();
+    void BeginWorker();
+    void SelfCheck();
+  private:
+    std::string RootPath_ = "/Real-Time";
+    bool Configured_ = false;
+    int Policy_;
+    int Priority_ = 80;
+    int Cpu_ = -1;
+    int AuxiliaryPriority_ = 0;
+    std::vector<int> AuxiliaryCpus_;
+    bool LockMemory_ = true;
+    size_t PrefaultHeap_kB_ = 8192;
+    size_t PrefaultStack_kB_ = 256;
+    bool SelfCheck_ = false;
+    uint32_t SelfCheckPeriod_us_ = 1000;
+    uint32_t SelfCheckSamples_ = 1000;
+    void SetScheduling(int Policy,int Priority,const std::vector<int> &Cpus,const std::string &Name);
+    void PrefaultStack(size_t Size);
+};
+
+#endif
@@ -26,6 +26,9 @@ using std::endl;
 /* configures sensor processing given a JSON value and registers data with global defs */
 void SensorProcessing::Configure(const rapidjson::Value& Config) {
   std::map<string, string> OutputKeysMap;
+  if (Config.HasMember("Lazy-Arming")) {
+    LazyArming_ = Config["Lazy-Arming"].GetBool();
+  }
   // configuring baseline sensor processing
   if (Config.HasMember("Baseline")) {
     // path for the baseline functions /Sensor-Processing/Baseline
@@ -85,6 +88,11 @@ void SensorProcessing::Configure(const rapidjson::Value& Config) {
         root_ele->description = base_ele->description;
         root_ele->datalog = base_ele->datalog;
         root_ele->telemetry = base_ele->telemetry;
+        root_ele->log_scale = base_ele->log_scale;
+        root_ele->log_offset = base_ele->log_offset;
+        if (!root_ele->setTypeFromLogging()) {
+          throw std::runtime_error(string("ERROR")+RootName+string(": Output type does not match the type of its other uses."));
+        }
         OutputNodes[KeyName] = root_ele;
       }
     }
@@ -154,6 +162,11 @@ void SensorProcessing::Configure(const rapidjson::Value& Config) {
             root_ele->description = research_ele->description;
             root_ele->datalog = research_ele->datalog;
             root_ele->telemetry = research_ele->telemetry;
+            root_ele->log_scale = research_ele->log_scale;
+            root_ele->log_offset = research_ele->log_offset;
+            if (!root_ele->setTypeFromLogging()) {
+              throw std::runtime_error(string("ERROR")+RootName+string(": Output type does not match the type of its other uses."));
+            }
             OutputNodes[KeyName] = root_ele;
           }
         }
@@ -162,6 +175,19 @@ void SensorProcessing::Configure(const rapidjson::Value& Config) {
       }
     }
   }
+  for (auto &Group : ResearchGroupKeys) {
+    ResearchFunctions_.push_back(&ResearchSensorProcessingGroups_[Group]);
+  }
+  ParallelGroups_.reserve(ResearchGroupKeys.size());
+  // pair each output with its sources so running does not look up keys
+  for (auto &Node : BaselineNodes) {
+    BaselineOutputs_.push_back(std::make_pair(OutputNodes[Node.first],Node.second));
+  }
+  for (auto &Group : ResearchNodes) {
+    for (auto &Node : Group.second) {
+      ResearchOutputs_[Group.first].push_back(std::make_pair(OutputNodes[Node.first],Node.second));
+    }
+  }
   Configured_ = true;
 }
 
@@ -200,51 +226,77 @@ bool SensorProcessing::Initialized() {
 }
 
 /* sets the sensor processing group to output */
-void SensorProcessing::SetEngagedSensorProcessing(string EngagedSensorProcessing) {
-  EngagedGroup = EngagedSensorProcessing;
+void SensorProcessing::SetEngagedSensorProcessing(const string &EngagedSensorProcessing) {
+  if (EngagedSensorProcessing != EngagedGroup) {
+    EngagedGroup = EngagedSensorProcessing;
+    if (EngagedGroup == "Baseline") {
+      EngagedOutputs_ = &BaselineOutputs_;
+    } else if (ResearchOutputs_.count(EngagedGroup)) {
+      EngagedOutputs_ = &ResearchOutputs_[EngagedGroup];
+    } else {
+      EngagedOutputs_ = &NoOutputs_;
+    }
+  }
+}
+
+/* sets the sensor processing group armed to be engaged next */
+void SensorProcessing::SetArmedSensorProcessing(const string &ArmedSensorProcessing) {
+  if (ArmedSensorProcessing != ArmedGroup_) {
+    ArmedGroup_ = ArmedSensorProcessing;
+  }
+}
+
+/* sets the pipeline the research groups run on, NULL runs them in order */
+void SensorProcessing::SetPipeline(FramePipeline *Pipeline) {
+  Pipeline_ = Pipeline;
 }
 
 /* computes sensor processing data */
 void SensorProcessing::Run() {
-  if (EngagedGroup == "Baseline") {
-    // running baseline sensor processing
-    for (auto Func : BaselineSensorProcessing_) {
-      Func->Run(GenericFunction::kEngage);
-    }
-    // running research sensor processing
-    for (auto Group : ResearchGroupKeys) {
-      for (auto Func : ResearchSensorProcessingGroups_[Group]) {
-        Func->Run(GenericFunction::kArm);
-      }
-    }
-    // setting the output
-    for (auto Key : BaselineKeys) {
-      string KeyName = Key.substr(Key.rfind("/"));
-      if (KeyName!="/Mode") {
-        OutputNodes[KeyName]->copyFrom( BaselineNodes[KeyName] );
-      }
+  // running baseline sensor processing
+  GenericFunction::Mode BaselineMode = (EngagedGroup == "Baseline") ? GenericFunction::kEngage : GenericFunction::kArm;
+  for (auto &Func : BaselineSensorProcessing_) {
+    Func->Run(BaselineMode);
+  }
+  // running the engaged research group first, then the others in parallel
+  ParallelGroups_.clear();
+  for (size_t i=0; i < ResearchGroupKeys.size(); i++) {
+    if (ResearchGroupKeys[i] == EngagedGroup) {
+      RunResearchGroup(i);
+    } else {
+      ParallelGroups_.push_back(i);
     }
+  }
+  if (Pipeline_) {
+    Pipeline_->RunParallel(ResearchJob_,ParallelGroups_.size());
   } else {
-    // running baseline sensor processing
-    for (auto Func : BaselineSensorProcessing_) {
-      Func->Run(GenericFunction::kArm);
-    }
-    // running research sensor processing
-    for (auto Group : ResearchGroupKeys) {
-      for (auto Func : ResearchSensorProcessingGroups_[Group]) {
-        if (Group == EngagedGroup) {
-          Func->Run(GenericFunction::kEngage);
-        } else {
-          Func->Run(GenericFunction::kArm);
-        }
-      }
-    }
-    // setting the output
-    for (auto Key : ResearchKeys[EngagedGroup]) {
-      string KeyName = Key.substr(Key.rfind("/"));
-      if (KeyName!="/Mode") {
-        OutputNodes[KeyName]->copyFrom( ResearchNodes[EngagedGroup][KeyName] );
-      }
+    for (size_t i=0; i < ParallelGroups_.size(); i++) {
+      RunResearchGroup(ParallelGroups_[i]);
     }
   }
+  // setting the output
+  for (auto &Copy : *EngagedOutputs_) {
+    Copy.first->copyFrom(*Copy.second);
+  }
+}
+
+/* runs a research sensor processing group, groups only share read-only inputs */
+void SensorProcessing::RunResearchGroup(size_t Index) {
+  GenericFunction::Mode Mode;
+  if (ResearchGroupKeys[Index] == EngagedGroup) {
+    Mode = GenericFunction::kEngage;
+  } else if ((!LazyArming_)||(ResearchGroupKeys[Index] == ArmedGroup_)) {
+    Mode = GenericFunction::kArm;
+  } else {
+    // still run every frame so filters and delays keep tracking their inputs
+    Mode = GenericFunction::kStandby;
+  }
+  for (auto &Func : *ResearchFunctions_[Index]) {
+    Func->Run(Mode);
+  }
+}
+
+/* runs the Index-th research group that is not engaged */
+void SensorProcessing::ResearchJob::Run(size_t Index) {
+  Parent_->RunResearchGroup(Parent_->ParallelGroups_[Index]);
 }
@@ -33,6 +33,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include "airdata-functions.h"
 #include "ins-functions.h"
 #include "power.h"
+#include "frame-pipeline.h"
 
 #include <stdio.h>
 #include <fcntl.h>
@@ -52,13 +53,33 @@ class SensorProcessing {
     void Configure(const rapidjson::Value& Config);
     bool Configured();
     bool Initialized();
-    void SetEngagedSensorProcessing(string EngagedSensorProcessing);
+    void SetEngagedSensorProcessing(const string &EngagedSensorProcessing);
+    void SetArmedSensorProcessing(const string &ArmedSensorProcessing);
+    void SetPipeline(FramePipeline *Pipeline);
     void Run();
   private:
+    // runs the research groups that are not engaged on the pipeline
+    class ResearchJob : public FramePipeline::Job {
+      public:
+        ResearchJob(SensorProcessing *Parent) : Parent_(Parent) {}
+        void Run(size_t Index);
+      private:
+        SensorProcessing *Parent_;
+    };
     string RootPath_ = "/Sensor-Processing";
     bool Configured_ = false;
     bool InitializedLatch_ = false;
     string EngagedGroup = "Baseline";
+    string ArmedGroup_ = "Baseline";
+    // with lazy arming only the armed research group runs in kArm, the
+    // others run in kStandby every frame, like the control law groups
+    // that are not armed
+    bool LazyArming_ = false;
+    // the engaged group runs on the flight thread, the rest may run in parallel
+    FramePipeline *Pipeline_ = NULL;
+    ResearchJob ResearchJob_{this};
+    vector<std::vector<std::shared_ptr<GenericFunction>>*> ResearchFunctions_;
+    vector<size_t> ParallelGroups_;
     std::vector<std::shared_ptr<GenericFunction>> BaselineSensorProcessing_;
     std::map<string, std::vector<std::shared_ptr<GenericFunction>>> ResearchSensorProcessingGroups_;
     vector<string> BaselineKeys;
@@ -67,6 +88,13 @@ class SensorProcessing {
     map<string, ElementPtr> OutputNodes;
     map<string, ElementPtr> BaselineNodes;
     map<string, map<string, ElementPtr> > ResearchNodes;
+    // output and source node pairs copied each frame, built at configuration
+    typedef vector<std::pair<ElementPtr, ElementPtr>> OutputCopies;
+    OutputCopies BaselineOutputs_;
+    map<string, OutputCopies> ResearchOutputs_;
+    OutputCopies NoOutputs_;
+    const OutputCopies *EngagedOutputs_ = &BaselineOutputs_;
+    void RunResearchGroup(size_t Index);
 };
 
 #endif
@@ -3,6 +3,7 @@ using std::cout;
 using std::endl;
 
 #include "telemetry.h"
+#include <cmath>
 
 /* Opens a socket for telemetry */
 TelemetryClient::TelemetryClient() {
@@ -18,7 +19,7 @@ void TelemetryClient::Configure(const rapidjson::Value& Config) {
     Uart = Config["Uart"].GetString();
     Buffer.resize(Uart.size());
     memcpy(Buffer.data(),Uart.data(),Buffer.size());
-    SendPacket(UartPacket,Buffer);
+    AddConfigPacket(UartPacket,Buffer);
   } else {
     throw std::runtime_error(std::string("ERROR")+_RootPath+std::string(": Uart not specified in configuration."));
   }
@@ -26,7 +27,7 @@ void TelemetryClient::Configure(const rapidjson::Value& Config) {
     Baud = Config["Baud"].GetUint64();
     Buffer.resize(sizeof(Baud));
     memcpy(Buffer.data(),&Baud,Buffer.size());
-    SendPacket(BaudPacket,Buffer);
+    AddConfigPacket(BaudPacket,Buffer);
   } else {
     throw std::runtime_error(std::string("ERROR")+_RootPath+std::string(": Baud not specified in configuration."));
   }
@@ -36,43 +37,43 @@ void TelemetryClient::Configure(const rapidjson::Value& Config) {
   }
   if (Config.HasMember("Static-Pressure")) {
     std::string Sensor = Config["Static-Pressure"].GetString();
-    Nodes_.StaticPress.Pressure_Pa = deftree.getElement(Sensor+"/Pressure_Pa");
-    Nodes_.StaticPress.Temperature_C = deftree.getElement(Sensor+"/Temperature_C");
+    Nodes_.StaticPress.Pressure_Pa = deftree.getSignal<float>(Sensor+"/Pressure_Pa");
+    Nodes_.StaticPress.Temperature_C = deftree.getSignal<float>(Sensor+"/Temperature_C");
     useStaticPressure = true;
   }
   if (Config.HasMember("Airspeed")) {
-    Nodes_.Airspeed.Airspeed_ms = deftree.getElement(Config["Airspeed"].GetString());
+    Nodes_.Airspeed.Airspeed_ms = deftree.getSignal<float>(Config["Airspeed"].GetString());
     useAirspeed = true;
   }
   if (Config.HasMember("Altitude")) {
-    Nodes_.Alt.Alt_m = deftree.getElement(Config["Altitude"].GetString());
+    Nodes_.Alt.Alt_m = deftree.getSignal<float>(Config["Altitude"].GetString());
     useAlt = true;
   }
   if (Config.HasMember("Filter")) {
     std::string Sensor = Config["Filter"].GetString();
-    Nodes_.Attitude.Ax = deftree.getElement(Sensor+"/AccelX_mss");
-    Nodes_.Attitude.Axb = deftree.getElement(Sensor+"/AccelXBias_mss");
-    Nodes_.Attitude.Ay = deftree.getElement(Sensor+"/AccelY_mss");
-    Nodes_.Attitude.Ayb = deftree.getElement(Sensor+"/AccelYBias_mss");
-    Nodes_.Attitude.Az = deftree.getElement(Sensor+"/AccelZ_mss");
-    Nodes_.Attitude.Azb = deftree.getElement(Sensor+"/AccelZBias_mss");
-    Nodes_.Attitude.Gx = deftree.getElement(Sensor+"/GyroX_rads");
-    Nodes_.Attitude.Gxb = deftree.getElement(Sensor+"/GyroXBias_rads");
-    Nodes_.Attitude.Gy = deftree.getElement(Sensor+"/GyroY_rads");
-    Nodes_.Attitude.Gyb = deftree.getElement(Sensor+"/GyroYBias_rads");
-    Nodes_.Attitude.Gz = deftree.getElement(Sensor+"/GyroZ_rads");
-    Nodes_.Attitude.Gzb = deftree.getElement(Sensor+"/GyroZBias_rads");
-    Nodes_.Attitude.Pitch = deftree.getElement(Sensor+"/Pitch_rad");
-    Nodes_.Attitude.Roll = deftree.getElement(Sensor+"/Roll_rad");
-    Nodes_.Attitude.Yaw = deftree.getElement(Sensor+"/Yaw_rad");
-    Nodes_.Attitude.Heading = deftree.getElement(Sensor+"/Heading_rad");
-    Nodes_.Attitude.Track = deftree.getElement(Sensor+"/Track_rad");
-    Nodes_.Attitude.Lon = deftree.getElement(Sensor+"/Longitude_rad");
-    Nodes_.Attitude.Lat = deftree.getElement(Sensor+"/Latitude_rad");
-    Nodes_.Attitude.Alt = deftree.getElement(Sensor+"/Altitude_m");
-    Nodes_.Attitude.Vn= deftree.getElement(Sensor+"/NorthVelocity_ms");
-    Nodes_.Attitude.Ve = deftree.getElement(Sensor+"/EastVelocity_ms");
-    Nodes_.Attitude.Vd = deftree.getElement(Sensor+"/DownVelocity_ms");
+    Nodes_.Attitude.Ax = deftree.getSignal<float>(Sensor+"/AccelX_mss");
+    Nodes_.Attitude.Axb = deftree.getSignal<float>(Sensor+"/AccelXBias_mss");
+    Nodes_.Attitude.Ay = deftree.getSignal<float>(Sensor+"/AccelY_mss");
+    Nodes_.Attitude.Ayb = deftree.getSignal<float>(Sensor+"/AccelYBias_mss");
+    Nodes_.Attitude.Az = deftree.getSignal<float>(Sensor+"/AccelZ_mss");
+    Nodes_.Attitude.Azb = deftree.getSignal<float>(Sensor+"/AccelZBias_mss");
+    Nodes_.Attitude.Gx = deftree.getSignal<float>(Sensor+"/GyroX_rads");
+    Nodes_.Attitude.Gxb = deftree.getSignal<float>(Sensor+"/GyroXBias_rads");
+    Nodes_.Attitude.Gy = deftree.getSignal<float>(Sensor+"/GyroY_rads");
+    Nodes_.Attitude.Gyb = deftree.getSignal<float>(Sensor+"/GyroYBias_rads");
+    Nodes_.Attitude.Gz = deftree.getSignal<float>(Sensor+"/GyroZ_rads");
+    Nodes_.Attitude.Gzb = deftree.getSignal<float>(Sensor+"/GyroZBias_rads");
+    Nodes_.Attitude.Pitch = deftree.getSignal<float>(Sensor+"/Pitch_rad");
+    Nodes_.Attitude.Roll = deftree.getSignal<float>(Sensor+"/Roll_rad");
+    Nodes_.Attitude.Yaw = deftree.getSignal<float>(Sensor+"/Yaw_rad");
+    Nodes_.Attitude.Heading = deftree.getSignal<float>(Sensor+"/Heading_rad");
+    Nodes_.Attitude.Track = deftree.getSignal<float>(Sensor+"/Track_rad");
+    Nodes_.Attitude.Lon = deftree.getSignal<double>(Sensor+"/Longitude_rad");
+    Nodes_.Attitude.Lat = deftree.getSignal<double>(Sensor+"/Latitude_rad");
+    Nodes_.Attitude.Alt = deftree.getSignal<float>(Sensor+"/Altitude_m");
+    Nodes_.Attitude.Vn = deftree.getSignal<float>(Sensor+"/NorthVelocity_ms");
+    Nodes_.Attitude.Ve = deftree.getSignal<float>(Sensor+"/EastVelocity_ms");
+    Nodes_.Attitude.Vd = deftree.getSignal<float>(Sensor+"/DownVelocity_ms");
     useAttitude = true;
   }
   if (Config.HasMember("Gps")) {
@@ -86,27 +87,27 @@ void TelemetryClient::Configure(const rapidjson::Value& Config) {
     Nodes_.Gps.Hour = deftree.getElement(Sensor+"/Hour");
     Nodes_.Gps.Min = deftree.getElement(Sensor+"/Minute");
     Nodes_.Gps.Sec = deftree.getElement(Sensor+"/Second");
-    Nodes_.Gps.Lat = deftree.getElement(Sensor+"/Latitude_rad");
-    Nodes_.Gps.Lon = deftree.getElement(Sensor+"/Longitude_rad");
-    Nodes_.Gps.Alt = deftree.getElement(Sensor+"/Altitude_m");
-    Nodes_.Gps.Vn = deftree.getElement(Sensor+"/NorthVelocity_ms");
-    Nodes_.Gps.Ve = deftree.getElement(Sensor+"/EastVelocity_ms");
-    Nodes_.Gps.Vd = deftree.getElement(Sensor+"/DownVelocity_ms");
-    Nodes_.Gps.HAcc = deftree.getElement(Sensor+"/HorizontalAccuracy_m");
-    Nodes_.Gps.VAcc = deftree.getElement(Sensor+"/VerticalAccuracy_m");
-    Nodes_.Gps.SAcc = deftree.getElement(Sensor+"/VelocityAccuracy_ms");
-    Nodes_.Gps.pDOP = deftree.getElement(Sensor+"/pDOP");
+    Nodes_.Gps.Lat = deftree.getSignal<double>(Sensor+"/Latitude_rad");
+    Nodes_.Gps.Lon = deftree.getSignal<double>(Sensor+"/Longitude_rad");
+    Nodes_.Gps.Alt = deftree.getSignal<float>(Sensor+"/Altitude_m");
+    Nodes_.Gps.Vn = deftree.getSignal<float>(Sensor+"/NorthVelocity_ms");
+    Nodes_.Gps.Ve = deftree.getSignal<float>(Sensor+"/EastVelocity_ms");
+    Nodes_.Gps.Vd = deftree.getSignal<float>(Sensor+"/DownVelocity_ms");
+    Nodes_.Gps.HAcc = deftree.getSignal<float>(Sensor+"/HorizontalAccuracy_m");
+    Nodes_.Gps.VAcc = deftree.getSignal<float>(Sensor+"/VerticalAccuracy_m");
+    Nodes_.Gps.SAcc = deftree.getSignal<float>(Sensor+"/VelocityAccuracy_ms");
+    Nodes_.Gps.pDOP = deftree.getSignal<float>(Sensor+"/pDOP");
     useGps = true;
   }
   if (Config.HasMember("Imu")) {
     std::string Sensor = Config["Imu"].GetString();
-    Nodes_.Imu.Ax = deftree.getElement(Sensor+"/AccelX_mss");
-    Nodes_.Imu.Ay = deftree.getElement(Sensor+"/AccelY_mss");
-    Nodes_.Imu.Az = deftree.getElement(Sensor+"/AccelZ_mss");
-    Nodes_.Imu.Gx = deftree.getElement(Sensor+"/GyroX_rads");
-    Nodes_.Imu.Gy = deftree.getElement(Sensor+"/GyroY_rads");
-    Nodes_.Imu.Gz = deftree.getElement(Sensor+"/GyroZ_rads");
-    Nodes_.Imu.Temperature_C = deftree.getElement(Sensor+"/Temperature_C");
+    Nodes_.Imu.Ax = deftree.getSignal<float>(Sensor+"/AccelX_mss");
+    Nodes_.Imu.Ay = deftree.getSignal<float>(Sensor+"/AccelY_mss");
+    Nodes_.Imu.Az = deftree.getSignal<float>(Sensor+"/AccelZ_mss");
+    Nodes_.Imu.Gx = deftree.getSignal<float>(Sensor+"/GyroX_rads");
+    Nodes_.Imu.Gy = deftree.getSignal<float>(Sensor+"/GyroY_rads");
+    Nodes_.Imu.Gz = deftree.getSignal<float>(Sensor+"/GyroZ_rads");
+    Nodes_.Imu.Temperature_C = deftree.getSignal<float>(Sensor+"/Temperature_C");
     useImu = true;
   }
   if (Config.HasMember("Sbus")) {
@@ -114,56 +115,229 @@ void TelemetryClient::Configure(const rapidjson::Value& Config) {
     Nodes_.Sbus.FailSafe = deftree.getElement(Sensor+"/FailSafe");
     Nodes_.Sbus.LostFrames = deftree.getElement(Sensor+"/LostFrames");
     for (size_t j=0; j < 16; j++) {
-      Nodes_.Sbus.Channels[j] = deftree.getElement(Sensor+"/Channels/"+std::to_string(j));
+      Nodes_.Sbus.Channels[j] = deftree.getSignal<float>(Sensor+"/Channels/"+std::to_string(j));
     }
     useSbus = true;
   }
   if (Config.HasMember("Power")) {
     std::string Power = Config["Power"].GetString();
-    Nodes_.Power.MinCellVolt = deftree.getElement(Power+"/MinCellVolt_V");
+    Nodes_.Power.MinCellVolt = deftree.getSignal<float>(Power+"/MinCellVolt_V");
     usePower = true;
   }
+  useLegacy = useTime||useStaticPressure||useAirspeed||useAlt||useAttitude||useGps||useImu||useSbus||usePower;
+  ConfigureChannels(Config);
+  if (Channels_.size() > 0) {
+    BuildSchema();
+  }
+  SendConfig();
+}
+
+/* Finds the channels: signals tagged for telemetry, configured keys and parts of keys */
+void TelemetryClient::ConfigureChannels(const rapidjson::Value& Config) {
+  static const char *TypeNames[] = {"Uint64","Uint32","Uint16","Uint8","Int64","Int32","Int16","Int8","Float","Double","Float16","ScaledInt16","ScaledUint16"};
+  std::vector<std::string> Signals;
+  if (Config.HasMember("Channels")) {
+    for (auto &Channel : Config["Channels"].GetArray()) {
+      if (Channel.IsString()) {
+        Signals.push_back(Channel.GetString());
+        continue;
+      }
+      if (!Channel.HasMember("Signal")||!Channel.HasMember("Type")) {
+        throw std::runtime_error(std::string("ERROR")+_RootPath+std::string(": Signal or Type not specified in channel configuration."));
+      }
+      std::string Key = Channel["Signal"].GetString();
+      ElementPtr Node = deftree.getElement(Key,false);
+      if (!Node) {
+        throw std::runtime_error(std::string("ERROR")+_RootPath+std::string(": Channel signal ")+Key+std::string(" not found."));
+      }
+      std::string TypeName = Channel["Type"].GetString();
+      size_t Type = 0;
+      while ((Type < sizeof(TypeNames)/sizeof(TypeNames[0]))&&(TypeName != TypeNames[Type])) {
+        Type++;
+      }
+      if (Type == sizeof(TypeNames)/sizeof(TypeNames[0])) {
+        throw std::runtime_error(std::string("ERROR")+_RootPath+std::string(": Unknown type ")+TypeName+std::string(" for channel ")+Key+std::string("."));
+      }
+      float Scale = Channel.HasMember("Scale") ? Channel["Scale"].GetFloat() : 1.0f;
+      float Offset = Channel.HasMember("Offset") ? Channel["Offset"].GetFloat() : 0.0f;
+      AddChannel(Key,Node,(ChannelType_)Type,Scale,Offset);
+    }
+  }
+  std::vector<std::string> Keys;
+  deftree.GetKeys("/",&Keys);
+  for (auto const & Key: Keys) {
+    bool Added = false;
+    for (auto const & Channel: Channels_) {
+      if (Channel.Key == Key) {
+        Added = true;
+        break;
+      }
+    }
+    if (Added) {
+      continue;
+    }
+    ElementPtr Node = deftree.getElement(Key);
+    log_tag_t Tag = Node->getTelemetryType();
+    if (Tag == LOG_NONE) {
+      for (auto const & Signal: Signals) {
+        if (Key.find(Signal) != std::string::npos) {
+          Tag = Node->getLoggingType();
+          break;
+        }
+      }
+    }
+    ChannelType_ Type;
+    if (ChannelTypeFromTag(Tag,&Type)) {
+      AddChannel(Key,Node,Type,Node->log_scale,Node->log_offset);
+    } else if (Tag != LOG_NONE) {
+      cout << "NOTICE: no valid telemetry type for: " << Key << endl;
+    }
+  }
+}
+
+/* Adds a channel, checking the scale of scaled types */
+void TelemetryClient::AddChannel(const std::string &Key, ElementPtr Node, ChannelType_ Type, float Scale, float Offset) {
+  if (((Type == ScaledInt16Channel)||(Type == ScaledUint16Channel))&&((Scale == 0.0f)||(!std::isfinite(Scale)))) {
+    throw std::runtime_error(std::string("ERROR")+_RootPath+std::string(": Scale of channel ")+Key+std::string(" must be finite and non-zero."));
+  }
+  Channel_ Channel;
+  Channel.Key = Key;
+  Channel.Node = Node;
+  Channel.Type = Type;
+  Channel.Scale = Scale;
+  Channel.Offset = Offset;
+  Channel.InvScale = 1.0f/Scale;
+  Channels_.push_back(Channel);
+}
+
+/* Gets the channel type of a log tag, returns false for tags without one */
+bool TelemetryClient::ChannelTypeFromTag(log_tag_t Tag, ChannelType_ *Type) {
+  switch (Tag) {
+    case LOG_UINT64: *Type = Uint64Channel; return true;
+    case LOG_UINT32: *Type = Uint32Channel; return true;
+    case LOG_UINT16: *Type = Uint16Channel; return true;
+    case LOG_UINT8: *Type = Uint8Channel; return true;
+    case LOG_INT64: *Type = Int64Channel; return true;
+    case LOG_INT32: *Type = Int32Channel; return true;
+    case LOG_INT16: *Type = Int16Channel; return true;
+    case LOG_INT8: *Type = Int8Channel; return true;
+    case LOG_FLOAT: *Type = FloatChannel; return true;
+    case LOG_DOUBLE: *Type = DoubleChannel; return true;
+    case LOG_FLOAT16: *Type = Float16Channel; return true;
+    case LOG_SCALED_INT16: *Type = ScaledInt16Channel; return true;
+    case LOG_SCALED_UINT16: *Type = ScaledUint16Channel; return true;
+    default: return false;
+  }
+}
+
+/* Returns the packed size of a channel type */
+size_t TelemetryClient::ChannelSize(ChannelType_ Type) {
+  switch (Type) {
+    case Uint64Channel: case Int64Channel: case DoubleChannel: return 8;
+    case Uint32Channel: case Int32Channel: case FloatChannel: return 4;
+    case Uint16Channel: case Int16Channel: case Float16Channel: case ScaledInt16Channel: case ScaledUint16Channel: return 2;
+    default: return 1;
+  }
+}
+
+/* Builds the schema packets, split to fit radio packets, and sizes the channel packet */
+void TelemetryClient::BuildSchema() {
+  std::vector<std::vector<uint8_t> > Entries;
+  std::vector<uint8_t> Schema;
+  size_t PayloadSize = sizeof(uint16_t);
+  for (auto const & Channel: Channels_) {
+    std::vector<uint8_t> Entry;
+    Entry.push_back(Channel.Type);
+    if ((Channel.Type == ScaledInt16Channel)||(Channel.Type == ScaledUint16Channel)) {
+      Entry.resize(sizeof(uint8_t) + 2*sizeof(float));
+      memcpy(Entry.data()+sizeof(uint8_t),&Channel.Scale,sizeof(float));
+      memcpy(Entry.data()+sizeof(uint8_t)+sizeof(float),&Channel.Offset,sizeof(float));
+    }
+    Entry.push_back(Channel.Key.size());
+    Entry.insert(Entry.end(),Channel.Key.begin(),Channel.Key.end());
+    if ((Channel.Key.size() > UINT8_MAX)||(Entry.size() > kMaxRadioPayload_ - kSchemaHeaderSize_)) {
+      throw std::runtime_error(std::string("ERROR")+_RootPath+std::string(": Channel key ")+Channel.Key+std::string(" is too long."));
+    }
+    Schema.insert(Schema.end(),Entry.begin(),Entry.end());
+    Entries.push_back(Entry);
+    PayloadSize += ChannelSize(Channel.Type);
+  }
+  if (PayloadSize > kMaxRadioPayload_) {
+    throw std::runtime_error(std::string("ERROR")+_RootPath+std::string(": Channels do not fit in one radio packet, ")+std::to_string(PayloadSize)+std::string(" bytes."));
+  }
+  CRC16 Crc;
+  SchemaId_ = Crc.xmodem(Schema.data(),Schema.size());
+  // split the entries into radio sized chunks
+  std::vector<std::vector<uint8_t> > Chunks(1);
+  for (auto const & Entry: Entries) {
+    if (kSchemaHeaderSize_ + Chunks.back().size() + Entry.size() > kMaxRadioPayload_) {
+      Chunks.emplace_back();
+    }
+    Chunks.back().insert(Chunks.back().end(),Entry.begin(),Entry.end());
+  }
+  if (Chunks.size() > UINT8_MAX) {
+    throw std::runtime_error(std::string("ERROR")+_RootPath+std::string(": Too many channels."));
+  }
+  for (size_t i=0; i < Chunks.size(); i++) {
+    std::vector<uint8_t> Buffer;
+    Buffer.push_back(SchemaId_ & 0xff);
+    Buffer.push_back(SchemaId_ >> 8);
+    Buffer.push_back(i);
+    Buffer.push_back(Chunks.size());
+    Buffer.insert(Buffer.end(),Chunks[i].begin(),Chunks[i].end());
+    AddConfigPacket(SchemaPacket,Buffer);
+  }
+  // channel values are packed straight into the frame after the schema id
+  PackedChannels_.resize(BfFrame::Size(PayloadSize));
+  uint8_t *Payload = BfFrame::Payload(PackedChannels_.data());
+  Payload[0] = SchemaId_ & 0xff;
+  Payload[1] = SchemaId_ >> 8;
 }
 
 void TelemetryClient::Send() {
-  std::vector<uint8_t> DataPayload;
+  Pack();
+  SendPacked();
+}
+
+/* Packs the telemetry data packet, sent by SendPacked */
+void TelemetryClient::Pack() {
   if (useTime) {
     Data_.Time.Time_us = Nodes_.Time.Time_us->getLong();
   }
   if (useStaticPressure) {
-    Data_.StaticPress.Pressure_Pa = Nodes_.StaticPress.Pressure_Pa->getFloat();
-    Data_.StaticPress.Temperature_C = Nodes_.StaticPress.Temperature_C->getFloat();
+    Data_.StaticPress.Pressure_Pa = Nodes_.StaticPress.Pressure_Pa.get();
+    Data_.StaticPress.Temperature_C = Nodes_.StaticPress.Temperature_C.get();
   }
   if (useAirspeed) {
-    Data_.Airspeed.Airspeed_ms = Nodes_.Airspeed.Airspeed_ms->getFloat();
+    Data_.Airspeed.Airspeed_ms = Nodes_.Airspeed.Airspeed_ms.get();
   }
   if (useAlt) {
-    Data_.Alt.Alt_m = Nodes_.Alt.Alt_m->getFloat();
+    Data_.Alt.Alt_m = Nodes_.Alt.Alt_m.get();
   }
   if (useAttitude) {
-    Data_.Attitude.Ax = Nodes_.Attitude.Ax->getFloat();
-    Data_.Attitude.Axb = Nodes_.Attitude.Axb->getFloat();
-    Data_.Attitude.Ay = Nodes_.Attitude.Ay->getFloat();
-    Data_.Attitude.Ayb = Nodes_.Attitude.Ayb->getFloat();
-    Data_.Attitude.Az = Nodes_.Attitude.Az->getFloat();
-    Data_.Attitude.Azb = Nodes_.Attitude.Azb->getFloat();
-    Data_.Attitude.Gx = Nodes_.Attitude.Gx->getFloat();
-    Data_.Attitude.Gxb = Nodes_.Attitude.Gxb->getFloat();
-    Data_.Attitude.Gy = Nodes_.Attitude.Gy->getFloat();
-    Data_.Attitude.Gyb = Nodes_.Attitude.Gyb->getFloat();
-    Data_.Attitude.Gz = Nodes_.Attitude.Gz->getFloat();
-    Data_.Attitude.Gzb = Nodes_.Attitude.Gzb->getFloat();
-    Data_.Attitude.Pitch = Nodes_.Attitude.Pitch->getFloat();
-    Data_.Attitude.Roll = Nodes_.Attitude.Roll->getFloat();
-    Data_.Attitude.Yaw = Nodes_.Attitude.Yaw->getFloat();
-    Data_.Attitude.Heading = Nodes_.Attitude.Heading->getFloat();
-    Data_.Attitude.Track = Nodes_.Attitude.Track->getFloat();
-    Data_.Attitude.Lon = Nodes_.Attitude.Lon->getDouble();
-    Data_.Attitude.Lat = Nodes_.Attitude.Lat->getDouble();
-    Data_.Attitude.Alt = Nodes_.Attitude.Alt->getFloat();
-    Data_.Attitude.Vn= Nodes_.Attitude.Vn->getFloat();
-    Data_.Attitude.Ve = Nodes_.Attitude.Ve->getFloat();
-    Data_.Attitude.Vd = Nodes_.Attitude.Vd->getFloat();
+    Data_.Attitude.Ax = Nodes_.Attitude.Ax.get();
+    Data_.Attitude.Axb = Nodes_.Attitude.Axb.get();
+    Data_.Attitude.Ay = Nodes_.Attitude.Ay.get();
+    Data_.Attitude.Ayb = Nodes_.Attitude.Ayb.get();
+    Data_.Attitude.Az = Nodes_.Attitude.Az.get();
+    Data_.Attitude.Azb = Nodes_.Attitude.Azb.get();
+    Data_.Attitude.Gx = Nodes_.Attitude.Gx.get();
+    Data_.Attitude.Gxb = Nodes_.Attitude.Gxb.get();
+    Data_.Attitude.Gy = Nodes_.Attitude.Gy.get();
+    Data_.Attitude.Gyb = Nodes_.Attitude.Gyb.get();
+    Data_.Attitude.Gz = Nodes_.Attitude.Gz.get();
+    Data_.Attitude.Gzb = Nodes_.Attitude.Gzb.get();
+    Data_.Attitude.Pitch = Nodes_.Attitude.Pitch.get();
+    Data_.Attitude.Roll = Nodes_.Attitude.Roll.get();
+    Data_.Attitude.Yaw = Nodes_.Attitude.Yaw.get();
+    Data_.Attitude.Heading = Nodes_.Attitude.Heading.get();
+    Data_.Attitude.Track = Nodes_.Attitude.Track.get();
+    Data_.Attitude.Lon = Nodes_.Attitude.Lon.get();
+    Data_.Attitude.Lat = Nodes_.Attitude.Lat.get();
+    Data_.Attitude.Alt = Nodes_.Attitude.Alt.get();
+    Data_.Attitude.Vn= Nodes_.Attitude.Vn.get();
+    Data_.Attitude.Ve = Nodes_.Attitude.Ve.get();
+    Data_.Attitude.Vd = Nodes_.Attitude.Vd.get();
   }
   if (useGps) {
     Data_.Gps.Fix = Nodes_.Gps.Fix->getInt();
@@ -175,73 +349,167 @@ void TelemetryClient::Send() {
     Data_.Gps.Hour = Nodes_.Gps.Hour->getInt();
     Data_.Gps.Min = Nodes_.Gps.Min->getInt();
     Data_.Gps.Sec = Nodes_.Gps.Sec->getInt();
-    Data_.Gps.Lat = Nodes_.Gps.Lat->getDouble();
-    Data_.Gps.Lon = Nodes_.Gps.Lon->getDouble();
-    Data_.Gps.Alt = Nodes_.Gps.Alt->getFloat();
-    Data_.Gps.Vn = Nodes_.Gps.Vn->getFloat();
-    Data_.Gps.Ve = Nodes_.Gps.Ve->getFloat();
-    Data_.Gps.Vd = Nodes_.Gps.Vd->getFloat();
-    Data_.Gps.HAcc = Nodes_.Gps.HAcc->getFloat();
-    Data_.Gps.VAcc = Nodes_.Gps.VAcc->getFloat();
-    Data_.Gps.SAcc = Nodes_.Gps.SAcc->getFloat();
-    Data_.Gps.pDOP = Nodes_.Gps.pDOP->getFloat();
+    Data_.Gps.Lat = Nodes_.Gps.Lat.get();
+    Data_.Gps.Lon = Nodes_.Gps.Lon.get();
+    Data_.Gps.Alt = Nodes_.Gps.Alt.get();
+    Data_.Gps.Vn = Nodes_.Gps.Vn.get();
+    Data_.Gps.Ve = Nodes_.Gps.Ve.get();
+    Data_.Gps.Vd = Nodes_.Gps.Vd.get();
+    Data_.Gps.HAcc = Nodes_.Gps.HAcc.get();
+    Data_.Gps.VAcc = Nodes_.Gps.VAcc.get();
+    Data_.Gps.SAcc = Nodes_.Gps.SAcc.get();
+    Data_.Gps.pDOP = Nodes_.Gps.pDOP.get();
   }
   if (useImu) {
-    Data_.Imu.Ax = Nodes_.Imu.Ax->getFloat();
-    Data_.Imu.Ay = Nodes_.Imu.Ay->getFloat();
-    Data_.Imu.Az = Nodes_.Imu.Az->getFloat();
-    Data_.Imu.Gx = Nodes_.Imu.Gx->getFloat();
-    Data_.Imu.Gy = Nodes_.Imu.Gy->getFloat();
-    Data_.Imu.Gz = Nodes_.Imu.Gz->getFloat();
-    Data_.Imu.Temperature_C = Nodes_.Imu.Temperature_C->getFloat();
+    Data_.Imu.Ax = Nodes_.Imu.Ax.get();
+    Data_.Imu.Ay = Nodes_.Imu.Ay.get();
+    Data_.Imu.Az = Nodes_.Imu.Az.get();
+    Data_.Imu.Gx = Nodes_.Imu.Gx.get();
+    Data_.Imu.Gy = Nodes_.Imu.Gy.get();
+    Data_.Imu.Gz = Nodes_.Imu.Gz.get();
+    Data_.Imu.Temperature_C = Nodes_.Imu.Temperature_C.get();
   }
   if (useSbus) {
     Data_.Sbus.FailSafe = Nodes_.Sbus.FailSafe->getInt();
     Data_.Sbus.LostFrames = Nodes_.Sbus.LostFrames->getLong();
     for (size_t j=0; j < 16; j++) {
-      Data_.Sbus.Channels[j] = Nodes_.Sbus.Channels[j]->getFloat();
+      Data_.Sbus.Channels[j] = Nodes_.Sbus.Channels[j].get();
     }
   }
   if (usePower) {
-    Data_.Power.MinCellVolt = Nodes_.Power.MinCellVolt->getFloat();
+    Data_.Power.MinCellVolt = Nodes_.Power.MinCellVolt.get();
+  }
+  if (useLegacy) {
+    PackedBuffer_.resize(BfFrame::Size(sizeof(Data)));
+    memcpy(BfFrame::Payload(PackedBuffer_.data()),&Data_,sizeof(Data));
+    BfFrame::Seal(DataPacket,sizeof(Data),PackedBuffer_.data());
+  }
+  if (Channels_.size() > 0) {
+    PackChannels();
+  }
+  Packed_ = true;
+}
+
+/* Packs the channel values after the schema id and seals the channel frame */
+void TelemetryClient::PackChannels() {
+  uint8_t *Payload = BfFrame::Payload(PackedChannels_.data());
+  size_t BufferLocation = sizeof(uint16_t);
+  for (auto &Channel : Channels_) {
+    switch (Channel.Type) {
+      case Uint64Channel: {
+        uint64_t tmp = Channel.Node->getLong();
+        memcpy(Payload+BufferLocation,&tmp,sizeof(tmp));
+        break;
+      }
+      case Uint32Channel: {
+        uint32_t tmp = Channel.Node->getInt();
+        memcpy(Payload+BufferLocation,&tmp,sizeof(tmp));
+        break;
+      }
+      case Uint16Channel: {
+        uint16_t tmp = Channel.Node->getInt();
+        memcpy(Payload+BufferLocation,&tmp,sizeof(tmp));
+        break;
+      }
+      case Uint8Channel: {
+        uint8_t tmp = Channel.Node->getInt();
+        memcpy(Payload+BufferLocation,&tmp,sizeof(tmp));
+        break;
+      }
+      case Int64Channel: {
+        int64_t tmp = Channel.Node->getLong();
+        memcpy(Payload+BufferLocation,&tmp,sizeof(tmp));
+        break;
+      }
+      case Int32Channel: {
+        int32_t tmp = Channel.Node->getInt();
+        memcpy(Payload+BufferLocation,&tmp,sizeof(tmp));
+        break;
+      }
+      case Int16Channel: {
+        int16_t tmp = Channel.Node->getInt();
+        memcpy(Payload+BufferLocation,&tmp,sizeof(tmp));
+        break;
+      }
+      case Int8Channel: {
+        int8_t tmp = Channel.Node->getInt();
+        memcpy(Payload+BufferLocation,&tmp,sizeof(tmp));
+        break;
+      }
+      case FloatChannel: {
+        float tmp = Channel.Node->getFloat();
+        memcpy(Payload+BufferLocation,&tmp,sizeof(tmp));
+        break;
+      }
+      case DoubleChannel: {
+        double tmp = Channel.Node->getDouble();
+        memcpy(Payload+BufferLocation,&tmp,sizeof(tmp));
+        break;
+      }
+      case Float16Channel: {
+        float Value = Channel.Node->getFloat();
+        uint16_t tmp;
+        FloatToHalf(&Value,&tmp,1);
+        memcpy(Payload+BufferLocation,&tmp,sizeof(tmp));
+        break;
+      }
+      case ScaledInt16Channel: {
+        float Value = Channel.Node->getFloat();
+        int16_t tmp;
+        FloatToScaledInt16(&Value,&Channel.Offset,&Channel.InvScale,&tmp,1);
+        memcpy(Payload+BufferLocation,&tmp,sizeof(tmp));
+        break;
+      }
+      case ScaledUint16Channel: {
+        float Value = Channel.Node->getFloat();
+        uint16_t tmp;
+        FloatToScaledUint16(&Value,&Channel.Offset,&Channel.InvScale,&tmp,1);
+        memcpy(Payload+BufferLocation,&tmp,sizeof(tmp));
+        break;
+      }
+    }
+    BufferLocation += ChannelSize(Channel.Type);
+  }
+  BfFrame::Seal(ChannelPacket,BufferLocation,PackedChannels_.data());
+}
+
+/* Sends the packed telemetry packets, may be called from another thread than Pack */
+void TelemetryClient::SendPacked() {
+  if (Packed_) {
+    if (useLegacy) {
+      sendto(TelemetrySocket_,PackedBuffer_.data(),PackedBuffer_.size(),0,(struct sockaddr *)&TelemetryServer_,sizeof(TelemetryServer_));
+    }
+    if (Channels_.size() > 0) {
+      sendto(TelemetrySocket_,PackedChannels_.data(),PackedChannels_.size(),0,(struct sockaddr *)&TelemetryServer_,sizeof(TelemetryServer_));
+    }
+    Packed_ = false;
+    // repeat the configuration so a restarted server picks it up
+    if (++ConfigCount_ >= kConfigPeriod_) {
+      ConfigCount_ = 0;
+      SendConfig();
+    }
   }
-  DataPayload.resize(sizeof(Data));
-  memcpy(DataPayload.data(),&Data_,DataPayload.size());
-  SendPacket(DataPacket,DataPayload);
 }
 
-/* Sends byte buffer given meta data */
-void TelemetryClient::SendPacket(PacketType_ Type, std::vector<uint8_t> &Buffer) {
-  std::vector<uint8_t> TelemBuffer;
-  TelemBuffer.resize(headerLength_ + Buffer.size() + checksumLength_);
-  // header
-  TelemBuffer[0] = header_[0];
-  TelemBuffer[1] = header_[1];
-  // data source
-  TelemBuffer[2] = (uint8_t) Type;
-  // data length
-  TelemBuffer[3] = Buffer.size() & 0xff;
-  TelemBuffer[4] = Buffer.size() >> 8;
-  // payload
-  std::memcpy(TelemBuffer.data()+headerLength_,Buffer.data(),Buffer.size());
-  // checksum
-  CalcChecksum((size_t)(Buffer.size()+headerLength_),TelemBuffer.data(),Checksum_);
-  TelemBuffer[Buffer.size()+headerLength_] = Checksum_[0];
-  TelemBuffer[Buffer.size()+headerLength_+1] = Checksum_[1];
-  // write to UDP
-  sendto(TelemetrySocket_,TelemBuffer.data(),TelemBuffer.size(),0,(struct sockaddr *)&TelemetryServer_,sizeof(TelemetryServer_));
+/* Frames a configuration packet, sent at start and repeated by SendPacked */
+void TelemetryClient::AddConfigPacket(PacketType_ Type, std::vector<uint8_t> &Buffer) {
+  ConfigFrames_.emplace_back();
+  FramePacket(Type,Buffer,&ConfigFrames_.back());
 }
 
-/* Computes a two byte checksum. */
-void TelemetryClient::CalcChecksum(size_t ArraySize, uint8_t *ByteArray, uint8_t *Checksum) {
-  Checksum[0] = 0;
-  Checksum[1] = 0;
-  for (size_t i = 0; i < ArraySize; i++) {
-    Checksum[0] += ByteArray[i];
-    Checksum[1] += Checksum[0];
+/* Sends the configuration packets */
+void TelemetryClient::SendConfig() {
+  for (auto const & Frame: ConfigFrames_) {
+    sendto(TelemetrySocket_,Frame.data(),Frame.size(),0,(struct sockaddr *)&TelemetryServer_,sizeof(TelemetryServer_));
   }
 }
 
+/* Frames byte buffer given meta data, reusing the frame buffer */
+void TelemetryClient::FramePacket(PacketType_ Type, std::vector<uint8_t> &Buffer, std::vector<uint8_t> *Frame) {
+  Frame->resize(BfFrame::Size(Buffer.size()));
+  BfFrame::Encode(Type,Buffer.data(),Buffer.size(),Frame->data(),Frame->size());
+}
+
 TelemetryServer::TelemetryServer() {
   TelemetrySocket_ = socket(AF_INET, SOCK_DGRAM, 0);
   TelemetryServer_.sin_family = AF_INET;
@@ -254,28 +522,36 @@ TelemetryServer::TelemetryServer() {
 }
 
 void TelemetryServer::ReceivePacket() {
-  PacketType_ Type;
-  std::vector<uint8_t> Payload;
   ssize_t MessageSize = recv(TelemetrySocket_,Buffer.data(),Buffer.size(),0);
-  if (MessageSize > 0) {
-    for (ssize_t i=0; i < MessageSize; i++) {
-      if (ParseMessage(Buffer[i],&Type,&Payload)) {
-        if (Type == UartPacket) {
-          Uart.resize(Payload.size());
-          for (size_t j=0; j < Payload.size(); j++) {
-            Uart[j] = (char) Payload[j];
-          }
-          rxUart = true;
-        }
-        if (Type == BaudPacket) {
-          memcpy(&Baud,Payload.data(),sizeof(Baud));
-          rxBaud = true;
-        }
-        if (Type == DataPacket) {
-          memcpy(&Data_,Payload.data(),sizeof(Data_));
-          update(Data_);
-        }
-      }
+  size_t i = 0;
+  while ((MessageSize > 0)&&(i < (size_t)MessageSize)) {
+    size_t Used;
+    bool Received = Parser_.Parse(Buffer.data()+i,MessageSize-i,&Used);
+    i += Used;
+    if (!Received) {
+      continue;
+    }
+    // the payload points into the parser and is valid until the next parse
+    PacketType_ Type = (PacketType_) Parser_.Type();
+    const uint8_t *Payload = Parser_.Payload();
+    size_t PayloadSize = Parser_.PayloadSize();
+    if (Type == UartPacket) {
+      Uart.assign((const char *)Payload,PayloadSize);
+      rxUart = true;
+    }
+    if ((Type == BaudPacket)&&(PayloadSize == sizeof(Baud))) {
+      memcpy(&Baud,Payload,sizeof(Baud));
+      rxBaud = true;
+    }
+    if ((Type == DataPacket)&&(PayloadSize == sizeof(Data_))) {
+      memcpy(&Data_,Payload,sizeof(Data_));
+      update(Data_);
+    }
+    if (Type == SchemaPacket) {
+      updateSchema(Payload,PayloadSize);
+    }
+    if (Type == ChannelPacket) {
+      updateChannels(Payload,PayloadSize);
     }
   }
   if ((rxUart)&&(rxBaud)&&(!uartLatch)) {
@@ -303,94 +579,11 @@ void TelemetryServer::ReceivePacket() {
     tcsetattr(FileDesc_,TCSANOW,&Options);
     fcntl(FileDesc_,F_SETFL,O_NONBLOCK);
     uartLatch = true;
+    sendSchema();
   }
 }
 
-bool TelemetryServer::ParseMessage(uint8_t byte,PacketType_ *message,std::vector<uint8_t> *Payload) {
-    RxByte_ = byte;
-    // header
-    if (ParserState_ < 2) {
-      if (RxByte_ == header_[ParserState_]) {
-        Buffer_[ParserState_] = RxByte_;
-        ParserState_++;
-      }
-    // length
-    } else if (ParserState_ == 3) {
-      LengthBuffer_[0] = RxByte_;
-      Buffer_[ParserState_] = RxByte_;
-      ParserState_++;
-    } else if (ParserState_ == 4) {
-      LengthBuffer_[1] = RxByte_;
-      Length_ = ((uint16_t)LengthBuffer_[1] << 8) | LengthBuffer_[0];
-      if (Length_ > (kUartBufferMaxSize-headerLength_-checksumLength_)) {
-        ParserState_ = 0;
-        LengthBuffer_[0] = 0;
-        LengthBuffer_[1] = 0;
-        Length_ = 0;
-        Checksum_[0] = 0;
-        Checksum_[1] = 0;
-        return false;
-      }
-      Buffer_[ParserState_] = RxByte_;
-      ParserState_++;
-    // message ID and payload
-    } else if (ParserState_ < (Length_ + headerLength_)) {
-      Buffer_[ParserState_] = RxByte_;
-      ParserState_++;
-    // checksum 0
-    } else if (ParserState_ == (Length_ + headerLength_)) {
-      CalcChecksum(Length_ + headerLength_,Buffer_,Checksum_);
-      if (RxByte_ == Checksum_[0]) {
-        ParserState_++;
-      } else {
-        ParserState_ = 0;
-        LengthBuffer_[0] = 0;
-        LengthBuffer_[1] = 0;
-        Length_ = 0;
-        Checksum_[0] = 0;
-        Checksum_[1] = 0;
-        return false;
-      }
-    // checksum 1
-    } else if (ParserState_ == (Length_ + headerLength_ + 1)) {
-      if (RxByte_ == Checksum_[1]) {
-        // message ID
-        *message = (PacketType_) Buffer_[2];
-        // payload size
-        Payload->resize(Length_);
-        // payload
-        std::memcpy(Payload->data(),Buffer_+headerLength_,Length_);
-        ParserState_ = 0;
-        LengthBuffer_[0] = 0;
-        LengthBuffer_[1] = 0;
-        Length_ = 0;
-        Checksum_[0] = 0;
-        Checksum_[1] = 0;
-        return true;
-      } else {
-        ParserState_ = 0;
-        LengthBuffer_[0] = 0;
-        LengthBuffer_[1] = 0;
-        Length_ = 0;
-        Checksum_[0] = 0;
-        Checksum_[1] = 0;
-        return false;
-      }
-    }
-  return false;
-}
-
-/* Computes a two byte checksum. */
-void TelemetryServer::CalcChecksum(size_t ArraySize, uint8_t *ByteArray, uint8_t *Checksum) {
-  Checksum[0] = 0;
-  Checksum[1] = 0;
-  for (size_t i = 0; i < ArraySize; i++) {
-    Checksum[0] += ByteArray[i];
-    Checksum[1] += Checksum[0];
-  }
-}
-
-void TelemetryServer :: generate_cksum(uint8_t id, uint8_t size, uint8_t * buf, uint8_t & cksum0, uint8_t & cksum1)
+void TelemetryServer :: generate_cksum(uint8_t id, uint8_t size, const uint8_t * buf, uint8_t & cksum0, uint8_t & cksum1)
 {
   cksum0 = 0;
   cksum1 = 0;
@@ -407,7 +600,7 @@ void TelemetryServer :: generate_cksum(uint8_t id, uint8_t size, uint8_t * buf,
   }
 }
 
-void TelemetryServer :: send_packet(uint8_t * package, uint8_t IDnum, uint8_t size)
+void TelemetryServer :: send_packet(const uint8_t * package, uint8_t IDnum, uint8_t size)
 {
   uint8_t buf[4];
   uint8_t checksum0;
@@ -622,3 +815,53 @@ if (filter.latitude_deg != 0 && num2 != 0) {
   IDnum = 41;
   send_packet((uint8_t *)(&health), IDnum, size);
 };
+
+/* Stores a chunk of the channel schema, forwarding it if it is new */
+void TelemetryServer :: updateSchema(const uint8_t *Payload, size_t PayloadSize)
+{
+  if (PayloadSize < 4) {
+    return;
+  }
+  uint16_t Id = ((uint16_t)Payload[1] << 8) | Payload[0];
+  size_t Index = Payload[2];
+  size_t Count = Payload[3];
+  if ((Id != SchemaId_)||(Schema_.size() != Count)) {
+    Schema_.clear();
+    Schema_.resize(Count);
+    SchemaId_ = Id;
+  }
+  if ((Index < Count)&&((Schema_[Index].size() != PayloadSize)||(memcmp(Schema_[Index].data(),Payload,PayloadSize) != 0))) {
+    Schema_[Index].assign(Payload,Payload+PayloadSize);
+    if (uartLatch) {
+      send_packet(Schema_[Index].data(), kSchemaId_, Schema_[Index].size());
+    }
+  }
+}
+
+/* Forwards channel packets at the telemetry rate, repeating the schema now and
+then since the ground station may connect at any time */
+void TelemetryServer :: updateChannels(const uint8_t *Payload, size_t PayloadSize)
+{
+  if (++ChannelCount_ < kChannelDecimation_) {
+    return;
+  }
+  ChannelCount_ = 0;
+  if (!uartLatch) {
+    return;
+  }
+  if (++SchemaCount_ >= kSchemaPeriod_) {
+    SchemaCount_ = 0;
+    sendSchema();
+  }
+  send_packet(Payload, kChannelId_, PayloadSize);
+}
+
+/* Sends the received schema chunks */
+void TelemetryServer :: sendSchema()
+{
+  for (auto &Chunk : Schema_) {
+    if (Chunk.size() > 0) {
+      send_packet(Chunk.data(), kSchemaId_, Chunk.size());
+    }
+  }
+}
@@ -21,6 +21,9 @@
 #include <arpa/inet.h>
 #include <sys/socket.h>
 #include <Eigen/Dense>
+#include "crc16.h"
+#include "log-conversions.h"
+#include "bf_frame.h"
 
 #pragma pack(push, 1)
 struct pilotPacket
@@ -158,11 +161,44 @@ struct ap_status
 };
 #pragma pack(pop)
 
+/*
+Telemetry client - sends the selected signals to the telemetry server, which
+forwards them over the radio. The fixed groups (Time, Static-Pressure,
+Airspeed, Altitude, Filter, Gps, Imu, Sbus, Power) fill the legacy data
+packet, sent only when one of them is configured. Channels are sent in their
+own packet, packed by type like the datalog. Every signal tagged for
+telemetry is a channel; the configuration adds others without a code change.
+A schema listing the key and type of each channel is sent with the UART
+configuration at start and again every kConfigPeriod_ packets so a restarted
+server picks it up. Channel packets start with the schema id, a CRC of the
+schema, so the ground can match them to it.
+Example JSON configuration:
+"Telemetry": {
+  "Uart": "/dev/ttyO4",
+  "Baud": 115200,
+  "Channels": [
+    "/Sensor-Processing/Altitude_m",
+    "/Mission/",
+    { "Signal": "/Sensor-Processing/Airspeed_ms", "Type": "ScaledUint16", "Scale": 0.01 }
+  ]
+}
+Where:
+   * Uart and Baud are the radio port and baud rate.
+   * Channels lists keys, or parts of keys, sent as channels using their
+     telemetry tag, or their datalog tag if they are not tagged for telemetry.
+     An object gives the type of one key instead, one of Uint64, Uint32,
+     Uint16, Uint8, Int64, Int32, Int16, Int8, Float, Double, Float16,
+     ScaledInt16 or ScaledUint16. Scaled types are sent as
+     round((value - Offset) / Scale), Offset is optional and defaults to 0.
+     The channel packet has to fit in one radio packet, 255 bytes.
+*/
 class TelemetryClient {
   public:
     TelemetryClient();
     void Configure(const rapidjson::Value& Config);
     void Send();
+    void Pack();
+    void SendPacked();
     void End();
   private:
     std::string _RootPath = "/Telemetry";
@@ -171,24 +207,57 @@ class TelemetryClient {
     enum PacketType_ {
       UartPacket,
       BaudPacket,
-      DataPacket
+      DataPacket,
+      SchemaPacket,
+      ChannelPacket
     };
+    /* channel types, numbered like the datalog key types */
+    enum ChannelType_ {
+      Uint64Channel,
+      Uint32Channel,
+      Uint16Channel,
+      Uint8Channel,
+      Int64Channel,
+      Int32Channel,
+      Int16Channel,
+      Int8Channel,
+      FloatChannel,
+      DoubleChannel,
+      Float16Channel,
+      ScaledInt16Channel,
+      ScaledUint16Channel
+    };
+    /* schema payloads are the schema id, the chunk index and count, and for
+    each channel its type, the float scale and offset for scaled types, and
+    its key with a one byte length */
+    struct Channel_ {
+      std::string Key;
+      ElementPtr Node;
+      ChannelType_ Type;
+      float Scale = 1.0f;
+      float Offset = 0.0f;
+      float InvScale = 1.0f;
+    };
+    static const size_t kMaxRadioPayload_ = 255;
+    static const size_t kSchemaHeaderSize_ = sizeof(uint16_t) + 2*sizeof(uint8_t);
+    static const size_t kConfigPeriod_ = 100;
     int TelemetrySocket_;
     int TelemetryPort_ = 8020;
     struct sockaddr_in TelemetryServer_;
-  bool useTime, useStaticPressure, useAirspeed, useAlt, useGps, useSbus, useImu, useAttitude, usePower;
+  bool useTime = false, useStaticPressure = false, useAirspeed = false, useAlt = false, useGps = false, useSbus = false, useImu = false, useAttitude = false, usePower = false;
+    bool useLegacy = false;
     struct TimeNodes{
       ElementPtr Time_us;
     };
     struct StaticPressNodes{
-      ElementPtr Pressure_Pa;
-      ElementPtr Temperature_C;
+      Signal<float> Pressure_Pa;
+      Signal<float> Temperature_C;
     };
     struct AirspeedNodes{
-      ElementPtr Airspeed_ms;
+      Signal<float> Airspeed_ms;
     };
     struct AltNodes{
-      ElementPtr Alt_m;
+      Signal<float> Alt_m;
     };
     struct GpsNodes{
       ElementPtr Fix;                                 // True for 3D fix only
@@ -200,39 +269,40 @@ class TelemetryClient {
       ElementPtr Hour;                             // UTC hour
       ElementPtr Min;                              // UTC minute
       ElementPtr Sec;                              // UTC second
-      ElementPtr Lat;
-      ElementPtr Lon;
-      ElementPtr Alt;
-      ElementPtr Vn;
-      ElementPtr Ve;
-      ElementPtr Vd;
-      ElementPtr HAcc;
-      ElementPtr VAcc;
-      ElementPtr SAcc;
-      ElementPtr pDOP;                              // Position DOP
+      Signal<double> Lat;
+      Signal<double> Lon;
+      Signal<float> Alt;
+      Signal<float> Vn;
+      Signal<float> Ve;
+      Signal<float> Vd;
+      Signal<float> HAcc;
+      Signal<float> VAcc;
+      Signal<float> SAcc;
+      Signal<float> pDOP;                              // Position DOP
     };
     struct SbusNodes{
-      ElementPtr Channels[16];
+      Signal<float> Channels[16];
       ElementPtr FailSafe;
       ElementPtr LostFrames;
     };
     struct ImuNodes{
-      ElementPtr Ax, Ay, Az;
-      ElementPtr Gx, Gy, Gz;
-      ElementPtr Hx, Hy, Hz;
-      ElementPtr Temperature_C;                      // Temperature, C
+      Signal<float> Ax, Ay, Az;
+      Signal<float> Gx, Gy, Gz;
+      Signal<float> Hx, Hy, Hz;
+      Signal<float> Temperature_C;                      // Temperature, C
     };
     struct AttitudeNodes{
-      ElementPtr Ax, Ay, Az;
-      ElementPtr Gx, Gy, Gz;
-      ElementPtr Axb, Ayb, Azb;
-      ElementPtr Gxb, Gyb, Gzb;
-      ElementPtr Pitch, Roll, Yaw, Heading, Track;
-      ElementPtr Lat, Lon, Alt;
-      ElementPtr Vn, Ve, Vd;
+      Signal<float> Ax, Ay, Az;
+      Signal<float> Gx, Gy, Gz;
+      Signal<float> Axb, Ayb, Azb;
+      Signal<float> Gxb, Gyb, Gzb;
+      Signal<float> Pitch, Roll, Yaw, Heading, Track;
+      Signal<double> Lat, Lon;
+      Signal<float> Alt;
+      Signal<float> Vn, Ve, Vd;
     };
   struct PowerNodes{
-    ElementPtr MinCellVolt;
+    Signal<float> MinCellVolt;
   };
     struct DataNodes{
       TimeNodes Time;
@@ -317,15 +387,22 @@ class TelemetryClient {
     };
     DataNodes Nodes_;
     Data Data_;
-    const uint8_t header_[2] = {0x42,0x46};
-    const uint8_t headerLength_ = 5;
-    const uint8_t checksumLength_ = 2;
-    uint8_t LengthBuffer_[2];
-    uint16_t Length_ = 0;
-    uint8_t Checksum_[2];
-    uint16_t ParserState_ = 0;
-    void SendPacket(PacketType_ Type, std::vector<uint8_t> &Buffer);
-    void CalcChecksum(size_t ArraySize, uint8_t *ByteArray, uint8_t *Checksum);
+    std::vector<uint8_t> PackedBuffer_;
+    std::vector<Channel_> Channels_;
+    uint16_t SchemaId_ = 0;
+    std::vector<uint8_t> PackedChannels_;
+    std::vector<std::vector<uint8_t> > ConfigFrames_;
+    size_t ConfigCount_ = 0;
+    bool Packed_ = false;
+    void ConfigureChannels(const rapidjson::Value& Config);
+    void AddChannel(const std::string &Key, ElementPtr Node, ChannelType_ Type, float Scale, float Offset);
+    bool ChannelTypeFromTag(log_tag_t Tag, ChannelType_ *Type);
+    size_t ChannelSize(ChannelType_ Type);
+    void BuildSchema();
+    void PackChannels();
+    void AddConfigPacket(PacketType_ Type, std::vector<uint8_t> &Buffer);
+    void SendConfig();
+    void FramePacket(PacketType_ Type, std::vector<uint8_t> &Buffer, std::vector<uint8_t> *Frame);
 };
 
 class TelemetryServer {
@@ -341,8 +418,19 @@ class TelemetryServer {
     enum PacketType_ {
       UartPacket,
       BaudPacket,
-      DataPacket
+      DataPacket,
+      SchemaPacket,
+      ChannelPacket
     };
+    // radio packet ids and rates of the channel schema and data
+    static const uint8_t kSchemaId_ = 50;
+    static const uint8_t kChannelId_ = 51;
+    static const size_t kChannelDecimation_ = 10;
+    static const size_t kSchemaPeriod_ = 50;
+    std::vector<std::vector<uint8_t> > Schema_;
+    uint16_t SchemaId_ = 0;
+    size_t ChannelCount_ = 0;
+    size_t SchemaCount_ = 0;
     struct TimeData{
       uint64_t Time_us;
     };
@@ -418,26 +506,18 @@ class TelemetryServer {
     int TelemetryPort_ = 8020;
     struct sockaddr_in TelemetryServer_;
     std::vector<uint8_t> Buffer;
-    uint8_t Buffer_[kUartBufferMaxSize];
-    const uint8_t header_[2] = {0x42,0x46};
-    const uint8_t headerLength_ = 5;
-    const uint8_t checksumLength_ = 2;
-    uint8_t RxByte_;
-    uint16_t ParserState_ = 0;
-    uint8_t LengthBuffer_[2];
-    uint16_t Length_ = 0;
-    uint8_t Checksum_[2];
+    BfFrameParser<kUartBufferMaxSize> Parser_;
 
    int count;
    int num2 = 1;
 
    void update(const Data &DataRef);
+   void updateSchema(const uint8_t *Payload, size_t PayloadSize);
+   void updateChannels(const uint8_t *Payload, size_t PayloadSize);
+   void sendSchema();
 
-   void generate_cksum(uint8_t id, uint8_t size, uint8_t * buf, uint8_t & cksum0, uint8_t &cksum1);
-   void send_packet(uint8_t * package, uint8_t IDnum, uint8_t size);
-
-   bool ParseMessage(uint8_t byte,PacketType_ *message,std::vector<uint8_t> *Payload);
-   void CalcChecksum(size_t ArraySize, uint8_t *ByteArray, uint8_t *Checksum);
+   void generate_cksum(uint8_t id, uint8_t size, const uint8_t * buf, uint8_t & cksum0, uint8_t &cksum1);
+   void send_packet(const uint8_t * package, uint8_t IDnum, uint8_t size);
 };
 
 #endif
@@ -114,12 +114,14 @@ void ExcitationSystem::Configure(const rapidjson::Value& Config) {
 }
 
 /* sets the engaged excitation group */
-void ExcitationSystem::SetEngagedExcitation(std::string ExcitationGroupName) {
-  EngagedGroup_ = ExcitationGroupName;
+void ExcitationSystem::SetEngagedExcitation(const std::string &ExcitationGroupName) {
+  if (ExcitationGroupName != EngagedGroup_) {
+    EngagedGroup_ = ExcitationGroupName;
+  }
 }
 
 /* run all excitation functions at a given control level */
-void ExcitationSystem::RunEngaged(std::string ControlLevel) {
+void ExcitationSystem::RunEngaged(const std::string &ControlLevel) {
   // iterate through all groups
   for (auto Group = ExcitationGroupKeys_.begin(); Group != ExcitationGroupKeys_.end(); ++Group) {
     auto GroupIndex = std::distance(ExcitationGroupKeys_.begin(),Group);
@@ -127,7 +129,7 @@ void ExcitationSystem::RunEngaged(std::string ControlLevel) {
     for (auto Level = ExcitationGroupLevels_[GroupIndex].begin(); Level != ExcitationGroupLevels_[GroupIndex].end(); ++Level) {
       auto LevelIndex = std::distance(ExcitationGroupLevels_[GroupIndex].begin(),Level);
       // iterate through all excitations
-      for (auto Func : ExcitationGroups_[GroupIndex][LevelIndex]) {
+      for (auto &Func : ExcitationGroups_[GroupIndex][LevelIndex]) {
         if (((*Group)==EngagedGroup_)&&((*Level)==ControlLevel)) {
           Func->Run(GenericFunction::kEngage);
         }
@@ -144,7 +146,7 @@ void ExcitationSystem::RunArmed() {
     for (auto Level = ExcitationGroupLevels_[GroupIndex].begin(); Level != ExcitationGroupLevels_[GroupIndex].end(); ++Level) {
       auto LevelIndex = std::distance(ExcitationGroupLevels_[GroupIndex].begin(),Level);
       // iterate through all excitations
-      for (auto Func : ExcitationGroups_[GroupIndex][LevelIndex]) {
+      for (auto &Func : ExcitationGroups_[GroupIndex][LevelIndex]) {
         if ((*Group)!=EngagedGroup_) {
           Func->Run(GenericFunction::kArm);
         }
@@ -80,8 +80,8 @@ Where:
 class ExcitationSystem {
   public:
     void Configure(const rapidjson::Value& Config);
-    void SetEngagedExcitation(std::string ExcitationGroupName);
-    void RunEngaged(std::string ControlLevel);
+    void SetEngagedExcitation(const std::string &ExcitationGroupName);
+    void RunEngaged(const std::string &ControlLevel);
     void RunArmed();
   private:
     std::string RootPath_ = "/Excitation";
@@ -29,16 +29,25 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include "effector.h"
 #include "telemetry.h"
 #include "datalog.h"
+#include "definition-tree-snapshot.h"
+#include "event-loop.h"
+#include "heap-monitor.h"
+#include "real-time.h"
+#include "frame-monitor.h"
+#include "frame-pipeline.h"
 #include "netSocket.h"
 #include "telnet.hxx"
+#include "signal_server.hxx"
 #include "FGFS.h"
 #include "route_mgr.hxx"
+#include "geofence.hxx"
 #include "rapidjson/document.h"
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/writer.h"
 #include <iostream>
 #include <iomanip>
 #include <stdint.h>
+#include <thread>
 
 using std::cout;
 using std::endl;
@@ -49,6 +58,19 @@ using std::endl;
 // deftree.
 float timePrev_s = 0;
 
+/* Sends the telemetry and datalog packets packed at the end of a frame */
+class OutputSender : public FramePipeline::Job {
+  public:
+    OutputSender(TelemetryClient *Telemetry,DatalogClient *Datalog) : Telemetry_(Telemetry), Datalog_(Datalog) {}
+    void Run(size_t) {
+      Telemetry_->SendPacked();
+      Datalog_->SendPackedData();
+    }
+  private:
+    TelemetryClient *Telemetry_;
+    DatalogClient *Datalog_;
+};
+
 int main(int argc, char* argv[]) {
   if (argc!=2) {
     std::cerr << "ERROR: Incorrect number of input arguments." << std::endl;
@@ -69,6 +91,10 @@ int main(int argc, char* argv[]) {
   DatalogClient Datalog;
   TelemetryClient Telemetry;
   FGRouteMgr route_mgr;
+  FGGeofenceMgr geofence;
+  RealTimeRuntime RealTime;
+  FrameMonitor Frame;
+  FramePipeline Pipeline;
 
   /* initialize classes */
   std::cout << "Initializing software modules." << std::endl;
@@ -101,6 +127,11 @@ int main(int argc, char* argv[]) {
       route_mgr.init(AircraftConfiguration["Route"]);
     }
 
+    if (AircraftConfiguration.HasMember("Geofence")) {
+      std::cout << "\tConfiguring geofence..." << std::endl;
+      geofence.init(AircraftConfiguration["Geofence"]);
+    }
+
     if (AircraftConfiguration.HasMember("Control")&&AircraftConfiguration.HasMember("Mission-Manager")&&AircraftConfiguration.HasMember("Effectors")) {
       std::cout << "\tConfiguring mission manager..." << std::flush;
       Mission.Configure(AircraftConfiguration["Mission-Manager"]);
@@ -136,21 +167,93 @@ int main(int argc, char* argv[]) {
     std::cout << "done!" << std::endl;
   }
 
+  // frames are always measured, shedding work is configured
+  std::cout << "\tConfiguring frame monitor..." << std::flush;
+  if (AircraftConfiguration.HasMember("Frame-Monitor")) {
+    Frame.Configure(AircraftConfiguration["Frame-Monitor"],Fmu.GetFramePeriod_us());
+  } else {
+    Frame.Configure(rapidjson::Value(rapidjson::kObjectType),Fmu.GetFramePeriod_us());
+  }
+  std::cout << "done!" << std::endl;
+
   std::cout << "\tConfiguring datalog..." << std::flush;
+  if (AircraftConfiguration.HasMember("Datalog")) {
+    Datalog.Configure(AircraftConfiguration["Datalog"],Fmu.GetFramePeriod_us());
+  }
+  // the engaged and armed groups are not deftree signals, log them as events
+  size_t EngagedSensorProcessingEvent = Datalog.AddStringEvent("/Mission-Manager/EngagedSensorProcessing","Engaged sensor processing group");
+  size_t ArmedSensorProcessingEvent = Datalog.AddStringEvent("/Mission-Manager/ArmedSensorProcessing","Armed sensor processing group");
+  size_t EngagedControllerEvent = Datalog.AddStringEvent("/Mission-Manager/EngagedController","Engaged control group");
+  size_t ArmedControllerEvent = Datalog.AddStringEvent("/Mission-Manager/ArmedController","Armed control group");
+  size_t EngagedExcitationEvent = Datalog.AddStringEvent("/Mission-Manager/EngagedExcitation","Engaged excitation");
   Datalog.RegisterGlobalData();
   std::cout << "done!" << std::endl;
+
+  if (AircraftConfiguration.HasMember("Real-Time")) {
+    std::cout << "\tConfiguring real-time runtime..." << std::flush;
+    RealTime.Configure(AircraftConfiguration["Real-Time"]);
+    std::cout << "done!" << std::endl;
+  }
+
+  if (AircraftConfiguration.HasMember("Pipeline")) {
+    std::cout << "\tConfiguring frame pipeline..." << std::flush;
+    Pipeline.Configure(AircraftConfiguration["Pipeline"]);
+    SenProc.SetPipeline(&Pipeline);
+    std::cout << "done!" << std::endl;
+  }
   std::cout << "Entering main loop." << std::endl;
 
+  bool fgfs = fgfs_init(AircraftConfiguration);
+
+  // the flight thread takes its real-time priority and core from here on,
+  // threads started below move themselves back to the auxiliary settings
+  RealTime.Begin();
+  RealTime.SelfCheck();
+  Pipeline.Begin([&RealTime]() {RealTime.BeginWorker();},[&RealTime]() {RealTime.BeginAuxiliary();});
+  // relative fences are positioned and indexed on their own thread at the first fix
+  geofence.begin([&RealTime]() {RealTime.BeginAuxiliary();});
+  OutputSender Output(&Telemetry,&Datalog);
+
+  // telnet reads a snapshot published at the end of each frame and
+  // runs on its own thread, off the real-time loop
+  DefinitionTreeSnapshot TelnetSnapshot;
+  TelnetSnapshot.Configure("/");
   netInit();                    // do this before creating telnet instance
-  UGTelnet telnet( 6500 );
+  UGTelnet telnet( 6500, &TelnetSnapshot );
   telnet.open();
   std::cout << "Telnet interface opened on port 6500" << std::endl;
+  // binary signal subscriptions, served from the same snapshot by the
+  // telnet thread's network poll
+  UGSignalServer Signals( 6501, &TelnetSnapshot );
+  Signals.open();
+  std::cout << "Signal subscription interface opened on port 6501" << std::endl;
+  std::thread TelnetThread([&telnet,&RealTime]() {
+    RealTime.BeginAuxiliary();
+    while(1) {
+      telnet.process(100);
+    }
+  });
+  TelnetThread.detach();
 
-  bool fgfs = fgfs_init(AircraftConfiguration);
+  // the flight loop sleeps until the FMU serial port has data rather
+  // than spinning on it, the registration is level triggered so bytes
+  // left over from a partial frame wake it up again
+  EventLoop FlightEvents;
+  FlightEvents.Add(Fmu.GetFileDescriptor(),EPOLLIN,[](uint32_t){});
+
+  // the flight loop should not touch the heap once configured, lookups by
+  // path are done here and the monitor (if built in) checks each frame
+  ElementPtr FmuTime = deftree.getElement("/Sensors/Fmu/Time_us");
+  HeapMonitor::Arm();
 
   /* main loop */
   while(1) {
-    if (Fmu.ReceiveSensorData()) {
+    if (!Fmu.ReceiveSensorData()) {
+      FlightEvents.Run(100);
+    } else {
+      Frame.BeginFrame();
+      HeapMonitor::BeginFrame();
+      deftree.NextGeneration();
       if ( fgfs ) {
         // insert flightgear sim data calls
         fgfs_imu_update();
@@ -159,14 +262,16 @@ int main(int argc, char* argv[]) {
       if (SenProc.Configured()&&SenProc.Initialized()) {
         // run mission
         Mission.Run();
-        // get and set engaged sensor processing
+        // get and set engaged and armed sensor processing
         SenProc.SetEngagedSensorProcessing(Mission.GetEngagedSensorProcessing());
+        SenProc.SetArmedSensorProcessing(Mission.GetArmedSensorProcessing());
         // run sensor processing
         SenProc.Run();
         if ( fgfs ) {
           fgfs_airdata_update(); // overwrite processed air data
         }
         route_mgr.update();
+        geofence.update();
         // get and set engaged and armed controllers
         Control.SetEngagedController(Mission.GetEngagedController());
         Control.SetArmedController(Mission.GetArmedController());
@@ -186,18 +291,22 @@ int main(int argc, char* argv[]) {
         if ( fgfs ) {
           fgfs_act_update();
         }
-        // run armed excitations
-        Excitation.RunArmed();
-        // run armed control laws
-        Control.RunArmed();
+        // run armed excitations and control laws, unless shed to keep
+        // the engaged control law on time
+        if (Frame.RunArmedExcitation()) {
+          Excitation.RunArmed();
+        }
+        if (Frame.RunArmedControl()) {
+          Control.RunArmed();
+        }
 
         // Print some status
         static const double r2d = 180.0 / M_PI;
 
-        std::string CtrlEngaged = Mission.GetEngagedController();
-        std::string ExcitEngaged = Mission.GetEngagedExcitation();
+        const std::string &CtrlEngaged = Mission.GetEngagedController();
+        const std::string &ExcitEngaged = Mission.GetEngagedExcitation();
 
-        float timeCurr_s = 1e-6 * (deftree.getElement("/Sensors/Fmu/Time_us") -> getFloat());
+        float timeCurr_s = 1e-6 * (FmuTime -> getFloat());
         float dt = timeCurr_s - timePrev_s;
         timePrev_s = timeCurr_s;
 
@@ -206,11 +315,26 @@ int main(int argc, char* argv[]) {
                   << std::endl;
 
       }
+      // the previous frame's packets have to be out before packing this frame's
+      Pipeline.WaitOutput();
       // run telemetry
-      Telemetry.Send();
+      if (Frame.SendTelemetry()) {
+        Telemetry.Pack();
+      }
       // run datalog
-      Datalog.LogBinaryData();
-      telnet.process();
+      Datalog.LogStringEvent(EngagedSensorProcessingEvent,Mission.GetEngagedSensorProcessing());
+      Datalog.LogStringEvent(ArmedSensorProcessingEvent,Mission.GetArmedSensorProcessing());
+      Datalog.LogStringEvent(EngagedControllerEvent,Mission.GetEngagedController());
+      Datalog.LogStringEvent(ArmedControllerEvent,Mission.GetArmedController());
+      Datalog.LogStringEvent(EngagedExcitationEvent,Mission.GetEngagedExcitation());
+      Datalog.PackBinaryData();
+      // sent on the output thread while the next frame is received, if configured
+      Pipeline.StartOutput(Output);
+      // publish the frame to non real-time consumers
+      TelnetSnapshot.Publish();
+      Signals.notify();
+      HeapMonitor::EndFrame();
+      Frame.EndFrame();
     }
   }
 
@@ -0,0 +1,654 @@
+// \file geofence.cpp
+// geofence and route corridor checks.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU LGPL
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <limits>
+
+#include "geofence.hxx"
+
+
+static const double d2r = M_PI / 180.0;
+static const double r2d = 180.0 / M_PI;
+static const float inf = std::numeric_limits<float>::infinity();
+static const size_t chunk_edges = 4;
+static const size_t group_chunks = 16;
+
+
+// compute the rotation from ECEF into the NED frame at lat/lon (rad),
+// the same rotation ecef2ned() applies
+static Matrix3d ned_rotation( double lat, double lon ) {
+  Matrix3d r;
+  r << -sin(lat)*cos(lon), -sin(lat)*sin(lon), cos(lat),
+       -sin(lon), cos(lon), 0.0,
+       -cos(lat)*cos(lon), -cos(lat)*sin(lon), -sin(lat);
+  return r;
+}
+
+// true if the segment p0-p1 touches the axis aligned box, clipping
+// the segment against each slab in turn (Liang-Barsky)
+static bool segment_hits_box( float n0, float e0, float n1, float e1,
+                              float min_n, float min_e,
+                              float max_n, float max_e ) {
+  float t0 = 0.0, t1 = 1.0;
+  float d[2] = { n1 - n0, e1 - e0 };
+  float p[2] = { n0, e0 };
+  float lo[2] = { min_n, min_e };
+  float hi[2] = { max_n, max_e };
+  for ( int i = 0; i < 2; i++ ) {
+    if ( d[i] == 0.0 ) {
+      if ( p[i] < lo[i] || p[i] > hi[i] ) {
+        return false;
+      }
+    } else {
+      float ta = (lo[i] - p[i]) / d[i];
+      float tb = (hi[i] - p[i]) / d[i];
+      if ( ta > tb ) { std::swap( ta, tb ); }
+      t0 = std::max( t0, ta );
+      t1 = std::min( t1, tb );
+      if ( t0 > t1 ) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+
+SGFence::SGFence( const rapidjson::Value& Config ):
+  type( INCLUSION ),
+  floor_m( -inf ),
+  ceiling_m( inf ),
+  relative( false ),
+  half_width_m( 0.0 ),
+  num_edges( 0 ),
+  min_north( 0.0 ),
+  min_east( 0.0 ),
+  cell_size( 1.0 ),
+  inv_cell_size( 1.0 ),
+  rows( 0 ),
+  cols( 0 )
+{
+  if ( Config.HasMember("name") ) {
+    name = Config["name"].GetString();
+  }
+  if ( Config.HasMember("type") ) {
+    string t = Config["type"].GetString();
+    if ( t == "inclusion" ) {
+      type = INCLUSION;
+    } else if ( t == "exclusion" ) {
+      type = EXCLUSION;
+    } else if ( t == "corridor" ) {
+      type = CORRIDOR;
+    } else {
+      printf("Unknown fence type: %s\n", t.c_str());
+      name.clear();
+    }
+  }
+  if ( Config.HasMember("floor_m") ) {
+    floor_m = Config["floor_m"].GetFloat();
+  }
+  if ( Config.HasMember("ceiling_m") ) {
+    ceiling_m = Config["ceiling_m"].GetFloat();
+  }
+  if ( Config.HasMember("half_width_m") ) {
+    half_width_m = Config["half_width_m"].GetFloat();
+  }
+  // same format as route waypoints, read directly so large fences
+  // are not echoed vertex by vertex
+  if ( Config.HasMember("waypoints") ) {
+    const rapidjson::Value& wpts = Config["waypoints"];
+    waypoints.reserve( wpts.Size() );
+    for ( rapidjson::Value::ConstValueIterator it = wpts.Begin(); it != wpts.End(); ++it ) {
+      if ( it->HasMember("lon") && it->HasMember("lat") ) {
+        waypoints.push_back( SGWayPoint( (*it)["lon"].GetDouble(),
+                                         (*it)["lat"].GetDouble(),
+                                         SGWayPoint::ABSOLUTE ) );
+      } else if ( it->HasMember("heading_deg") && it->HasMember("dist_m") ) {
+        waypoints.push_back( SGWayPoint( (*it)["heading_deg"].GetDouble(),
+                                         (*it)["dist_m"].GetDouble(),
+                                         SGWayPoint::RELATIVE ) );
+        relative = true;
+      }
+    }
+  }
+  printf("fence %s: %d vertices\n", name.c_str(), (int)waypoints.size());
+}
+
+
+void SGFence::refresh_offset_positions( const SGWayPoint &ref ) {
+  for ( unsigned int i = 0; i < waypoints.size(); ++i ) {
+    if ( waypoints[i].get_mode() == SGWayPoint::RELATIVE ) {
+      waypoints[i].update_relative_pos( ref, 0.0 );
+    }
+  }
+}
+
+
+void SGFence::build( const Vector3d &ecef0, const Matrix3d &ecef2ned, float cell_m ) {
+  size_t n = waypoints.size();
+  // polygons close back on the first vertex, corridors do not
+  num_edges = ( type == CORRIDOR ) ? n - 1 : n;
+  north_m.resize( n );
+  east_m.resize( n );
+  float max_north = -inf, max_east = -inf;
+  min_north = inf;
+  min_east = inf;
+  for ( size_t i = 0; i < n; i++ ) {
+    Vector3d ned = ecef2ned * (lla2ecef( Vector3d(waypoints[i].get_target_lat() * d2r,
+                                                  waypoints[i].get_target_lon() * d2r,
+                                                  0.0) ) - ecef0);
+    north_m[i] = ned(0);
+    east_m[i] = ned(1);
+    min_north = std::min( min_north, north_m[i] );
+    min_east = std::min( min_east, east_m[i] );
+    max_north = std::max( max_north, north_m[i] );
+    max_east = std::max( max_east, east_m[i] );
+  }
+  // edge directions, saving the per query divide
+  edge_north.resize( num_edges );
+  edge_east.resize( num_edges );
+  edge_inv_len2.resize( num_edges );
+  for ( size_t i = 0; i < num_edges; i++ ) {
+    size_t j = (i + 1) % n;
+    edge_north[i] = north_m[j] - north_m[i];
+    edge_east[i] = east_m[j] - east_m[i];
+    float len2 = edge_north[i] * edge_north[i] + edge_east[i] * edge_east[i];
+    edge_inv_len2[i] = (len2 > 0.0) ? 1.0 / len2 : 0.0;
+  }
+
+  // cover the whole corridor and some of the surroundings so most
+  // queries hit the grid, points off it fall back to a slower search
+  float pad = 0.25 * std::max( max_north - min_north, max_east - min_east );
+  if ( type == CORRIDOR ) {
+    pad += half_width_m;
+  }
+  min_north -= pad;
+  min_east -= pad;
+  max_north += pad;
+  max_east += pad;
+
+  // a few edges per boundary cell unless told otherwise, never so
+  // fine that the grid outgrows the polygon
+  float height = max_north - min_north;
+  float width = max_east - min_east;
+  cell_size = cell_m;
+  if ( cell_size <= 0.0 ) {
+    float perimeter = 0.0;
+    for ( size_t i = 0; i < num_edges; i++ ) {
+      size_t j = (i + 1) % n;
+      perimeter += hypot( north_m[j] - north_m[i], east_m[j] - east_m[i] );
+    }
+    cell_size = std::min( 4.0f * perimeter / num_edges,
+                          sqrt( std::max( height * width, 1.0f ) / n ) );
+  }
+  cell_size = std::max( cell_size, 1.0f );
+  while ( (floor(height / cell_size) + 1) * (floor(width / cell_size) + 1) > 16.0 * n + 1024.0 ) {
+    cell_size *= 2.0;
+  }
+  inv_cell_size = 1.0 / cell_size;
+  rows = (int)(height * inv_cell_size) + 1;
+  cols = (int)(width * inv_cell_size) + 1;
+
+  // bucket the edges by the cells they cross, counting first so the
+  // buckets are contiguous
+  cell_start.assign( rows * cols + 1, 0 );
+  for ( int pass = 0; pass < 2; pass++ ) {
+    vector<uint32_t> fill;
+    if ( pass == 1 ) {
+      for ( int c = 0; c < rows * cols; c++ ) {
+        cell_start[c + 1] += cell_start[c];
+      }
+      cell_edges.resize( cell_start[rows * cols] );
+      fill.assign( cell_start.begin(), cell_start.end() - 1 );
+    }
+    for ( size_t i = 0; i < num_edges; i++ ) {
+      size_t j = (i + 1) % n;
+      int r0 = (int)((std::min( north_m[i], north_m[j] ) - min_north) * inv_cell_size);
+      int r1 = (int)((std::max( north_m[i], north_m[j] ) - min_north) * inv_cell_size);
+      int c0 = (int)((std::min( east_m[i], east_m[j] ) - min_east) * inv_cell_size);
+      int c1 = (int)((std::max( east_m[i], east_m[j] ) - min_east) * inv_cell_size);
+      for ( int r = std::max( r0, 0 ); r <= std::min( r1, rows - 1 ); r++ ) {
+        for ( int c = std::max( c0, 0 ); c <= std::min( c1, cols - 1 ); c++ ) {
+          float n0 = min_north + r * cell_size;
+          float e0 = min_east + c * cell_size;
+          if ( segment_hits_box( north_m[i], east_m[i], north_m[j], east_m[j],
+                                 n0, e0, n0 + cell_size, e0 + cell_size ) ) {
+            if ( pass == 0 ) {
+              cell_start[r * cols + c + 1]++;
+            } else {
+              cell_edges[fill[r * cols + c]++] = i;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // bounds of runs of consecutive edges and of groups of runs, for
+  // the searches that cannot use the grid
+  size_t chunks = (num_edges + chunk_edges - 1) / chunk_edges;
+  chunk_box.assign( chunks, Box() );
+  group_box.assign( (chunks + group_chunks - 1) / group_chunks, Box() );
+  for ( size_t i = 0; i < num_edges; i++ ) {
+    size_t j = (i + 1) % n;
+    chunk_box[i / chunk_edges].add( north_m[i], east_m[i] );
+    chunk_box[i / chunk_edges].add( north_m[j], east_m[j] );
+    group_box[i / (chunk_edges * group_chunks)].add( north_m[i], east_m[i] );
+    group_box[i / (chunk_edges * group_chunks)].add( north_m[j], east_m[j] );
+  }
+
+  // the edges that can be nearest to some point of each cell.  None
+  // is further from the cell center than a cell diagonal beyond the
+  // nearest edge, and none is further from the cell than the largest
+  // distance from a cell corner to one edge.
+  float diagonal = cell_size * sqrt( 2.0f );
+  vector<uint32_t> seen( num_edges, 0xffffffff );
+  near_start.assign( rows * cols + 1, 0 );
+  near_edges.clear();
+  for ( int r = 0; r < rows; r++ ) {
+    for ( int c = 0; c < cols; c++ ) {
+      int cell = r * cols + c;
+      float cn = min_north + (r + 0.5) * cell_size;
+      float ce = min_east + (c + 0.5) * cell_size;
+      float reach = search_distance( cn, ce ) + diagonal;
+      int k_max = (int)(reach * inv_cell_size) + 1;
+      for ( int y = std::max( r - k_max, 0 ); y <= std::min( r + k_max, rows - 1 ); y++ ) {
+        for ( int x = std::max( c - k_max, 0 ); x <= std::min( c + k_max, cols - 1 ); x++ ) {
+          int other = y * cols + x;
+          for ( uint32_t m = cell_start[other]; m < cell_start[other + 1]; m++ ) {
+            uint32_t i = cell_edges[m];
+            if ( seen[i] != (uint32_t)cell && edge_distance2( i, cn, ce ) <= reach * reach ) {
+              seen[i] = cell;
+              near_edges.push_back( i );
+            }
+          }
+        }
+      }
+      float n0 = min_north + r * cell_size;
+      float e0 = min_east + c * cell_size;
+      float reach2 = inf;
+      for ( size_t m = near_start[cell]; m < near_edges.size(); m++ ) {
+        uint32_t i = near_edges[m];
+        float corner2 = std::max( std::max( edge_distance2( i, n0, e0 ),
+                                            edge_distance2( i, n0 + cell_size, e0 ) ),
+                                  std::max( edge_distance2( i, n0, e0 + cell_size ),
+                                            edge_distance2( i, n0 + cell_size, e0 + cell_size ) ) );
+        reach2 = std::min( reach2, corner2 );
+      }
+      size_t kept = near_start[cell];
+      for ( size_t m = near_start[cell]; m < near_edges.size(); m++ ) {
+        if ( edge_box_distance2( near_edges[m], n0, e0, n0 + cell_size, e0 + cell_size ) <= reach2 ) {
+          near_edges[kept++] = near_edges[m];
+        }
+      }
+      near_edges.resize( kept );
+      near_start[cell + 1] = near_edges.size();
+    }
+  }
+
+  // containment of each cell center, the starting point of queries
+  if ( type != CORRIDOR ) {
+    cell_center_inside.resize( rows * cols );
+    for ( int r = 0; r < rows; r++ ) {
+      for ( int c = 0; c < cols; c++ ) {
+        cell_center_inside[r * cols + c] =
+          contains_brute( min_north + (r + 0.5) * cell_size,
+                          min_east + (c + 0.5) * cell_size );
+      }
+    }
+  }
+}
+
+
+// even-odd rule over every edge, only used to seed the grid
+bool SGFence::contains_brute( float north, float east ) const {
+  bool inside = false;
+  size_t n = north_m.size();
+  for ( size_t i = 0, j = n - 1; i < n; j = i++ ) {
+    if ( (north_m[i] > north) != (north_m[j] > north) ) {
+      float e = east_m[j] + (north - north_m[j]) * (east_m[i] - east_m[j]) / (north_m[i] - north_m[j]);
+      if ( east < e ) {
+        inside = !inside;
+      }
+    }
+  }
+  return inside;
+}
+
+
+// walk from the center of the cell holding the point to the point,
+// each edge crossed on the way flips the center's containment.  The
+// walk never leaves the cell so only the cell's edges are tested.
+bool SGFence::contains( float north, float east ) const {
+  int r = (int)floor( (north - min_north) * inv_cell_size );
+  int c = (int)floor( (east - min_east) * inv_cell_size );
+  if ( type == CORRIDOR || r < 0 || r >= rows || c < 0 || c >= cols ) {
+    return false;
+  }
+  int cell = r * cols + c;
+  bool inside = cell_center_inside[cell];
+  float cn = min_north + (r + 0.5) * cell_size;
+  float ce = min_east + (c + 0.5) * cell_size;
+  float dn = north - cn, de = east - ce;
+  size_t n = north_m.size();
+  for ( uint32_t k = cell_start[cell]; k < cell_start[cell + 1]; k++ ) {
+    uint32_t i = cell_edges[k];
+    uint32_t j = (i + 1 == n) ? 0 : i + 1;
+    // edge end points on opposite sides of the walk...
+    bool si = dn * (east_m[i] - ce) - de * (north_m[i] - cn) > 0.0;
+    bool sj = dn * (east_m[j] - ce) - de * (north_m[j] - cn) > 0.0;
+    if ( si == sj ) {
+      continue;
+    }
+    // ...and walk end points on opposite sides of the edge
+    float en = north_m[j] - north_m[i], ee = east_m[j] - east_m[i];
+    bool s0 = en * (ce - east_m[i]) - ee * (cn - north_m[i]) > 0.0;
+    bool s1 = en * (east - east_m[i]) - ee * (north - north_m[i]) > 0.0;
+    if ( s0 != s1 ) {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+
+float SGFence::edge_distance2( uint32_t i, float north, float east ) const {
+  float en = edge_north[i], ee = edge_east[i];
+  float pn = north - north_m[i], pe = east - east_m[i];
+  float t = (pn * en + pe * ee) * edge_inv_len2[i];
+  t = std::min( std::max( t, 0.0f ), 1.0f );
+  float dn = pn - t * en, de = pe - t * ee;
+  return dn * dn + de * de;
+}
+
+
+float SGFence::edge_box_distance2( uint32_t i, float min_n, float min_e,
+                                   float max_n, float max_e ) const {
+  uint32_t j = (i + 1 == north_m.size()) ? 0 : i + 1;
+  if ( segment_hits_box( north_m[i], east_m[i], north_m[j], east_m[j],
+                         min_n, min_e, max_n, max_e ) ) {
+    return 0.0;
+  }
+  // otherwise the closest points include an edge end or a box corner
+  Box box;
+  box.add( min_n, min_e );
+  box.add( max_n, max_e );
+  return std::min( std::min( std::min( box.distance2( north_m[i], east_m[i] ),
+                                       box.distance2( north_m[j], east_m[j] ) ),
+                             std::min( edge_distance2( i, min_n, min_e ),
+                                       edge_distance2( i, max_n, min_e ) ) ),
+                   std::min( edge_distance2( i, min_n, max_e ),
+                             edge_distance2( i, max_n, max_e ) ) );
+}
+
+
+// points on the grid only need the candidates of their own cell
+float SGFence::distance( float north, float east ) const {
+  int r = (int)floor( (north - min_north) * inv_cell_size );
+  int c = (int)floor( (east - min_east) * inv_cell_size );
+  if ( r < 0 || r >= rows || c < 0 || c >= cols ) {
+    return search_distance( north, east );
+  }
+  int cell = r * cols + c;
+  float best2 = inf;
+  for ( uint32_t m = near_start[cell]; m < near_start[cell + 1]; m++ ) {
+    best2 = std::min( best2, edge_distance2( near_edges[m], north, east ) );
+  }
+  return sqrt( best2 );
+}
+
+
+SGFence::Box::Box():
+  min_north( inf ),
+  min_east( inf ),
+  max_north( -inf ),
+  max_east( -inf )
+{
+}
+
+
+void SGFence::Box::add( float north, float east ) {
+  min_north = std::min( min_north, north );
+  min_east = std::min( min_east, east );
+  max_north = std::max( max_north, north );
+  max_east = std::max( max_east, east );
+}
+
+
+float SGFence::Box::distance2( float north, float east ) const {
+  float dn = std::max( std::max( min_north - north, north - max_north ), 0.0f );
+  float de = std::max( std::max( min_east - east, east - max_east ), 0.0f );
+  return dn * dn + de * de;
+}
+
+
+// the edges of the runs in group g lying closer than best2
+void SGFence::search_group( size_t g, float north, float east, float &best2 ) const {
+  size_t chunk_end = std::min( (g + 1) * group_chunks, chunk_box.size() );
+  for ( size_t k = g * group_chunks; k < chunk_end; k++ ) {
+    if ( chunk_box[k].distance2( north, east ) < best2 ) {
+      size_t edge_end = std::min( (k + 1) * chunk_edges, num_edges );
+      for ( size_t i = k * chunk_edges; i < edge_end; i++ ) {
+        best2 = std::min( best2, edge_distance2( i, north, east ) );
+      }
+    }
+  }
+}
+
+
+// search the nearest group first, then only the groups whose bounds
+// are closer than the best edge so far
+float SGFence::search_distance( float north, float east ) const {
+  size_t groups = group_box.size();
+  if ( groups == 0 ) {
+    return inf;
+  }
+  size_t nearest = 0;
+  float nearest2 = inf;
+  for ( size_t g = 0; g < groups; g++ ) {
+    float d2 = group_box[g].distance2( north, east );
+    if ( d2 < nearest2 ) {
+      nearest2 = d2;
+      nearest = g;
+    }
+  }
+  float best2 = inf;
+  search_group( nearest, north, east, best2 );
+  for ( size_t g = 0; g < groups; g++ ) {
+    if ( g != nearest && group_box[g].distance2( north, east ) < best2 ) {
+      search_group( g, north, east, best2 );
+    }
+  }
+  return sqrt( best2 );
+}
+
+
+float SGFence::margin( float north, float east, float alt_m ) const {
+  float h;
+  if ( type == CORRIDOR ) {
+    h = half_width_m - distance( north, east );
+  } else {
+    h = distance( north, east );
+    if ( !contains( north, east ) ) {
+      h = -h;
+    }
+  }
+  // positive inside the fenced volume
+  float v = std::min( alt_m - floor_m, ceiling_m - alt_m );
+  float in = std::min( h, v );
+  return ( type == EXCLUSION ) ? -in : in;
+}
+
+
+FGGeofenceMgr::FGGeofenceMgr() :
+  initialized( false ),
+  relative( false ),
+  built( false ),
+  cell_m( 0.0 ),
+  build_requested( false ),
+  stop( false ),
+  ref_lat_deg( 0.0 ),
+  ref_lon_deg( 0.0 ),
+  ecef0( Vector3d::Zero() ),
+  ecef2ned( Matrix3d::Identity() )
+{
+}
+
+
+FGGeofenceMgr::~FGGeofenceMgr() {
+  if ( builder.joinable() ) {
+    {
+      std::lock_guard<std::mutex> lock( build_mutex );
+      stop = true;
+    }
+    build_cond.notify_all();
+    builder.join();
+  }
+  for ( unsigned int i = 0; i < fences.size(); i++ ) {
+    delete fences[i];
+  }
+}
+
+
+void FGGeofenceMgr::init( const rapidjson::Value& Config ) {
+  printf("Initializing Geofence Manager...\n");
+
+  // configuration
+  if ( Config.HasMember("Cell_m") ) {
+    cell_m = Config["Cell_m"].GetFloat();
+  }
+  string alt_path = "/Sensor-Processing/Altitude_m";
+  if ( Config.HasMember("Altitude") ) {
+    alt_path = Config["Altitude"].GetString();
+  }
+
+  // input signals
+  lat_rad_node = deftree.getElement("/Sensor-Processing/Latitude_rad", true);
+  lon_rad_node = deftree.getElement("/Sensor-Processing/Longitude_rad", true);
+  alt_node = deftree.getElement(alt_path, true);
+  gps_fix_node = deftree.getElement("/Sensors/uBlox/Fix", true);
+
+  // fences
+  if ( Config.HasMember("fences") ) {
+    const rapidjson::Value& fence_list = Config["fences"];
+    for ( rapidjson::Value::ConstValueIterator it = fence_list.Begin(); it != fence_list.End(); ++it ) {
+      SGFence *fence = new SGFence( *it );
+      fences.push_back( fence );
+      size_t min_waypoints = ( fence->get_type() == SGFence::CORRIDOR ) ? 2 : 3;
+      if ( fence->get_name().empty() || fence->get_waypoints_size() < min_waypoints ) {
+        printf("Each fence needs a name, a known type and at least 3 waypoints (2 for corridors)\n");
+        exit(-1);
+      }
+      relative = relative || fence->has_relative();
+    }
+  }
+
+  // output signals
+  ready_node = deftree.initElement("/Geofence/Ready", "Geofence positioned and checked", LOG_UINT8, LOG_NONE);
+  violation_node = deftree.initElement("/Geofence/Violation", "Any fence violated", LOG_UINT8, LOG_NONE);
+  margin_node = deftree.initElement("/Geofence/Margin_m", "Smallest fence margin, negative when violated, m", LOG_FLOAT, LOG_NONE);
+  for ( unsigned int i = 0; i < fences.size(); i++ ) {
+    string path = "/Geofence/" + fences[i]->get_name();
+    fence_margin_nodes.push_back( deftree.initElement(path + "/Margin_m", "Fence margin, negative when violated, m", LOG_FLOAT, LOG_NONE) );
+    fence_inside_nodes.push_back( deftree.initElement(path + "/Inside", "Inside the fenced volume", LOG_UINT8, LOG_NONE) );
+  }
+
+  // absolute fences can be indexed now, relative ones wait for a fix
+  if ( !relative && fences.size() > 0 ) {
+    build( fences[0]->get_first_lat(), fences[0]->get_first_lon() );
+  }
+
+  initialized = true;
+}
+
+
+// index all fences in the NED frame at lat/lon (deg)
+void FGGeofenceMgr::build( double lat_deg, double lon_deg ) {
+  ecef0 = lla2ecef( Vector3d(lat_deg * d2r, lon_deg * d2r, 0.0) );
+  ecef2ned = ned_rotation( lat_deg * d2r, lon_deg * d2r );
+  for ( unsigned int i = 0; i < fences.size(); i++ ) {
+    fences[i]->build( ecef0, ecef2ned, cell_m );
+  }
+  built.store( true, std::memory_order_release );
+}
+
+
+void FGGeofenceMgr::begin( std::function<void()> thread_init ) {
+  if ( initialized && relative && !built ) {
+    builder = std::thread( &FGGeofenceMgr::build_loop, this, thread_init );
+  }
+}
+
+
+// waits for the reference from the first fix, then positions and
+// indexes the relative fences, which allocates and can take a while
+void FGGeofenceMgr::build_loop( std::function<void()> thread_init ) {
+  if ( thread_init ) {
+    thread_init();
+  }
+  double lat_deg, lon_deg;
+  {
+    std::unique_lock<std::mutex> lock( build_mutex );
+    build_cond.wait( lock, [this]{ return build_requested || stop; } );
+    if ( stop ) {
+      return;
+    }
+    lat_deg = ref_lat_deg;
+    lon_deg = ref_lon_deg;
+  }
+  printf("Positioning relative fences...\n");
+  SGWayPoint ref( lon_deg, lat_deg );
+  for ( unsigned int i = 0; i < fences.size(); i++ ) {
+    fences[i]->refresh_offset_positions( ref );
+  }
+  build( lat_deg, lon_deg );
+  printf("Relative fences ready\n");
+}
+
+
+void FGGeofenceMgr::update() {
+  if ( !initialized || fences.empty() ) {
+    return;
+  }
+
+  double lat = lat_rad_node->getDouble();
+  double lon = lon_rad_node->getDouble();
+
+  // the fences and the local frame are only read once built is set
+  if ( !built.load( std::memory_order_acquire ) ) {
+    if ( !build_requested && gps_fix_node->getInt() == 1 ) {
+      {
+        std::lock_guard<std::mutex> lock( build_mutex );
+        ref_lat_deg = lat * r2d;
+        ref_lon_deg = lon * r2d;
+        build_requested = true;
+      }
+      build_cond.notify_one();
+    }
+    ready_node->setInt( 0 );
+    return;
+  }
+
+  Vector3d ned = ecef2ned * (lla2ecef( Vector3d(lat, lon, 0.0) ) - ecef0);
+  float north = ned(0);
+  float east = ned(1);
+  float alt_m = alt_node->getFloat();
+
+  float min_margin = inf;
+  for ( unsigned int i = 0; i < fences.size(); i++ ) {
+    float m = fences[i]->margin( north, east, alt_m );
+    fence_margin_nodes[i]->setFloat( m );
+    fence_inside_nodes[i]->setInt( (fences[i]->get_type() == SGFence::EXCLUSION) ? m <= 0.0 : m > 0.0 );
+    min_margin = std::min( min_margin, m );
+  }
+  margin_node->setFloat( min_margin );
+  violation_node->setInt( min_margin < 0.0 );
+  ready_node->setInt( 1 );
+}
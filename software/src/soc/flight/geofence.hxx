@@ -0,0 +1,212 @@
+// \file geofence.hxx
+// geofence and route corridor checks.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU LGPL
+//
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+using std::string;
+using std::vector;
+
+#include "rapidjson/document.h"
+
+#include "definition-tree2.h"
+#include "nav_functions_float.hxx"
+#include "waypoint.hxx"
+
+
+/**
+ * A single fence: a polygon of waypoints, or a route corridor around
+ * a polyline, with an optional altitude floor and ceiling.  It is
+ * indexed by a uniform grid in a local north/east frame so
+ * containment and boundary distance only look at the edges near the
+ * query point.
+ */
+
+class SGFence {
+
+public:
+
+  enum fencetype {
+    INCLUSION = 0,		// stay inside
+    EXCLUSION = 1,		// stay outside
+    CORRIDOR = 2		// stay within half_width_m of the legs
+  };
+
+  SGFence( const rapidjson::Value& Config );
+
+  inline const string& get_name() const { return name; }
+  inline fencetype get_type() const { return type; }
+  inline bool has_relative() const { return relative; }
+  inline size_t get_waypoints_size() const { return waypoints.size(); }
+  inline double get_first_lat() const { return waypoints[0].get_target_lat(); }
+  inline double get_first_lon() const { return waypoints[0].get_target_lon(); }
+
+  /** Position relative waypoints from the given reference */
+  void refresh_offset_positions( const SGWayPoint &ref );
+
+  /**
+   * Convert the polygon into the local frame and build the grid.
+   * @param ecef0 origin of the local frame
+   * @param ecef2ned rotation into the local frame
+   * @param cell_m grid cell size, 0 picks one from the polygon size
+   */
+  void build( const Vector3d &ecef0, const Matrix3d &ecef2ned, float cell_m );
+
+  /** @return true if the local point (m) is inside the polygon, always
+   * false for corridors */
+  bool contains( float north, float east ) const;
+
+  /** @return distance (m) from the local point to the nearest edge */
+  float distance( float north, float east ) const;
+
+  /**
+   * @return signed distance (m) to the edge of the fenced volume,
+   * positive when allowed (inside an inclusion fence or outside an
+   * exclusion fence) and negative when violated.
+   */
+  float margin( float north, float east, float alt_m ) const;
+
+private:
+
+  string name;
+  fencetype type;
+  float floor_m;
+  float ceiling_m;
+  bool relative;
+  float half_width_m;
+  vector<SGWayPoint> waypoints;
+  size_t num_edges;
+
+  // polygon in the local frame, vertex i to i+1 is edge i
+  vector<float> north_m;
+  vector<float> east_m;
+  vector<float> edge_north;
+  vector<float> edge_east;
+  vector<float> edge_inv_len2;
+
+  // grid over the polygon bounds, the edges crossing cell c are
+  // cell_edges[cell_start[c]] to cell_edges[cell_start[c+1]-1]
+  float min_north, min_east;
+  float cell_size, inv_cell_size;
+  int rows, cols;
+  vector<uint32_t> cell_start;
+  vector<uint32_t> cell_edges;
+  vector<uint8_t> cell_center_inside;
+  // bounds of runs of consecutive edges, and of groups of runs
+  struct Box {
+    float min_north, min_east, max_north, max_east;
+    Box();
+    void add( float north, float east );
+    float distance2( float north, float east ) const;
+  };
+  vector<Box> chunk_box;
+  vector<Box> group_box;
+  // edges that can be nearest to a point in cell c, same layout
+  vector<uint32_t> near_start;
+  vector<uint32_t> near_edges;
+
+  bool contains_brute( float north, float east ) const;
+  float search_distance( float north, float east ) const;
+  void search_group( size_t group, float north, float east, float &best2 ) const;
+  float edge_distance2( uint32_t edge, float north, float east ) const;
+  float edge_box_distance2( uint32_t edge, float min_north, float min_east,
+                            float max_north, float max_east ) const;
+};
+
+
+/**
+ * Top level geofence manager: checks the aircraft position against
+ * all fences each frame and publishes the results.
+ *
+ * Example JSON configuration:
+ * "Geofence": {
+ *   "Cell_m": 50,
+ *   "Altitude": "/Sensor-Processing/Altitude_m",
+ *   "fences": [
+ *     { "name": "Range", "type": "inclusion", "floor_m": 0, "ceiling_m": 120,
+ *       "waypoints": [ {"lon": -93.1, "lat": 45.1}, ... ] },
+ *     { "name": "Tower", "type": "exclusion",
+ *       "waypoints": [ {"heading_deg": 90, "dist_m": 300}, ... ] },
+ *     { "name": "Transit", "type": "corridor", "half_width_m": 100,
+ *       "waypoints": [ {"lon": -93.1, "lat": 45.1}, ... ] }
+ *   ]
+ * }
+ * Where:
+ *   * Cell_m is the grid cell size. Optional, by default each fence
+ *     picks one from its vertex count and edge lengths.
+ *   * Altitude is the altitude compared against floors and ceilings.
+ *     Optional, defaults to /Sensor-Processing/Altitude_m.
+ *   * fences use the route waypoint format. Relative waypoints are
+ *     positioned from the first GPS fix like relative route waypoints
+ *     and the fences are not checked before then. Positioning and
+ *     indexing them runs on a builder thread started by begin(), the
+ *     flight thread keeps publishing Ready as 0 until the finished
+ *     index is handed over. A corridor is
+ *     the open polyline through its waypoints widened by half_width_m
+ *     to each side. floor_m and ceiling_m are optional.
+ *
+ * Outputs /Geofence/<name>/Margin_m and Inside for each fence, plus
+ * /Geofence/Margin_m, the smallest fence margin, /Geofence/Violation
+ * and /Geofence/Ready.
+ */
+
+class FGGeofenceMgr {
+
+public:
+
+  FGGeofenceMgr();
+  ~FGGeofenceMgr();
+
+  void init( const rapidjson::Value& Config );
+
+  /** Start the builder thread for relative fences, it calls
+   * thread_init first */
+  void begin( std::function<void()> thread_init );
+
+  void update();
+
+private:
+
+  bool initialized;
+  bool relative;
+  std::atomic<bool> built;
+  float cell_m;
+  vector<SGFence *> fences;
+
+  // relative fences are built off the flight thread from the
+  // reference requested at the first fix
+  std::thread builder;
+  std::mutex build_mutex;
+  std::condition_variable build_cond;
+  bool build_requested;
+  bool stop;
+  double ref_lat_deg, ref_lon_deg;
+
+  // local frame shared by all fences
+  Vector3d ecef0;
+  Matrix3d ecef2ned;
+
+  ElementPtr lat_rad_node;
+  ElementPtr lon_rad_node;
+  ElementPtr alt_node;
+  ElementPtr gps_fix_node;
+  ElementPtr ready_node;
+  ElementPtr violation_node;
+  ElementPtr margin_node;
+  vector<ElementPtr> fence_margin_nodes;
+  vector<ElementPtr> fence_inside_nodes;
+
+  void build( double lat_deg, double lon_deg );
+  void build_loop( std::function<void()> thread_init );
+};
@@ -28,8 +28,20 @@
 // Maybe assert valid handle, too?
 
 #include "netChannel.h"
+#include "event-loop.h"
 
-static netChannel* channels = 0 ;
+#include <vector>
+
+// all open channels share one event loop, run by whichever thread
+// calls poll()
+static EventLoop& events ()
+{
+  static EventLoop loop ;
+  return loop ;
+}
+
+static int num_open = 0 ;
+static std::vector<netChannel*> deletes ;
 
 netChannel::netChannel ()
 {
@@ -38,34 +50,43 @@ netChannel::netChannel ()
   accepting = false ;
   write_blocked = false ;
   should_delete = false ;
-
-  next_channel = channels ;
-  channels = this ;
 }
   
 netChannel::~netChannel ()
 {
   close();
+}
 
-  netChannel* prev = NULL ;
-
-  for ( netChannel* ch = channels; ch != NULL;
-                    ch = ch -> next_channel )
-  {
-    if (ch == this)
-    {
-      ch = ch -> next_channel ;
-      if ( prev != NULL )
-        prev -> next_channel = ch ;
-      else
-        channels = ch ;
-      next_channel = 0 ;
-      break;
-    }
-    prev = ch ;
+void
+netChannel::shouldDelete ()
+{
+  if ( !should_delete ) {
+    should_delete = true ;
+    deletes.push_back ( this ) ;
   }
 }
-  
+
+void
+netChannel::watch (void)
+{
+  num_open++ ;
+  events().Add ( getHandle(), 0, [this](uint32_t ev) { handleEvents(ev); } ) ;
+  updateEvents () ;
+}
+
+void
+netChannel::updateEvents (void)
+{
+  if ( closed )
+    return ;
+  uint32_t ev = EPOLLET | EPOLLRDHUP ;
+  if ( readable() )
+    ev |= EPOLLIN ;
+  if ( writable() )
+    ev |= EPOLLOUT ;
+  events().Modify ( getHandle(), ev ) ;
+}
+
 void
 netChannel::setHandle (int handle, bool is_connected)
 {
@@ -74,15 +95,17 @@ netChannel::setHandle (int handle, bool is_connected)
   connected = is_connected ;
   //if ( connected ) this->handleConnect();
   closed = false ;
+  watch () ;
 }
 
 bool
-netChannel::open (void)
+netChannel::open (bool stream)
 {
   close();
-  if (netSocket::open(true)) {
+  if (netSocket::open(stream)) {
     closed = false ;
     setBlocking ( false ) ;
+    watch () ;
     return true ;
   }
   return false ;
@@ -92,6 +115,7 @@ int
 netChannel::listen ( int backlog )
 {
   accepting = true ;
+  updateEvents () ;
   return netSocket::listen ( backlog ) ;
 }
 
@@ -102,8 +126,10 @@ netChannel::connect ( const char* host, int port )
   if (result == 0) {
     connected = true ;
     //this->handleConnect();
+    updateEvents () ;
     return 0;
   } else if (isNonBlockingError ()) {
+    updateEvents () ;
     return 0;
   } else {
     // some other error condition
@@ -167,6 +193,9 @@ netChannel::close (void)
     connected = false ;
     accepting = false ;
     write_blocked = false ;
+
+    events().Remove ( getHandle() ) ;
+    num_open-- ;
   }
 
   netSocket::close () ;
@@ -201,74 +230,33 @@ netChannel::handleWriteEvent (void)
   this->handleWrite();
 }
 
-bool
-netChannel::poll (unsigned int timeout)
+void
+netChannel::handleEvents (uint32_t ev)
 {
-  if (!channels)
-    return false ;
-  
-  enum { MAX_SOCKETS = 256 } ;
-  netSocket* reads [ MAX_SOCKETS+1 ] ;
-  netSocket* writes [ MAX_SOCKETS+1 ] ;
-  netSocket* deletes [ MAX_SOCKETS+1 ] ;
-  int nreads = 0 ;
-  int nwrites = 0 ;
-  int ndeletes = 0 ;
-  int nopen = 0 ;
-  netChannel* ch;
-  for (  ch = channels; ch != NULL; ch = ch -> next_channel )
-  {
-    if ( ch -> should_delete )
-    {
-      assert(ndeletes<MAX_SOCKETS);
-      deletes[ndeletes++] = ch ;
-    }
-    else if ( ! ch -> closed )
-    {
-      nopen++ ;
-      if (ch -> readable()) {
-        assert(nreads<MAX_SOCKETS);
-        reads[nreads++] = ch ;
-      }
-      if (ch -> writable()) {
-        assert(nwrites<MAX_SOCKETS);
-        writes[nwrites++] = ch ;
-      }
-    }
+  // errors and hangups are reported to the read handler, whose recv()
+  // picks up the error or end of file and closes the channel
+  if ( (ev & (EPOLLIN|EPOLLRDHUP|EPOLLHUP|EPOLLERR)) && readable() ) {
+    handleReadEvent();
   }
-  reads[nreads] = NULL ;
-  writes[nwrites] = NULL ;
-  deletes[ndeletes] = NULL ;
-
-  int i ;
-  for ( i=0; deletes[i]; i++ )
-  {
-    ch = (netChannel*)deletes[i];
-    delete ch ;
+  if ( !closed && (ev & EPOLLOUT) && writable() ) {
+    handleWriteEvent();
   }
+  // re-arm for whatever the handlers left pending, a descriptor that
+  // is still ready fires again on the next poll
+  updateEvents();
+}
 
-  if (!nopen)
-    return false ;
-  if (!nreads && !nwrites)
-    return true ; //hmmm- should we shutdown?
-
-  netSocket::select (reads, writes, timeout) ;
+bool
+netChannel::poll (unsigned int timeout)
+{
+  for ( size_t i = 0; i < deletes.size(); i++ )
+    delete deletes[i] ;
+  deletes.clear () ;
 
-  for ( i=0; reads[i]; i++ )
-  {
-    ch = (netChannel*)reads[i];
-    if ( ! ch -> closed ) {
-      ch -> handleReadEvent();
-    }
-  }
+  if (!num_open)
+    return false ;
 
-  for ( i=0; writes[i]; i++ )
-  {
-    ch = (netChannel*)writes[i];
-    if ( ! ch -> closed ) {
-      ch -> handleWriteEvent();
-    }
-  }
+  events().Run ( timeout ) ;
 
   return true ;
 }
@@ -30,11 +30,18 @@
 *   netSocket class.  Otherwise, it can be treated as
 *   a normal non-blocking socket object.
 *
-*   The direct interface between the netPoll() loop and
+*   The direct interface between the poll() loop and
 *   the channel object are the handleReadEvent and
 *   handleWriteEvent methods. These are called
 *   whenever a channel object 'fires' that event.
 *
+*   Open channels are registered edge triggered with a
+*   shared epoll event loop, so a poll() only visits the
+*   channels that are ready. The events a channel waits
+*   for follow readable() and writable() and are updated
+*   after each event it handles; a channel that queues
+*   output outside of its handlers calls updateEvents().
+*
 *   The firing of these low-level events can tell us whether
 *   certain higher-level events have taken place, depending on
 *   the timing and state of the connection.
@@ -52,13 +59,14 @@
 #define NET_CHANNEL_H
 
 #include "netSocket.h"
+#include <stdint.h>
 
 class netChannel : public netSocket
 {
   bool closed, connected, accepting, write_blocked, should_delete ;
-  netChannel* next_channel ;
-  
-  friend bool netPoll (unsigned int timeout);
+
+  void watch (void) ;
+  void handleEvents (uint32_t events) ;
 
 public:
 
@@ -68,13 +76,14 @@ public:
   void setHandle (int s, bool is_connected = true);
   bool isConnected () const { return connected; }
   bool isClosed () const { return closed; }
-  void shouldDelete () { should_delete = true ; }
+  void shouldDelete () ;
+  void updateEvents () ;
 
   // --------------------------------------------------
   // socket methods
   // --------------------------------------------------
   
-  bool  open    ( void ) ;
+  bool  open    ( bool stream=true ) ;
   void  close   ( void ) ;
   int   listen  ( int backlog ) ;
   int   connect ( const char* host, int port ) ;
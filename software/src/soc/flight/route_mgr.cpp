@@ -5,6 +5,7 @@
 
 #include "waypoint.hxx"
 #include "route_mgr.hxx"
+#include "wgs84.hxx"
 
 
 static const double r2d = 180.0 / M_PI;
@@ -31,7 +32,20 @@ FGRouteMgr::FGRouteMgr() :
   start_mode( FIRST_WPT ),
   completion_mode( LOOP ),
   xtrack_gain( 0.0 ),
-  dist_remaining_m( 0.0 )
+  dist_remaining_m( 0.0 ),
+  long_leg_m( 10000.0 ),
+  leg_valid( false ),
+  leg_lon0( 0.0 ),
+  leg_lat0( 0.0 ),
+  leg_lon1( 0.0 ),
+  leg_lat1( 0.0 ),
+  leg_course_deg( 0.0 ),
+  leg_length_m( 0.0 ),
+  leg_ecef0( Vector3d::Zero() ),
+  leg_ecef2ned( Matrix3d::Identity() ),
+  leg_north( 1.0 ),
+  leg_east( 0.0 ),
+  leg_plane_m( 0.0 )
 {
 }
 
@@ -51,6 +65,9 @@ void FGRouteMgr::init( const rapidjson::Value& Config ) {
   } else {
     xtrack_gain = 1.0;
   }
+  if ( Config.HasMember("LongLeg_m") ) {
+    long_leg_m = Config["LongLeg_m"].GetFloat();
+  }
   
   // input signals
   vn_node = deftree.getElement("/Sensor-Processing/NorthVelocity_ms", true);
@@ -89,9 +106,6 @@ void FGRouteMgr::update() {
     return;
   }
   
-  float direct_course, direct_distance;
-  float leg_distance;
-
   float gs_mps = sqrt(vn_node->getFloat() * vn_node->getFloat()
                       + ve_node->getFloat() * ve_node->getFloat());
   float track_deg = track_node->getFloat() * r2d;
@@ -127,21 +141,9 @@ void FGRouteMgr::update() {
     SGWayPoint prev = active->get_previous();
     SGWayPoint wp = active->get_current();
 
-    // compute direct-to course and distance
-    wp.CourseAndDistance( lon_deg, lat_deg,
-                          &direct_course, &direct_distance );
-
-    // compute leg course and distance
-    float leg_course;
-    wp.CourseAndDistance( prev, &leg_course, &leg_distance );
-
-    // difference between ideal (leg) course and direct course
-    float angle = leg_course - direct_course;
-    if ( angle < -180.0 ) {
-      angle += 360.0;
-    } else if ( angle > 180.0 ) {
-      angle -= 360.0;
-    }
+    // leg course and distance only change with the waypoints
+    update_leg( prev, wp );
+    float leg_course = leg_course_deg;
 
     // compute course error
     float course_error = leg_course - track_deg;
@@ -152,12 +154,34 @@ void FGRouteMgr::update() {
     }
     course_error_node->setFloat(course_error * d2r);
         
-    // compute cross-track error
-    float angle_rad = angle * d2r;
-    float xtrack_m = sin( angle_rad ) * direct_distance;
-    float dist_m = cos( angle_rad ) * direct_distance;
-    /* printf("direct_dist = %.1f angle = %.1f dist_m = %.1f\n",
-       direct_distance, angle, dist_m); */
+    // compute cross-track error and distance remaining on the leg
+    float xtrack_m, dist_m;
+    if ( leg_length_m <= long_leg_m ) {
+      // position in the NED frame of the leg start, along and
+      // across the leg direction
+      Vector3d ned = leg_ecef2ned * (lla2ecef( Vector3d(lat_deg * d2r, lon_deg * d2r, 0.0) ) - leg_ecef0);
+      float north = ned(0);
+      float east = ned(1);
+      xtrack_m = east * leg_north - north * leg_east;
+      dist_m = leg_plane_m - (north * leg_north + east * leg_east);
+    } else {
+      // long leg, the frame is too far off the ellipsoid so use the
+      // direct-to course and distance
+      float direct_course, direct_distance;
+      wp.CourseAndDistance( lon_deg, lat_deg,
+                            &direct_course, &direct_distance );
+      // difference between ideal (leg) course and direct course
+      float angle = leg_course - direct_course;
+      if ( angle < -180.0 ) {
+        angle += 360.0;
+      } else if ( angle > 180.0 ) {
+        angle -= 360.0;
+      }
+      float angle_rad = angle * d2r;
+      xtrack_m = sin( angle_rad ) * direct_distance;
+      dist_m = cos( angle_rad ) * direct_distance;
+    }
+    /* printf("xtrack_m = %.1f dist_m = %.1f\n", xtrack_m, dist_m); */
 
     xtrack_node->setFloat(xtrack_m);
     nav_dist_node->setFloat(dist_m);
@@ -232,6 +256,50 @@ void FGRouteMgr::update() {
 }
 
 
+// compute the geometry of the leg from prev to wp if either end point
+// moved (new target waypoint, route swap or relative waypoints being
+// positioned)
+void FGRouteMgr::update_leg( const SGWayPoint &prev, const SGWayPoint &wp ) {
+  if ( leg_valid
+       && prev.get_target_lon() == leg_lon0
+       && prev.get_target_lat() == leg_lat0
+       && wp.get_target_lon() == leg_lon1
+       && wp.get_target_lat() == leg_lat1 ) {
+    return;
+  }
+  leg_lon0 = prev.get_target_lon();
+  leg_lat0 = prev.get_target_lat();
+  leg_lon1 = wp.get_target_lon();
+  leg_lat1 = wp.get_target_lat();
+
+  // ellipsoidal course and length of the leg
+  float reverse = 0.0;
+  geo_inverse_wgs_84( leg_lat0, leg_lon0, leg_lat1, leg_lon1,
+                      &leg_course_deg, &reverse, &leg_length_m );
+
+  // local NED frame anchored at the leg start, the rotation is the
+  // one ecef2ned() computes
+  double lat0 = leg_lat0 * d2r, lon0 = leg_lon0 * d2r;
+  leg_ecef0 = lla2ecef( Vector3d(lat0, lon0, 0.0) );
+  leg_ecef2ned << -sin(lat0)*cos(lon0), -sin(lat0)*sin(lon0), cos(lat0),
+                  -sin(lon0), cos(lon0), 0.0,
+                  -cos(lat0)*cos(lon0), -cos(lat0)*sin(lon0), -sin(lat0);
+  Vector3d ned = leg_ecef2ned * (lla2ecef( Vector3d(leg_lat1 * d2r, leg_lon1 * d2r, 0.0) ) - leg_ecef0);
+  float north = ned(0);
+  float east = ned(1);
+  leg_plane_m = sqrt( north * north + east * east );
+  if ( leg_plane_m > 0.0 ) {
+    leg_north = north / leg_plane_m;
+    leg_east = east / leg_plane_m;
+  } else {
+    // degenerate leg, fall back on the ellipsoidal course
+    leg_east = sin( leg_course_deg * d2r );
+    leg_north = cos( leg_course_deg * d2r );
+  }
+  leg_valid = true;
+}
+
+
 bool FGRouteMgr::swap() {
   if ( !standby->size() ) {
     // standby route is empty
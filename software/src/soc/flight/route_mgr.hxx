@@ -30,6 +30,7 @@ using std::vector;
 #include "rapidjson/document.h"
 
 #include "definition-tree2.h"
+#include "nav_functions_float.hxx"
 #include "route.hxx"
 
 
@@ -72,6 +73,23 @@ private:
   // stats
   float dist_remaining_m;
 
+  // geometry of the active leg, computed once when its end points
+  // change.  The aircraft is projected into the local NED frame
+  // anchored at the start of the leg, legs longer than long_leg_m
+  // use the ellipsoidal solution every frame instead.
+  float long_leg_m;
+  bool leg_valid;
+  double leg_lon0, leg_lat0;
+  double leg_lon1, leg_lat1;
+  float leg_course_deg;
+  float leg_length_m;
+  Vector3d leg_ecef0;		// leg start
+  Matrix3d leg_ecef2ned;	// rotation into the leg start NED frame
+  float leg_north, leg_east;	// unit direction of the leg
+  float leg_plane_m;		// leg length in the local frame
+
+  void update_leg( const SGWayPoint &prev, const SGWayPoint &wp );
+
   SGWayPoint make_waypoint( const string& wpt_string );
 
   // build a route from a property (sub) tree
@@ -0,0 +1,438 @@
+// \file signal_server.cpp
+// binary signal subscription server class.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU LGPL
+//
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+
+#include "checksum.h"
+#include "strutils.hxx"
+#include "netChat.h"
+#include "signal_server.hxx"
+
+
+/**
+ * TCP subscriber connection.
+ */
+class SignalChannel : public netChat
+{
+  netBuffer buffer;
+  UGSignalServer *server;
+  UGSignalServer::Subscription sub;
+  vector<uint8_t> reply;
+
+public:
+
+  SignalChannel( UGSignalServer *server_ptr );
+
+  void collectIncomingData( const char* s, int n );
+  void foundTerminator();
+  void handleClose();
+};
+
+/**
+ * UDP subscribers, one subscription per sender address.
+ */
+class SignalDatagrams : public netChannel
+{
+  UGSignalServer *server;
+  vector<std::unique_ptr<UGSignalServer::Subscription>> subs;
+  vector<uint8_t> reply;
+
+public:
+
+  SignalDatagrams( UGSignalServer *server_ptr, size_t max_subscribers, uint64_t lease_us );
+
+  bool readable() { return !isClosed(); }
+  bool writable() { return false; }
+  void handleRead();
+  void handleClose() {}
+
+  /** Drop subscriptions not renewed within their lease */
+  void expire( uint64_t now_us );
+
+private:
+
+  size_t max_subs;
+  uint64_t lease;
+};
+
+/**
+ * Wakes the server thread when the flight loop publishes a frame.
+ */
+class SignalNotifier : public netChannel
+{
+  UGSignalServer *server;
+
+public:
+
+  SignalNotifier( UGSignalServer *server_ptr ) : server(server_ptr) {}
+
+  bool writable() { return false; }
+  void handleRead();
+  void handleClose() {}
+};
+
+
+SignalChannel::SignalChannel( UGSignalServer *server_ptr )
+  : buffer(4096),
+    server(server_ptr)
+{
+  sub.channel = this;
+  setTerminator( "\n" );
+}
+
+void
+SignalChannel::collectIncomingData( const char* s, int n )
+{
+  buffer.append( s, n );
+}
+
+void
+SignalChannel::foundTerminator()
+{
+  server->remove( &sub );
+  if ( server->request( buffer.getData(), &sub, &reply ) ) {
+    server->add( &sub );
+  }
+  bufferSend( (const char *)reply.data(), reply.size() );
+  buffer.remove();
+}
+
+void
+SignalChannel::handleClose()
+{
+  server->remove( &sub );
+  netChat::handleClose();
+  shouldDelete();
+}
+
+
+// steady clock time, used for UDP subscription leases
+static uint64_t now_us()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+
+SignalDatagrams::SignalDatagrams( UGSignalServer *server_ptr, size_t max_subscribers, uint64_t lease_us )
+  : server(server_ptr),
+    max_subs(max_subscribers),
+    lease(lease_us)
+{
+}
+
+void
+SignalDatagrams::expire( uint64_t now_us )
+{
+  for ( size_t i = 0; i < subs.size(); ) {
+    if ( subs[i]->expires_us <= now_us ) {
+      server->remove( subs[i].get() );
+      subs.erase( subs.begin() + i );
+    } else {
+      i++;
+    }
+  }
+}
+
+void
+SignalDatagrams::handleRead()
+{
+  char line[4096];
+  netAddress from;
+  int len;
+  // edge triggered, drain the socket
+  while ( (len = recvfrom( line, sizeof(line) - 1, 0, &from )) > 0 ) {
+    line[len] = 0;
+    uint64_t now = now_us();
+    // free the slots of clients that stopped renewing
+    expire( now );
+    size_t i = 0;
+    while ( i < subs.size() && (subs[i]->address.getIP() != from.getIP() ||
+                                subs[i]->address.getPort() != from.getPort()) ) {
+      i++;
+    }
+    if ( i == subs.size() ) {
+      if ( subs.size() >= max_subs ) {
+        const char *msg = "too many subscribers";
+        vector<uint8_t> text( msg, msg + strlen(msg) );
+        UGSignalServer::encode( UGSignalServer::kError, text, &reply );
+        sendto( reply.data(), reply.size(), 0, &from );
+        continue;
+      }
+      subs.push_back( std::unique_ptr<UGSignalServer::Subscription>(new UGSignalServer::Subscription) );
+      subs[i]->address = from;
+    }
+    server->remove( subs[i].get() );
+    bool subscribed = server->request( line, subs[i].get(), &reply );
+    sendto( reply.data(), reply.size(), 0, &from );
+    if ( subscribed ) {
+      subs[i]->expires_us = now + lease;
+      server->add( subs[i].get() );
+    } else {
+      subs.erase( subs.begin() + i );
+    }
+  }
+}
+
+
+void
+SignalNotifier::handleRead()
+{
+  uint64_t count;
+  if ( ::read( getHandle(), &count, sizeof(count) ) == sizeof(count) ) {
+    server->update();
+  }
+}
+
+
+UGSignalServer::UGSignalServer( const int port_num, DefinitionTreeSnapshot *snapshot_ptr,
+                                const double lease_sec ):
+  port(port_num),
+  enabled(false),
+  lease_us((uint64_t)(lease_sec * 1e6)),
+  snapshot(snapshot_ptr),
+  time_index(-1),
+  last_frame(0),
+  last_time_us(0),
+  frame_us(0),
+  num_subscriptions(0)
+{
+}
+
+UGSignalServer::~UGSignalServer()
+{
+}
+
+bool
+UGSignalServer::open()
+{
+  if ( enabled ) {
+    printf("The signal server is already running, ignoring\n" );
+    return false;
+  }
+
+  netChannel::open();
+  netChannel::bind( "", port );
+  netChannel::listen( 5 );
+
+  datagrams.reset( new SignalDatagrams( this, kMaxDatagramSubscribers, lease_us ) );
+  datagrams->open( false );
+  datagrams->bind( "", port );
+
+  int fd = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+  if ( fd < 0 ) {
+    printf("Signal server unable to create its notification event\n" );
+    return false;
+  }
+  notifier.reset( new SignalNotifier( this ) );
+  notifier->setHandle( fd );
+
+  time_index = snapshot->Index( "/Sensors/Fmu/Time_us" );
+  printf("Signal server started on port %d\n", port );
+
+  enabled = true;
+
+  return true;
+}
+
+void
+UGSignalServer::notify()
+{
+  if ( num_subscriptions.load( std::memory_order_relaxed ) > 0 ) {
+    uint64_t one = 1;
+    if ( ::write( notifier->getHandle(), &one, sizeof(one) ) < 0 ) {
+      // the counter saturating is harmless, the server is awake
+    }
+  }
+}
+
+bool
+UGSignalServer::request( const string& line, Subscription *sub, vector<uint8_t> *reply )
+{
+  vector<string> tokens = split( line );
+  string error;
+
+  if ( !tokens.empty() && tokens[0] == "subscribe" && tokens.size() >= 3 ) {
+    double rate_hz = atof( tokens[1].c_str() );
+    if ( tokens.size() - 2 > kMaxSignals ) {
+      error = "too many signals";
+    } else {
+      snapshot->Update();
+      sub->signals.clear();
+      payload.clear();
+      uint16_t count = tokens.size() - 2;
+      payload.insert( payload.end(), (uint8_t *)&count, (uint8_t *)&count + sizeof(count) );
+      for ( size_t i = 2; i < tokens.size(); i++ ) {
+        int index = snapshot->Index( tokens[i] );
+        sub->signals.push_back( index );
+        if ( index >= 0 ) {
+          payload.push_back( snapshot->getElement( (size_t)index )->getTag() );
+        } else {
+          payload.push_back( Element::NONE );
+        }
+      }
+      sub->period_us = ( rate_hz > 0 ) ? (uint64_t)(1e6 / rate_hz) : 0;
+      sub->next_us = 0;
+      encode( kAck, payload, reply );
+      return true;
+    }
+  } else if ( !tokens.empty() && tokens[0] == "unsubscribe" ) {
+    sub->signals.clear();
+    encode( kAck, vector<uint8_t>( 2, 0 ), reply );
+    return false;
+  } else {
+    error = "usage: subscribe <rate_hz> <path> [<path> ...] | unsubscribe";
+  }
+
+  encode( kError, vector<uint8_t>( error.begin(), error.end() ), reply );
+  return false;
+}
+
+void
+UGSignalServer::add( Subscription *sub )
+{
+  if ( std::find( subscriptions.begin(), subscriptions.end(), sub ) == subscriptions.end() ) {
+    subscriptions.push_back( sub );
+    num_subscriptions.store( subscriptions.size(), std::memory_order_relaxed );
+  }
+}
+
+void
+UGSignalServer::remove( Subscription *sub )
+{
+  vector<Subscription *>::iterator it;
+  it = std::find( subscriptions.begin(), subscriptions.end(), sub );
+  if ( it != subscriptions.end() ) {
+    subscriptions.erase( it );
+    num_subscriptions.store( subscriptions.size(), std::memory_order_relaxed );
+  }
+}
+
+void
+UGSignalServer::update()
+{
+  snapshot->Update();
+  uint64_t frame_num = snapshot->Frame();
+  if ( frame_num == last_frame ) {
+    return;
+  }
+  last_frame = frame_num;
+
+  // stop sending to UDP clients that went away without unsubscribing
+  uint64_t now = now_us();
+  datagrams->expire( now );
+
+  uint64_t time_us;
+  if ( time_index >= 0 ) {
+    time_us = snapshot->getElement( (size_t)time_index )->getLong();
+  } else {
+    time_us = now;
+  }
+  if ( time_us > last_time_us && last_time_us > 0 ) {
+    frame_us = time_us - last_time_us;
+  }
+  last_time_us = time_us;
+
+  for ( size_t i = 0; i < subscriptions.size(); i++ ) {
+    Subscription *sub = subscriptions[i];
+    // decimate to the requested rate, allowing half a frame of
+    // jitter so a rate that divides the frame rate is met exactly
+    if ( time_us + frame_us / 2 < sub->next_us ) {
+      continue;
+    }
+    sub->next_us += sub->period_us;
+    if ( sub->next_us + frame_us / 2 <= time_us ) {
+      sub->next_us = time_us + sub->period_us;
+    }
+
+    payload.clear();
+    payload.insert( payload.end(), (uint8_t *)&frame_num, (uint8_t *)&frame_num + sizeof(frame_num) );
+    payload.insert( payload.end(), (uint8_t *)&time_us, (uint8_t *)&time_us + sizeof(time_us) );
+    for ( size_t j = 0; j < sub->signals.size(); j++ ) {
+      if ( sub->signals[j] < 0 ) {
+        payload.push_back( Element::NONE );
+        continue;
+      }
+      Element *ele = snapshot->getElement( (size_t)sub->signals[j] );
+      Element::Type tag = ele->getTag();
+      payload.push_back( tag );
+      switch ( tag ) {
+      case Element::BOOL: {
+        payload.push_back( ele->getBool() );
+        break;
+      }
+      case Element::INT: {
+        int32_t val = ele->getInt();
+        payload.insert( payload.end(), (uint8_t *)&val, (uint8_t *)&val + sizeof(val) );
+        break;
+      }
+      case Element::LONGLONG: {
+        int64_t val = ele->getLong();
+        payload.insert( payload.end(), (uint8_t *)&val, (uint8_t *)&val + sizeof(val) );
+        break;
+      }
+      case Element::FLOAT: {
+        float val = ele->getFloat();
+        payload.insert( payload.end(), (uint8_t *)&val, (uint8_t *)&val + sizeof(val) );
+        break;
+      }
+      case Element::DOUBLE: {
+        double val = ele->getDouble();
+        payload.insert( payload.end(), (uint8_t *)&val, (uint8_t *)&val + sizeof(val) );
+        break;
+      }
+      default:
+        break;
+      }
+    }
+    encode( kUpdate, payload, &frame );
+    send( sub, frame );
+  }
+}
+
+void
+UGSignalServer::send( Subscription *sub, const vector<uint8_t> &data )
+{
+  if ( sub->channel != NULL ) {
+    // a client that falls behind loses frames rather than growing
+    // the output buffer
+    sub->channel->bufferSend( (const char *)data.data(), data.size() );
+    sub->channel->updateEvents();
+  } else {
+    datagrams->sendto( data.data(), data.size(), 0, &sub->address );
+  }
+}
+
+void
+UGSignalServer::encode( FrameType type, const vector<uint8_t> &payload, vector<uint8_t> *frame )
+{
+  uint16_t len = payload.size();
+  frame->resize( kHeaderSize + len + 2 );
+  (*frame)[0] = 'B';
+  (*frame)[1] = 'S';
+  (*frame)[2] = type;
+  memcpy( frame->data() + 3, &len, sizeof(len) );
+  memcpy( frame->data() + kHeaderSize, payload.data(), len );
+  uint16_t sum = fletcher16( frame->data() + 2, kHeaderSize - 2 + len );
+  memcpy( frame->data() + kHeaderSize + len, &sum, sizeof(sum) );
+}
+
+void
+UGSignalServer::handleAccept()
+{
+  netAddress addr;
+  int handle = netChannel::accept( &addr );
+  printf("Signal server accepted connection from %s:%d\n",
+         addr.getHost(), addr.getPort() );
+  SignalChannel* channel = new SignalChannel( this );
+  channel->setHandle( handle );
+}
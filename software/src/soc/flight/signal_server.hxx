@@ -0,0 +1,160 @@
+// \file signal_server.hxx
+// binary signal subscription server class.
+//
+// Serves the same snapshot of the definition tree as the telnet
+// property server, but pushes values instead of answering requests.
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU LGPL
+//
+
+#ifndef _AURA_SIGNAL_SERVER_HXX
+#define _AURA_SIGNAL_SERVER_HXX
+
+
+#include "netChannel.h"
+#include "definition-tree-snapshot.h"
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+class SignalChannel;
+class SignalDatagrams;
+class SignalNotifier;
+
+/**
+ * Signal subscription server class.
+ *
+ * A client subscribes to a list of signals with a one line text
+ * request, sent over a TCP connection to the server port or as a UDP
+ * datagram to the same port number:
+ *
+ *   subscribe <rate_hz> <path> [<path> ...]
+ *   unsubscribe
+ *
+ * A new subscription replaces the previous one of the client, a rate
+ * of 0 sends every frame. The server replies with an ack frame and
+ * from then on pushes an update frame whenever the subscription falls
+ * due, to the TCP connection or to the address the datagram came
+ * from. A UDP subscription lasts lease_sec seconds (10 by default),
+ * a client keeps it by sending its subscribe line again before then,
+ * otherwise it is dropped and its slot freed. Frames are little endian:
+ *
+ *   'B' 'S' type(u8) length(u16) payload checksum(u16, fletcher16)
+ *
+ *   kAck:    count(u16) type(u8) * count, kNone for unknown signals
+ *   kUpdate: frame(u64) time_us(u64) [type(u8) value] * count
+ *   kError:  message text
+ *
+ * Values take 1 (bool), 4 (int, float), 8 (long, double) or 0 (none)
+ * bytes following their Element::Type code.
+ */
+class UGSignalServer: netChannel
+{
+
+public:
+
+  enum FrameType {
+    kAck = 1,
+    kUpdate = 2,
+    kError = 3
+  };
+
+  /**
+   * Signals and rate requested by a client.
+   */
+  struct Subscription {
+    vector<int> signals;
+    uint64_t period_us = 0;
+    uint64_t next_us = 0;
+    uint64_t expires_us = 0;
+    SignalChannel *channel = NULL;
+    netAddress address;
+  };
+
+  /**
+   * Create a new subscription server.
+   *
+   * @param port_num Server port, used for both TCP and UDP
+   * @param snapshot_ptr Signals served to clients
+   * @param lease_sec How long a UDP subscription lasts without being renewed
+   */
+  UGSignalServer( const int port_num, DefinitionTreeSnapshot *snapshot_ptr,
+                  const double lease_sec = 10.0 );
+
+  /**
+   * Destructor.
+   */
+  ~UGSignalServer();
+
+  /**
+   * Start the server, served by netChannel::poll() on the telnet thread.
+   */
+  bool open();
+
+  /**
+   * Called by the flight loop after publishing the snapshot, wakes
+   * the server if anyone is subscribed. Safe to call from another
+   * thread than the one running the server.
+   */
+  void notify();
+
+  /**
+   * Send the due subscriptions the newest published frame.
+   */
+  void update();
+
+  /**
+   * Handle a request line from a client, sub holds the client's
+   * subscription and reply receives the frame to send back. Returns
+   * true if the client is subscribed afterwards.
+   */
+  bool request( const string& line, Subscription *sub, vector<uint8_t> *reply );
+
+  /**
+   * Add and remove subscriptions served by update().
+   */
+  void add( Subscription *sub );
+  void remove( Subscription *sub );
+
+  /**
+   * Wrap payload into a frame of the given type.
+   */
+  static void encode( FrameType type, const vector<uint8_t> &payload, vector<uint8_t> *frame );
+
+  /**
+   * Accept a new client connection.
+   */
+  void handleAccept();
+
+private:
+
+  static const size_t kHeaderSize = 5;
+  static const size_t kMaxSignals = 256;
+  static const size_t kMaxDatagramSubscribers = 16;
+
+  int port;
+  bool enabled;
+  uint64_t lease_us;
+  DefinitionTreeSnapshot *snapshot;
+  int time_index;
+  uint64_t last_frame;
+  uint64_t last_time_us;
+  uint64_t frame_us;
+  vector<Subscription *> subscriptions;
+  std::atomic<int> num_subscriptions;
+  std::unique_ptr<SignalDatagrams> datagrams;
+  std::unique_ptr<SignalNotifier> notifier;
+  vector<uint8_t> payload;
+  vector<uint8_t> frame;
+
+  void send( Subscription *sub, const vector<uint8_t> &data );
+};
+
+#endif // _AURA_SIGNAL_SERVER_HXX
@@ -66,6 +66,11 @@ class PropsChannel : public netChat
    */
   string path;
 
+  /**
+   * Signals served to the client.
+   */
+  DefinitionTreeSnapshot *snapshot;
+
   enum Mode {
     PROMPT,
     DATA
@@ -77,7 +82,7 @@ public:
   /**
    * Constructor.
    */
-  PropsChannel();
+  PropsChannel( DefinitionTreeSnapshot *snapshot_ptr );
     
   /**
    * Append incoming data to our request buffer.
@@ -102,9 +107,10 @@ private:
 /**
  * 
  */
-PropsChannel::PropsChannel()
+PropsChannel::PropsChannel( DefinitionTreeSnapshot *snapshot_ptr )
   : buffer(512),
     path("/"),
+    snapshot(snapshot_ptr),
     mode(PROMPT)
 {
   // setTerminator( "\r\n" );
@@ -144,6 +150,9 @@ PropsChannel::foundTerminator()
   const char* cmd = buffer.getData();
   vector<string> tokens = split( cmd );
 
+  // serve the newest frame published by the flight loop
+  snapshot->Update();
+
   if ( debug_on ) {
     printf( "processing command: " );
     for ( size_t i = 0; i < tokens.size(); i++ ) {
@@ -174,7 +183,7 @@ PropsChannel::foundTerminator()
         string line = "path: " + dir + getTerminator();
         push( line.c_str() );
         vector<string> children;
-        deftree.GetKeys(dir, &children);
+        snapshot->GetKeys(dir, &children);
         string last_child = "";
         for ( unsigned int i = 0; i < children.size(); i++ ) {
           string tail = "";
@@ -196,7 +205,7 @@ PropsChannel::foundTerminator()
           }
           string line = "";
           if ( is_leaf ) {
-            ElementPtr ele = deftree.getElement(children[i]);
+            Element *ele = snapshot->getElement(children[i]);
             string type = ele->getType();
             string value = ele->getValueAsString();
             if ( mode == PROMPT ) {
@@ -242,8 +251,8 @@ PropsChannel::foundTerminator()
         printf("newpath before = %s\n", newpath.c_str());
         // validate path
         vector<string> tmp_children;
-        deftree.GetKeys(newpath, &tmp_children);
-        ElementPtr tmp_ele = deftree.getElement(newpath, false);
+        snapshot->GetKeys(newpath, &tmp_children);
+        Element *tmp_ele = snapshot->getElement(newpath);
         if ( tmp_children.size() > 0 && tmp_ele == NULL ) {
           // path matches stuff, but not an element
           printf("path ok = %s\n", newpath.c_str());
@@ -271,17 +280,21 @@ PropsChannel::foundTerminator()
         }
                 
         string tmp;
-        ElementPtr ele = deftree.getElement(newpath);
-        string type = ele->getType();
-        string value = ele->getValueAsString();
-        if ( mode == PROMPT ) {
-          tmp = tokens[1];
-          tmp += "(" + type + ") = " + value;
+        Element *ele = snapshot->getElement(newpath);
+        if ( ele != NULL ) {
+          string type = ele->getType();
+          string value = ele->getValueAsString();
+          if ( mode == PROMPT ) {
+            tmp = tokens[1];
+            tmp += "(" + type + ") = " + value;
+          } else {
+            tmp = value;
+          }
+          push( tmp.c_str() );
+          push( getTerminator() );
         } else {
-          tmp = value;
+          node_not_found_error( tokens[1] );
         }
-        push( tmp.c_str() );
-        push( getTerminator() );
       }
     } else if ( command == "set" ) {
       // an adventure for a later time ...
@@ -316,8 +329,9 @@ pwd                display your current path\r\n\
 /**
  * 
  */
-UGTelnet::UGTelnet( const int port_num ):
-  enabled(false)
+UGTelnet::UGTelnet( const int port_num, DefinitionTreeSnapshot *snapshot_ptr ):
+  enabled(false),
+  snapshot(snapshot_ptr)
 {
   port = port_num;
 }
@@ -367,9 +381,9 @@ UGTelnet::close()
  * 
  */
 bool
-UGTelnet::process()
+UGTelnet::process( unsigned int timeout )
 {
-  netChannel::poll();
+  netChannel::poll( timeout );
   return true;
 }
 
@@ -383,6 +397,6 @@ UGTelnet::handleAccept()
   int handle = netChannel::accept( &addr );
   printf("Telnet server accepted connection from %s:%d\n",
          addr.getHost(), addr.getPort() );
-  PropsChannel* channel = new PropsChannel();
+  PropsChannel* channel = new PropsChannel( snapshot );
   channel->setHandle( handle );
 }
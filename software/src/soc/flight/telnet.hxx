@@ -16,6 +16,7 @@
 
 
 #include "netChannel.h"
+#include "definition-tree-snapshot.h"
 
 
 /**
@@ -34,14 +35,20 @@ private:
   int port;
   bool enabled;
 
+  /**
+   * Signals served to clients, published by the flight loop.
+   */
+  DefinitionTreeSnapshot *snapshot;
+
 public:
 
   /**
    * Create a new TCP server.
    * 
-   * @param tokens Tokenized configuration parameters
+   * @param port_num Server port
+   * @param snapshot_ptr Signals served to clients
    */
-  UGTelnet( const int port_num );
+  UGTelnet( const int port_num, DefinitionTreeSnapshot *snapshot_ptr );
 
   /**
    * Destructor.
@@ -54,9 +61,9 @@ public:
   bool open();
 
   /**
-   * Process network activity.
+   * Process network activity, waiting up to timeout ms for it.
    */
-  bool process();
+  bool process( unsigned int timeout = 0 );
 
   /**
    * 
@@ -22,13 +22,32 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SO
 #include <iostream>
 #include <iomanip>
 #include <stdint.h>
+#include <stdlib.h>
 
 int main(int argc, char* argv[]) {
   std::cout << "Bolder Flight Systems" << std::endl;
   std::cout << "Datalog Server Version 1.0.0 " << std::endl << std::endl;
 
+  /* compress the log with --compress, segment size in MB and segment time in seconds */
+  bool Compress = false;
+  size_t SegmentSize = DatalogServer::kDefaultSegmentSize;
+  uint32_t SegmentTime_s = 0;
+  for (int i=1; i < argc; i++) {
+    std::string Arg(argv[i]);
+    if (Arg == "--compress") {
+      Compress = true;
+    } else if ((Arg == "--segment-size")&&(i+1 < argc)&&(atoi(argv[i+1]) > 0)) {
+      SegmentSize = (size_t)atoi(argv[++i])*1024*1024;
+    } else if ((Arg == "--segment-time")&&(i+1 < argc)&&(atoi(argv[i+1]) >= 0)) {
+      SegmentTime_s = atoi(argv[++i]);
+    } else {
+      std::cerr << "Usage: datalog-server [--compress] [--segment-size MB] [--segment-time s]" << std::endl;
+      return -1;
+    }
+  }
+
   /* declare classes */
-  DatalogServer Datalog;
+  DatalogServer Datalog(Compress,SegmentSize,SegmentTime_s);
 
   while(1) {
     Datalog.ReceiveBinary();
@@ -0,0 +1,106 @@
+/*
+bench-airdata.cpp
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+Times Run of the air data functions (IndicatedAirspeed and AglAltitude with four
+sources, PitotStatic and FiveHole) and checks their outputs against the AirData
+formulas evaluated directly on the same pressures.
+*/
+
+#include "test.h"
+#include "airdata-functions.h"
+#include <chrono>
+#include <cmath>
+
+/* Configures a function from a JSON string under /Sensor-Processing/Test */
+static void Configure(GenericFunction *Function,const char *Json) {
+  rapidjson::Document Config;
+  Config.Parse(Json);
+  Function->Configure(Config,"/Sensor-Processing/Test");
+  // no initialization time, so the biases stay zero
+  Function->Initialize();
+  CHECK(Function->Initialized());
+}
+
+/* Returns the mean time of Runs calls of Run in kEngage, in nanoseconds, varying the pressures each call */
+static double TimeRun(GenericFunction *Function,std::vector<ElementPtr> &Pressures,size_t Runs) {
+  auto Start = std::chrono::steady_clock::now();
+  for (size_t i=0; i < Runs; i++) {
+    for (size_t j=0; j < Pressures.size(); j++) {
+      Pressures[j]->setFloat(Pressures[j]->getFloat() + ((i & 1) ? 1.0f : -1.0f));
+    }
+    Function->Run(GenericFunction::kEngage);
+  }
+  return std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now() - Start).count()/Runs;
+}
+
+/* True if A and B agree to a relative tolerance */
+static bool Near(float A,float B) {
+  return fabsf(A - B) <= 1.0e-5f*std::max(1.0f,fabsf(B));
+}
+
+int main() {
+  const char *Names[] = {"Pitot1","Pitot2","Pitot3","Pitot4","Static1","Static2","Static3","Static4","Tip","Alpha1","Alpha2","Beta1","Beta2"};
+  const float Values[] = {250.0f,252.0f,248.0f,251.0f,98000.0f,98010.0f,97990.0f,98005.0f,300.0f,40.0f,-20.0f,10.0f,-5.0f};
+  std::vector<ElementPtr> Pressures;
+  for (size_t i=0; i < 13; i++) {
+    Pressures.push_back(deftree.initElement(std::string("/Sensors/")+Names[i],"Test pressure, Pa",LOG_FLOAT,LOG_NONE));
+    Pressures.back()->setFloat(Values[i]);
+  }
+  std::vector<ElementPtr> Differential(Pressures.begin(),Pressures.begin()+4);
+  std::vector<ElementPtr> Static(Pressures.begin()+4,Pressures.begin()+8);
+  std::vector<ElementPtr> PitotStaticPorts = {Pressures[0],Pressures[4]};
+  std::vector<ElementPtr> FiveHolePorts = {Pressures[4],Pressures[8],Pressures[9],Pressures[10],Pressures[11],Pressures[12]};
+
+  IndicatedAirspeed Ias;
+  AglAltitude Agl;
+  PitotStatic Pitot;
+  FiveHole Probe;
+  Configure(&Ias,"{\"Output\":\"Ias\",\"Initialization-Time\":0,"
+    "\"Differential-Pressure\":[\"/Sensors/Pitot1\",\"/Sensors/Pitot2\",\"/Sensors/Pitot3\",\"/Sensors/Pitot4\"]}");
+  Configure(&Agl,"{\"Output\":\"Agl\",\"Initialization-Time\":0,"
+    "\"Static-Pressure\":[\"/Sensors/Static1\",\"/Sensors/Static2\",\"/Sensors/Static3\",\"/Sensors/Static4\"]}");
+  Configure(&Pitot,"{\"Output\":\"Pitot\",\"OutputIas\":\"Ias\",\"OutputAltitude\":\"Agl\",\"Initialization-Time\":0,"
+    "\"Differential-Pressure\":\"/Sensors/Pitot1\",\"Static-Pressure\":\"/Sensors/Static1\"}");
+  Configure(&Probe,"{\"Output\":\"FiveHole\",\"OutputIas\":\"Ias\",\"OutputAltitude\":\"Agl\",\"OutputAlpha\":\"Alpha\",\"OutputBeta\":\"Beta\","
+    "\"Tip-Pressure\":\"/Sensors/Tip\",\"Static-Pressure\":\"/Sensors/Static1\",\"Alpha1-Pressure\":\"/Sensors/Alpha1\","
+    "\"Alpha2-Pressure\":\"/Sensors/Alpha2\",\"Beta1-Pressure\":\"/Sensors/Beta1\",\"Beta2-Pressure\":\"/Sensors/Beta2\","
+    "\"Alpha-Calibration\":0.08,\"Beta-Calibration\":0.08,\"Initialization-Time\":0}");
+
+  // outputs against the formulas, on the initial pressures
+  AirData Reference;
+  Ias.Run(GenericFunction::kEngage);
+  Agl.Run(GenericFunction::kEngage);
+  Probe.Run(GenericFunction::kEngage);
+  float MeanDifferential = (Values[0] + Values[1] + Values[2] + Values[3])/4.0f;
+  CHECK(Near(deftree.getElement("/Sensor-Processing/Test/Ias/Ias")->getFloat(),Reference.getIAS(MeanDifferential)));
+  CHECK(Near(deftree.getElement("/Sensor-Processing/Test/FiveHole/Ias")->getFloat(),Reference.getIAS(Values[8])));
+  float Alpha = Reference.getAngle(Values[8],Values[9],Values[10],Values[11],Values[12],0.08f);
+  float Beta = Reference.getAngle(Values[8],Values[11],Values[12],Values[9],Values[10],0.08f);
+  CHECK(Near(deftree.getElement("/Sensor-Processing/Test/FiveHole/Alpha")->getFloat(),std::max(-0.7854f,std::min(0.7854f,Alpha))));
+  CHECK(Near(deftree.getElement("/Sensor-Processing/Test/FiveHole/Beta")->getFloat(),std::max(-0.7854f,std::min(0.7854f,Beta))));
+  CHECK(std::isfinite(deftree.getElement("/Sensor-Processing/Test/Agl/Agl")->getFloat()));
+
+  const size_t Runs = 2000000;
+  std::cout << "airdata: IndicatedAirspeed (4 sources) " << TimeRun(&Ias,Differential,Runs) << " ns, AglAltitude (4 sources) "
+    << TimeRun(&Agl,Static,Runs) << " ns, PitotStatic " << TimeRun(&Pitot,PitotStaticPorts,Runs) << " ns, FiveHole "
+    << TimeRun(&Probe,FiveHolePorts,Runs) << " ns per Run" << std::endl;
+  return TestResult();
+}
@@ -0,0 +1,122 @@
+/*
+bench-bf-frame.cpp
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+Reports the throughput of the BF frame checksum against the byte loop, of
+encoding frames, and of parsing a stream of frames byte by byte and in runs,
+for payload sizes from a node message to a datalog block.
+*/
+
+#include "test.h"
+#include "bf_frame.h"
+#include <chrono>
+#include <random>
+#include <vector>
+
+/* The checksum as defined, one byte at a time */
+static void ByteLoopChecksum(const uint8_t *Data,size_t Size,uint8_t *Checksum) {
+  uint8_t Sum0 = 0, Sum1 = 0;
+  for (size_t i=0; i < Size; i++) {
+    Sum0 += Data[i];
+    Sum1 += Sum0;
+  }
+  Checksum[0] = Sum0;
+  Checksum[1] = Sum1;
+}
+
+/* Returns MB/s given the bytes processed since Start */
+static double Throughput(size_t Bytes,std::chrono::steady_clock::time_point Start) {
+  return Bytes/std::chrono::duration<double,std::micro>(std::chrono::steady_clock::now() - Start).count();
+}
+
+int main() {
+  std::mt19937 Random(42);
+  const size_t Bytes = 64*1024*1024;
+  const size_t PayloadSizes[] = {16,32,64,256,4096,60000};
+  std::vector<uint8_t> Payload(60000);
+  for (size_t i=0; i < Payload.size(); i++) {
+    Payload[i] = Random() & 0xff;
+  }
+  for (size_t k=0; k < sizeof(PayloadSizes)/sizeof(PayloadSizes[0]); k++) {
+    const size_t PayloadSize = PayloadSizes[k];
+    const size_t Count = Bytes/BfFrame::Size(PayloadSize);
+    std::vector<uint8_t> Frame(BfFrame::Size(PayloadSize));
+    // checksum, the optimizer must not drop the results
+    uint8_t Checksum[2];
+    uint32_t Sink = 0;
+    auto Start = std::chrono::steady_clock::now();
+    for (size_t i=0; i < Count; i++) {
+      Payload[0] = i;
+      BfFrame::Checksum(Payload.data(),PayloadSize,Checksum);
+      Sink += Checksum[1];
+    }
+    double Vector = Throughput(Count*PayloadSize,Start);
+    Start = std::chrono::steady_clock::now();
+    for (size_t i=0; i < Count; i++) {
+      Payload[0] = i;
+      ByteLoopChecksum(Payload.data(),PayloadSize,Checksum);
+      Sink -= Checksum[1];
+    }
+    double Loop = Throughput(Count*PayloadSize,Start);
+    CHECK(Sink == 0);
+    // encode
+    Start = std::chrono::steady_clock::now();
+    for (size_t i=0; i < Count; i++) {
+      Payload[0] = i;
+      BfFrame::Encode(1,Payload.data(),PayloadSize,Frame.data(),Frame.size());
+    }
+    double Encode = Throughput(Count*Frame.size(),Start);
+    // a stream of frames, parsed byte by byte and in 1 KiB reads
+    std::vector<uint8_t> Stream;
+    while (Stream.size() < 4*1024*1024) {
+      Stream.insert(Stream.end(),Frame.begin(),Frame.end());
+    }
+    const size_t Passes = std::max((size_t)1,Bytes/Stream.size());
+    BfFrameParser<BfFrame::kOverhead+60000> *Parser = new BfFrameParser<BfFrame::kOverhead+60000>;
+    size_t Parsed = 0;
+    Start = std::chrono::steady_clock::now();
+    for (size_t Pass=0; Pass < Passes; Pass++) {
+      for (size_t i=0; i < Stream.size(); i++) {
+        Parsed += Parser->Parse(Stream[i]);
+      }
+    }
+    double ByteParse = Throughput(Passes*Stream.size(),Start);
+    Start = std::chrono::steady_clock::now();
+    for (size_t Pass=0; Pass < Passes; Pass++) {
+      for (size_t i=0; i < Stream.size(); i += 1024) {
+        const uint8_t *Bytes = Stream.data() + i;
+        size_t Remaining = std::min((size_t)1024,Stream.size() - i);
+        while (Remaining > 0) {
+          size_t Used;
+          Parsed -= Parser->Parse(Bytes,Remaining,&Used);
+          Bytes += Used;
+          Remaining -= Used;
+        }
+      }
+    }
+    double RunParse = Throughput(Passes*Stream.size(),Start);
+    delete Parser;
+    CHECK(Parsed == 0);
+    std::cout << "bf frame " << PayloadSize << " B payload: checksum " << Vector << " MB/s (byte loop " << Loop
+      << " MB/s, " << Vector/Loop << "x), encode " << Encode << " MB/s, parse bytes " << ByteParse << " MB/s, parse runs "
+      << RunParse << " MB/s" << std::endl;
+  }
+  return TestResult();
+}
@@ -0,0 +1,171 @@
+/*
+bench-sensor-frame.cpp
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+Builds the FMU sensor frame of a typical aircraft (internal MPU-9250 and BME-280,
+four voltages, a Swift and an SBUS receiver) the way AircraftSensors::GetDataBuffer
+does, with the default message rates, and reports the bytes per frame and the
+time to encode and decode a frame. Also checks the packed messages round trip,
+including the SBUS lost frame count.
+*/
+
+#include "test.h"
+#include "messages.h"
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+/* a message of the frame, with the slot it belongs to */
+struct FrameMessage {
+  uint8_t Slot;
+  MsgId_t Id;
+  void *Payload;
+  size_t UnpackedSize;
+};
+
+/* message dividers, slowly changing temperature and humidity are sent every 10th frame */
+static unsigned int Divider(MsgId_t Id) {
+  return ((Id == MSG_TEMPERATURE_DATA)||(Id == MSG_HUMIDITY_DATA)) ? 10 : 1;
+}
+
+/* appends the frame's meta data, FMU time and packed messages to Buffer */
+static void Encode(const std::vector<FrameMessage> &Messages,uint32_t FrameCounter,std::vector<uint8_t> *Buffer) {
+  Buffer->assign(10+sizeof(uint64_t),0);
+  for (size_t i=0; i < Messages.size(); i++) {
+    const FrameMessage &Message = Messages[i];
+    if ((FrameCounter + Message.Slot) % Divider(Message.Id) != 0) {
+      continue;
+    }
+    size_t Location = Buffer->size();
+    Buffer->resize(Location+2+msg_packed_size(Message.Id));
+    (*Buffer)[Location] = Message.Slot;
+    (*Buffer)[Location+1] = Message.Id;
+    msg_pack(Message.Id,Message.Payload,Buffer->data()+Location+2);
+  }
+}
+
+/* unpacks every message of a frame, returns the number of messages */
+static size_t Decode(const std::vector<uint8_t> &Buffer,uint8_t *Scratch) {
+  size_t Count = 0;
+  size_t Location = 10+sizeof(uint64_t);
+  while (Location + 2 <= Buffer.size()) {
+    MsgId_t Id = (MsgId_t)(Buffer[Location+1] & 0x7F);
+    size_t Size = msg_packed_size(Id);
+    if ((Size == 0)||(Location + 2 + Size > Buffer.size())) {
+      break;
+    }
+    msg_unpack(Id,Buffer.data()+Location+2,Scratch);
+    Location += 2 + Size;
+    Count++;
+  }
+  return Count;
+}
+
+int main() {
+  struct accel_data Accel = {0,0,0.1f,-0.2f,-9.8f};
+  struct gyro_data Gyro = {0,0,0.01f,-0.02f,0.03f};
+  struct mag_data Mag = {0,0,20.0f,-5.0f,40.0f};
+  struct temperature_data Temperature = {0,0,25.0f};
+  struct static_press_data Static = {0,0,98000.0f};
+  struct diff_press_data Differential = {0,0,250.0f};
+  struct humidity_data Humidity = {0,0,40.0f};
+  struct voltage_data Voltage = {0,0,5.0f};
+  struct inceptor_data Inceptor;
+  memset(&Inceptor,0,sizeof(Inceptor));
+  Inceptor.lost_frames = 3;
+  for (size_t i=0; i < 16; i++) {
+    Inceptor.ch[i] = -1.0f + i/8.0f;
+  }
+  std::vector<FrameMessage> Messages = {
+    {0,MSG_ACCEL_DATA,&Accel,sizeof(Accel)},
+    {0,MSG_GYRO_DATA,&Gyro,sizeof(Gyro)},
+    {0,MSG_MAG_DATA,&Mag,sizeof(Mag)},
+    {0,MSG_TEMPERATURE_DATA,&Temperature,sizeof(Temperature)},
+    {1,MSG_STATIC_PRESS_DATA,&Static,sizeof(Static)},
+    {1,MSG_TEMPERATURE_DATA,&Temperature,sizeof(Temperature)},
+    {1,MSG_HUMIDITY_DATA,&Humidity,sizeof(Humidity)},
+    {2,MSG_VOLTAGE_DATA,&Voltage,sizeof(Voltage)},
+    {3,MSG_VOLTAGE_DATA,&Voltage,sizeof(Voltage)},
+    {4,MSG_VOLTAGE_DATA,&Voltage,sizeof(Voltage)},
+    {5,MSG_VOLTAGE_DATA,&Voltage,sizeof(Voltage)},
+    {6,MSG_STATIC_PRESS_DATA,&Static,sizeof(Static)},
+    {6,MSG_TEMPERATURE_DATA,&Temperature,sizeof(Temperature)},
+    {7,MSG_DIFF_PRESS_DATA,&Differential,sizeof(Differential)},
+    {7,MSG_TEMPERATURE_DATA,&Temperature,sizeof(Temperature)},
+    {8,MSG_INCEPTOR_DATA,&Inceptor,sizeof(Inceptor)}
+  };
+
+  // every message sent every frame as unpacked structs, for comparison
+  size_t UnpackedSize = 10+sizeof(uint64_t);
+  for (size_t i=0; i < Messages.size(); i++) {
+    UnpackedSize += Messages[i].UnpackedSize;
+  }
+
+  // frame sizes over a full divider cycle
+  std::vector<uint8_t> Buffer;
+  size_t MinSize = SIZE_MAX, MaxSize = 0, TotalSize = 0;
+  for (uint32_t Frame=0; Frame < 10; Frame++) {
+    Encode(Messages,Frame,&Buffer);
+    MinSize = std::min(MinSize,Buffer.size());
+    MaxSize = std::max(MaxSize,Buffer.size());
+    TotalSize += Buffer.size();
+  }
+  std::cout << "sensor frame: " << TotalSize/10.0 << " bytes mean, " << MinSize << " min, " << MaxSize
+    << " max, unpacked structs " << UnpackedSize << " bytes" << std::endl;
+
+  // encode and decode time
+  const size_t Frames = 200000;
+  uint8_t Scratch[256];
+  size_t Decoded = 0;
+  auto Start = std::chrono::steady_clock::now();
+  for (size_t i=0; i < Frames; i++) {
+    Encode(Messages,i,&Buffer);
+  }
+  double EncodeTime = std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now() - Start).count()/Frames;
+  Start = std::chrono::steady_clock::now();
+  for (size_t i=0; i < Frames; i++) {
+    Decoded += Decode(Buffer,Scratch);
+  }
+  double DecodeTime = std::chrono::duration<double,std::nano>(std::chrono::steady_clock::now() - Start).count()/Frames;
+  std::cout << "sensor frame: encode " << EncodeTime << " ns, decode " << DecodeTime << " ns" << std::endl;
+  CHECK(Decoded > 0);
+
+  // round trip, the lost frame count saturates at what the message holds
+  uint8_t Packed[64];
+  struct inceptor_data Unpacked;
+  for (unsigned int Lost=0; Lost <= MSG_MAX_LOST_FRAMES+5; Lost++) {
+    Inceptor.lost_frames = Lost;
+    msg_pack(MSG_INCEPTOR_DATA,&Inceptor,Packed);
+    CHECK(msg_unpack(MSG_INCEPTOR_DATA,Packed,&Unpacked) == MSG_ERROR_SUCCESS);
+    CHECK(Unpacked.lost_frames == std::min(Lost,(unsigned int)MSG_MAX_LOST_FRAMES));
+    for (size_t i=0; i < 16; i++) {
+      CHECK(fabsf(Unpacked.ch[i] - Inceptor.ch[i]) < 1.0e-3f);
+    }
+  }
+  struct static_press_data StaticUnpacked;
+  msg_pack(MSG_STATIC_PRESS_DATA,&Static,Packed);
+  msg_unpack(MSG_STATIC_PRESS_DATA,Packed,&StaticUnpacked);
+  CHECK(fabsf(StaticUnpacked.press_pa - Static.press_pa) < 10.0f);
+  struct diff_press_data DifferentialUnpacked;
+  msg_pack(MSG_DIFF_PRESS_DATA,&Differential,Packed);
+  msg_unpack(MSG_DIFF_PRESS_DATA,Packed,&DifferentialUnpacked);
+  CHECK(fabsf(DifferentialUnpacked.press_pa - Differential.press_pa) < 1.0f);
+  return TestResult();
+}
@@ -0,0 +1,189 @@
+/*
+datalog-decoder.h
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+Reads back datalog block files for the datalog tests. The LZ4 block decoder is
+written from the format description rather than shared with the encoder, and
+rejects blocks breaking the format's end of block rules: the last sequence is
+literals only, the last 5 bytes are literals and the last match starts at least
+12 bytes before the end.
+*/
+
+#ifndef DATALOG_DECODER_H_
+#define DATALOG_DECODER_H_
+
+#include "datalog-compression.h"
+#include "bf_frame.h"
+#include "crc16.h"
+#include <algorithm>
+#include <set>
+#include <vector>
+
+/* Lengths seen by the decoder */
+struct Sequences {
+  std::set<size_t> Literals;
+  std::set<size_t> Matches;
+  size_t LastLiterals = 0;
+};
+
+/* Reads a length continued in 255 steps after a 15 in the token */
+static bool Length(const uint8_t *Src, size_t SrcSize, size_t *In, size_t *Value) {
+  uint8_t Byte;
+  do {
+    if (*In >= SrcSize) {
+      return false;
+    }
+    Byte = Src[(*In)++];
+    *Value += Byte;
+  } while (Byte == 255);
+  return true;
+}
+
+/* Decodes an LZ4 block of RawSize bytes, returns false on any format error */
+static bool Decompress(const uint8_t *Src, size_t SrcSize, size_t RawSize, std::vector<uint8_t> *Raw, Sequences *Seen) {
+  Raw->clear();
+  size_t In = 0;
+  size_t LastMatchStart = 0;
+  bool Matched = false;
+  while (true) {
+    if (In >= SrcSize) {
+      return false;
+    }
+    uint8_t Token = Src[In++];
+    size_t Literals = Token >> 4;
+    if ((Literals == 15)&&(!Length(Src,SrcSize,&In,&Literals))) {
+      return false;
+    }
+    if (In + Literals > SrcSize) {
+      return false;
+    }
+    Raw->insert(Raw->end(),Src+In,Src+In+Literals);
+    In += Literals;
+    Seen->Literals.insert(Literals);
+    if (In == SrcSize) {
+      // the last sequence has no match
+      Seen->LastLiterals = Literals;
+      if ((Token & 0x0f) != 0) {
+        return false;
+      }
+      break;
+    }
+    if (In + 2 > SrcSize) {
+      return false;
+    }
+    size_t Offset = Src[In] | (Src[In+1] << 8);
+    In += 2;
+    size_t Match = Token & 0x0f;
+    if ((Match == 15)&&(!Length(Src,SrcSize,&In,&Match))) {
+      return false;
+    }
+    Match += 4;
+    if ((Offset == 0)||(Offset > Raw->size())) {
+      return false;
+    }
+    Seen->Matches.insert(Match);
+    LastMatchStart = Raw->size();
+    Matched = true;
+    // byte by byte, matches may overlap their own output
+    for (size_t i=0; i < Match; i++) {
+      Raw->push_back((*Raw)[Raw->size()-Offset]);
+    }
+  }
+  if (Raw->size() != RawSize) {
+    return false;
+  }
+  if (Matched&&((Seen->LastLiterals < 5)||(LastMatchStart + 12 > RawSize))) {
+    return false;
+  }
+  return true;
+}
+
+/* Reverses the per stream XOR of Data and GroupData payloads in a decoded block */
+static void Unxor(std::vector<uint8_t> *Raw) {
+  std::vector<uint8_t> Previous[257];
+  size_t Location = 0;
+  while (Location + BfFrame::kHeaderSize <= Raw->size()) {
+    uint8_t *Frame = Raw->data() + Location;
+    if ((Frame[0] != BfFrame::kHeader0)||(Frame[1] != BfFrame::kHeader1)) {
+      break;
+    }
+    size_t Length = Frame[3] | (Frame[4] << 8);
+    Location += BfFrame::Size(Length);
+    uint8_t *Payload = BfFrame::Payload(Frame);
+    size_t Stream;
+    if (Frame[2] == 20) {
+      Stream = 256;
+    } else if ((Frame[2] == 24)&&(Length > 0)) {
+      Stream = Payload[0];
+      Payload++;
+      Length--;
+    } else {
+      continue;
+    }
+    if (Previous[Stream].size() == Length) {
+      for (size_t i=0; i < Length; i++) {
+        Payload[i] ^= Previous[Stream][i];
+      }
+    }
+    Previous[Stream].assign(Payload,Payload+Length);
+  }
+}
+
+/* Decodes the complete blocks of a file, returns false if a complete block is invalid */
+static bool DecodeFile(const std::vector<uint8_t> &File, std::vector<std::vector<uint8_t>> *Blocks, Sequences *Seen) {
+  Blocks->clear();
+  if ((File.size() < 4)||(!std::equal(File.begin(),File.begin()+4,DatalogBlockEncoder::kFileHeader))) {
+    return false;
+  }
+  size_t Location = 4;
+  while (Location + DatalogBlockEncoder::kBlockHeaderSize <= File.size()) {
+    const uint8_t *Header = File.data() + Location;
+    if ((Header[0] != 'B')||(Header[1] != 'F')||(Header[2] != 'Z')||(Header[3] != 'B')) {
+      return false;
+    }
+    size_t RawSize = 0, StoredSize = 0;
+    for (size_t i=0; i < 4; i++) {
+      RawSize |= (size_t)Header[4+i] << (8*i);
+      StoredSize |= (size_t)Header[8+i] << (8*i);
+    }
+    uint16_t Checksum = Header[12] | (Header[13] << 8);
+    if (Location + DatalogBlockEncoder::kBlockHeaderSize + StoredSize > File.size()) {
+      // cut short, the complete blocks before it stand
+      break;
+    }
+    const uint8_t *Stored = Header + DatalogBlockEncoder::kBlockHeaderSize;
+    std::vector<uint8_t> Raw;
+    if (StoredSize == RawSize) {
+      Raw.assign(Stored,Stored+StoredSize);
+    } else if ((StoredSize > RawSize)||(!Decompress(Stored,StoredSize,RawSize,&Raw,Seen))) {
+      return false;
+    }
+    Unxor(&Raw);
+    CRC16 Crc;
+    if (Crc.xmodem(Raw.data(),Raw.size()) != Checksum) {
+      return false;
+    }
+    Blocks->push_back(Raw);
+    Location += DatalogBlockEncoder::kBlockHeaderSize + StoredSize;
+  }
+  return true;
+}
+
+#endif
@@ -0,0 +1,191 @@
+/*
+test-bf-frame.cpp
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+Checks the BF frame codec: the vectorized checksum against the byte loop over
+lengths and alignments, Encode and Seal, and BfFrameParser on a stream with
+noise, false headers, a corrupted frame and an oversized frame, fed byte by byte
+and in random fragments.
+*/
+
+#include "test.h"
+#include "bf_frame.h"
+#include <random>
+#include <vector>
+
+/* The checksum as defined, one byte at a time */
+static void ReferenceChecksum(const uint8_t *Data,size_t Size,uint8_t *Checksum) {
+  uint8_t Sum0 = 0, Sum1 = 0;
+  for (size_t i=0; i < Size; i++) {
+    Sum0 += Data[i];
+    Sum1 += Sum0;
+  }
+  Checksum[0] = Sum0;
+  Checksum[1] = Sum1;
+}
+
+/* A frame expected out of the parser */
+struct Expected {
+  uint8_t Type;
+  std::vector<uint8_t> Payload;
+};
+
+/* Appends an encoded frame to Stream */
+static void AppendFrame(uint8_t Type,const std::vector<uint8_t> &Payload,std::vector<uint8_t> *Stream) {
+  std::vector<uint8_t> Frame(BfFrame::Size(Payload.size()));
+  CHECK(BfFrame::Encode(Type,Payload.data(),Payload.size(),Frame.data(),Frame.size()) == Frame.size());
+  Stream->insert(Stream->end(),Frame.begin(),Frame.end());
+}
+
+/* Compares the frames a parser returned with the ones expected */
+static void CheckFrames(const std::vector<Expected> &Parsed,const std::vector<Expected> &Frames) {
+  CHECK(Parsed.size() == Frames.size());
+  for (size_t i=0; (i < Parsed.size())&&(i < Frames.size()); i++) {
+    CHECK(Parsed[i].Type == Frames[i].Type);
+    CHECK(Parsed[i].Payload == Frames[i].Payload);
+  }
+}
+
+int main() {
+  std::mt19937 Random(42);
+
+  // checksum, every length to 600 at every alignment within a block, then long runs
+  std::vector<uint8_t> Data(70000+16);
+  for (size_t i=0; i < Data.size(); i++) {
+    Data[i] = Random() & 0xff;
+  }
+  uint8_t Checksum[2], Reference[2];
+  for (size_t Offset=0; Offset < 16; Offset++) {
+    for (size_t Size=0; Size <= 600; Size++) {
+      BfFrame::Checksum(Data.data()+Offset,Size,Checksum);
+      ReferenceChecksum(Data.data()+Offset,Size,Reference);
+      CHECK((Checksum[0] == Reference[0])&&(Checksum[1] == Reference[1]));
+    }
+  }
+  const size_t LongSizes[] = {4095,4096,4097,65535,BfFrame::Size(BfFrame::kMaxPayload),70000};
+  for (size_t i=0; i < sizeof(LongSizes)/sizeof(LongSizes[0]); i++) {
+    BfFrame::Checksum(Data.data()+3,LongSizes[i],Checksum);
+    ReferenceChecksum(Data.data()+3,LongSizes[i],Reference);
+    CHECK((Checksum[0] == Reference[0])&&(Checksum[1] == Reference[1]));
+  }
+  // all 0xff, the largest lane sums
+  std::vector<uint8_t> Ones(BfFrame::Size(BfFrame::kMaxPayload),0xff);
+  BfFrame::Checksum(Ones.data(),Ones.size(),Checksum);
+  ReferenceChecksum(Ones.data(),Ones.size(),Reference);
+  CHECK((Checksum[0] == Reference[0])&&(Checksum[1] == Reference[1]));
+
+  // encode and seal
+  uint8_t Frame[64];
+  const uint8_t Payload[] = {1,2,3,4,5};
+  CHECK(BfFrame::Encode(7,Payload,sizeof(Payload),Frame,sizeof(Frame)) == 12);
+  CHECK((Frame[0] == 0x42)&&(Frame[1] == 0x46)&&(Frame[2] == 7)&&(Frame[3] == 5)&&(Frame[4] == 0));
+  CHECK(memcmp(Frame+BfFrame::kHeaderSize,Payload,sizeof(Payload)) == 0);
+  ReferenceChecksum(Frame,BfFrame::kHeaderSize+sizeof(Payload),Reference);
+  CHECK((Frame[10] == Reference[0])&&(Frame[11] == Reference[1]));
+  uint8_t Sealed[64];
+  memcpy(BfFrame::Payload(Sealed),Payload,sizeof(Payload));
+  CHECK(BfFrame::Seal(7,sizeof(Payload),Sealed) == 12);
+  CHECK(memcmp(Sealed,Frame,12) == 0);
+  CHECK(BfFrame::Encode(7,Payload,sizeof(Payload),Frame,11) == 0);
+  CHECK(BfFrame::Encode(7,Ones.data(),BfFrame::kMaxPayload+1,Ones.data(),Ones.size()) == 0);
+
+  // a stream of frames with noise between them, the noise has no 0x42 so it
+  // cannot start a frame
+  const size_t ParserSize = 512;
+  std::vector<uint8_t> Stream;
+  std::vector<Expected> Frames;
+  for (size_t i=0; i < 200; i++) {
+    Expected Next;
+    Next.Type = Random() & 0xff;
+    Next.Payload.resize(Random() % (BfFrameParser<ParserSize>::kMaxPayload+1));
+    for (size_t j=0; j < Next.Payload.size(); j++) {
+      Next.Payload[j] = Random() & 0xff;
+    }
+    switch (i % 5) {
+      case 1: {
+        // noise
+        for (size_t j=Random() % 8; j > 0; j--) {
+          uint8_t Byte = Random() & 0xff;
+          Stream.push_back((Byte == 0x42) ? 0 : Byte);
+        }
+        break;
+      }
+      case 2: {
+        // a repeated first header byte, and a bad second one
+        Stream.insert(Stream.end(),{0x42,0x00,0x42});
+        break;
+      }
+      case 3: {
+        // a corrupted frame that is dropped
+        size_t Location = Stream.size();
+        AppendFrame(1,Next.Payload,&Stream);
+        Stream[Location+BfFrame::kHeaderSize+Next.Payload.size()] ^= 0x01;
+        break;
+      }
+      case 4: {
+        // a frame longer than the parser buffer, dropped at its header
+        Stream.insert(Stream.end(),{0x42,0x46,1,0xff,0x7f});
+        break;
+      }
+    }
+    AppendFrame(Next.Type,Next.Payload,&Stream);
+    Frames.push_back(Next);
+  }
+
+  // byte by byte
+  BfFrameParser<ParserSize> Parser;
+  std::vector<Expected> Parsed;
+  for (size_t i=0; i < Stream.size(); i++) {
+    if (Parser.Parse(Stream[i])) {
+      Expected Frame;
+      Frame.Type = Parser.Type();
+      Frame.Payload.assign(Parser.Payload(),Parser.Payload()+Parser.PayloadSize());
+      Parsed.push_back(Frame);
+    }
+  }
+  CheckFrames(Parsed,Frames);
+
+  // in fragments of 1 to 300 bytes, as reads from a socket or serial port return them
+  for (size_t Run=0; Run < 20; Run++) {
+    Parser.Reset();
+    Parsed.clear();
+    size_t Location = 0;
+    while (Location < Stream.size()) {
+      size_t Fragment = std::min(Stream.size() - Location,(size_t)(1 + Random() % 300));
+      const uint8_t *Bytes = Stream.data() + Location;
+      while (Fragment > 0) {
+        size_t Used;
+        bool Valid = Parser.Parse(Bytes,Fragment,&Used);
+        CHECK((Used > 0)&&(Used <= Fragment));
+        if (Valid) {
+          Expected Frame;
+          Frame.Type = Parser.Type();
+          Frame.Payload.assign(Parser.Payload(),Parser.Payload()+Parser.PayloadSize());
+          Parsed.push_back(Frame);
+        }
+        Bytes += Used;
+        Location += Used;
+        Fragment -= Used;
+      }
+    }
+    CheckFrames(Parsed,Frames);
+  }
+  return TestResult();
+}
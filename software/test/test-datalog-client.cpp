@@ -0,0 +1,268 @@
+/*
+test-datalog-client.cpp
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+Logs 100 frames at 100 Hz through the datalog client with two decimation groups,
+numeric and string events, receives the frames where the datalog server would
+and decodes them with BfFrameParser sized like the server's receive buffer.
+Checks the group definitions, that each group is sent on its decimation with the
+frame time, that events are sent only when their value changes, and that events
+too large for one frame are split across frames that fit the receive buffer.
+*/
+
+#include "test.h"
+#include "datalog.h"
+#include <map>
+
+// message types and event value types of the datalog format
+enum {
+  kData = 20,
+  kGroupDef = 21,
+  kGroupData = 24,
+  kEventKey = 31,
+  kEventData = 33,
+  kUint8 = 3,
+  kFloat = 8,
+  kString = 34
+};
+
+/* A received frame */
+struct Frame {
+  uint8_t Type;
+  std::vector<uint8_t> Payload;
+};
+
+/* Receives the frames sent so far, each datagram must hold one valid frame */
+static std::vector<Frame> Receive(int Socket) {
+  static BfFrameParser<kUartBufferMaxSize> Parser;
+  std::vector<Frame> Frames;
+  uint8_t Buffer[2*kUartBufferMaxSize];
+  ssize_t Size;
+  while ((Size = recv(Socket,Buffer,sizeof(Buffer),MSG_DONTWAIT)) > 0) {
+    size_t Used;
+    bool Valid = Parser.Parse(Buffer,Size,&Used);
+    CHECK(Valid&&(Used == (size_t)Size));
+    if (Valid) {
+      Frame Received;
+      Received.Type = Parser.Type();
+      Received.Payload.assign(Parser.Payload(),Parser.Payload()+Parser.PayloadSize());
+      Frames.push_back(Received);
+    }
+    Parser.Reset();
+  }
+  return Frames;
+}
+
+/* Returns the frames of a type */
+static std::vector<Frame> OfType(const std::vector<Frame> &Frames, uint8_t Type) {
+  std::vector<Frame> Found;
+  for (const Frame &Received : Frames) {
+    if (Received.Type == Type) {
+      Found.push_back(Received);
+    }
+  }
+  return Found;
+}
+
+/* Decodes event frames into event number and value bytes, checking each frame's time */
+static std::map<uint16_t,std::vector<uint8_t>> Events(const std::vector<Frame> &Frames, const std::map<uint16_t,uint8_t> &Types, uint64_t Time_us) {
+  std::map<uint16_t,std::vector<uint8_t>> Values;
+  for (const Frame &Received : OfType(Frames,kEventData)) {
+    const std::vector<uint8_t> &Payload = Received.Payload;
+    uint64_t Time;
+    memcpy(&Time,Payload.data(),sizeof(Time));
+    CHECK(Time == Time_us);
+    size_t Location = sizeof(Time);
+    while (Location + sizeof(uint16_t) <= Payload.size()) {
+      uint16_t Event = Payload[Location] | (Payload[Location+1] << 8);
+      Location += sizeof(uint16_t);
+      size_t Size;
+      if (Types.at(Event) == kString) {
+        Size = 1 + Payload[Location];
+      } else {
+        Size = (Types.at(Event) == kUint8) ? 1 : 4;
+      }
+      CHECK(Location + Size <= Payload.size());
+      CHECK(Values.count(Event) == 0);
+      Values[Event].assign(Payload.begin()+Location,Payload.begin()+std::min(Location+Size,Payload.size()));
+      Location += Size;
+    }
+    CHECK(Location == Payload.size());
+  }
+  return Values;
+}
+
+int main() {
+  // receives where the datalog server would
+  int Socket = socket(AF_INET,SOCK_DGRAM,0);
+  struct sockaddr_in Address;
+  Address.sin_family = AF_INET;
+  Address.sin_port = htons(8000);
+  Address.sin_addr.s_addr = inet_addr("127.0.0.1");
+  CHECK(bind(Socket,(struct sockaddr *)&Address,sizeof(Address)) == 0);
+
+  ElementPtr Time = deftree.initElement("/Sensors/Fmu/Time_us","Time, us",LOG_UINT64,LOG_NONE);
+  ElementPtr Fast = deftree.initElement("/Fast/A","Full rate",LOG_FLOAT,LOG_NONE);
+  ElementPtr Slow = deftree.initElement("/Slow/B","Slow counter",LOG_UINT32,LOG_NONE);
+  ElementPtr Mid = deftree.initElement("/Mid/C","Mid rate",LOG_FLOAT16,LOG_NONE);
+  ElementPtr Mode = deftree.initElement("/Mission/Mode","Mode",LOG_UINT8,LOG_NONE);
+  ElementPtr Gain = deftree.initElement("/Mission/Gain","Gain",LOG_FLOAT,LOG_NONE);
+  deftree.initElement("/Mission/Unlogged","Not logged",LOG_NONE,LOG_NONE);
+  Mode->setInt(1);
+  Gain->setFloat(0.25f);
+  Mid->setFloat(1.5f);
+
+  rapidjson::Document Config;
+  Config.Parse("{\"Groups\":["
+    "{\"Name\":\"Slow\",\"Decimation\":10,\"Signals\":[\"/Slow/\"]},"
+    "{\"Name\":\"Mid\",\"Rate\":25,\"Signals\":[\"/Mid/\"]}],"
+    "\"Events\":[\"/Mission/\"]}");
+  DatalogClient Client;
+  Client.Configure(Config,10000);
+  size_t Engaged = Client.AddStringEvent("/Control/Engaged","Engaged controller");
+  std::vector<size_t> Strings;
+  for (size_t i=0; i < 20; i++) {
+    Strings.push_back(Client.AddStringEvent("/Test/String" + std::to_string(i),"Long string"));
+  }
+  Client.RegisterGlobalData();
+
+  // group definitions and event numbers from the meta data
+  std::vector<Frame> Meta = Receive(Socket);
+  std::vector<Frame> Defs = OfType(Meta,kGroupDef);
+  CHECK(Defs.size() == 2);
+  if (Defs.size() == 2) {
+    CHECK(Defs[0].Payload == std::vector<uint8_t>({1,10,0,'S','l','o','w'}));
+    CHECK(Defs[1].Payload == std::vector<uint8_t>({2,4,0,'M','i','d'}));
+  }
+  std::map<std::string,uint16_t> EventNumbers;
+  std::map<uint16_t,uint8_t> EventTypes;
+  for (const Frame &Key : OfType(Meta,kEventKey)) {
+    uint16_t Event = Key.Payload[0] | (Key.Payload[1] << 8);
+    EventNumbers[std::string(Key.Payload.begin()+3,Key.Payload.end())] = Event;
+    EventTypes[Event] = Key.Payload[2];
+  }
+  CHECK(EventNumbers.size() == 23);
+  CHECK(EventNumbers.at("/Control/Engaged") == Engaged);
+  CHECK(EventTypes.at(EventNumbers.at("/Mission/Mode")) == kUint8);
+  CHECK(EventTypes.at(EventNumbers.at("/Mission/Gain")) == kFloat);
+  CHECK(EventTypes.at(Engaged) == kString);
+  CHECK(EventNumbers.count("/Mission/Unlogged") == 0);
+  uint16_t ModeEvent = EventNumbers.at("/Mission/Mode");
+  uint16_t GainEvent = EventNumbers.at("/Mission/Gain");
+
+  size_t SlowFrames = 0, MidFrames = 0;
+  for (uint32_t i=0; i < 100; i++) {
+    uint64_t Time_us = 1000000 + 10000*i;
+    deftree.NextGeneration();
+    Time->setLong(Time_us);
+    Fast->setFloat(i);
+    Slow->setInt(i);
+    // rewritten every frame with the same value
+    Mode->setInt((i < 30) ? 1 : 2);
+    Client.LogStringEvent(Engaged,(i < 60) ? "Baseline" : "Test");
+    if (i == 40) {
+      Gain->setFloat(0.5f);
+    }
+    if (i == 50) {
+      // changed and set back to its logged value within the frame
+      Gain->setFloat(0.75f);
+      Gain->setFloat(0.5f);
+    }
+    if (i == 80) {
+      // longer than an event string, logged cut to 255 characters
+      for (size_t j=0; j < Strings.size(); j++) {
+        Client.LogStringEvent(Strings[j],std::string(300,'a' + j));
+      }
+    }
+    Client.LogBinaryData();
+    std::vector<Frame> Frames = Receive(Socket);
+
+    // the full rate row every frame
+    std::vector<Frame> Data = OfType(Frames,kData);
+    CHECK(Data.size() == 1);
+    if (Data.size() == 1) {
+      uint64_t Row_us;
+      float Value;
+      CHECK(Data[0].Payload.size() == sizeof(Row_us) + sizeof(Value));
+      memcpy(&Row_us,Data[0].Payload.data(),sizeof(Row_us));
+      memcpy(&Value,Data[0].Payload.data()+sizeof(Row_us),sizeof(Value));
+      CHECK((Row_us == Time_us)&&(Value == i));
+    }
+
+    // groups on their decimation, starting with the first frame, with the frame time
+    for (const Frame &Group : OfType(Frames,kGroupData)) {
+      uint64_t Group_us;
+      memcpy(&Group_us,Group.Payload.data()+1,sizeof(Group_us));
+      CHECK(Group_us == Time_us);
+      if (Group.Payload[0] == 1) {
+        SlowFrames++;
+        uint32_t Value;
+        CHECK(Group.Payload.size() == 1 + sizeof(Group_us) + sizeof(Value));
+        memcpy(&Value,Group.Payload.data()+1+sizeof(Group_us),sizeof(Value));
+        CHECK((i % 10 == 0)&&(Value == i));
+      } else {
+        MidFrames++;
+        // 1.5 as a half float
+        CHECK(Group.Payload.size() == 1 + sizeof(Group_us) + sizeof(uint16_t));
+        CHECK((Group.Payload[0] == 2)&&(Group.Payload[9] == 0x00)&&(Group.Payload[10] == 0x3e));
+        CHECK(i % 4 == 0);
+      }
+    }
+
+    // events only when their value changes
+    std::vector<Frame> EventFrames = OfType(Frames,kEventData);
+    std::map<uint16_t,std::vector<uint8_t>> Values = Events(Frames,EventTypes,Time_us);
+    if (i == 0) {
+      CHECK(EventFrames.size() == 1);
+      CHECK(Values.size() == 23);
+      CHECK(Values[ModeEvent] == std::vector<uint8_t>({1}));
+      CHECK(Values[Engaged] == std::vector<uint8_t>({8,'B','a','s','e','l','i','n','e'}));
+      CHECK(Values[Strings[0]] == std::vector<uint8_t>({0}));
+    } else if (i == 30) {
+      CHECK((Values.size() == 1)&&(Values[ModeEvent] == std::vector<uint8_t>({2})));
+    } else if (i == 40) {
+      float Value = 0.0f;
+      CHECK((Values.size() == 1)&&(Values[GainEvent].size() == sizeof(Value)));
+      memcpy(&Value,Values[GainEvent].data(),sizeof(Value));
+      CHECK(Value == 0.5f);
+    } else if (i == 60) {
+      CHECK((Values.size() == 1)&&(Values[Engaged] == std::vector<uint8_t>({4,'T','e','s','t'})));
+    } else if (i == 80) {
+      // 20 strings of 255 characters do not fit one frame of the receive buffer
+      CHECK(EventFrames.size() == 2);
+      CHECK(Values.size() == Strings.size());
+      for (size_t j=0; j < Strings.size(); j++) {
+        std::vector<uint8_t> Expected(1 + 255,'a' + j);
+        Expected[0] = 255;
+        CHECK(Values[Strings[j]] == Expected);
+      }
+      for (const Frame &Received : EventFrames) {
+        CHECK(BfFrame::Size(Received.Payload.size()) <= kUartBufferMaxSize);
+      }
+    } else {
+      CHECK(EventFrames.size() == 0);
+    }
+  }
+  CHECK(SlowFrames == 10);
+  CHECK(MidFrames == 25);
+  Client.End();
+  close(Socket);
+  return TestResult();
+}
@@ -0,0 +1,183 @@
+/*
+test-datalog-compression.cpp
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+Round trips blocks through DatalogBlockEncoder and the independent decoder in
+datalog-decoder.h. Covers incompressible data, literal and match runs at the 15
+and 255 length code boundaries, runs to the end of a block, datalog frames XORed
+per stream and a file cut short in the middle of a block.
+*/
+
+#include "test.h"
+#include "datalog-decoder.h"
+#include <string>
+
+/* Encodes blocks into a file, the encoder gets copies since it XORs in place */
+static std::vector<uint8_t> EncodeFile(DatalogBlockEncoder *Encoder, const std::vector<std::vector<uint8_t>> &Blocks) {
+  std::vector<uint8_t> File(DatalogBlockEncoder::kFileHeader,DatalogBlockEncoder::kFileHeader+4);
+  for (size_t i=0; i < Blocks.size(); i++) {
+    std::vector<uint8_t> Raw = Blocks[i];
+    std::vector<uint8_t> Block;
+    Encoder->Encode(Raw.data(),Raw.size(),&Block);
+    File.insert(File.end(),Block.begin(),Block.end());
+  }
+  return File;
+}
+
+/* Encodes a block on its own and checks it decodes back, returns the decoder's view of it */
+static Sequences RoundTrip(DatalogBlockEncoder *Encoder, const std::vector<uint8_t> &Raw, size_t *StoredSize = NULL) {
+  Sequences Seen;
+  std::vector<std::vector<uint8_t>> Decoded;
+  std::vector<uint8_t> File = EncodeFile(Encoder,{Raw});
+  CHECK(DecodeFile(File,&Decoded,&Seen));
+  CHECK((Decoded.size() == 1)&&(Decoded[0] == Raw));
+  if (StoredSize != NULL) {
+    *StoredSize = File.size() - 4 - DatalogBlockEncoder::kBlockHeaderSize;
+  }
+  return Seen;
+}
+
+/* Deterministic bytes without repeated 4 byte sequences in practice */
+static std::vector<uint8_t> Noise(size_t Size, uint32_t *State) {
+  std::vector<uint8_t> Bytes(Size);
+  for (size_t i=0; i < Size; i++) {
+    *State ^= *State << 13;
+    *State ^= *State >> 17;
+    *State ^= *State << 5;
+    Bytes[i] = *State >> 24;
+  }
+  return Bytes;
+}
+
+/* Appends a sealed frame */
+static void Append(uint8_t Type, const std::vector<uint8_t> &Payload, std::vector<uint8_t> *Raw) {
+  size_t Location = Raw->size();
+  Raw->resize(Location + BfFrame::Size(Payload.size()));
+  BfFrame::Encode(Type,Payload.data(),Payload.size(),Raw->data()+Location,BfFrame::Size(Payload.size()));
+}
+
+int main() {
+  DatalogBlockEncoder Encoder;
+  uint32_t State = 0x12345678;
+  size_t StoredSize;
+
+  // incompressible data is stored as is
+  std::vector<uint8_t> Raw = Noise(4096,&State);
+  RoundTrip(&Encoder,Raw,&StoredSize);
+  CHECK(StoredSize == Raw.size());
+
+  // a match has to start 12 bytes before the end, shorter blocks are literals only
+  for (size_t Size=1; Size <= 24; Size++) {
+    Sequences Seen = RoundTrip(&Encoder,std::vector<uint8_t>(Size,0xaa));
+    CHECK((Size > 12)||(Seen.Matches.empty()));
+  }
+
+  // literals then a match repeating them, matches of 19 and 274 bytes put 15 and
+  // 15 + 255 in their length codes
+  Sequences Seen;
+  for (size_t Match : {18, 19, 20, 273, 274, 275, 529}) {
+    Raw = Noise(15,&State);
+    for (size_t i=0; i < Match; i++) {
+      Raw.push_back(Raw[i]);
+    }
+    std::vector<uint8_t> Tail = Noise(20,&State);
+    Raw.insert(Raw.end(),Tail.begin(),Tail.end());
+    Seen = RoundTrip(&Encoder,Raw);
+    CHECK(Seen.Literals.count(15) == 1);
+    CHECK(Seen.Matches.count(Match) == 1);
+  }
+
+  // a match up to the last run of literals, which has exactly the noise length
+  for (size_t Literals : {14, 15, 16, 269, 270, 271, 525, 1000}) {
+    Raw.assign(2000,0);
+    Raw[0] = 1;
+    std::vector<uint8_t> Tail = Noise(Literals,&State);
+    Tail[0] |= 1;
+    Raw.insert(Raw.end(),Tail.begin(),Tail.end());
+    Seen = RoundTrip(&Encoder,Raw);
+    CHECK(Seen.LastLiterals == Literals);
+  }
+
+  // a run to the end of the block leaves the last bytes as literals
+  for (size_t Size : {13, 17, 64, 1000, 65536}) {
+    Raw.assign(Size,0);
+    Raw[0] = 1;
+    Seen = RoundTrip(&Encoder,Raw,&StoredSize);
+    if (StoredSize < Size) {
+      CHECK(Seen.LastLiterals >= 5);
+    }
+    if (Size >= 64) {
+      CHECK(StoredSize < Size/16 + 16);
+    }
+  }
+
+  // datalog frames, Data and two groups with slowly changing columns and other messages between them
+  std::vector<std::vector<uint8_t>> Blocks(3);
+  uint32_t Counter = 0;
+  for (size_t i=0; i < Blocks.size(); i++) {
+    while (Blocks[i].size() < DatalogBlockEncoder::kBlockSize - 1024) {
+      Counter++;
+      std::vector<uint8_t> Data(120);
+      for (size_t j=0; j < Data.size(); j += 4) {
+        uint32_t Column = Counter/(j/4 + 1);
+        memcpy(Data.data()+j,&Column,sizeof(Column));
+      }
+      Append(20,Data,&Blocks[i]);
+      if (Counter % 5 == 0) {
+        std::vector<uint8_t> Group(1 + 40,(uint8_t)(Counter/50));
+        Group[0] = 1;
+        Append(24,Group,&Blocks[i]);
+      }
+      if (Counter % 7 == 0) {
+        std::vector<uint8_t> Group(1 + 12,(uint8_t)(Counter/70));
+        Group[0] = 2;
+        Append(24,Group,&Blocks[i]);
+      }
+      if (Counter % 97 == 0) {
+        std::string Text = "event " + std::to_string(Counter);
+        Append(22,std::vector<uint8_t>(Text.begin(),Text.end()),&Blocks[i]);
+      }
+    }
+  }
+  std::vector<uint8_t> File = EncodeFile(&Encoder,Blocks);
+  std::vector<std::vector<uint8_t>> Decoded;
+  Seen = Sequences();
+  CHECK(DecodeFile(File,&Decoded,&Seen));
+  CHECK(Decoded == Blocks);
+  CHECK(File.size() < (Blocks[0].size() + Blocks[1].size() + Blocks[2].size())/4);
+
+  // a file cut short decodes up to its last complete block
+  size_t FirstBlock = 4 + DatalogBlockEncoder::kBlockHeaderSize;
+  size_t Stored = File[FirstBlock-6] | (File[FirstBlock-5] << 8) | (File[FirstBlock-4] << 16);
+  size_t SecondBlock = FirstBlock + Stored;
+  for (size_t Cut : {(size_t)4, FirstBlock - 1, FirstBlock + Stored/2, SecondBlock, SecondBlock + 3, File.size() - 1}) {
+    std::vector<uint8_t> Truncated(File.begin(),File.begin()+Cut);
+    CHECK(DecodeFile(Truncated,&Decoded,&Seen));
+    size_t Complete = (Cut >= SecondBlock) ? 1 : 0;
+    if (Cut == File.size() - 1) {
+      Complete = 2;
+    }
+    CHECK(Decoded.size() == Complete);
+    for (size_t i=0; i < std::min(Decoded.size(),Complete); i++) {
+      CHECK(Decoded[i] == Blocks[i]);
+    }
+  }
+  return TestResult();
+}
@@ -0,0 +1,253 @@
+/*
+test-datalog-segments.cpp
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+Runs the datalog server in a temporary directory, sending it numbered frames
+over the loopback, and reads the segments back in sequence order. Checks the
+log numbers picked with an index, without one and with one pointing at an
+existing log, segment rotation by size, the segment headers, and that segments
+cut short mid-frame or mid-block lose only the frames past the cut.
+*/
+
+#include "test.h"
+#include "datalog.h"
+#include "datalog-decoder.h"
+#include <stdlib.h>
+
+static const size_t kFramePayload_ = 64;
+
+/* A segment read back from disk */
+struct Segment {
+  std::string Name;
+  uint32_t Log;
+  uint32_t Sequence;
+  uint16_t Flags;
+  std::vector<uint8_t> Data;
+};
+
+/* Sends numbered frames to a datalog server, which writes them as the next log */
+static void Run(bool Compress, size_t SegmentSize, uint32_t Frames) {
+  DatalogServer Server(Compress,SegmentSize);
+  int Socket = socket(AF_INET,SOCK_DGRAM,0);
+  struct sockaddr_in Address;
+  Address.sin_family = AF_INET;
+  Address.sin_port = htons(8000);
+  Address.sin_addr.s_addr = inet_addr("127.0.0.1");
+  uint8_t Frame[BfFrame::kOverhead + kFramePayload_];
+  for (uint32_t Counter=0; Counter < Frames; Counter++) {
+    uint8_t *Payload = BfFrame::Payload(Frame);
+    memcpy(Payload,&Counter,sizeof(Counter));
+    // slowly changing columns, as logged signals mostly are
+    for (size_t i=sizeof(Counter); i < kFramePayload_; i++) {
+      Payload[i] = Counter/(16*i);
+    }
+    BfFrame::Seal(20,kFramePayload_,Frame);
+    sendto(Socket,Frame,sizeof(Frame),0,(struct sockaddr *)&Address,sizeof(Address));
+    Server.ReceiveBinary();
+  }
+  Server.End();
+  close(Socket);
+}
+
+/* Returns the number stored in the index, or -1 */
+static long Index() {
+  long Number = -1;
+  if (FILE *File = fopen("datalog.idx","r")) {
+    if (fscanf(File,"%ld",&Number) != 1) {
+      Number = -1;
+    }
+    fclose(File);
+  }
+  return Number;
+}
+
+/* Writes text to the index */
+static void SetIndex(const char *Text) {
+  FILE *File = fopen("datalog.idx","w");
+  fputs(Text,File);
+  fclose(File);
+}
+
+/* Reads the segments of a log, sorted by the sequence number in their headers */
+static std::vector<Segment> Segments(uint32_t Log) {
+  std::vector<Segment> Found;
+  std::string Prefix = "data" + std::to_string(Log) + "_";
+  DIR *Directory = opendir(".");
+  while (struct dirent *Entry = readdir(Directory)) {
+    std::string Name = Entry->d_name;
+    if (Name.compare(0,Prefix.size(),Prefix) != 0) {
+      continue;
+    }
+    std::ifstream File(Name,std::ios::binary);
+    std::vector<uint8_t> Bytes((std::istreambuf_iterator<char>(File)),std::istreambuf_iterator<char>());
+    CHECK(Bytes.size() >= 24);
+    if (Bytes.size() < 24) {
+      continue;
+    }
+    CHECK(memcmp(Bytes.data(),"BFLS",4) == 0);
+    CHECK((Bytes[4] | (Bytes[5] << 8)) == 1);
+    Segment Read;
+    Read.Name = Name;
+    memcpy(&Read.Flags,Bytes.data()+6,sizeof(Read.Flags));
+    memcpy(&Read.Log,Bytes.data()+8,sizeof(Read.Log));
+    memcpy(&Read.Sequence,Bytes.data()+12,sizeof(Read.Sequence));
+    Read.Data.assign(Bytes.begin()+24,Bytes.end());
+    Found.push_back(Read);
+  }
+  closedir(Directory);
+  std::sort(Found.begin(),Found.end(),[](const Segment &A, const Segment &B) {
+    return A.Sequence < B.Sequence;
+  });
+  return Found;
+}
+
+/* Returns the frame counters logged in the segments, each segment decoded on its own */
+static std::vector<uint32_t> Counters(const std::vector<Segment> &Log) {
+  std::vector<uint32_t> Read;
+  for (const Segment &Segment : Log) {
+    std::vector<uint8_t> Data;
+    if (Segment.Flags & 0x01) {
+      std::vector<std::vector<uint8_t>> Blocks;
+      Sequences Seen;
+      CHECK(DecodeFile(Segment.Data,&Blocks,&Seen));
+      for (size_t i=0; i < Blocks.size(); i++) {
+        Data.insert(Data.end(),Blocks[i].begin(),Blocks[i].end());
+      }
+    } else {
+      Data = Segment.Data;
+    }
+    BfFrameParser<256> Parser;
+    size_t Location = 0, Used;
+    while (Location < Data.size()) {
+      if (Parser.Parse(Data.data()+Location,Data.size()-Location,&Used)) {
+        uint32_t Counter;
+        memcpy(&Counter,Parser.Payload(),sizeof(Counter));
+        Read.push_back(Counter);
+      }
+      Location += Used;
+    }
+  }
+  return Read;
+}
+
+/* Checks the counters are Frames counters in order with Lost of them missing, returns the first missing */
+static uint32_t CheckCounters(const std::vector<uint32_t> &Read, uint32_t Frames, uint32_t Lost) {
+  CHECK(Read.size() == Frames - Lost);
+  uint32_t Missing = Frames;
+  for (size_t i=0; i < Read.size(); i++) {
+    if ((Missing == Frames)&&(Read[i] != i)) {
+      Missing = i;
+    }
+    CHECK(Read[i] == ((Missing == Frames) ? i : i + Lost));
+  }
+  return Missing;
+}
+
+int main() {
+  char Directory[] = "/tmp/test-datalog-XXXXXX";
+  CHECK(mkdtemp(Directory) != NULL);
+  CHECK(chdir(Directory) == 0);
+  const size_t FrameSize = BfFrame::kOverhead + kFramePayload_;
+  const size_t SegmentFrames = (4096 - 24)/FrameSize;
+
+  // without an index the first log is 0, segments rotate before they pass the segment size
+  Run(false,4096,300);
+  CHECK(Index() == 1);
+  std::vector<Segment> Log = Segments(0);
+  CHECK(Log.size() == (300 + SegmentFrames - 1)/SegmentFrames);
+  for (size_t i=0; i < Log.size(); i++) {
+    char Name[64];
+    snprintf(Name,sizeof(Name),"data0_%04zu.bin",i);
+    CHECK(Log[i].Name == Name);
+    CHECK((Log[i].Log == 0)&&(Log[i].Sequence == i)&&(Log[i].Flags == 0));
+    CHECK(24 + Log[i].Data.size() <= 4096);
+    if (i + 1 < Log.size()) {
+      CHECK(24 + Log[i].Data.size() + FrameSize > 4096);
+    }
+  }
+  CheckCounters(Counters(Log),300,0);
+
+  // the index gives the next log
+  Run(false,4096,10);
+  CHECK(Index() == 2);
+  CHECK(Segments(1).size() == 1);
+
+  // a missing or unreadable index falls back to the highest log on the card
+  CHECK(unlink("datalog.idx") == 0);
+  Run(false,4096,10);
+  CHECK(Index() == 3);
+  CHECK(Segments(2).size() == 1);
+  SetIndex("garbage\n");
+  Run(false,4096,10);
+  CHECK(Index() == 4);
+  CHECK(Segments(3).size() == 1);
+
+  // a stale index pointing at an existing log does the same rather than failing to open it
+  SetIndex("1\n");
+  bool Opened = true;
+  try {
+    Run(false,4096,10);
+  } catch (const std::exception &Error) {
+    Opened = false;
+  }
+  CHECK(Opened);
+  CHECK(Index() == 5);
+  CHECK(Segments(4).size() == 1);
+  CHECK(Segments(1).size() == 1);
+
+  // compressed segments rotate by whole blocks and each decodes on its own
+  const uint32_t Frames = 8000;
+  Run(true,16384,Frames);
+  CHECK(Index() == 6);
+  Log = Segments(5);
+  CHECK(Log.size() >= 3);
+  for (size_t i=0; i < Log.size(); i++) {
+    CHECK((Log[i].Log == 5)&&(Log[i].Sequence == i)&&(Log[i].Flags == 0x01));
+    CHECK(24 + Log[i].Data.size() <= 16384);
+  }
+  CheckCounters(Counters(Log),Frames,0);
+
+  // a segment cut mid-block loses that block, the segments after it still read back in order
+  const uint32_t BlockFrames = DatalogBlockEncoder::kBlockSize/FrameSize;
+  CHECK(truncate(Log[1].Name.c_str(),24 + Log[1].Data.size() - 1) == 0);
+  std::vector<uint32_t> Read = Counters(Segments(5));
+  uint32_t Lost = Frames - Read.size();
+  CHECK((Lost > 0)&&(Lost <= BlockFrames));
+  uint32_t Missing = CheckCounters(Read,Frames,Lost);
+  CHECK(Missing % BlockFrames == 0);
+
+  // an uncompressed segment cut mid-frame loses that frame
+  Log = Segments(0);
+  CHECK(truncate(Log[1].Name.c_str(),24 + Log[1].Data.size() - 3) == 0);
+  Missing = CheckCounters(Counters(Segments(0)),300,1);
+  CHECK(Missing == 2*SegmentFrames - 1);
+
+  // clean up
+  DIR *Files = opendir(".");
+  while (struct dirent *Entry = readdir(Files)) {
+    if (Entry->d_name[0] != '.') {
+      unlink(Entry->d_name);
+    }
+  }
+  closedir(Files);
+  CHECK(chdir("/") == 0);
+  rmdir(Directory);
+  return TestResult();
+}
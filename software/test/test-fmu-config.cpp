@@ -0,0 +1,346 @@
+/*
+test-fmu-config.cpp
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+Runs FlightManagementUnit::Configure over SerialLink against a simulated FMU.
+The SOC and the simulated FMU each open the slave of a pseudo terminal and a
+thread copies bytes between the two masters, so both ends go through the same
+HardwareSerial and SerialLink code as on the aircraft. The simulated FMU
+follows the configuration hash protocol of fmu/main.cpp with the FMU's section
+cache, or ignores the hash messages like firmware without it.
+*/
+
+#include "test.h"
+#include "fmu.h"
+#include "HardwareSerial.h"
+#include "SerialLink.h"
+#include "config_sections.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <poll.h>
+#include <stdlib.h>
+
+/* Two pseudo terminals with their masters joined, each slave is one end of the serial link */
+class PtyLink {
+  public:
+    PtyLink() {
+      for (size_t i=0; i < 2; i++) {
+        Master_[i] = posix_openpt(O_RDWR|O_NOCTTY);
+        if ((Master_[i] < 0)||(grantpt(Master_[i]) < 0)||(unlockpt(Master_[i]) < 0)) {
+          throw std::runtime_error("could not open pseudo terminal");
+        }
+        Slave_[i] = ptsname(Master_[i]);
+      }
+    }
+    ~PtyLink() {
+      Running_ = false;
+      if (Thread_.joinable()) {
+        Thread_.join();
+      }
+      close(Master_[0]);
+      close(Master_[1]);
+    }
+    std::string Slave(size_t Index) {
+      return Slave_[Index];
+    }
+    /* Starts copying, called once both slaves are open and set raw */
+    void Connect() {
+      Running_ = true;
+      Thread_ = std::thread([this]() {
+        struct pollfd Fds[2] = {{Master_[0],POLLIN,0},{Master_[1],POLLIN,0}};
+        uint8_t Buffer[4096];
+        while (Running_) {
+          if (poll(Fds,2,10) <= 0) {
+            continue;
+          }
+          for (size_t i=0; i < 2; i++) {
+            if (Fds[i].revents & POLLIN) {
+              ssize_t Count = read(Master_[i],Buffer,sizeof(Buffer));
+              for (ssize_t Sent=0; Sent < Count; ) {
+                ssize_t Written = write(Master_[1-i],Buffer+Sent,Count-Sent);
+                if (Written > 0) {
+                  Sent += Written;
+                }
+              }
+            }
+          }
+        }
+      });
+    }
+  private:
+    int Master_[2];
+    std::string Slave_[2];
+    std::atomic<bool> Running_{false};
+    std::thread Thread_;
+};
+
+/* Simulated FMU, answers configuration messages and streams empty sensor frames in run mode */
+class SimulatedFmu {
+  public:
+    struct State {
+      size_t ModeCommands = 0;
+      size_t ConfigMessages = 0;
+      size_t HashMessages = 0;
+      std::vector<std::string> Applied;
+    };
+    SimulatedFmu(std::string Port,bool Hashing) : Serial_(Port), Bus_(Serial_) {
+      Hashing_ = Hashing;
+      Bus_.begin(FmuBaud);
+    }
+    ~SimulatedFmu() {
+      Running_ = false;
+      if (Thread_.joinable()) {
+        Thread_.join();
+      }
+    }
+    void Start() {
+      Running_ = true;
+      Thread_ = std::thread([this]() {
+        while (Running_) {
+          Poll();
+          usleep(500);
+        }
+      });
+    }
+    State GetState() {
+      std::lock_guard<std::mutex> Lock(Mutex_);
+      return State_;
+    }
+    /* Loses the next Count configuration messages, as a dropped serial frame would */
+    void DropSections(size_t Count) {
+      std::lock_guard<std::mutex> Lock(Mutex_);
+      Drop_ = Count;
+    }
+  private:
+    HardwareSerial Serial_;
+    SerialLink Bus_;
+    bool Hashing_;
+    std::atomic<bool> Running_{false};
+    std::thread Thread_;
+    std::mutex Mutex_;
+    State State_;
+    FlightManagementUnit::Mode Mode_ = FlightManagementUnit::kRunMode;
+    // the FMU's section cache
+    ConfigSections Sections_;
+    size_t Drop_ = 0;
+    void Poll() {
+      std::lock_guard<std::mutex> Lock(Mutex_);
+      if (Bus_.checkReceived()) {
+        FlightManagementUnit::Message Message = (FlightManagementUnit::Message) Bus_.read();
+        std::vector<uint8_t> Payload(Bus_.available());
+        Bus_.read(Payload.data(),Payload.size());
+        Bus_.sendStatus(true);
+        Handle(Message,Payload);
+      }
+      if (Mode_ == FlightManagementUnit::kRunMode) {
+        // sensor meta data with no sensors
+        uint8_t Metadata[10] = {0};
+        Send(FlightManagementUnit::kSensorData,Metadata,sizeof(Metadata));
+      }
+    }
+    void Handle(FlightManagementUnit::Message Message,std::vector<uint8_t> &Payload) {
+      if ((Message == FlightManagementUnit::kModeCommand)&&(Payload.size() == 1)) {
+        State_.ModeCommands++;
+        FlightManagementUnit::Mode Requested = (FlightManagementUnit::Mode) Payload[0];
+        if ((Mode_ == FlightManagementUnit::kRunMode)&&(Requested == FlightManagementUnit::kConfigMode)) {
+          State_.Applied.clear();
+          Sections_.ClearApplied();
+        }
+        if ((Mode_ == FlightManagementUnit::kConfigMode)&&(Requested == FlightManagementUnit::kRunMode)&&Sections_.Requested()) {
+          State_.Applied.clear();
+          Sections_.Apply([this](const char *Json) {
+            State_.Applied.push_back(Json);
+          });
+        }
+        Mode_ = Requested;
+      }
+      if (Message == FlightManagementUnit::kConfigMesg) {
+        State_.ConfigMessages++;
+        if (Drop_ > 0) {
+          Drop_--;
+          return;
+        }
+        std::string Json(Payload.begin(),Payload.end());
+        if (!Sections_.Cache(Json.data(),Json.size())) {
+          State_.Applied.push_back(Json);
+        }
+      }
+      if ((Message == FlightManagementUnit::kConfigHashes)&&Hashing_) {
+        State_.HashMessages++;
+        std::vector<uint32_t> Hashes(Payload.size()/sizeof(uint32_t));
+        memcpy(Hashes.data(),Payload.data(),Hashes.size()*sizeof(uint32_t));
+        std::vector<uint32_t> Reply;
+        if (Hashes.size() == 0) {
+          Sections_.GetApplied(&Reply);
+        } else {
+          Sections_.SetRequested(Hashes,&Reply);
+        }
+        Send(FlightManagementUnit::kConfigHashes,(uint8_t *)Reply.data(),Reply.size()*sizeof(uint32_t));
+      }
+    }
+    void Send(FlightManagementUnit::Message Message,uint8_t *Data,size_t Size) {
+      Bus_.beginTransmission();
+      Bus_.write((uint8_t) Message);
+      Bus_.write(Data,Size);
+      Bus_.sendTransmission();
+    }
+};
+
+/* Aircraft configuration with FMU control laws and Count effectors, the last one with the given channel */
+static void MakeConfig(size_t Count,int LastChannel,rapidjson::Document *Config) {
+  std::string Json = "{\"Mission-Manager\":{\"Soc-Engage-Switch\":{\"Source\":\"/Sensors/Sbus/Ch[5]\",\"Gain\":1}},"
+    "\"Control\":{\"Fmu\":\"PitchDamper\",\"PitchDamper\":[{\"Type\":\"Gain\",\"Input\":\"/Sensors/Fmu/Mpu9250/GyroY_rads\","
+    "\"Output\":\"cmdElev\",\"Gain\":0.1}]},\"Effectors\":[";
+  for (size_t i=0; i < Count; i++) {
+    int Channel = (i == Count-1) ? LastChannel : (int)i;
+    Json += std::string(i ? "," : "") + "{\"Type\":\"Pwm\",\"Input\":\"/Control/cmd" + std::to_string(i) + "\",\"Channel\":"
+      + std::to_string(Channel) + ",\"Calibration\":[1000,1500]}";
+  }
+  Json += "]}";
+  Config->Parse(Json.c_str());
+}
+
+int main() {
+  const size_t Effectors = 6;
+  // mission manager, control laws and one section per effector
+  const size_t Sections = 2 + Effectors;
+  rapidjson::Document Config, Changed;
+  MakeConfig(Effectors,7,&Config);
+  MakeConfig(Effectors,9,&Changed);
+
+  {
+    // a requested section that never arrived is not reported as applied
+    const char *Json[] = {"{\"A\":1}","{\"B\":2}","{\"C\":3}"};
+    std::vector<uint32_t> Hashes, Missing, Applied;
+    for (size_t i=0; i < 3; i++) {
+      Hashes.push_back(fnv1a32((const unsigned char *)Json[i],strlen(Json[i])));
+    }
+    ConfigSections Cache;
+    CHECK(!Cache.Cache(Json[0],strlen(Json[0])));
+    Cache.SetRequested(Hashes,&Missing);
+    CHECK(Missing == Hashes);
+    CHECK(Cache.Cache(Json[0],strlen(Json[0])));
+    CHECK(Cache.Cache(Json[2],strlen(Json[2])));
+    std::vector<std::string> Calls;
+    CHECK(Cache.Apply([&Calls](const char *Section) {Calls.push_back(Section);}) == 1);
+    CHECK((Calls.size() == 2)&&(Calls[0] == Json[0])&&(Calls[1] == Json[2]));
+    Cache.GetApplied(&Applied);
+    CHECK((Applied.size() == 2)&&(Applied[0] == Hashes[0])&&(Applied[1] == Hashes[2]));
+    CHECK(!Cache.Requested());
+    // asking again only needs the missing section
+    Cache.SetRequested(Hashes,&Missing);
+    CHECK((Missing.size() == 1)&&(Missing[0] == Hashes[1]));
+  }
+
+  {
+    PtyLink Link;
+    FlightManagementUnit Fmu;
+    Fmu.Begin(Link.Slave(0));
+    SimulatedFmu Simulated(Link.Slave(1),true);
+    Link.Connect();
+    Simulated.Start();
+
+    // first start, every section is uploaded and applied in order, then the applied list is checked
+    Fmu.Configure(Config);
+    SimulatedFmu::State First = Simulated.GetState();
+    CHECK(First.HashMessages == 3);
+    CHECK(First.ModeCommands == 2);
+    CHECK(First.ConfigMessages == Sections);
+    CHECK(First.Applied.size() == Sections);
+    CHECK((First.Applied.size() > 0)&&(First.Applied[0].find("Mission-Manager") != std::string::npos));
+    CHECK((First.Applied.size() == Sections)&&(First.Applied[Sections-1].find("\"Channel\":7") != std::string::npos));
+
+    // unchanged configuration, the FMU stays in run mode and nothing is uploaded
+    Fmu.Configure(Config);
+    SimulatedFmu::State Unchanged = Simulated.GetState();
+    CHECK(Unchanged.HashMessages == First.HashMessages + 1);
+    CHECK(Unchanged.ModeCommands == First.ModeCommands);
+    CHECK(Unchanged.ConfigMessages == First.ConfigMessages);
+    CHECK(Unchanged.Applied == First.Applied);
+
+    // one changed section, only it is uploaded and the whole list is applied from the cache
+    Fmu.Configure(Changed);
+    SimulatedFmu::State Updated = Simulated.GetState();
+    CHECK(Updated.ModeCommands == Unchanged.ModeCommands + 2);
+    CHECK(Updated.ConfigMessages == Unchanged.ConfigMessages + 1);
+    CHECK(Updated.Applied.size() == Sections);
+    CHECK((Updated.Applied.size() == Sections)&&(Updated.Applied[Sections-1].find("\"Channel\":9") != std::string::npos));
+    for (size_t i=0; (i < Sections-1)&&(Updated.Applied.size() == Sections); i++) {
+      CHECK(Updated.Applied[i] == First.Applied[i]);
+    }
+  }
+
+  {
+    PtyLink Link;
+    FlightManagementUnit Fmu;
+    Fmu.Begin(Link.Slave(0));
+    SimulatedFmu Simulated(Link.Slave(1),true);
+    Link.Connect();
+    Simulated.Start();
+
+    // a section lost on the way, the FMU reports it as not applied and the SOC uploads it again
+    Simulated.DropSections(1);
+    Fmu.Configure(Config);
+    SimulatedFmu::State Retried = Simulated.GetState();
+    CHECK(Retried.ModeCommands == 4);
+    CHECK(Retried.ConfigMessages == Sections + 1);
+    CHECK(Retried.Applied.size() == Sections);
+    CHECK((Retried.Applied.size() > 0)&&(Retried.Applied[0].find("Mission-Manager") != std::string::npos));
+
+    // next start it is unchanged
+    Fmu.Configure(Config);
+    CHECK(Simulated.GetState().ConfigMessages == Retried.ConfigMessages);
+
+    // a section that never arrives, the SOC gives up rather than run without it
+    Simulated.DropSections(SIZE_MAX);
+    bool Failed = false;
+    try {
+      Fmu.Configure(Changed);
+    } catch (std::runtime_error &) {
+      Failed = true;
+    }
+    CHECK(Failed);
+    // and it is not taken as applied on the next start
+    Simulated.DropSections(0);
+    Fmu.Configure(Changed);
+    SimulatedFmu::State Recovered = Simulated.GetState();
+    CHECK(Recovered.Applied.size() == Sections);
+    CHECK((Recovered.Applied.size() == Sections)&&(Recovered.Applied[Sections-1].find("\"Channel\":9") != std::string::npos));
+  }
+
+  {
+    // firmware without configuration hashes, the SOC times out and sends every section
+    PtyLink Link;
+    FlightManagementUnit Fmu;
+    Fmu.Begin(Link.Slave(0));
+    SimulatedFmu Simulated(Link.Slave(1),false);
+    Link.Connect();
+    Simulated.Start();
+    Fmu.Configure(Config);
+    SimulatedFmu::State Legacy = Simulated.GetState();
+    CHECK(Legacy.HashMessages == 0);
+    CHECK(Legacy.ModeCommands == 2);
+    CHECK(Legacy.ConfigMessages == Sections);
+    CHECK(Legacy.Applied.size() == Sections);
+  }
+
+  return TestResult();
+}
@@ -0,0 +1,83 @@
+/*
+test-general-functions.cpp
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+Runs the general function blocks in steady state under the heap monitor and
+checks none of them allocates once configured. Also checks the Delay ring
+buffer output for integer and fractional delays.
+*/
+
+#include "test.h"
+#include "general-functions.h"
+#include "heap-monitor.h"
+
+/* Configures a block from a JSON string under /Control/Test */
+static void Configure(GenericFunction *Block,const char *Json) {
+  rapidjson::Document Config;
+  Config.Parse(Json);
+  Block->Configure(Config,"/Control/Test");
+  Block->Initialize();
+}
+
+int main() {
+  Signal<float> InputA = deftree.initSignal<float>("/Test/InputA","Test input",LOG_FLOAT,LOG_NONE);
+  Signal<float> InputB = deftree.initSignal<float>("/Test/InputB","Test input",LOG_FLOAT,LOG_NONE);
+
+  ConstantClass Constant;
+  GainClass Gain;
+  SumClass Sum;
+  ProductClass Product;
+  DelayClass Delay, FractionalDelay;
+  LatchClass Latch;
+  Configure(&Constant,"{\"Output\":\"Constant\",\"Constant\":2.0}");
+  Configure(&Gain,"{\"Output\":\"Gain\",\"Input\":\"/Test/InputA\",\"Gain\":0.5,\"Limits\":{\"Lower\":-1.0,\"Upper\":1.0}}");
+  Configure(&Sum,"{\"Output\":\"Sum\",\"Inputs\":[\"/Test/InputA\",\"/Test/InputB\"],\"Limits\":{\"Lower\":-10.0,\"Upper\":10.0}}");
+  Configure(&Product,"{\"Output\":\"Product\",\"Inputs\":[\"/Test/InputA\",\"/Test/InputB\"]}");
+  Configure(&Delay,"{\"Output\":\"Delay\",\"Input\":\"/Test/InputA\",\"Delay_frames\":3}");
+  Configure(&FractionalDelay,"{\"Output\":\"FractionalDelay\",\"Input\":\"/Test/InputA\",\"Delay_frames\":1.5}");
+  Configure(&Latch,"{\"Output\":\"Latch\",\"Input\":\"/Test/InputA\"}");
+  std::vector<GenericFunction *> Blocks = {&Constant,&Gain,&Sum,&Product,&Delay,&FractionalDelay,&Latch};
+  Signal<float> DelayOutput = deftree.getSignal<float>("/Control/Test/Delay");
+  Signal<float> FractionalDelayOutput = deftree.getSignal<float>("/Control/Test/FractionalDelay");
+
+  // steady state, every mode, input k on frame k
+  const size_t Frames = 1000;
+  const GenericFunction::Mode Modes[] = {GenericFunction::kStandby,GenericFunction::kArm,GenericFunction::kHold,GenericFunction::kEngage};
+  HeapMonitor::Arm(0);
+  for (size_t k=0; k < Frames; k++) {
+    HeapMonitor::BeginFrame();
+    InputA.set((float)k);
+    InputB.set(1.0f - (float)k);
+    for (size_t i=0; i < Blocks.size(); i++) {
+      Blocks[i]->Run(Modes[(k/10) % 4]);
+    }
+    HeapMonitor::EndFrame();
+    if (k >= 3) {
+      CHECK(DelayOutput.get() == (float)(k-3));
+    } else {
+      CHECK(DelayOutput.get() == 0.0f);
+    }
+    if (k >= 2) {
+      CHECK(FractionalDelayOutput.get() == (float)k - 1.5f);
+    }
+  }
+  CHECK(HeapMonitor::Allocations() == 0);
+  return TestResult();
+}
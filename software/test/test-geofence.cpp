@@ -0,0 +1,111 @@
+/*
+test-geofence.cpp
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+Positions relative fences at a simulated first fix and checks, with the heap
+monitor, that the geofence manager's update on the flight thread never allocates: Ready stays
+0 while the builder thread indexes the fences and the checks start once it hands
+them over.
+*/
+
+#include "test.h"
+#include "geofence.hxx"
+#include "heap-monitor.h"
+#include <chrono>
+#include <thread>
+
+/* Runs update as a flight loop frame would, under the heap monitor */
+static void Update(FGGeofenceMgr *Geofence) {
+  HeapMonitor::BeginFrame();
+  Geofence->update();
+  HeapMonitor::EndFrame();
+}
+
+int main() {
+  const double Lat_rad = 45.0*M_PI/180.0, Lon_rad = -93.0*M_PI/180.0;
+  ElementPtr Latitude = deftree.initElement("/Sensor-Processing/Latitude_rad","Latitude, rad",LOG_DOUBLE,LOG_NONE);
+  ElementPtr Longitude = deftree.initElement("/Sensor-Processing/Longitude_rad","Longitude, rad",LOG_DOUBLE,LOG_NONE);
+  ElementPtr Altitude = deftree.initElement("/Sensor-Processing/Altitude_m","Altitude, m",LOG_FLOAT,LOG_NONE);
+  ElementPtr Fix = deftree.initElement("/Sensors/uBlox/Fix","GPS fix",LOG_UINT8,LOG_NONE);
+  Latitude->setDouble(Lat_rad);
+  Longitude->setDouble(Lon_rad);
+  Altitude->setFloat(50.0f);
+  Fix->setInt(0);
+
+  // a 1 km box around the fix and a 100 m box centered 300 m north of it
+  rapidjson::Document Config;
+  Config.Parse("{\"fences\":["
+    "{\"name\":\"Range\",\"type\":\"inclusion\",\"ceiling_m\":400,\"waypoints\":["
+    "{\"heading_deg\":45,\"dist_m\":707},{\"heading_deg\":135,\"dist_m\":707},"
+    "{\"heading_deg\":225,\"dist_m\":707},{\"heading_deg\":315,\"dist_m\":707}]},"
+    "{\"name\":\"Tower\",\"type\":\"exclusion\",\"waypoints\":["
+    "{\"heading_deg\":11.31,\"dist_m\":254.95},{\"heading_deg\":8.13,\"dist_m\":353.55},"
+    "{\"heading_deg\":351.87,\"dist_m\":353.55},{\"heading_deg\":348.69,\"dist_m\":254.95}]}]}");
+  FGGeofenceMgr Geofence;
+  Geofence.init(Config);
+  Geofence.begin(NULL);
+  ElementPtr Ready = deftree.getElement("/Geofence/Ready");
+  ElementPtr Violation = deftree.getElement("/Geofence/Violation");
+  ElementPtr Margin = deftree.getElement("/Geofence/Margin_m");
+  ElementPtr RangeInside = deftree.getElement("/Geofence/Range/Inside");
+  ElementPtr TowerInside = deftree.getElement("/Geofence/Tower/Inside");
+
+  // no fix, nothing positioned
+  HeapMonitor::Arm(0);
+  for (size_t i=0; i < 10; i++) {
+    Update(&Geofence);
+    CHECK(Ready->getInt() == 0);
+  }
+
+  // first fix, the flight thread only hands over the reference
+  Fix->setInt(1);
+  size_t Frames = 0;
+  auto Start = std::chrono::steady_clock::now();
+  while ((Ready->getInt() == 0)&&(std::chrono::steady_clock::now() - Start < std::chrono::seconds(10))) {
+    Update(&Geofence);
+    Frames++;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  CHECK(Ready->getInt() == 1);
+  CHECK(Frames > 0);
+
+  // at the fix, inside the range and 250 m clear of the tower
+  Update(&Geofence);
+  CHECK(RangeInside->getInt() == 1);
+  CHECK(TowerInside->getInt() == 0);
+  CHECK(Violation->getInt() == 0);
+  CHECK((Margin->getFloat() > 245.0f)&&(Margin->getFloat() < 255.0f));
+
+  // 300 m north is inside the tower box
+  Latitude->setDouble(Lat_rad + 300.0/6367000.0);
+  Update(&Geofence);
+  CHECK(TowerInside->getInt() == 1);
+  CHECK(Violation->getInt() == 1);
+
+  // above the range ceiling
+  Latitude->setDouble(Lat_rad);
+  Altitude->setFloat(450.0f);
+  Update(&Geofence);
+  CHECK(RangeInside->getInt() == 0);
+  CHECK(Violation->getInt() == 1);
+
+  CHECK(HeapMonitor::Allocations() == 0);
+  return TestResult();
+}
@@ -0,0 +1,68 @@
+/*
+test-heap-monitor.cpp
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+Built with HEAP_MONITOR, checks each allocation path is counted inside a frame,
+including aligned operator new and Eigen's aligned allocations, and that nothing
+is counted outside a frame or during the warmup frames.
+*/
+
+#include "test.h"
+#include "heap-monitor.h"
+#include <Eigen/Dense>
+#include <new>
+#include <stdlib.h>
+#include <malloc.h>
+
+struct alignas(64) OverAligned {
+  float Data[16];
+};
+
+/* Runs Allocate in a monitored frame, returns the number of allocations counted */
+template <typename Function>
+static uint64_t Count(Function Allocate) {
+  uint64_t Before = HeapMonitor::Allocations();
+  HeapMonitor::BeginFrame();
+  Allocate();
+  HeapMonitor::EndFrame();
+  return HeapMonitor::Allocations() - Before;
+}
+
+int main() {
+  // volatile keeps the compiler from eliding the allocations
+  void * volatile Ptr = NULL;
+  HeapMonitor::Arm(1);
+  CHECK(Count([&]() { free(Ptr = malloc(16)); }) == 0);
+  CHECK(Count([&]() { free(Ptr = malloc(16)); }) == 1);
+  CHECK(Count([&]() { free(Ptr = calloc(4,4)); }) == 1);
+  CHECK(Count([&]() { Ptr = malloc(16); free(Ptr = realloc(Ptr,64)); }) == 2);
+  CHECK(Count([&]() { void *Aligned; if (posix_memalign(&Aligned,64,64) == 0) free(Ptr = Aligned); }) == 1);
+  CHECK(Count([&]() { free(Ptr = aligned_alloc(64,64)); }) == 1);
+  CHECK(Count([&]() { free(Ptr = memalign(64,64)); }) == 1);
+  CHECK(Count([&]() { free(Ptr = valloc(64)); }) == 1);
+  CHECK(Count([&]() { delete (OverAligned *)(Ptr = new OverAligned); }) == 1);
+  CHECK(Count([&]() { delete (int *)(Ptr = new int); }) == 1);
+  CHECK(Count([&]() { Eigen::MatrixXf Matrix(8,8); Ptr = Matrix.data(); }) == 1);
+  // outside a frame nothing is counted
+  uint64_t Before = HeapMonitor::Allocations();
+  free(Ptr = aligned_alloc(64,64));
+  CHECK(HeapMonitor::Allocations() == Before);
+  return TestResult();
+}
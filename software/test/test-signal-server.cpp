@@ -0,0 +1,206 @@
+/*
+test-signal-server.cpp
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+Subscribes UDP clients on the loopback to a signal server serving a snapshot
+published at 100 Hz, checks the ack types, the update frames and checksums, the
+decimation to the requested rate, that a full subscriber table refuses new clients
+and that the slots of clients that stop renewing their lease are freed.
+*/
+
+#include "test.h"
+#include "signal_server.hxx"
+#include "checksum.h"
+#include <string.h>
+#include <chrono>
+#include <thread>
+
+static const int Port_ = 47391;
+static const double Lease_s = 0.5;
+
+/* Reads one frame from the client, returns its type or 0 if none arrived */
+static int Receive(netSocket *Client, std::vector<uint8_t> *Payload) {
+  uint8_t Buffer[2048];
+  int Length = Client->recv(Buffer,sizeof(Buffer));
+  if (Length <= 0) {
+    return 0;
+  }
+  uint16_t PayloadLength, Sum;
+  CHECK(Length >= 7);
+  CHECK((Buffer[0] == 'B')&&(Buffer[1] == 'S'));
+  memcpy(&PayloadLength,Buffer+3,sizeof(PayloadLength));
+  CHECK(Length == 5 + PayloadLength + 2);
+  memcpy(&Sum,Buffer+5+PayloadLength,sizeof(Sum));
+  CHECK(Sum == fletcher16(Buffer+2,3+PayloadLength));
+  Payload->assign(Buffer+5,Buffer+5+PayloadLength);
+  return Buffer[2];
+}
+
+/* Sends a request and serves it, returns the type of the reply */
+static int Request(netSocket *Client, const char *Line, std::vector<uint8_t> *Payload) {
+  netAddress Server("127.0.0.1",Port_);
+  Client->sendto(Line,strlen(Line),0,&Server);
+  for (size_t i=0; i < 100; i++) {
+    netChannel::poll(10);
+    int Type = Receive(Client,Payload);
+    if (Type != 0) {
+      return Type;
+    }
+  }
+  return 0;
+}
+
+/* Opens a non blocking UDP client */
+static void Open(netSocket *Client) {
+  Client->open(false);
+  Client->setBlocking(false);
+}
+
+/* Drains the client, returns the number of update frames it received */
+static size_t Updates(netSocket *Client) {
+  std::vector<uint8_t> Payload;
+  size_t Count = 0;
+  int Type;
+  while ((Type = Receive(Client,&Payload)) != 0) {
+    if (Type == UGSignalServer::kUpdate) {
+      Count++;
+    }
+  }
+  return Count;
+}
+
+int main() {
+  netInit();
+  ElementPtr Time = deftree.initElement("/Sensors/Fmu/Time_us","Time, us",LOG_UINT64,LOG_NONE);
+  ElementPtr Altitude = deftree.initElement("/Sensor-Processing/Altitude_m","Altitude, m",LOG_FLOAT,LOG_NONE);
+  Time->setLong(1000000);
+  Altitude->setFloat(0.0f);
+  DefinitionTreeSnapshot Snapshot;
+  Snapshot.Configure("/");
+  Snapshot.Publish();
+  UGSignalServer Server(Port_,&Snapshot,Lease_s);
+  CHECK(Server.open());
+
+  // publishes a 100 Hz frame and serves it
+  uint64_t Time_us = 1000000;
+  auto Frame = [&]() {
+    Time_us += 10000;
+    deftree.NextGeneration();
+    Time->setLong(Time_us);
+    Altitude->setFloat(Altitude->getFloat() + 1.0f);
+    Snapshot.Publish();
+    Server.update();
+  };
+
+  // ack lists the signal types, none for an unknown signal
+  netSocket Decimated, Every;
+  Open(&Decimated);
+  Open(&Every);
+  std::vector<uint8_t> Payload;
+  CHECK(Request(&Decimated,"subscribe 25 /Sensors/Fmu/Time_us /Sensor-Processing/Altitude_m /Missing",&Payload) == UGSignalServer::kAck);
+  CHECK(Payload.size() == 5);
+  if (Payload.size() == 5) {
+    uint16_t Count;
+    memcpy(&Count,Payload.data(),sizeof(Count));
+    CHECK(Count == 3);
+    CHECK(Payload[2] == Element::LONGLONG);
+    CHECK(Payload[3] == Element::FLOAT);
+    CHECK(Payload[4] == Element::NONE);
+  }
+  CHECK(Request(&Every,"subscribe 0 /Sensor-Processing/Altitude_m",&Payload) == UGSignalServer::kAck);
+  CHECK(Request(&Every,"bogus",&Payload) == UGSignalServer::kError);
+  CHECK(Request(&Every,"subscribe 0 /Sensor-Processing/Altitude_m",&Payload) == UGSignalServer::kAck);
+
+  // update frames carry the frame, the time and the typed values
+  Frame();
+  int Type = Receive(&Decimated,&Payload);
+  CHECK(Type == UGSignalServer::kUpdate);
+  CHECK(Payload.size() == 8 + 8 + 9 + 5 + 1);
+  if ((Type == UGSignalServer::kUpdate)&&(Payload.size() == 31)) {
+    uint64_t FrameNumber, FrameTime_us;
+    int64_t Value;
+    float Altitude_m;
+    memcpy(&FrameNumber,Payload.data(),sizeof(FrameNumber));
+    memcpy(&FrameTime_us,Payload.data()+8,sizeof(FrameTime_us));
+    memcpy(&Value,Payload.data()+17,sizeof(Value));
+    memcpy(&Altitude_m,Payload.data()+26,sizeof(Altitude_m));
+    CHECK(FrameNumber == Snapshot.Frame());
+    CHECK(FrameTime_us == Time_us);
+    CHECK(Payload[16] == Element::LONGLONG);
+    CHECK(Value == (int64_t)Time_us);
+    CHECK(Payload[25] == Element::FLOAT);
+    CHECK(Altitude_m == 1.0f);
+    CHECK(Payload[30] == Element::NONE);
+  }
+  CHECK(Updates(&Decimated) == 0);
+  CHECK(Updates(&Every) == 1);
+
+  // 25 Hz out of 100 Hz frames is every fourth frame, 0 Hz every frame
+  for (size_t i=0; i < 100; i++) {
+    Frame();
+  }
+  CHECK(Updates(&Decimated) == 25);
+  CHECK(Updates(&Every) == 100);
+
+  // fill the subscriber table, the next client is refused
+  std::vector<netSocket> Clients(14);
+  for (size_t i=0; i < Clients.size(); i++) {
+    Open(&Clients[i]);
+    CHECK(Request(&Clients[i],"subscribe 0 /Sensors/Fmu/Time_us",&Payload) == UGSignalServer::kAck);
+  }
+  netSocket Late;
+  Open(&Late);
+  CHECK(Request(&Late,"subscribe 0 /Sensors/Fmu/Time_us",&Payload) == UGSignalServer::kError);
+
+  // unsubscribing frees a slot right away
+  CHECK(Request(&Clients[0],"unsubscribe",&Payload) == UGSignalServer::kAck);
+  CHECK(Request(&Late,"subscribe 0 /Sensors/Fmu/Time_us",&Payload) == UGSignalServer::kAck);
+  Frame();
+  CHECK(Updates(&Clients[0]) == 0);
+  CHECK(Updates(&Late) == 1);
+  CHECK(Updates(&Every) == 1);
+
+  // only the client that renews its lease keeps receiving frames
+  auto Start = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() - Start < std::chrono::duration<double>(1.5*Lease_s)) {
+    CHECK(Request(&Every,"subscribe 0 /Sensor-Processing/Altitude_m",&Payload) == UGSignalServer::kAck);
+    std::this_thread::sleep_for(std::chrono::duration<double>(Lease_s/5.0));
+  }
+  Updates(&Every);
+  Updates(&Decimated);
+  Updates(&Late);
+  for (size_t i=1; i < Clients.size(); i++) {
+    Updates(&Clients[i]);
+  }
+  Frame();
+  CHECK(Updates(&Every) == 1);
+  CHECK(Updates(&Decimated) == 0);
+  CHECK(Updates(&Late) == 0);
+  for (size_t i=1; i < Clients.size(); i++) {
+    CHECK(Updates(&Clients[i]) == 0);
+  }
+
+  // the expired clients' slots are free again
+  for (size_t i=0; i < Clients.size(); i++) {
+    CHECK(Request(&Clients[i],"subscribe 0 /Sensors/Fmu/Time_us",&Payload) == UGSignalServer::kAck);
+  }
+  CHECK(Request(&Decimated,"subscribe 0 /Sensors/Fmu/Time_us",&Payload) == UGSignalServer::kAck);
+  return TestResult();
+}
@@ -0,0 +1,45 @@
+/*
+test.h
+Brian R Taylor
+brian.taylor@bolderflight.com
+
+Copyright (c) 2018 Bolder Flight Systems
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+and associated documentation files (the "Software"), to deal in the Software without restriction,
+including without limitation the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all copies or
+substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <iostream>
+
+/*
+Minimal checks for the host tests and benchmarks ("make test", "make bench").
+Each program is its own executable, CHECK reports a failed condition and keeps
+going, and main returns TestResult() so make stops on the first failing program.
+*/
+
+static int TestFailures = 0;
+
+#define CHECK(Condition) do { \
+  if (!(Condition)) { \
+    std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #Condition << std::endl; \
+    TestFailures++; \
+  } \
+} while (0)
+
+static inline int TestResult() {
+  return TestFailures ? 1 : 0;
+}
+
+#endif